@@ -4,34 +4,103 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../source/adaptive_timing.c \
+../source/boot.c \
+../source/conflict_monitor.c \
+../source/console.c \
+../source/crashdump.c \
+../source/crosswalk_policy.c \
+../source/cycle_bench.c \
+../source/faultlog.c \
+../source/greenwave.c \
+../source/greenwave_uart.c \
+../source/inputrec.c \
+../source/logfmt.c \
+../source/logfmt_bench.c \
+../source/logtok.c \
 ../source/main.c \
+../source/metrics.c \
 ../source/mtb.c \
+../source/night_mode.c \
+../source/phase_controller.c \
+../source/power_mode.c \
 ../source/pwm.c \
 ../source/semihost_hardfault.c \
 ../source/statemachine.c \
 ../source/switch.c \
+../source/telemetry.c \
+../source/timebase.c \
 ../source/timer.c \
-../source/touchslider.c 
+../source/touchslider.c \
+../source/update.c \
+../source/update_flash.c \
+../source/watchdog.c 
 
 OBJS += \
+./source/adaptive_timing.o \
+./source/boot.o \
+./source/conflict_monitor.o \
+./source/console.o \
+./source/crashdump.o \
+./source/crosswalk_policy.o \
+./source/cycle_bench.o \
+./source/faultlog.o \
+./source/greenwave.o \
+./source/greenwave_uart.o \
+./source/inputrec.o \
+./source/logfmt.o \
+./source/logfmt_bench.o \
+./source/logtok.o \
 ./source/main.o \
+./source/metrics.o \
 ./source/mtb.o \
+./source/night_mode.o \
+./source/phase_controller.o \
+./source/power_mode.o \
 ./source/pwm.o \
 ./source/semihost_hardfault.o \
 ./source/statemachine.o \
 ./source/switch.o \
+./source/telemetry.o \
+./source/timebase.o \
 ./source/timer.o \
-./source/touchslider.o 
+./source/touchslider.o \
+./source/update.o \
+./source/update_flash.o \
+./source/watchdog.o 
 
 C_DEPS += \
+./source/adaptive_timing.d \
+./source/boot.d \
+./source/conflict_monitor.d \
+./source/console.d \
+./source/crashdump.d \
+./source/crosswalk_policy.d \
+./source/cycle_bench.d \
+./source/faultlog.d \
+./source/greenwave.d \
+./source/greenwave_uart.d \
+./source/inputrec.d \
+./source/logfmt.d \
+./source/logfmt_bench.d \
+./source/logtok.d \
 ./source/main.d \
+./source/metrics.d \
 ./source/mtb.d \
+./source/night_mode.d \
+./source/phase_controller.d \
+./source/power_mode.d \
 ./source/pwm.d \
 ./source/semihost_hardfault.d \
 ./source/statemachine.d \
 ./source/switch.d \
+./source/telemetry.d \
+./source/timebase.d \
 ./source/timer.d \
-./source/touchslider.d 
+./source/touchslider.d \
+./source/update.d \
+./source/update_flash.d \
+./source/watchdog.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
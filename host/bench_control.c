@@ -0,0 +1,384 @@
+/**
+ * @file    bench_control.c
+ * @brief   This source file runs the benchmarks of the control hot paths on the host build and
+ * 			prints the results as JSON for tools/bench_compare.py
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal_host.h"
+#include "statemachine.h"
+#include "timer.h"
+#include "switch.h"
+#include "pwm.h"
+#include "conflict_monitor.h"
+#include "faultlog.h"
+#include "watchdog.h"
+#include "telemetry.h"
+
+#define SAMPLES				(101)	/*Odd, so that the median is one sample*/
+#define SAMPLE_NS			(2000000) /*Each sample runs about 2 msec*/
+#define CALIBRATION_NS		(200000)
+#define NS_PER_SECOND		(1000000000ull)
+#define FADE_STEPS			(16)	/*fadeStep of a transition runs 0 to 15*/
+#define CYCLE_TICKS			(768)	/*STOP, TRANSITION_TO_GO, GO, TRANSITION_TO_WARNING, WARNING, TRANSITION_TO_STOP*/
+
+
+#define BENCH_COUNT			(13)
+
+typedef void (*bench_fn_t)(uint32_t iterations);
+
+typedef struct
+{
+	const char *name;
+	bench_fn_t run;
+	void (*setup)(void);		/*Called before every sample*/
+} bench_t;
+
+volatile uint32_t benchSink;		/*Keeps results of timer reads alive*/
+static uint8_t benchState;
+/*Every colour is allowed, so commits take the full check and never trip the monitor*/
+static const conflict_monitor_rule_t benchRules[] = { MONITOR_RULE_BETWEEN(0, 0, 0, 255, 255, 255) };
+
+/*
+ * @brief Monotonic time in nsec
+ *
+ * @return time
+ */
+static uint64_t bench_now(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * NS_PER_SECOND + (uint64_t)time.tv_nsec;
+}
+
+/*
+ * @brief set_led_colour() of one transition, every fade step in turn
+ *
+ * @return void
+ */
+static void bench_fade(uint8_t previousState, uint32_t iterations)
+{
+	sm_ctx_t *ctx = statemachine_context();
+	uint32_t index;
+
+	for (index = 0; index < iterations; index++)
+	{
+		ctx->fadeStep = (int8_t)(index & (FADE_STEPS - 1));
+		set_led_colour(previousState);
+	}
+}
+
+static void bench_set_led_stop(uint32_t iterations) { bench_fade(START, iterations); }
+static void bench_set_led_to_go(uint32_t iterations) { bench_fade(STOP, iterations); }
+static void bench_set_led_to_warning(uint32_t iterations) { bench_fade(GO, iterations); }
+static void bench_set_led_to_stop(uint32_t iterations) { bench_fade(WARNING, iterations); }
+static void bench_set_led_to_crosswalk(uint32_t iterations) { bench_fade(TRANSITION_TO_CROSSWALK, iterations); }
+static void bench_set_led_from_crosswalk(uint32_t iterations) { bench_fade(CROSSWALK, iterations); }
+
+/*
+ * @brief update_led_colour() with a changing colour
+ *
+ * @return void
+ */
+static void bench_update_led(uint32_t iterations)
+{
+	uint32_t index;
+
+	for (index = 0; index < iterations; index++)
+	{
+		update_led_colour(index & 0xFF, (index >> 1) & 0xFF, (index >> 2) & 0xFF);
+	}
+}
+
+/*
+ * @brief check_button_pressed() with the mocked TSI not touched
+ *
+ * @return void
+ */
+static void bench_check_button(uint32_t iterations)
+{
+	uint32_t index;
+
+	for (index = 0; index < iterations; index++)
+	{
+		benchSink += check_button_pressed();
+	}
+}
+
+/*
+ * @brief now(), get_timer() and current_time() as the state machine reads them
+ *
+ * @return void
+ */
+static void bench_timer_read(uint32_t iterations)
+{
+	uint32_t index;
+
+	for (index = 0; index < iterations; index++)
+	{
+		benchSink += now() + get_timer() + current_time();
+	}
+}
+
+/*
+ * @brief One full STOP to STOP cycle of the state machine, main loop iterations and ticks
+ *
+ * @return void
+ */
+static void bench_state_machine_cycle(uint32_t iterations)
+{
+	uint32_t index;
+	uint32_t tick;
+	int loop;
+
+	for (index = 0; index < iterations; index++)
+	{
+		for (tick = 0; tick < CYCLE_TICKS; tick++)
+		{
+			host_tick();
+			for (loop = 0; loop < HOST_LOOPS_PER_TICK; loop++)
+			{
+				statemachine_poll();
+			}
+		}
+	}
+}
+
+/*
+ * @brief The same cycle on an instance of its own through sm_step() alone, once per tick
+ * without the main loop, the inputs or the led, as a caller simulating many instances would
+ *
+ * @return void
+ */
+static void bench_sm_step_cycle(uint32_t iterations)
+{
+	static const sm_inputs_t inputs = { .pressed = false, .actuations = 0 };
+	sm_ctx_t ctx;
+	sm_outputs_t outputs;
+	uint32_t index;
+	ticktime tick;
+
+	for (index = 0; index < iterations; index++)
+	{
+		sm_init(&ctx, &smDefaultConfig, 0);
+		for (tick = 1; tick <= CYCLE_TICKS; tick++)
+		{
+			do
+			{
+				sm_step(&ctx, tick, &inputs, &outputs);
+			} while (outputs.state != outputs.previousState);
+			benchSink += outputs.write;
+		}
+	}
+}
+
+/*
+ * @brief Encodes the frame of a busy second, two state changes and counters past 8 bits:
+ * the CPU cost per frame of the telemetry uplink
+ *
+ * @return void
+ */
+static void bench_telemetry_frame(uint32_t iterations)
+{
+	static const telemetry_sample_t sample = {
+		.tick = 12345, .state = GO, .timeInState = 40, .presses = 300, .ignored = 12, .actuations = 4000,
+		.tsiScans = 20000, .loopIterations = 900, .tsiScanCycles = 25000
+	};
+	static const uint8_t events[2][2] = { { 0x2A, TRANSITION_TO_GO }, { 0x30, GO } };
+	uint8_t frame[TELEMETRY_FRAME_MAX];
+	uint32_t index;
+
+	for (index = 0; index < iterations; index++)
+	{
+		benchSink += telemetry_encode(&sample, (uint8_t)index, events, 2, frame);
+	}
+}
+
+/*
+ * @brief Fixed integer work, the other results are also given relative to it so that a
+ * host running slower or faster as a whole does not look like a regression
+ *
+ * @return void
+ */
+static void bench_reference(uint32_t iterations)
+{
+	uint32_t value = benchSink;
+	uint32_t index;
+
+	for (index = 0; index < iterations; index++)
+	{
+		value = value * 1664525u + 1013904223u;
+		__asm__ volatile("" : "+r"(value));
+	}
+	benchSink = value;
+}
+
+/*
+ * @brief Commits are checked against rules which allow every colour
+ *
+ * @return void
+ */
+static void setup_bench_rules(void)
+{
+	conflict_monitor_init(&benchState, benchRules, 1);
+}
+
+static const bench_t benches[BENCH_COUNT] = {
+	{ "reference", bench_reference, setup_bench_rules },
+	{ "set_led_colour/stop", bench_set_led_stop, setup_bench_rules },
+	{ "set_led_colour/to_go", bench_set_led_to_go, setup_bench_rules },
+	{ "set_led_colour/to_warning", bench_set_led_to_warning, setup_bench_rules },
+	{ "set_led_colour/to_stop", bench_set_led_to_stop, setup_bench_rules },
+	{ "set_led_colour/to_crosswalk", bench_set_led_to_crosswalk, setup_bench_rules },
+	{ "set_led_colour/from_crosswalk", bench_set_led_from_crosswalk, setup_bench_rules },
+	{ "update_led_colour", bench_update_led, setup_bench_rules },
+	{ "check_button_pressed", bench_check_button, setup_bench_rules },
+	{ "timer_read", bench_timer_read, setup_bench_rules },
+	{ "state_machine_cycle", bench_state_machine_cycle, statemachine_init }, /*From STOP with its own rules*/
+	{ "sm_step_cycle", bench_sm_step_cycle, setup_bench_rules },
+	{ "telemetry_frame", bench_telemetry_frame, setup_bench_rules },
+};
+
+static int compare_u64(const void *a, const void *b)
+{
+	uint64_t left = *(const uint64_t *)a;
+	uint64_t right = *(const uint64_t *)b;
+
+	return (left > right) - (left < right);
+}
+
+/*
+ * @brief Time of one sample of a benchmark
+ *
+ * @return nsec
+ */
+static uint64_t time_sample(const bench_t *bench, uint32_t iterations)
+{
+	uint64_t start;
+
+	bench->setup();
+	start = bench_now();
+	bench->run(iterations);
+	return bench_now() - start;
+}
+
+/*
+ * @brief Iterations for a sample of about SAMPLE_NS
+ *
+ * @return iterations
+ */
+static uint32_t calibrate(const bench_t *bench)
+{
+	uint32_t iterations = 1;
+	uint64_t elapsed;
+	int pass;
+
+	while ((elapsed = time_sample(bench, iterations)) < CALIBRATION_NS)
+	{
+		iterations *= 2;
+	}
+	for (pass = 0; pass < 3; pass++)		/*The first estimates are taken on a cold cache*/
+	{
+		iterations = (uint32_t)((uint64_t)iterations * SAMPLE_NS / elapsed) + 1;
+		elapsed = time_sample(bench, iterations);
+	}
+	return iterations;
+}
+
+/*
+ * @brief Runs every benchmark SAMPLES times, one sample of each in turn
+ *
+ * Interleaving spreads a slow period of the host over all benchmarks instead of one. The
+ * minimum over the samples is the result, it is the least disturbed by the host, the median
+ * is printed for reference
+ *
+ * @return void
+ */
+static void run_benches(FILE *out)
+{
+	static uint64_t samples[BENCH_COUNT][SAMPLES];
+	uint32_t iterations[BENCH_COUNT];
+	double reference = 0;
+	int sample;
+	int index;
+
+	for (index = 0; index < BENCH_COUNT; index++)
+	{
+		iterations[index] = calibrate(&benches[index]);
+	}
+	for (sample = 0; sample < SAMPLES; sample++)
+	{
+		for (index = 0; index < BENCH_COUNT; index++)
+		{
+			samples[index][sample] = time_sample(&benches[index], iterations[index]);
+		}
+	}
+
+	fprintf(out, "{\n  \"benchmarks\": {\n");
+	for (index = 0; index < BENCH_COUNT; index++)
+	{
+		double nsPerOp;
+
+		qsort(samples[index], SAMPLES, sizeof(samples[index][0]), compare_u64);
+		nsPerOp = samples[index][0] / (double)iterations[index];
+		if (index == 0)
+		{
+			reference = nsPerOp;
+		}
+		fprintf(out, "    \"%s\": {\"ns_per_op\": %.3f, \"median_ns_per_op\": %.3f, \"relative\": %.4f, "
+				"\"iterations\": %lu, \"samples\": %d}%s\n",
+				benches[index].name, nsPerOp, samples[index][SAMPLES / 2] / (double)iterations[index],
+				nsPerOp / reference, (unsigned long)iterations[index], SAMPLES, (index == BENCH_COUNT - 1) ? "" : ",");
+	}
+	fprintf(out, "  }\n}\n");
+}
+
+int main(int argc, char **argv)
+{
+	FILE *out = stdout;
+	cpu_set_t cpus;
+
+	if ((argc == 3) && (strcmp(argv[1], "--json") == 0))
+	{
+		out = fopen(argv[2], "w");
+		if (out == NULL)
+		{
+			perror(argv[2]);
+			return 1;
+		}
+	}
+	else if (argc != 1)
+	{
+		printf("usage: %s [--json FILE]\n", argv[0]);
+		return 1;
+	}
+
+	CPU_ZERO(&cpus);			/*One core, no migration between samples*/
+	CPU_SET(0, &cpus);
+	sched_setaffinity(0, sizeof(cpus), &cpus);
+
+	Init_Red_LED_PWM();
+	Init_Green_LED_PWM();
+	Init_Blue_LED_PWM();
+	Init_SysTick();
+	init_switch();
+	faultlog_init();
+	watchdog_init();
+	statemachine_init();
+
+	run_benches(out);
+	if (out != stdout)
+	{
+		fclose(out);
+	}
+	return conflictMonitor.tripped ? 1 : 0;
+}
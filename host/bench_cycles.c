@@ -0,0 +1,38 @@
+/**
+ * @file    bench_cycles.c
+ * @brief   This source file runs the cycle count benchmark image on the host as a smoke test
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include "hal_host.h"
+#include "cycle_bench.h"
+#include "statemachine.h"
+#include "timer.h"
+#include "switch.h"
+#include "pwm.h"
+#include "conflict_monitor.h"
+#include "faultlog.h"
+#include "watchdog.h"
+
+/*
+ * @brief Initializes the modules as main() does and runs the same benchmark as the
+ * CYCLE_BENCHMARK firmware image, the counts are TSC ticks instead of core cycles
+ *
+ * @return 1 when a routine tripped the conflict monitor, else 0
+ */
+int main(void)
+{
+	Init_Red_LED_PWM();
+	Init_Green_LED_PWM();
+	Init_Blue_LED_PWM();
+	Init_SysTick();
+	init_switch();
+	faultlog_init();
+	watchdog_init();
+	statemachine_init();
+
+	cycle_benchmark();
+	return conflictMonitor.tripped ? 1 : 0;
+}
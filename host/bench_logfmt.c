@@ -0,0 +1,19 @@
+/**
+ * @file    bench_logfmt.c
+ * @brief   This source file runs the LOG formatter microbenchmark on the host
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include "logfmt.h"
+
+/*
+ * @brief Runs the same check and benchmark as the LOGFMT_BENCHMARK firmware build
+ *
+ * @return 1 if the output of a formatter does not match snprintf()
+ */
+int main(void)
+{
+	return logfmt_benchmark() ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file    crashdump_host.c
+ * @brief   Host stand-in for source/crashdump.c, there is no HardFault and no flash to save to
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include "crashdump.h"
+
+crashdump_t crashDump;
+
+/**
+ * @brief Reports a dump left by the previous run, never on the host
+ *
+ * @return void
+ */
+void crashdump_init(void)
+{
+}
+
+/**
+ * @brief Prints the dump saved in flash to the console
+ *
+ * @return void
+ */
+void crashdump_report_saved(void)
+{
+	logfmt_printf("\r\nno crash dump saved\r\n");
+}
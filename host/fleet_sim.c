@@ -0,0 +1,990 @@
+/**
+ * @file    fleet_sim.c
+ * @brief   This source file consists of the fleet simulator which steps many intersections at
+ * 			once. Their states are kept as one array per field, so that a SIMD kernel advances
+ * 			16 of them per instruction, checked tick by tick against sm_step() and timed against
+ * 			the loop calling it for every intersection
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "statemachine.h"
+
+#define TICKS_PER_SECOND		(16)
+#define SECONDS_PER_HOUR		(3600)
+#define DEFAULT_INSTANCES		(4096)
+#define DEFAULT_SECONDS			(900)
+#define DEFAULT_PRESS_RATE		(40)	/*Presses per hour at every intersection*/
+#define DEFAULT_DEMAND			(300)	/*Vehicles per hour at every intersection*/
+#define ADAPTIVE_MIN_GO			(5)		/*Adaptive GO limits in seconds, as in sim.c*/
+#define ADAPTIVE_MAX_GO			(40)
+#define ADAPTIVE_PASSAGE		(3)
+#define TIMING_RUNS				(3)		/*The fastest run of every kernel counts*/
+#define NS_PER_SECOND			(1000000000.0)
+#define RANDOM_RANGE			(1u << 24)
+#define NO_EVENT				(~0ull)
+#define VEHICLE_SEED			(0x5A5A5A5Au) /*Vehicles are drawn from another stream than the presses*/
+
+#define FLEET_LANES				(16)	/*Intersections per vector, 16 bit lanes fill an AVX2 register*/
+#define FLEET_ALIGN				(32)
+#define TIMER_MAX				(0x7FFF) /*Timers saturate, every duration compared with them is shorter*/
+#define FADE_SHIFT				(4)		/*Fades, and the walk blinking on for 12 of every 16 ticks, as in statemachine.c*/
+#define BLINK_MASK				(16 - 1)
+#define BLINK_ON_TICKS			(12)
+
+/*Lanes of a vector, masks are 0 or -1 in every lane*/
+typedef int16_t fleet_vec_t __attribute__((vector_size(FLEET_LANES * sizeof(int16_t))));
+
+#define FLEET_SELECT(mask, a, b)	(((mask) & (a)) | (~(mask) & (b)))
+/*Comparisons from the sign of a difference, -1 when true. Every value in a lane is 0 to TIMER_MAX
+  so that differences do not overflow, and without AVX gcc splits these into SSE2 instructions
+  where it would compare 256 bit vectors lane by lane*/
+#define FLEET_LT(a, b)				(((a) - (b)) >> 15)
+#define FLEET_GE(a, b)				(~FLEET_LT(a, b))
+#define FLEET_EQ(a, b)				((((a) ^ (b)) - 1) >> 15)
+#define FLEET_HAS(flags, flag)		FLEET_EQ((flags) & (flag), flag)
+#define FLEET_FADE(from, to, step)	((((from) << FADE_SHIFT) + ((to) - (from)) * (step)) >> FADE_SHIFT) /*sm_fade()*/
+#define FLEET_LOAD(vector, array, first)	memcpy(&(vector), &(array)[first], sizeof(fleet_vec_t))
+#define FLEET_STORE(array, first, vector)	memcpy(&(array)[first], &(vector), sizeof(fleet_vec_t))
+
+/*What a state does, kept in every lane so that the kernels need no lookup by state*/
+#define FLAG_SHOWS				(0x01)	/*Writes a colour every tick*/
+#define FLAG_FADES				(0x02)	/*A transition, fadeStep counts*/
+#define FLAG_GREEN				(0x04)	/*Green for the crosswalk policy*/
+#define FLAG_GO					(0x08)	/*Ends from the adaptive timing*/
+#define FLAG_BLINK				(0x10)	/*The walk*/
+
+/*Intersections as one array per field of sm_ctx_t. Timers count the ticks since an event, where
+  sm_ctx_t keeps the tick of the event, so that they fit in 16 bits*/
+typedef struct
+{
+	uint32_t count;				/*Intersections, a multiple of FLEET_LANES*/
+	int16_t *state;
+	int16_t *timer;				/*now - stateStart*/
+	int16_t *step;				/*fadeStep*/
+	int16_t *red;				/*colour*/
+	int16_t *green;
+	int16_t *blue;
+	int16_t *fromRed;			/*Colour the state shows or fades from, fadeFrom for TRANSITION_TO_CROSSWALK*/
+	int16_t *fromGreen;
+	int16_t *fromBlue;
+	int16_t *toRed;				/*Colour it fades to*/
+	int16_t *toGreen;
+	int16_t *toBlue;
+	int16_t *duration;			/*Ticks after which the state ends, the maximum green for GO*/
+	int16_t *flags;				/*FLAG_ values of the state*/
+	int16_t *seenGreen;			/*Green in policy.state, 0 or -1*/
+	int16_t *pending;			/*policy.pending, 0 or -1*/
+	int16_t *greenTimer;		/*now - policy.greenSince*/
+	int16_t *gapTimer;			/*now - timing.lastActuation*/
+	int16_t *pressed;			/*Inputs of the tick, 0 or -1*/
+	int16_t *actuated;
+} fleet_t;
+
+/*One vector of every field while a kernel works on it*/
+typedef struct
+{
+	fleet_vec_t state, timer, step, red, green, blue, fromRed, fromGreen, fromBlue, toRed, toGreen, toBlue;
+	fleet_vec_t duration, flags, seenGreen, pending, greenTimer, gapTimer;
+} fleet_lanes_t;
+
+/*Values of a state in every lane of a vector*/
+typedef struct
+{
+	fleet_vec_t next;			/*State entered at its end*/
+	fleet_vec_t duration;		/*Ticks after which it ends, the maximum green for GO*/
+	fleet_vec_t flags;
+	fleet_vec_t fromRed, fromGreen, fromBlue, toRed, toGreen, toBlue;
+} fleet_state_t;
+
+/*Values of every state, and the limits of the configuration in every lane of a vector*/
+typedef struct
+{
+	fleet_state_t states[SM_STATE_COUNT];
+	fleet_vec_t minGo, passage;
+	fleet_vec_t minGreen, lateJoin;
+	fleet_vec_t noLatchInWalk;	/*-1 when presses late in the walk are discarded*/
+} fleet_tables_t;
+
+/*Steps every intersection of a fleet by one tick*/
+typedef void (*fleet_kernel_t)(fleet_t *fleet, const fleet_tables_t *tables);
+
+typedef struct
+{
+	const char *name;
+	fleet_kernel_t run;
+	bool (*supported)(void);
+} fleet_variant_t;
+
+/*Random events over every intersection and tick, numbered tick * count + intersection, with
+  exponential gaps so that every intersection sees a Poisson process*/
+typedef struct
+{
+	double probability;			/*Of an event in one intersection and tick*/
+	uint64_t next;				/*Number of the next event*/
+	uint32_t randomState;
+	uint32_t *lanes;			/*Intersections with an event in the current tick*/
+	uint32_t lanesCount;
+} fleet_events_t;
+
+/*Simulation parameters from the command line*/
+typedef struct
+{
+	uint32_t instances;
+	uint32_t seconds;
+	uint32_t pressesPerHour;
+	uint32_t demand;
+	uint32_t seed;
+	bool adaptive;				/*GO follows the detector instead of the fixed STOP_GO_TIME*/
+} fleet_options_t;
+
+static sm_config_t fleetConfig;
+static fleet_tables_t fleetTables;
+static fleet_events_t presses;
+static fleet_events_t vehicles;
+
+/*
+ * @brief True if any lane of a mask is set
+ *
+ * @return true for any
+ */
+static inline __attribute__((always_inline)) bool fleet_any(const fleet_vec_t *mask)
+{
+	uint64_t words[sizeof(fleet_vec_t) / sizeof(uint64_t)];
+	uint64_t any = 0;
+	uint32_t index;
+
+	memcpy(words, mask, sizeof(words));
+	for (index = 0; index < sizeof(words) / sizeof(words[0]); index++)
+	{
+		any |= words[index];
+	}
+	return any != 0;
+}
+
+/*
+ * @brief sm_enter() in the lanes of a mask, with adaptive_timing_green_start() and
+ * crosswalk_policy_served(). The values of the states entered are gathered by comparing with
+ * every state, the kernels only come here when a lane of the vector changes state
+ *
+ * @param1 lanes
+ * @param2 tables
+ * @param3 lanes which enter a state
+ * @param4 state entered in every lane
+ * @return void
+ */
+static inline __attribute__((always_inline)) void fleet_enter(fleet_lanes_t *lanes, const fleet_tables_t *tables,
+															   const fleet_vec_t *entered, const fleet_vec_t *nextState)
+{
+	fleet_state_t entry = { { 0 } };
+	fleet_vec_t toCrosswalk = *entered & FLEET_EQ(*nextState, TRANSITION_TO_CROSSWALK);
+	int16_t stateId;
+
+	for (stateId = STOP; stateId <= TRANSITION_FROM_CROSSWALK; stateId++)
+	{
+		fleet_vec_t is = FLEET_EQ(*nextState, stateId);
+
+		entry.duration |= is & tables->states[stateId].duration;
+		entry.flags |= is & tables->states[stateId].flags;
+		entry.fromRed |= is & tables->states[stateId].fromRed;
+		entry.fromGreen |= is & tables->states[stateId].fromGreen;
+		entry.fromBlue |= is & tables->states[stateId].fromBlue;
+		entry.toRed |= is & tables->states[stateId].toRed;
+		entry.toGreen |= is & tables->states[stateId].toGreen;
+		entry.toBlue |= is & tables->states[stateId].toBlue;
+	}
+	lanes->state = FLEET_SELECT(*entered, *nextState, lanes->state);
+	lanes->timer &= ~*entered;
+	lanes->step &= ~*entered;
+	lanes->duration = FLEET_SELECT(*entered, entry.duration, lanes->duration);
+	lanes->flags = FLEET_SELECT(*entered, entry.flags, lanes->flags);
+	/*TRANSITION_TO_CROSSWALK fades from the colour shown*/
+	lanes->fromRed = FLEET_SELECT(*entered, FLEET_SELECT(toCrosswalk, lanes->red, entry.fromRed), lanes->fromRed);
+	lanes->fromGreen = FLEET_SELECT(*entered, FLEET_SELECT(toCrosswalk, lanes->green, entry.fromGreen), lanes->fromGreen);
+	lanes->fromBlue = FLEET_SELECT(*entered, FLEET_SELECT(toCrosswalk, lanes->blue, entry.fromBlue), lanes->fromBlue);
+	lanes->toRed = FLEET_SELECT(*entered, entry.toRed, lanes->toRed);
+	lanes->toGreen = FLEET_SELECT(*entered, entry.toGreen, lanes->toGreen);
+	lanes->toBlue = FLEET_SELECT(*entered, entry.toBlue, lanes->toBlue);
+	lanes->gapTimer &= ~(*entered & FLEET_EQ(*nextState, GO));
+	lanes->pending &= ~(*entered & FLEET_EQ(*nextState, CROSSWALK));
+}
+
+/*
+ * @brief The state after the current one of every lane
+ *
+ * @param1 lanes
+ * @param2 tables
+ * @param3 next state
+ * @return void
+ */
+static inline __attribute__((always_inline)) void fleet_next(const fleet_lanes_t *lanes, const fleet_tables_t *tables,
+															  fleet_vec_t *nextState)
+{
+	fleet_vec_t next = { 0 };
+	int16_t stateId;
+
+	for (stateId = STOP; stateId <= TRANSITION_FROM_CROSSWALK; stateId++)
+	{
+		next |= FLEET_EQ(lanes->state, stateId) & tables->states[stateId].next;
+	}
+	*nextState = next;
+}
+
+/*
+ * @brief Loads the vectors of a fleet
+ *
+ * @param1 lanes
+ * @param2 fleet
+ * @param3 first intersection, a multiple of FLEET_LANES
+ * @return void
+ */
+static inline __attribute__((always_inline)) void fleet_load(fleet_lanes_t *lanes, const fleet_t *fleet, uint32_t first)
+{
+	FLEET_LOAD(lanes->state, fleet->state, first);
+	FLEET_LOAD(lanes->timer, fleet->timer, first);
+	FLEET_LOAD(lanes->step, fleet->step, first);
+	FLEET_LOAD(lanes->red, fleet->red, first);
+	FLEET_LOAD(lanes->green, fleet->green, first);
+	FLEET_LOAD(lanes->blue, fleet->blue, first);
+	FLEET_LOAD(lanes->fromRed, fleet->fromRed, first);
+	FLEET_LOAD(lanes->fromGreen, fleet->fromGreen, first);
+	FLEET_LOAD(lanes->fromBlue, fleet->fromBlue, first);
+	FLEET_LOAD(lanes->toRed, fleet->toRed, first);
+	FLEET_LOAD(lanes->toGreen, fleet->toGreen, first);
+	FLEET_LOAD(lanes->toBlue, fleet->toBlue, first);
+	FLEET_LOAD(lanes->duration, fleet->duration, first);
+	FLEET_LOAD(lanes->flags, fleet->flags, first);
+	FLEET_LOAD(lanes->seenGreen, fleet->seenGreen, first);
+	FLEET_LOAD(lanes->pending, fleet->pending, first);
+	FLEET_LOAD(lanes->greenTimer, fleet->greenTimer, first);
+	FLEET_LOAD(lanes->gapTimer, fleet->gapTimer, first);
+}
+
+/*
+ * @brief Stores the vectors of a fleet
+ *
+ * @param1 fleet
+ * @param2 first intersection, a multiple of FLEET_LANES
+ * @param3 lanes
+ * @return void
+ */
+static inline __attribute__((always_inline)) void fleet_store(fleet_t *fleet, uint32_t first, const fleet_lanes_t *lanes)
+{
+	FLEET_STORE(fleet->state, first, lanes->state);
+	FLEET_STORE(fleet->timer, first, lanes->timer);
+	FLEET_STORE(fleet->step, first, lanes->step);
+	FLEET_STORE(fleet->red, first, lanes->red);
+	FLEET_STORE(fleet->green, first, lanes->green);
+	FLEET_STORE(fleet->blue, first, lanes->blue);
+	FLEET_STORE(fleet->fromRed, first, lanes->fromRed);
+	FLEET_STORE(fleet->fromGreen, first, lanes->fromGreen);
+	FLEET_STORE(fleet->fromBlue, first, lanes->fromBlue);
+	FLEET_STORE(fleet->toRed, first, lanes->toRed);
+	FLEET_STORE(fleet->toGreen, first, lanes->toGreen);
+	FLEET_STORE(fleet->toBlue, first, lanes->toBlue);
+	FLEET_STORE(fleet->duration, first, lanes->duration);
+	FLEET_STORE(fleet->flags, first, lanes->flags);
+	FLEET_STORE(fleet->seenGreen, first, lanes->seenGreen);
+	FLEET_STORE(fleet->pending, first, lanes->pending);
+	FLEET_STORE(fleet->greenTimer, first, lanes->greenTimer);
+	FLEET_STORE(fleet->gapTimer, first, lanes->gapTimer);
+}
+
+/*
+ * @brief The pass of sm_step() after the inputs, the switch on the state, in the active lanes
+ *
+ * @param1 lanes
+ * @param2 tables
+ * @param3 lanes to step, -1 for every one to step
+ * @param4 lanes which entered another state
+ * @return void
+ */
+static inline __attribute__((always_inline)) void fleet_pass(fleet_lanes_t *lanes, const fleet_tables_t *tables,
+															  const fleet_vec_t *active, fleet_vec_t *changed)
+{
+	fleet_vec_t timer = lanes->timer;
+	fleet_vec_t flags = lanes->flags;
+	fleet_vec_t step = lanes->step;
+	fleet_vec_t gapOut = FLEET_HAS(flags, FLAG_GO) & FLEET_GE(timer, tables->minGo) & FLEET_GE(lanes->gapTimer, tables->passage);
+	fleet_vec_t done = *active & (FLEET_GE(timer, lanes->duration) | gapOut);
+	fleet_vec_t running = *active & ~done;
+	fleet_vec_t shows = running & FLEET_HAS(flags, FLAG_SHOWS);
+	fleet_vec_t blinkOff = FLEET_HAS(flags, FLAG_BLINK) & FLEET_GE(timer & BLINK_MASK, BLINK_ON_TICKS + 1);
+
+	/*The steady colours fade from a colour to itself*/
+	lanes->red = FLEET_SELECT(shows, FLEET_FADE(lanes->fromRed, lanes->toRed, step) & ~blinkOff, lanes->red);
+	lanes->green = FLEET_SELECT(shows, FLEET_FADE(lanes->fromGreen, lanes->toGreen, step) & ~blinkOff, lanes->green);
+	lanes->blue = FLEET_SELECT(shows, FLEET_FADE(lanes->fromBlue, lanes->toBlue, step) & ~blinkOff, lanes->blue);
+	lanes->step = step - (running & FLEET_HAS(flags, FLAG_FADES));
+	if (fleet_any(&done))
+	{
+		fleet_vec_t nextState;
+
+		fleet_next(lanes, tables, &nextState);
+		fleet_enter(lanes, tables, &done, &nextState);
+	}
+	*changed = done;
+}
+
+/*
+ * @brief One tick of FLEET_LANES intersections, what sm_step() does in the calls of a tick
+ *
+ * The inputs and the crosswalk policy come first, then the switch on the state. With
+ * durations of at least a tick, a state entered in the switch runs its first tick in a second
+ * pass and never ends in it, so two passes give the state sm_step() settles in
+ *
+ * @param1 fleet
+ * @param2 tables
+ * @param3 first intersection, a multiple of FLEET_LANES
+ * @return void
+ */
+static inline __attribute__((always_inline)) void fleet_block(fleet_t *fleet, const fleet_tables_t *tables, uint32_t first)
+{
+	fleet_lanes_t lanes;
+	fleet_vec_t pressed, actuated, inWalk, toCrosswalk, green, start, changed;
+	const fleet_vec_t none = { 0 };
+	fleet_vec_t every = ~none;
+
+	fleet_load(&lanes, fleet, first);
+	FLEET_LOAD(pressed, fleet->pressed, first);
+	FLEET_LOAD(actuated, fleet->actuated, first);
+
+	/*A tick has passed*/
+	lanes.timer -= FLEET_LT(lanes.timer, TIMER_MAX);
+	lanes.greenTimer -= FLEET_LT(lanes.greenTimer, TIMER_MAX);
+	lanes.gapTimer -= FLEET_LT(lanes.gapTimer, TIMER_MAX);
+
+	/*adaptive_timing_detector()*/
+	lanes.gapTimer &= ~actuated;
+
+	/*crosswalk_policy_press(), presses which latch a new request*/
+	inWalk = FLEET_EQ(lanes.state, CROSSWALK);
+	toCrosswalk = FLEET_EQ(lanes.state, TRANSITION_TO_CROSSWALK);
+	pressed &= ~(inWalk & (FLEET_LT(lanes.timer, tables->lateJoin) | tables->noLatchInWalk));
+	pressed &= ~lanes.pending & ~toCrosswalk;
+	lanes.pending |= pressed;
+
+	/*crosswalk_policy_should_start()*/
+	green = FLEET_HAS(lanes.flags, FLAG_GREEN);
+	lanes.greenTimer &= ~(green & ~lanes.seenGreen);
+	lanes.seenGreen = green;
+	start = lanes.pending & ~inWalk & ~toCrosswalk &
+			(~green | FLEET_GE(lanes.greenTimer, tables->minGreen));
+	if (fleet_any(&start))
+	{
+		fleet_vec_t preempted = none + TRANSITION_TO_CROSSWALK;
+
+		fleet_enter(&lanes, tables, &start, &preempted);
+	}
+
+	fleet_pass(&lanes, tables, &every, &changed);
+	if (fleet_any(&changed))
+	{
+		fleet_pass(&lanes, tables, &changed, &changed);
+	}
+
+	fleet_store(fleet, first, &lanes);
+}
+
+/*
+ * @brief The kernel for the target of the build, SSE2 on x86-64 and scalar code on a host
+ * without SIMD, the compiler splits the vectors into what the target has
+ *
+ * @return void
+ */
+static void fleet_tick_generic(fleet_t *fleet, const fleet_tables_t *tables)
+{
+	uint32_t first;
+
+	for (first = 0; first < fleet->count; first += FLEET_LANES)
+	{
+		fleet_block(fleet, tables, first);
+	}
+}
+
+static bool fleet_supported_always(void)
+{
+	return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/*
+ * @brief The same kernel with AVX2, a vector in one register, selected when the CPU has it
+ *
+ * @return void
+ */
+__attribute__((target("avx2"))) static void fleet_tick_avx2(fleet_t *fleet, const fleet_tables_t *tables)
+{
+	uint32_t first;
+
+	for (first = 0; first < fleet->count; first += FLEET_LANES)
+	{
+		fleet_block(fleet, tables, first);
+	}
+}
+
+static bool fleet_supported_avx2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+#if defined(__SSE2__)
+#define FLEET_GENERIC_NAME		"sse2"
+#else
+#define FLEET_GENERIC_NAME		"generic"
+#endif
+
+static const fleet_variant_t variants[] = {
+	{ FLEET_GENERIC_NAME, fleet_tick_generic, fleet_supported_always },
+#if defined(__x86_64__) || defined(__i386__)
+	{ "avx2", fleet_tick_avx2, fleet_supported_avx2 },
+#endif
+};
+
+#define VARIANT_COUNT			(sizeof(variants) / sizeof(variants[0]))
+
+/*
+ * @brief Fills the tables of the kernels from the configuration of the instances
+ *
+ * @param1 tables
+ * @param2 an instance initialized with the configuration, with its adjusted adaptive timing
+ * @return void
+ */
+static void fleet_tables_init(fleet_tables_t *tables, const sm_ctx_t *ctx)
+{
+	static const uint8_t next[SM_STATE_COUNT] = {
+		[STOP] = TRANSITION_TO_GO, [TRANSITION_TO_GO] = GO, [GO] = TRANSITION_TO_WARNING,
+		[TRANSITION_TO_WARNING] = WARNING, [WARNING] = TRANSITION_TO_STOP, [TRANSITION_TO_STOP] = STOP,
+		[TRANSITION_TO_CROSSWALK] = CROSSWALK, [CROSSWALK] = TRANSITION_FROM_CROSSWALK, [TRANSITION_FROM_CROSSWALK] = GO
+	};
+	static const int16_t flags[SM_STATE_COUNT] = {
+		[TRANSITION_TO_GO] = FLAG_FADES | FLAG_GREEN, [GO] = FLAG_GO | FLAG_GREEN, [TRANSITION_TO_WARNING] = FLAG_FADES,
+		[TRANSITION_TO_STOP] = FLAG_FADES, [TRANSITION_TO_CROSSWALK] = FLAG_FADES, [CROSSWALK] = FLAG_BLINK,
+		[TRANSITION_FROM_CROSSWALK] = FLAG_FADES | FLAG_GREEN
+	};
+	const sm_config_t *config = ctx->config;
+	fleet_vec_t none = { 0 };
+	uint8_t stateId;
+
+	memset(tables, 0, sizeof(*tables));
+	for (stateId = 0; stateId < SM_STATE_COUNT; stateId++)
+	{
+		fleet_state_t *values = &tables->states[stateId];
+		int16_t duration = config->transitionTicks;
+		sm_colour_t from, to;
+
+		switch (stateId)
+		{
+		case STOP:
+			duration = config->stopTicks;
+			break;
+		case GO:
+			duration = ctx->timing.config.maxGreenTicks;
+			break;
+		case WARNING:
+			duration = config->warningTicks;
+			break;
+		case CROSSWALK:
+			duration = config->crosswalkTicks;
+			break;
+		}
+		values->next = none + next[stateId];
+		values->duration = none + duration;
+		values->flags = none + (int16_t)(flags[stateId] | (sm_state_colours(stateId, &from, &to) ? FLAG_SHOWS : 0));
+		values->fromRed = none + from.red;
+		values->fromGreen = none + from.green;
+		values->fromBlue = none + from.blue;
+		values->toRed = none + to.red;
+		values->toGreen = none + to.green;
+		values->toBlue = none + to.blue;
+	}
+
+	tables->minGo = none + (int16_t)ctx->timing.config.minGreenTicks;
+	tables->passage = none + (int16_t)ctx->timing.config.passageTicks;
+	tables->minGreen = none + (int16_t)ctx->policy.config.minGreenTicks;
+	tables->lateJoin = none + (int16_t)ctx->policy.config.lateJoinTicks;
+	tables->noLatchInWalk = none - (int16_t)!ctx->policy.config.latchDuringWalk;
+}
+
+/*
+ * @brief An array of the fleet, aligned for the vectors
+ *
+ * @return zeroed array, exits when out of memory
+ */
+static int16_t *fleet_array(uint32_t count)
+{
+	void *array;
+
+	if (posix_memalign(&array, FLEET_ALIGN, count * sizeof(int16_t)) != 0)
+	{
+		fprintf(stderr, "out of memory for %lu intersections\n", (unsigned long)count);
+		exit(1);
+	}
+	memset(array, 0, count * sizeof(int16_t));
+	return array;
+}
+
+/*
+ * @brief Allocates a fleet in the state sm_init() leaves an instance in at tick 0
+ *
+ * @param1 fleet
+ * @param2 intersections, a multiple of FLEET_LANES
+ * @param3 presses, shared with the other fleets and sm_step()
+ * @param4 detector actuations
+ * @return void
+ */
+static void fleet_init(fleet_t *fleet, uint32_t count, int16_t *pressed, int16_t *actuated)
+{
+	int16_t **arrays[] = { &fleet->state, &fleet->timer, &fleet->step, &fleet->red, &fleet->green, &fleet->blue,
+						   &fleet->fromRed, &fleet->fromGreen, &fleet->fromBlue, &fleet->toRed, &fleet->toGreen,
+						   &fleet->toBlue, &fleet->duration, &fleet->flags, &fleet->seenGreen, &fleet->pending,
+						   &fleet->greenTimer, &fleet->gapTimer };
+	uint32_t index;
+
+	fleet->count = count;
+	fleet->pressed = pressed;
+	fleet->actuated = actuated;
+	for (index = 0; index < sizeof(arrays) / sizeof(arrays[0]); index++)
+	{
+		*arrays[index] = fleet_array(count);
+	}
+	for (index = 0; index < count; index++)
+	{
+		const fleet_state_t *stop = &fleetTables.states[STOP];
+
+		fleet->state[index] = STOP;
+		fleet->duration[index] = stop->duration[0];
+		fleet->flags[index] = stop->flags[0];
+		fleet->fromRed[index] = stop->fromRed[0];
+		fleet->fromGreen[index] = stop->fromGreen[0];
+		fleet->fromBlue[index] = stop->fromBlue[0];
+		fleet->toRed[index] = stop->toRed[0];
+		fleet->toGreen[index] = stop->toGreen[0];
+		fleet->toBlue[index] = stop->toBlue[0];
+	}
+}
+
+/*
+ * @brief Frees the arrays of a fleet, the inputs are shared and freed by the caller
+ *
+ * @return void
+ */
+static void fleet_free(fleet_t *fleet)
+{
+	int16_t *arrays[] = { fleet->state, fleet->timer, fleet->step, fleet->red, fleet->green, fleet->blue,
+						  fleet->fromRed, fleet->fromGreen, fleet->fromBlue, fleet->toRed, fleet->toGreen,
+						  fleet->toBlue, fleet->duration, fleet->flags, fleet->seenGreen, fleet->pending,
+						  fleet->greenTimer, fleet->gapTimer };
+	uint32_t index;
+
+	for (index = 0; index < sizeof(arrays) / sizeof(arrays[0]); index++)
+	{
+		free(arrays[index]);
+	}
+}
+
+/*
+ * @brief Gap to the next event, exponential with a mean of 1 / probability
+ *
+ * @return events
+ */
+static uint64_t events_gap(fleet_events_t *events)
+{
+	double uniform;
+
+	events->randomState = events->randomState * 1664525u + 1013904223u;
+	uniform = ((events->randomState >> 8) + 0.5) / RANDOM_RANGE;
+	return 1 + (uint64_t)(-log(uniform) / events->probability);
+}
+
+/*
+ * @brief Starts a stream of events from the seed
+ *
+ * @param1 events
+ * @param2 events per hour at every intersection
+ * @param3 intersections
+ * @param4 seed
+ * @return void
+ */
+static void events_init(fleet_events_t *events, uint32_t perHour, uint32_t count, uint32_t seed)
+{
+	events->probability = (double)perHour / (SECONDS_PER_HOUR * TICKS_PER_SECOND);
+	events->randomState = seed;
+	events->lanesCount = 0;
+	if (events->lanes == NULL)
+	{
+		events->lanes = malloc(count * sizeof(uint32_t));
+	}
+	events->next = NO_EVENT;
+	if (events->probability > 0)
+	{
+		events->next = events_gap(events) - 1;	/*The first event can be number 0*/
+	}
+}
+
+/*
+ * @brief Sets the inputs of the intersections with an event in a tick, -1, and clears those of
+ * the previous tick
+ *
+ * @param1 events
+ * @param2 inputs of every intersection
+ * @param3 intersections
+ * @param4 tick from 0
+ * @return void
+ */
+static void events_tick(fleet_events_t *events, int16_t *inputs, uint32_t count, uint32_t tick)
+{
+	uint64_t end = (uint64_t)(tick + 1) * count;
+	uint32_t index;
+
+	for (index = 0; index < events->lanesCount; index++)
+	{
+		inputs[events->lanes[index]] = 0;
+	}
+	events->lanesCount = 0;
+	while (events->next < end)
+	{
+		uint32_t lane = (uint32_t)(events->next - (uint64_t)tick * count);
+
+		if (inputs[lane] == 0)
+		{
+			inputs[lane] = -1;
+			events->lanes[events->lanesCount++] = lane;
+		}
+		events->next += events_gap(events);
+	}
+}
+
+/*
+ * @brief One tick of every instance through sm_step(), called until the state stays as the
+ * main loop does
+ *
+ * @param1 instances
+ * @param2 presses of every instance, 0 or -1
+ * @param3 detector actuations
+ * @param4 instances
+ * @param5 tick from 1
+ * @return void
+ */
+static void reference_tick(sm_ctx_t *instances, const int16_t *pressed, const int16_t *actuated, uint32_t count,
+						   ticktime tick)
+{
+	uint32_t index;
+
+	for (index = 0; index < count; index++)
+	{
+		sm_inputs_t inputs = { .pressed = (pressed[index] != 0), .actuations = (actuated[index] != 0) };
+		sm_outputs_t outputs;
+
+		do
+		{
+			sm_step(&instances[index], tick, &inputs, &outputs);
+		} while (outputs.state != outputs.previousState);
+	}
+}
+
+/*
+ * @brief Compares the state and colour of every intersection with its instance
+ *
+ * @return true if all are the same
+ */
+static bool fleet_matches(const fleet_t *fleet, const sm_ctx_t *instances, const char *name, uint32_t tick)
+{
+	uint32_t index;
+
+	for (index = 0; index < fleet->count; index++)
+	{
+		const sm_ctx_t *ctx = &instances[index];
+
+		if ((fleet->state[index] != ctx->state) || (fleet->red[index] != ctx->colour.red) ||
+			(fleet->green[index] != ctx->colour.green) || (fleet->blue[index] != ctx->colour.blue))
+		{
+			printf("%s differs from sm_step() at tick %lu, intersection %lu: state %d colour %02x%02x%02x, "
+				   "sm_step() state %u colour %02x%02x%02x\n", name, (unsigned long)tick, (unsigned long)index,
+				   fleet->state[index], fleet->red[index], fleet->green[index], fleet->blue[index],
+				   ctx->state, ctx->colour.red, ctx->colour.green, ctx->colour.blue);
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * @brief Prints the command line options
+ *
+ * @return void
+ */
+static void usage(const char *program)
+{
+	printf("usage: %s [--instances N] [--seconds N] [--press-rate PRESSES_PER_HOUR]\n"
+		   "          [--demand VEHICLES_PER_HOUR] [--seed N] [--timing fixed|adaptive]\n", program);
+}
+
+/*
+ * @brief Reads the command line options
+ *
+ * @return true if the options are valid
+ */
+static bool parse_options(int argc, char **argv, fleet_options_t *options)
+{
+	int index;
+
+	memset(options, 0, sizeof(*options));
+	options->instances = DEFAULT_INSTANCES;
+	options->seconds = DEFAULT_SECONDS;
+	options->pressesPerHour = DEFAULT_PRESS_RATE;
+	options->demand = DEFAULT_DEMAND;
+	options->seed = 1;
+
+	for (index = 1; index + 1 < argc; index += 2)
+	{
+		const char *option = argv[index];
+		const char *value = argv[index + 1];
+
+		if (strcmp(option, "--instances") == 0)
+		{
+			options->instances = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--seconds") == 0)
+		{
+			options->seconds = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--press-rate") == 0)
+		{
+			options->pressesPerHour = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--demand") == 0)
+		{
+			options->demand = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--seed") == 0)
+		{
+			options->seed = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--timing") == 0)
+		{
+			options->adaptive = (strcmp(value, "adaptive") == 0);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	if ((index != argc) || (options->instances == 0))
+	{
+		return false;
+	}
+	options->instances = (options->instances + FLEET_LANES - 1) / FLEET_LANES * FLEET_LANES;
+	return true;
+}
+
+/*
+ * @brief Monotonic time in sec
+ *
+ * @return time
+ */
+static double fleet_seconds(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / NS_PER_SECOND;
+}
+
+/*
+ * @brief Instances stepped with sm_step(), as sm_init() leaves them at tick 0
+ *
+ * @return instances, exits when out of memory
+ */
+static sm_ctx_t *reference_init(uint32_t count)
+{
+	sm_ctx_t *instances = malloc(count * sizeof(sm_ctx_t));
+	uint32_t index;
+
+	if (instances == NULL)
+	{
+		fprintf(stderr, "out of memory for %lu intersections\n", (unsigned long)count);
+		exit(1);
+	}
+	for (index = 0; index < count; index++)
+	{
+		sm_init(&instances[index], &fleetConfig, 0);
+	}
+	return instances;
+}
+
+/*
+ * @brief Runs sm_step() and every supported kernel side by side on the same inputs
+ *
+ * @param1 options
+ * @param2 ticks to run
+ * @param3 inputs shared by all
+ * @return true if every kernel matched sm_step() at every tick
+ */
+static bool run_check(const fleet_options_t *options, uint32_t ticks, int16_t *pressed, int16_t *actuated)
+{
+	sm_ctx_t *instances = reference_init(options->instances);
+	fleet_t fleets[VARIANT_COUNT];
+	bool matched = true;
+	uint32_t tick;
+	uint32_t index;
+
+	for (index = 0; index < VARIANT_COUNT; index++)
+	{
+		fleet_init(&fleets[index], options->instances, pressed, actuated);
+	}
+	events_init(&presses, options->pressesPerHour, options->instances, options->seed);
+	events_init(&vehicles, options->demand, options->instances, options->seed ^ VEHICLE_SEED);
+	for (tick = 0; matched && (tick < ticks); tick++)
+	{
+		events_tick(&presses, pressed, options->instances, tick);
+		events_tick(&vehicles, actuated, options->instances, tick);
+		reference_tick(instances, pressed, actuated, options->instances, tick + 1);
+		for (index = 0; matched && (index < VARIANT_COUNT); index++)
+		{
+			if (variants[index].supported())
+			{
+				variants[index].run(&fleets[index], &fleetTables);
+				matched = fleet_matches(&fleets[index], instances, variants[index].name, tick + 1);
+			}
+		}
+	}
+	for (index = 0; index < VARIANT_COUNT; index++)
+	{
+		fleet_free(&fleets[index]);
+	}
+	free(instances);
+	return matched;
+}
+
+/*
+ * @brief Times a run of sm_step() for every instance, or of a kernel, inputs included
+ *
+ * @param1 options
+ * @param2 ticks to run
+ * @param3 kernel, NULL for sm_step()
+ * @param4 inputs
+ * @return sec of the fastest of TIMING_RUNS runs
+ */
+static double time_run(const fleet_options_t *options, uint32_t ticks, const fleet_variant_t *variant,
+					   int16_t *pressed, int16_t *actuated)
+{
+	double best = 0;
+	int run;
+
+	for (run = 0; run < TIMING_RUNS; run++)
+	{
+		sm_ctx_t *instances = NULL;
+		fleet_t fleet;
+		double start;
+		uint32_t tick;
+
+		if (variant == NULL)
+		{
+			instances = reference_init(options->instances);
+		}
+		else
+		{
+			fleet_init(&fleet, options->instances, pressed, actuated);
+		}
+		events_init(&presses, options->pressesPerHour, options->instances, options->seed);
+		events_init(&vehicles, options->demand, options->instances, options->seed ^ VEHICLE_SEED);
+		start = fleet_seconds();
+		for (tick = 0; tick < ticks; tick++)
+		{
+			events_tick(&presses, pressed, options->instances, tick);
+			events_tick(&vehicles, actuated, options->instances, tick);
+			if (variant == NULL)
+			{
+				reference_tick(instances, pressed, actuated, options->instances, tick + 1);
+			}
+			else
+			{
+				variant->run(&fleet, &fleetTables);
+			}
+		}
+		start = fleet_seconds() - start;
+		if ((run == 0) || (start < best))
+		{
+			best = start;
+		}
+		if (variant == NULL)
+		{
+			free(instances);
+		}
+		else
+		{
+			fleet_free(&fleet);
+		}
+	}
+	return best;
+}
+
+int main(int argc, char **argv)
+{
+	fleet_options_t options;
+	sm_ctx_t configured;
+	int16_t *pressed, *actuated;
+	uint32_t ticks;
+	double reference;
+	uint32_t index;
+
+	if (!parse_options(argc, argv, &options))
+	{
+		usage(argv[0]);
+		return 1;
+	}
+	fleetConfig = smDefaultConfig;
+	if (options.adaptive)
+	{
+		fleetConfig.timing.minGreenTicks = ADAPTIVE_MIN_GO * TICKS_PER_SECOND;
+		fleetConfig.timing.maxGreenTicks = ADAPTIVE_MAX_GO * TICKS_PER_SECOND;
+		fleetConfig.timing.passageTicks = ADAPTIVE_PASSAGE * TICKS_PER_SECOND;
+	}
+	sm_init(&configured, &fleetConfig, 0);
+	fleet_tables_init(&fleetTables, &configured);
+	pressed = fleet_array(options.instances);
+	actuated = fleet_array(options.instances);
+	ticks = options.seconds * TICKS_PER_SECOND;
+
+	printf("%lu intersections, %lu s (%lu ticks), %lu presses/h and %lu vehicles/h each, %s timing\n",
+		   (unsigned long)options.instances, (unsigned long)options.seconds, (unsigned long)ticks,
+		   (unsigned long)options.pressesPerHour, (unsigned long)options.demand, options.adaptive ? "adaptive" : "fixed");
+	if (!run_check(&options, ticks, pressed, actuated))
+	{
+		return 1;
+	}
+	printf("every kernel matched sm_step() in state and colour at every tick\n\n");
+
+	reference = time_run(&options, ticks, NULL, pressed, actuated);
+	printf("%-24s %12s %8s\n", "kernel", "M ticks/s", "speedup");
+	printf("%-24s %12.1f %8.2f\n", "sm_step per instance", (double)options.instances * ticks / reference / 1e6, 1.0);
+	for (index = 0; index < VARIANT_COUNT; index++)
+	{
+		double seconds;
+
+		if (!variants[index].supported())
+		{
+			printf("%-24s %12s\n", variants[index].name, "not supported by this CPU");
+			continue;
+		}
+		seconds = time_run(&options, ticks, &variants[index], pressed, actuated);
+		printf("%-24s %12.1f %8.2f\n", variants[index].name, (double)options.instances * ticks / seconds / 1e6,
+			   reference / seconds);
+	}
+	printf("(intersection-ticks per second, the fastest of %d runs, inputs included)\n", TIMING_RUNS);
+	free(presses.lanes);
+	free(vehicles.lanes);
+	free(pressed);
+	free(actuated);
+	return 0;
+}
@@ -0,0 +1,596 @@
+/**
+ * @file    fuzz_statemachine.c
+ * @brief   This source file consists of the fuzzing harness which decodes a byte stream into
+ * 			ticks, switch and detector interrupts and touch slider values, drives sm_step() on
+ * 			the instance of the firmware one tick at a time, skipping the ticks in which only
+ * 			time passes, and checks its invariants
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux, libFuzzer or AFL
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal_host.h"
+#include "statemachine.h"
+#include "timer.h"
+#include "switch.h"
+#include "pwm.h"
+#include "touchslider.h"
+#include "conflict_monitor.h"
+#include "crosswalk_policy.h"
+#include "faultlog.h"
+
+/*The first input byte picks the start state, see fuzz_capture_starts(). The other bytes,
+  the low 2 bits select the operation and the upper 6 bits are its argument*/
+#define OP_MASK					(0x03)
+#define OP_SHIFT				(2)
+#define OP_TICKS				(0)		/*Argument + 1 ticks, each with the steps due at it, quiet ones skipped*/
+#define OP_PRESS				(1)		/*Switch press, or a vehicle detector actuation when bit 2 is set*/
+#define OP_TOUCH				(2)		/*Touch slider value of argument * 8, pressed above 100*/
+#define OP_LOOPS				(3)		/*Up to argument more steps without a tick, see LLVMFuzzerTestOneInput()*/
+#define OP_DETECTOR_BIT			(0x04)
+#define TOUCH_VALUE_SCALE		(8)
+
+#define STATE_TICKS_MARGIN		(2)		/*A state may last its duration and the tick it ends in*/
+#define STEPPED_TICKS_MAX		(24)	/*Ticks stepped through in one input, the rest of it is not run*/
+#define START_STATES_MAX		(16)
+#define CAPTURE_TICKS_MAX		(4096)	/*Two cycles with two walks take about 1700 ticks*/
+#define CAPTURE_PRESS_DELAY		(8)		/*Ticks into GO, and after the late join of the first walk*/
+#define NO_PRESS				(0xFFFFFFFFu)
+#define RANDOM_INPUT_MAX		(64)
+#define NS_PER_SECOND			(1000000000.0)
+#define TARGET_EXECS_PER_SECOND	(1000000.0)
+
+extern ticktime ticksCount;			/*Tick counter of timer.c*/
+
+/*What the harness tracks of one run*/
+typedef struct
+{
+	uint8_t state;				/*State at the previous check*/
+	uint32_t stateTicks;		/*Ticks spent in it*/
+	ticktime walkTick;			/*Entry into the current or last CROSSWALK*/
+	ticktime greenTick;			/*Start of the current or last green, including its transition*/
+	ticktime pressTick;			/*Oldest press not served by a walk, NO_PRESS for none*/
+	uint32_t stateTicksMax;		/*Longest state of the configuration*/
+	uint32_t steppedTicks;		/*Ticks of the input stepped through, the skipped ones not counted*/
+	ticktime startTick;			/*Tick of the start state*/
+	sm_ctx_t *ctx;				/*The instance of the firmware, set up by statemachine_init()*/
+} fuzz_run_t;
+
+/*A state reached from the power on reset, an input starts from one of them*/
+typedef struct
+{
+	sm_ctx_t ctx;
+	fuzz_run_t run;
+} fuzz_start_t;
+
+static fuzz_run_t run;
+static fuzz_start_t fuzzStarts[START_STATES_MAX];
+static uint32_t fuzzStartCount;
+
+/*
+ * @brief Stops the run with the violated invariant, a crash is what the fuzzers look for
+ *
+ * @return does not return
+ */
+static void fuzz_fail(const char *invariant)
+{
+	uint8_t red, green, blue;
+
+	host_led_colour(&red, &green, &blue);
+	fprintf(stderr, "invariant failed: %s at tick %lu in state %u (%lu ticks), fadeStep %d, led %02x%02x%02x\n",
+			invariant, (unsigned long)now(), run.ctx->state, (unsigned long)run.stateTicks,
+			run.ctx->fadeStep, red, green, blue);
+	abort();
+}
+
+/*
+ * @brief Starts the sequence as after a power on reset, so that every input runs alone
+ *
+ * @return void
+ */
+static void fuzz_reset(void)
+{
+	ticksCount = 0;
+	host_touch_value = 0;
+	(void)check_switch_pressed();		/*Clears a press left by the previous input*/
+	(void)detector_actuations();
+	statemachine_init();
+	run.ctx = statemachine_context();
+	run.stateTicksMax = run.ctx->config->stopTicks;
+	if (run.ctx->config->timing.maxGreenTicks > run.stateTicksMax)
+	{
+		run.stateTicksMax = run.ctx->config->timing.maxGreenTicks;
+	}
+	if (run.ctx->config->crosswalkTicks > run.stateTicksMax)
+	{
+		run.stateTicksMax = run.ctx->config->crosswalkTicks;
+	}
+	run.stateTicksMax += STATE_TICKS_MARGIN;
+
+	run.state = run.ctx->state;
+	run.stateTicks = 0;
+	run.walkTick = 0;
+	run.greenTick = 0;
+	run.pressTick = NO_PRESS;
+	run.steppedTicks = 0;
+	run.startTick = 0;
+}
+
+/*
+ * @brief Green for the vehicles, as the crosswalk policy counts its minimum green
+ *
+ * @param state ID
+ * @return true for a green state
+ */
+static bool fuzz_is_green(uint8_t stateId)
+{
+	return (stateId == TRANSITION_TO_GO) || (stateId == GO) || (stateId == TRANSITION_FROM_CROSSWALK);
+}
+
+/*
+ * @brief Notes a crosswalk press, a press served by the running walk needs no other one
+ *
+ * @return void
+ */
+static void fuzz_press(void)
+{
+	if ((run.ctx->state == CROSSWALK) && ((now() - run.walkTick) < run.ctx->policy.config.lateJoinTicks))
+	{
+		return;
+	}
+	if (run.pressTick == NO_PRESS)
+	{
+		run.pressTick = now();
+	}
+}
+
+/*
+ * @brief Checks the invariants after the steps of a tick or a step without one
+ *
+ * @param true if a tick came before the steps
+ * @return void
+ */
+static void fuzz_check(bool ticked)
+{
+	uint8_t stateId = run.ctx->state;
+	int16_t fadeStep = run.ctx->fadeStep;
+
+	if (conflictMonitor.tripped)
+	{
+		fuzz_fail("legal colour");
+	}
+	if ((fadeStep < 0) || (fadeStep > (int16_t)run.ctx->config->transitionTicks))
+	{
+		fuzz_fail("fadeStep within a fade");
+	}
+	if (stateId != run.state)
+	{
+		if ((stateId == CROSSWALK) && (run.pressTick != NO_PRESS))
+		{
+			run.pressTick = NO_PRESS;
+		}
+		if (stateId == CROSSWALK)
+		{
+			run.walkTick = now();
+		}
+		if (fuzz_is_green(stateId) && !fuzz_is_green(run.state))
+		{
+			run.greenTick = now();
+		}
+		if ((stateId == TRANSITION_TO_CROSSWALK) && fuzz_is_green(run.state) &&
+			((now() - run.greenTick) < run.ctx->policy.config.minGreenTicks))
+		{
+			fuzz_fail("minimum green before a walk");
+		}
+		run.state = stateId;
+		run.stateTicks = 0;
+	}
+	else if (ticked && (++run.stateTicks > run.stateTicksMax))
+	{
+		fuzz_fail("no stuck state");
+	}
+	if ((run.pressTick != NO_PRESS) && ((now() - run.pressTick) > run.ctx->policy.config.maxWaitTicks))
+	{
+		fuzz_fail("crosswalk within its bound");
+	}
+}
+
+/*
+ * @brief One sm_step(), the colour it computes goes through the conflict monitor as in
+ * 		  update_led_colour(). No logging, metrics or PWM: only the sequence is exercised
+ *
+ * @param inputs, read when due
+ * @return true if the step changed the state
+ */
+static bool fuzz_step(const sm_inputs_t *inputs)
+{
+	sm_outputs_t outputs;
+
+	sm_step(run.ctx, ticksCount, inputs, &outputs);
+	if (outputs.write && !conflict_monitor_commit(outputs.colour.red, outputs.colour.green, outputs.colour.blue))
+	{
+		fuzz_fail("legal colour");
+	}
+	return outputs.state != outputs.previousState;
+}
+
+/*
+ * @brief One tick and the steps due at it: the inputs are sampled as statemachine_poll()
+ * 		  does and the step is repeated while it changes the state
+ *
+ * @return true if the inputs held a press
+ */
+static bool fuzz_tick(void)
+{
+	sm_inputs_t inputs;
+
+	ticksCount++;
+	run.steppedTicks++;
+	inputs.pressed = check_button_pressed();
+	host_touch_value = 0;			/*A touch lasts one tick, as a switch press*/
+	inputs.actuations = detector_actuations();
+	if (inputs.pressed)
+	{
+		fuzz_press();
+	}
+	while (fuzz_step(&inputs))
+	{
+	}
+	fuzz_check(true);
+	return inputs.pressed;
+}
+
+/*
+ * @brief Ticks after the current one in which sm_step() would only see time pass: the state
+ * 		  and its colour hold until the tick returned
+ *
+ * The ends are those of sm_step(): STOP after stopTicks and its trim, GO at the max-out or
+ * once both the minimum green and the passage after the last actuation have run, or at the
+ * minimum green of the policy with a request latched, WARNING after warningTicks, and the
+ * next change of the walk light. A latched request starts the walk at once in STOP and
+ * WARNING, and the fades change the colour every tick, these are stepped tick by tick
+ *
+ * @return ticks which can be skipped, 0 for none
+ */
+static uint32_t fuzz_quiet_ticks(void)
+{
+	const sm_ctx_t *ctx = run.ctx;
+	const adaptive_timing_t *timing = &ctx->timing;
+	ticktime end;
+	uint32_t phase;
+
+	if (ctx->policy.pending && (ctx->state != GO) && (ctx->state != CROSSWALK))
+	{
+		return 0;
+	}
+	switch (ctx->state)
+	{
+	case STOP:
+		end = ctx->stateStart + (ticktime)((int32_t)ctx->config->stopTicks + ctx->stopTrim);
+		break;
+	case GO:
+		end = timing->lastActuation + timing->config.passageTicks;
+		if ((int32_t)(end - (timing->greenStart + timing->config.minGreenTicks)) < 0)
+		{
+			end = timing->greenStart + timing->config.minGreenTicks;
+		}
+		if ((int32_t)(end - (timing->greenStart + timing->config.maxGreenTicks)) > 0)
+		{
+			end = timing->greenStart + timing->config.maxGreenTicks;
+		}
+		if (ctx->policy.pending &&
+			((int32_t)(end - (ctx->policy.greenSince + ctx->policy.config.minGreenTicks)) > 0))
+		{
+			end = ctx->policy.greenSince + ctx->policy.config.minGreenTicks;
+		}
+		break;
+	case WARNING:
+		end = ctx->stateStart + ctx->config->warningTicks;
+		break;
+	case CROSSWALK:
+		phase = (now() - ctx->stateStart) % TICKS_FOR_SECOND;
+		end = now() + ((phase <= TICKS_FOR_750MS) ? (TICKS_FOR_750MS + 1) : TICKS_FOR_SECOND) - phase;
+		if ((int32_t)(end - (ctx->stateStart + ctx->config->crosswalkTicks)) > 0)
+		{
+			end = ctx->stateStart + ctx->config->crosswalkTicks;
+		}
+		break;
+	default:
+		return 0;
+	}
+	return ((int32_t)(end - now()) > 1) ? (end - now() - 1) : 0;
+}
+
+/*
+ * @brief Ticks of an OP_TICKS operation. After a tick without a press the quiet ticks
+ * 		  are skipped in one step of the tick counter, the inputs cannot change before the
+ * 		  next operation and the state ends at the same tick as when stepped through
+ *
+ * Stops at STEPPED_TICKS_MAX ticks stepped through in the input, which bounds the time of
+ * an exec: the fades, the walk and a held press are stepped tick by tick
+ *
+ * @param ticks
+ * @return void
+ */
+static void fuzz_ticks(uint32_t count)
+{
+	while ((count != 0) && (run.steppedTicks < STEPPED_TICKS_MAX))
+	{
+		uint32_t quiet = 0;
+
+		count--;
+		if (!fuzz_tick())
+		{
+			quiet = fuzz_quiet_ticks();
+		}
+		if (quiet > count)
+		{
+			quiet = count;
+		}
+		ticksCount += quiet;
+		run.stateTicks += quiet;
+		count -= quiet;
+	}
+}
+
+/*
+ * @brief Keeps the instance and what the harness tracks of it as a start state
+ *
+ * @return void
+ */
+static void fuzz_save_start(void)
+{
+	if (fuzzStartCount < START_STATES_MAX)
+	{
+		fuzzStarts[fuzzStartCount].ctx = *run.ctx;
+		fuzzStarts[fuzzStartCount].run = run;
+		fuzzStarts[fuzzStartCount].run.startTick = ticksCount;
+		fuzzStarts[fuzzStartCount].run.steppedTicks = 0;
+		fuzzStartCount++;
+	}
+}
+
+/*
+ * @brief Runs the sequence from the power on reset through two walks and a full cycle, and
+ * 		  keeps the reset and every state entered or request latched as start states
+ *
+ * The first walk is requested early in GO, the second by a press after the late join of the
+ * first, which waits out the walk and the minimum green. An input then reaches a walk, the
+ * green after it or a latched request without stepping through the fades before them, so
+ * that STEPPED_TICKS_MAX bounds the time of an exec and not how deep it gets
+ *
+ * @return void
+ */
+static void fuzz_capture_starts(void)
+{
+	uint32_t walks = 0;
+	uint32_t tick;
+
+	fuzzStartCount = 0;
+	fuzz_reset();
+	fuzz_save_start();
+	for (tick = 0; (tick < CAPTURE_TICKS_MAX) && (fuzzStartCount < START_STATES_MAX); tick++)
+	{
+		uint8_t stateId = run.ctx->state;
+		bool pending = run.ctx->policy.pending;
+		uint32_t elapsed = now() - run.ctx->stateStart;
+
+		if (((stateId == GO) && (walks == 0) && (elapsed == CAPTURE_PRESS_DELAY)) ||
+			((stateId == CROSSWALK) && (walks == 1) &&
+			 (elapsed == run.ctx->policy.config.lateJoinTicks + CAPTURE_PRESS_DELAY)))
+		{
+			host_press_switch();
+		}
+		(void)fuzz_tick();
+		if (run.ctx->state != stateId)
+		{
+			walks += (run.ctx->state == CROSSWALK);
+			fuzz_save_start();
+		}
+		else if (run.ctx->policy.pending != pending)
+		{
+			fuzz_save_start();
+		}
+	}
+}
+
+/*
+ * @brief Starts an input from one of the start states
+ *
+ * @param first byte of the input
+ * @return void
+ */
+static void fuzz_start(uint8_t selector)
+{
+	const fuzz_start_t *start = &fuzzStarts[selector % fuzzStartCount];
+
+	*run.ctx = start->ctx;
+	run = start->run;
+	ticksCount = run.startTick;
+}
+
+/*
+ * @brief Runs one input from a start state, the first byte picks it
+ *
+ * @return 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	size_t index;
+
+	fuzz_reset();
+	if (size != 0)
+	{
+		fuzz_start(data[0]);
+	}
+	for (index = 1; (index < size) && (run.steppedTicks < STEPPED_TICKS_MAX); index++)
+	{
+		uint8_t argument = data[index] >> OP_SHIFT;
+		uint8_t count;
+
+		switch (data[index] & OP_MASK)
+		{
+		case OP_TICKS:
+			fuzz_ticks((uint32_t)argument + 1);
+			break;
+		case OP_PRESS:
+			if (data[index] & OP_DETECTOR_BIT)
+			{
+				host_detect_vehicle();
+			}
+			else
+			{
+				host_press_switch();		/*Sampled at the next tick*/
+			}
+			break;
+		case OP_TOUCH:
+			host_touch_value = argument * TOUCH_VALUE_SCALE;
+			break;
+		default:
+			/*A step without a tick which keeps the state changes nothing, the steps after it
+			  would repeat it*/
+			for (count = 0; count < argument; count++)
+			{
+				const sm_inputs_t none = { .pressed = false, .actuations = 0 };
+				bool changed = fuzz_step(&none);
+
+				fuzz_check(false);
+				if (!changed)
+				{
+					break;
+				}
+			}
+			break;
+		}
+	}
+	return 0;
+}
+
+/*
+ * @brief Initializes the peripherals once, as main() does
+ *
+ * @return 0
+ */
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+	(void)argc;
+	(void)argv;
+	Init_Red_LED_PWM();
+	Init_Green_LED_PWM();
+	Init_Blue_LED_PWM();
+	Init_SysTick();
+	init_switch();
+	init_detector();
+	faultlog_init();
+	fuzz_capture_starts();
+	return 0;
+}
+
+/*libFuzzer brings its own main(), this one runs files for AFL and random inputs as a smoke test*/
+#if !defined(FUZZ_LIBFUZZER)
+
+/*
+ * @brief Runs the input in a file, or stdin for "-"
+ *
+ * @return true if the file was read
+ */
+static bool run_file(const char *path)
+{
+	static uint8_t data[1 << 16];
+	FILE *file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+	size_t size;
+
+	if (file == NULL)
+	{
+		perror(path);
+		return false;
+	}
+	size = fread(data, 1, sizeof(data), file);
+	if (file != stdin)
+	{
+		fclose(file);
+	}
+	LLVMFuzzerTestOneInput(data, size);
+	return true;
+}
+
+/*
+ * @brief Runs random inputs of up to RANDOM_INPUT_MAX bytes and prints the rate against the
+ * 		  target of a million execs a second
+ *
+ * @return void
+ */
+static void run_random(uint32_t inputs)
+{
+	uint8_t data[RANDOM_INPUT_MAX];
+	uint32_t randomState = 1;
+	struct timespec start, end;
+	double seconds;
+	uint64_t ticks = 0;
+	uint64_t stepped = 0;
+	uint32_t input;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (input = 0; input < inputs; input++)
+	{
+		size_t size;
+		size_t index;
+
+		randomState = randomState * 1664525u + 1013904223u;
+		size = (randomState >> 24) % (RANDOM_INPUT_MAX + 1);
+		for (index = 0; index < size; index++)
+		{
+			randomState = randomState * 1664525u + 1013904223u;
+			data[index] = (uint8_t)(randomState >> 24);
+		}
+		LLVMFuzzerTestOneInput(data, size);
+		ticks += now() - run.startTick;
+		stepped += run.steppedTicks;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / NS_PER_SECOND;
+	printf("%lu random inputs in %.2f s, %.0f execs/s (%.0f %% of %.0f), %.1f M simulated ticks/s, "
+		   "%.0f ticks/exec of which %.1f stepped, invariants held\n",
+		   (unsigned long)inputs, seconds, seconds > 0 ? inputs / seconds : 0.0,
+		   seconds > 0 ? 100.0 * inputs / seconds / TARGET_EXECS_PER_SECOND : 0.0, TARGET_EXECS_PER_SECOND,
+		   seconds > 0 ? ticks / seconds / 1e6 : 0.0, inputs ? (double)ticks / inputs : 0.0,
+		   inputs ? (double)stepped / inputs : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+	int index;
+
+	LLVMFuzzerInitialize(&argc, &argv);
+	if ((argc == 3) && (strcmp(argv[1], "--random") == 0))
+	{
+		run_random((uint32_t)strtoul(argv[2], NULL, 0));
+		return 0;
+	}
+	if (argc == 1)
+	{
+#if defined(__AFL_HAVE_MANUAL_CONTROL)
+		while (__AFL_LOOP(10000))		/*Persistent mode of afl-clang-fast*/
+		{
+			run_file("-");
+		}
+		return 0;
+#else
+		return run_file("-") ? 0 : 1;
+#endif
+	}
+	for (index = 1; index < argc; index++)
+	{
+		if (!run_file(argv[index]))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+#endif /* !defined(FUZZ_LIBFUZZER) */
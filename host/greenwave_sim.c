@@ -0,0 +1,499 @@
+/**
+ * @file    greenwave_sim.c
+ * @brief   This source file consists of the green wave network simulator. A chain of
+ * 			controllers, each an sm_ctx_t with greenwave.c on its own drifting clock, passes the
+ * 			sync messages byte by byte over in-process links at the UART baud rate, and the GO
+ * 			starts are measured against the cycle of the reference in true time
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "statemachine.h"
+#include "greenwave.h"
+
+#define TICKS_PER_SECOND		(16)
+#define US_PER_TICK				(62500.0)
+#define SECONDS_PER_HOUR		(3600)
+#define STEP_US					(1000)	/*Main loop of the simulation, the link timing is exact*/
+#define BITS_PER_BYTE			(10)	/*Start, 8 data and stop bit*/
+#define MAX_CONTROLLERS			(64)
+#define DEFAULT_CONTROLLERS		(8)
+#define DEFAULT_SECONDS			(3600)
+#define DEFAULT_SETTLE			(300)	/*Seconds before the GO starts are measured*/
+#define DEFAULT_OFFSET			(80)	/*Ticks between neighbours, 5 s of travel*/
+#define DEFAULT_DRIFT			(100)	/*Clock error of every controller within +-ppm*/
+#define DEFAULT_MAX_ERROR_MS	(62.5)	/*A GO start can only be placed on a local tick*/
+#define SYNC_TICKS				(16)	/*As greenwave_uart.c*/
+#define HOLDOVER_TICKS			(16 * 600)
+#define RANDOM_RANGE			(1u << 24)
+#define PPM						(1e-6)
+
+typedef struct
+{
+	uint32_t controllers;
+	uint32_t seconds;
+	uint32_t settle;
+	uint32_t offsetTicks;
+	uint32_t driftPpm;
+	uint32_t baud;
+	uint32_t pressesPerHour;
+	uint32_t outageAt;			/*Seconds, all links drop their bytes from outageAt for outage*/
+	uint32_t outage;
+	uint32_t seed;
+	double maxErrorMs;
+	bool driftCorrection;
+} greenwave_options_t;
+
+/*One controller and the link to the next one in the chain*/
+typedef struct
+{
+	sm_ctx_t ctx;
+	greenwave_t gw;
+	double rate;				/*Local ticks per true tick, 1 + the drift of its clock*/
+	double start;				/*Local tick at true time 0*/
+	ticktime tick;				/*Last local tick stepped*/
+	bool recovering;			/*The last STOP trim hit its limits or the controller runs free*/
+	uint8_t tx[GREENWAVE_FRAME_BYTES];
+	uint8_t txLength;
+	uint8_t txIndex;
+	double txStart;				/*True time in usec at which the first byte was written*/
+	uint32_t aligned;			/*GO starts measured*/
+	uint32_t recovered;			/*GO starts after a STOP trim at its limits, not measured*/
+	double sumError;			/*GO start error, msec*/
+	double maxError;
+	double maxEstimateError;	/*Reference phase estimate error at the GO starts, msec*/
+} controller_t;
+
+static controller_t controllers[MAX_CONTROLLERS];
+static sm_config_t simConfig;
+static uint32_t randomState;
+
+/*
+ * @brief Uniform random number
+ *
+ * @return value in (0, 1)
+ */
+static double random_uniform(void)
+{
+	randomState = randomState * 1664525u + 1013904223u;
+	return ((randomState >> 8) + 0.5) / RANDOM_RANGE;
+}
+
+/*
+ * @brief Local time of a controller in ticks at a true time
+ *
+ * @param1 controller
+ * @param2 true time in usec
+ * @return local ticks
+ */
+static double local_ticks(const controller_t *controller, double trueUs)
+{
+	return trueUs / US_PER_TICK * controller->rate + controller->start;
+}
+
+/*
+ * @brief Local tick and the time within it as the firmware reads them from SysTick
+ *
+ * @param1 controller
+ * @param2 true time in usec
+ * @param3 time within the tick in 1/256
+ * @return local tick
+ */
+static ticktime local_time(const controller_t *controller, double trueUs, uint8_t *fraction)
+{
+	double ticks = local_ticks(controller, trueUs);
+	double whole = floor(ticks);
+
+	*fraction = (uint8_t)((ticks - whole) * (1 << GREENWAVE_FRACTION_BITS));
+	return (ticktime)whole;
+}
+
+/*
+ * @brief A phase difference in ticks as the shortest way round the cycle
+ *
+ * @param1 difference
+ * @param2 cycle
+ * @return difference in [-cycle/2, cycle/2)
+ */
+static double wrap_ticks(double difference, double cycle)
+{
+	difference = fmod(difference, cycle);
+	if (difference >= cycle / 2)
+	{
+		difference -= cycle;
+	}
+	else if (difference < -cycle / 2)
+	{
+		difference += cycle;
+	}
+	return difference;
+}
+
+/*
+ * @brief Error of a GO start against its offset in the cycle of the reference, in true time
+ *
+ * The reference is read at the true time of the local tick which started GO, so the error
+ * includes the estimate, the drift and the placement of the GO on a local tick
+ *
+ * @param1 controller
+ * @param2 local tick of the GO start
+ * @return void
+ */
+static void measure_go_start(controller_t *controller, ticktime tick)
+{
+	const controller_t *reference = &controllers[0];
+	double cycle = controller->gw.config.cycleTicks;
+	double trueUs = (tick - controller->start) / controller->rate * US_PER_TICK;
+	double referencePhase = local_ticks(reference, trueUs);
+	double error = wrap_ticks(referencePhase - controller->gw.config.offsetTicks, cycle) * US_PER_TICK / 1000.0;
+	double estimate = greenwave_reference_phase(&controller->gw, tick, 0) / (double)(1 << GREENWAVE_FRACTION_BITS);
+	double estimateError = fabs(wrap_ticks(estimate - referencePhase, cycle)) * US_PER_TICK / 1000.0;
+
+	controller->aligned++;
+	controller->sumError += fabs(error);
+	if (fabs(error) > controller->maxError)
+	{
+		controller->maxError = fabs(error);
+	}
+	if (estimateError > controller->maxEstimateError)
+	{
+		controller->maxEstimateError = estimateError;
+	}
+}
+
+/*
+ * @brief One local tick of a controller: sm_step() until the state holds, the STOP trim of a
+ * 		  STOP entered and the error of a coordinated GO start
+ *
+ * @param1 controller
+ * @param2 local tick
+ * @param3 presses per tick
+ * @param4 true if the GO starts are measured
+ * @return void
+ */
+static void step_controller(controller_t *controller, ticktime tick, double pressChance, bool measuring)
+{
+	const sm_config_t *config = controller->ctx.config;
+	sm_inputs_t inputs = { .pressed = random_uniform() < pressChance, .actuations = 0 };
+	sm_outputs_t outputs;
+
+	do
+	{
+		sm_step(&controller->ctx, tick, &inputs, &outputs);
+		if (outputs.state == outputs.previousState)
+		{
+			continue;
+		}
+		if (outputs.state == STOP)
+		{
+			int32_t trim = greenwave_stop_trim(&controller->gw, tick, 0, config->stopTicks + config->transitionTicks);
+
+			controller->ctx.stopTrim = trim;
+			controller->recovering = !controller->gw.locked && !controller->gw.config.reference;
+			controller->recovering |= (trim == -(int32_t)controller->gw.config.maxShortenTicks) ||
+									  (trim == (int32_t)controller->gw.config.maxExtendTicks);
+		}
+		else if ((outputs.state == GO) && (outputs.previousState == TRANSITION_TO_GO) && measuring)
+		{
+			if (controller->recovering)
+			{
+				controller->recovered++;
+			}
+			else
+			{
+				measure_go_start(controller, tick);
+			}
+		}
+	} while (outputs.state != outputs.previousState);
+}
+
+/*
+ * @brief Whether the links are cut at a true time
+ *
+ * @param1 options
+ * @param2 true time in usec
+ * @return true during the outage
+ */
+static bool in_outage(const greenwave_options_t *options, double trueUs)
+{
+	double seconds = trueUs / 1e6;
+
+	return (options->outage != 0) && (seconds >= options->outageAt) && (seconds < options->outageAt + options->outage);
+}
+
+/*
+ * @brief Delivers the bytes of a link which have been received by a true time, each at the
+ * 		  local time of the receiver at the end of its stop bit
+ *
+ * @param1 options
+ * @param2 sending controller
+ * @param3 receiving controller
+ * @param4 true time in usec
+ * @return void
+ */
+static void deliver(const greenwave_options_t *options, controller_t *sender, controller_t *receiver, double trueUs)
+{
+	double byteUs = 1e6 * BITS_PER_BYTE / options->baud;
+
+	while ((sender->txIndex < sender->txLength) && (sender->txStart + (sender->txIndex + 1) * byteUs <= trueUs))
+	{
+		double receivedUs = sender->txStart + (sender->txIndex + 1) * byteUs;
+		uint8_t byte = sender->tx[sender->txIndex++];
+		uint8_t fraction;
+		ticktime tick;
+
+		if (in_outage(options, receivedUs))
+		{
+			continue;
+		}
+		tick = local_time(receiver, receivedUs, &fraction);
+		(void)greenwave_receive(&receiver->gw, byte, tick, fraction);
+	}
+}
+
+/*
+ * @brief Starts the chain: controller 0 is the reference, every controller on a clock of its
+ * 		  own drift and phase, with its GO offset a further offsetTicks down the chain
+ *
+ * @param options
+ * @return void
+ */
+static void network_init(const greenwave_options_t *options)
+{
+	uint32_t cycle = 2 * simConfig.stopTicks + simConfig.warningTicks + 3 * simConfig.transitionTicks;
+	uint32_t index;
+
+	for (index = 0; index < options->controllers; index++)
+	{
+		controller_t *controller = &controllers[index];
+		greenwave_config_t config = {
+			.cycleTicks = cycle,
+			.offsetTicks = (index * options->offsetTicks) % cycle,
+			.syncTicks = SYNC_TICKS,
+			.holdoverTicks = HOLDOVER_TICKS,
+			.maxShortenTicks = simConfig.stopTicks / 2,
+			.maxExtendTicks = simConfig.stopTicks / 2,
+			.linkDelay = GREENWAVE_FRAME_DELAY(options->baud),
+			.reference = (index == 0),
+			.driftCorrection = options->driftCorrection
+		};
+
+		memset(controller, 0, sizeof(*controller));
+		controller->rate = 1.0 + (2.0 * random_uniform() - 1.0) * options->driftPpm * PPM;
+		controller->start = floor(random_uniform() * cycle);
+		controller->tick = (ticktime)controller->start;
+		sm_init(&controller->ctx, &simConfig, controller->tick);
+		greenwave_init(&controller->gw, &config, controller->tick);
+	}
+}
+
+/*
+ * @brief Runs the chain for the given time, the links move bytes at the baud rate
+ *
+ * @param options
+ * @return void
+ */
+static void network_run(const greenwave_options_t *options)
+{
+	double pressChance = (double)options->pressesPerHour / (SECONDS_PER_HOUR * TICKS_PER_SECOND);
+	double endUs = options->seconds * 1e6;
+	double trueUs;
+	uint32_t index;
+
+	for (trueUs = 0; trueUs < endUs; trueUs += STEP_US)
+	{
+		bool measuring = trueUs >= options->settle * 1e6;
+
+		for (index = 0; index < options->controllers; index++)
+		{
+			controller_t *controller = &controllers[index];
+			uint8_t fraction;
+			ticktime tick = local_time(controller, trueUs, &fraction);
+
+			if (index > 0)
+			{
+				deliver(options, &controllers[index - 1], controller, trueUs);
+			}
+			while (controller->tick != tick)
+			{
+				step_controller(controller, ++controller->tick, pressChance, measuring);
+			}
+			if ((index + 1 < options->controllers) && (controller->txIndex >= controller->txLength) &&
+				greenwave_sync_due(&controller->gw, tick))
+			{
+				controller->txLength = greenwave_frame(&controller->gw, tick, fraction, controller->tx);
+				controller->txIndex = 0;
+				controller->txStart = trueUs;
+			}
+		}
+	}
+}
+
+/*
+ * @brief Prints the alignment and the link use of every controller
+ *
+ * @param options
+ * @return largest GO start error in msec
+ */
+static double network_report(const greenwave_options_t *options)
+{
+	double worst = 0;
+	uint64_t bytes = 0;
+	uint32_t index;
+
+	printf("%4s %7s %4s %9s %9s %6s %5s %4s %7s %9s %9s %11s %8s\n", "ctl", "offset", "hops", "drift ppm",
+		   "estimate", "frames", "lost", "bad", "GO", "mean ms", "max ms", "estimate ms", "recover");
+	for (index = 0; index < options->controllers; index++)
+	{
+		const controller_t *controller = &controllers[index];
+		const greenwave_t *gw = &controller->gw;
+		double drift = (controller->rate / controllers[0].rate - 1.0) / PPM;
+		double estimate = -gw->drift / (65536.0 * (1 << GREENWAVE_FRACTION_BITS)) / PPM;
+
+		printf("%4lu %7lu %4u %9.1f %9.1f %6lu %5lu %4lu %7lu %9.2f %9.2f %11.2f %8lu\n", (unsigned long)index,
+			   (unsigned long)gw->config.offsetTicks, gw->config.reference ? 0 : gw->rxHops + 1, drift,
+			   gw->config.reference ? 0.0 : estimate, (unsigned long)gw->stats.framesReceived,
+			   (unsigned long)gw->stats.lostFrames, (unsigned long)gw->stats.badFrames, (unsigned long)controller->aligned,
+			   controller->aligned ? controller->sumError / controller->aligned : 0.0, controller->maxError,
+			   controller->maxEstimateError, (unsigned long)controller->recovered);
+		if (controller->maxError > worst)
+		{
+			worst = controller->maxError;
+		}
+		bytes += gw->stats.bytesSent;
+	}
+	printf("\n%lu links at %lu baud: %.1f bytes/s each, %.3f %% of the link, %lu bytes in all\n",
+		   (unsigned long)(options->controllers - 1), (unsigned long)options->baud,
+		   (double)bytes / (options->controllers - 1) / options->seconds,
+		   100.0 * bytes * BITS_PER_BYTE / (options->controllers - 1) / options->seconds / options->baud,
+		   (unsigned long)bytes);
+	printf("largest GO start error %.2f ms after %lu s, bound %.2f ms\n", worst, (unsigned long)options->settle,
+		   options->maxErrorMs);
+	return worst;
+}
+
+/*
+ * @brief Prints the command line options
+ *
+ * @return void
+ */
+static void usage(const char *program)
+{
+	printf("usage: %s [--controllers N] [--seconds N] [--settle SECONDS] [--offset TICKS]\n"
+		   "          [--drift PPM] [--baud N] [--press-rate PRESSES_PER_HOUR] [--seed N]\n"
+		   "          [--outage-at SECONDS] [--outage SECONDS] [--drift-correction on|off]\n"
+		   "          [--max-error MS]\n", program);
+}
+
+/*
+ * @brief Reads the command line options
+ *
+ * @return true if the options are valid
+ */
+static bool parse_options(int argc, char **argv, greenwave_options_t *options)
+{
+	int index;
+
+	memset(options, 0, sizeof(*options));
+	options->controllers = DEFAULT_CONTROLLERS;
+	options->seconds = DEFAULT_SECONDS;
+	options->settle = DEFAULT_SETTLE;
+	options->offsetTicks = DEFAULT_OFFSET;
+	options->driftPpm = DEFAULT_DRIFT;
+	options->baud = GREENWAVE_BAUD;
+	options->seed = 1;
+	options->maxErrorMs = DEFAULT_MAX_ERROR_MS;
+	options->driftCorrection = true;
+
+	for (index = 1; index + 1 < argc; index += 2)
+	{
+		const char *option = argv[index];
+		const char *value = argv[index + 1];
+
+		if (strcmp(option, "--controllers") == 0)
+		{
+			options->controllers = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--seconds") == 0)
+		{
+			options->seconds = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--settle") == 0)
+		{
+			options->settle = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--offset") == 0)
+		{
+			options->offsetTicks = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--drift") == 0)
+		{
+			options->driftPpm = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--baud") == 0)
+		{
+			options->baud = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--press-rate") == 0)
+		{
+			options->pressesPerHour = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--seed") == 0)
+		{
+			options->seed = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--outage-at") == 0)
+		{
+			options->outageAt = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--outage") == 0)
+		{
+			options->outage = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--drift-correction") == 0)
+		{
+			options->driftCorrection = (strcmp(value, "off") != 0);
+		}
+		else if (strcmp(option, "--max-error") == 0)
+		{
+			options->maxErrorMs = strtod(value, NULL);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return (index == argc) && (options->controllers >= 2) && (options->controllers <= MAX_CONTROLLERS) &&
+		   (options->baud != 0) && (options->settle < options->seconds);
+}
+
+int main(int argc, char **argv)
+{
+	greenwave_options_t options;
+
+	if (!parse_options(argc, argv, &options))
+	{
+		usage(argv[0]);
+		return 1;
+	}
+	simConfig = smDefaultConfig;
+	randomState = options.seed;
+
+	printf("%lu controllers, %lu s, offset %lu ticks, clocks within +-%lu ppm, %lu presses/h, drift correction %s",
+		   (unsigned long)options.controllers, (unsigned long)options.seconds, (unsigned long)options.offsetTicks,
+		   (unsigned long)options.driftPpm, (unsigned long)options.pressesPerHour, options.driftCorrection ? "on" : "off");
+	if (options.outage != 0)
+	{
+		printf(", links down %lu s from %lu s", (unsigned long)options.outage, (unsigned long)options.outageAt);
+	}
+	printf("\n");
+
+	network_init(&options);
+	network_run(&options);
+	return (network_report(&options) > options.maxErrorMs) ? 1 : 0;
+}
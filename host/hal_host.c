@@ -0,0 +1,176 @@
+/**
+ * @file    hal_host.c
+ * @brief   This source file consists of the host peripherals and the functions which raise
+ * 			the firmware interrupts in the simulator
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include "hal_host.h"
+#include "clock_config.h"
+#include "power_mode.h"
+#include "timebase.h"
+
+#define SWITCH_PIN			(3)
+#define DETECTOR_PIN		(2)
+#define COLOUR_SHIFT		(8) /*update_led_colour() loads CnV with the colour value << 8, scaled*/
+#define DUTY_SCALE_SHIFT	(16)
+#define VLPR_MCGIRCLK		(4000000U) /*Fast internal reference, IRCS set in the VLPR profile*/
+#define COP_SERVICED		(0xAA) /*Last byte of the service sequence*/
+#define HALF_MS_PER_TICK	(125)
+
+#define HOST_DEFINE_PERIPHERAL(name, type)		type host_##name;
+HOST_PERIPHERALS(HOST_DEFINE_PERIPHERAL)
+
+uint32_t host_primask;
+uint8_t host_irq_priority[32];
+uint32_t host_irq_enabled;
+uint32_t SystemCoreClock = BOARD_BOOTCLOCKRUN_CORE_CLOCK;
+
+/*COP timeout in 1 kHz LPO cycles for COPT 0-3, 0 is disabled*/
+static const uint32_t copTimeoutMs[4] = { 0, 32, 256, 1024 };
+static uint32_t copElapsed; /*Half msec since the last service*/
+
+extern void SysTick_Handler(void);
+extern void PORTD_IRQHandler(void);
+
+/*
+ * @brief Raises the SysTick interrupt if SysTick is enabled
+ *
+ * @return void
+ */
+void host_tick(void)
+{
+	if ((SysTick->CTRL & (SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk)) ==
+		(SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk))
+	{
+		SysTick->VAL = SysTick->LOAD;
+		SysTick_Handler();
+	}
+}
+
+/*
+ * @brief Raises the PORTD interrupt for a press of the switch on PTD3
+ *
+ * @return void
+ */
+void host_press_switch(void)
+{
+	PORTD->ISFR |= (1u << SWITCH_PIN);
+	if (host_irq_enabled & (1UL << PORTD_IRQn))
+	{
+		PORTD_IRQHandler();
+	}
+	PORTD->ISFR = 0; /*Write one to clear on the board*/
+}
+
+/*
+ * @brief Raises the PORTD interrupt for a vehicle detector actuation on PTD2
+ *
+ * @return void
+ */
+void host_detect_vehicle(void)
+{
+	PORTD->ISFR |= (1u << DETECTOR_PIN);
+	if (host_irq_enabled & (1UL << PORTD_IRQn))
+	{
+		PORTD_IRQHandler();
+	}
+	PORTD->ISFR = 0;
+}
+
+/*
+ * @brief Advances the COP counter by one tick, the firmware services it with 0x55, 0xAA
+ *
+ * @return true if the COP timed out, which resets the board
+ */
+bool host_cop_tick(void)
+{
+	uint32_t copt = (SIM->COPC & SIM_COPC_COPT_MASK) >> SIM_COPC_COPT_SHIFT;
+
+	if ((SIM->SRVCOP == COP_SERVICED) || (copt == 0))
+	{
+		SIM->SRVCOP = 0;
+		copElapsed = 0;
+		return false;
+	}
+	copElapsed += HALF_MS_PER_TICK;
+	if (copElapsed >= 2 * copTimeoutMs[copt])
+	{
+		copElapsed = 0;
+		return true;
+	}
+	return false;
+}
+
+/*
+ * @brief Restarts the COP counter and loads the reset status registers, as a reset does
+ *
+ * @param1 RCM SRS0 value
+ * @param2 RCM SRS1 value
+ * @return void
+ */
+void host_reset(uint8_t srs0, uint8_t srs1)
+{
+	*(volatile uint8_t *)&RCM->SRS0 = srs0; /*Read only on the board*/
+	*(volatile uint8_t *)&RCM->SRS1 = srs1;
+	SIM->COPC = 0;
+	SIM->SRVCOP = 0;
+	copElapsed = 0;
+}
+
+/*
+ * @brief Colour value of a duty cycle in counts of the timebase PWM period, rounded as a
+ * count is less than half a colour step at every clock the timebase accepts
+ *
+ * @param CnV value
+ * @return colour value
+ */
+static uint8_t duty_colour(uint32_t counts)
+{
+	uint64_t scaled = ((uint64_t)counts << DUTY_SCALE_SHIFT) + (uint64_t)timebase.dutyScale * (1u << (COLOUR_SHIFT - 1));
+
+	return (uint8_t)((scaled / timebase.dutyScale) >> COLOUR_SHIFT);
+}
+
+/*
+ * @brief Current PWM duty of the red, green and blue LEDs as 0-255 colour values
+ *
+ * @param1 red value
+ * @param2 green value
+ * @param3 blue value
+ * @return void
+ */
+void host_led_colour(uint8_t *red, uint8_t *green, uint8_t *blue)
+{
+	*red = duty_colour(TPM2->CONTROLS[0].CnV);
+	*green = duty_colour(TPM2->CONTROLS[1].CnV);
+	*blue = duty_colour(TPM0->CONTROLS[1].CnV);
+}
+
+/*
+ * @brief Host power_mode_vlpr(): the clock profile is a core clock value, the SysTick and
+ * the TPM modules are moved as on the board. Ticks come from the simulator, so it does not
+ * wait for one
+ *
+ * @return 0, no switch time
+ */
+uint32_t power_mode_vlpr(void)
+{
+	SystemCoreClock = BOARD_BOOTCLOCKVLPR_CORE_CLOCK;
+	timebase_switch(SystemCoreClock, TIMEBASE_TPM_MCGIRCLK, VLPR_MCGIRCLK);
+	return 0;
+}
+
+/*
+ * @brief Host power_mode_run()
+ *
+ * @return 0, no switch time
+ */
+uint32_t power_mode_run(void)
+{
+	SystemCoreClock = BOARD_BOOTCLOCKRUN_CORE_CLOCK;
+	timebase_switch(SystemCoreClock, TIMEBASE_TPM_PLLFLL, BOARD_BOOTCLOCKRUN_CORE_CLOCK);
+	return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file    hal_host.h
+ * @brief   This header file consists of the host stand-ins for the hardware events which
+ * 			drive the firmware in the simulator: SysTick interrupts, switch presses and touch values
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "MKL25Z4.h"
+
+#define HOST_LOOPS_PER_TICK		(8) /*Main loop iterations simulated between two ticks*/
+
+extern int host_touch_value; /*Returned by the host Touch_Scan_LH()*/
+extern bool host_touch_hang; /*Next Touch_Scan_LH() never sees the end of scan flag*/
+extern bool host_main_hung; /*Set by a hung Touch_Scan_LH(), the main loop makes no progress*/
+
+/*
+ * @brief Raises the SysTick interrupt if SysTick is enabled
+ *
+ * @return void
+ */
+void host_tick(void);
+
+/*
+ * @brief Raises the PORTD interrupt for a press of the switch on PTD3
+ *
+ * @return void
+ */
+void host_press_switch(void);
+
+/*
+ * @brief Raises the PORTD interrupt for a vehicle detector actuation on PTD2
+ *
+ * @return void
+ */
+void host_detect_vehicle(void);
+
+/*
+ * @brief Advances the COP counter by one tick, the firmware services it with 0x55, 0xAA
+ *
+ * @return true if the COP timed out, which resets the board
+ */
+bool host_cop_tick(void);
+
+/*
+ * @brief Restarts the COP counter and loads the reset status registers, as a reset does
+ *
+ * @param1 RCM SRS0 value
+ * @param2 RCM SRS1 value
+ * @return void
+ */
+void host_reset(uint8_t srs0, uint8_t srs1);
+
+/*
+ * @brief Current PWM duty of the red, green and blue LEDs as 0-255 colour values
+ *
+ * @param1 red value
+ * @param2 green value
+ * @param3 blue value
+ * @return void
+ */
+void host_led_colour(uint8_t *red, uint8_t *green, uint8_t *blue);
+
+#endif /* HAL_HOST_H_ */
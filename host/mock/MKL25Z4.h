@@ -0,0 +1,107 @@
+/**
+ * @file    MKL25Z4.h
+ * @brief   Host stand-in for the device header. The register layouts and bit field macros
+ * 			come from CMSIS/MKL25Z4.h, the peripherals are plain structures in host memory
+ * 			(see host/hal_host.c) and the core intrinsics only track the interrupt mask
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef HOST_MKL25Z4_H_
+#define HOST_MKL25Z4_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*The Cortex-M0+ core header is replaced by the definitions below*/
+#define __CORE_CM0PLUS_H_GENERIC
+#define __CORE_CM0PLUS_H_DEPENDANT
+#define __I		volatile const
+#define __O		volatile
+#define __IO	volatile
+#define __IM	volatile const
+#define __OM	volatile
+#define __IOM	volatile
+
+#include "../../CMSIS/MKL25Z4.h"
+
+typedef struct
+{
+	__IOM uint32_t CTRL;
+	__IOM uint32_t LOAD;
+	__IOM uint32_t VAL;
+	__IM  uint32_t CALIB;
+} SysTick_Type;
+
+#define SysTick_CTRL_COUNTFLAG_Msk		(1UL << 16U)
+#define SysTick_CTRL_CLKSOURCE_Msk		(1UL << 2U)
+#define SysTick_CTRL_TICKINT_Msk		(1UL << 1U)
+#define SysTick_CTRL_ENABLE_Msk			(1UL)
+#define SysTick_LOAD_RELOAD_Msk			(0xFFFFFFUL)
+
+/*Peripherals used by the firmware, each one is a host variable named host_<peripheral>*/
+#define HOST_PERIPHERALS(X)		\
+	X(SIM, SIM_Type)			\
+	X(PORTB, PORT_Type)			\
+	X(PORTD, PORT_Type)			\
+	X(GPIOD, GPIO_Type)			\
+	X(TPM0, TPM_Type)			\
+	X(TPM1, TPM_Type)			\
+	X(TPM2, TPM_Type)			\
+	X(TSI0, TSI_Type)			\
+	X(UART0, UART0_Type)		\
+	X(RCM, RCM_Type)			\
+	X(SysTick, SysTick_Type)
+
+#define HOST_DECLARE_PERIPHERAL(name, type)		extern type host_##name;
+HOST_PERIPHERALS(HOST_DECLARE_PERIPHERAL)
+
+#undef SIM
+#undef PORTB
+#undef PORTD
+#undef GPIOD
+#undef TPM0
+#undef TPM1
+#undef TPM2
+#undef TSI0
+#undef UART0
+#undef RCM
+#define SIM			(&host_SIM)
+#define PORTB		(&host_PORTB)
+#define PORTD		(&host_PORTD)
+#define GPIOD		(&host_GPIOD)
+#define TPM0		(&host_TPM0)
+#define TPM1		(&host_TPM1)
+#define TPM2		(&host_TPM2)
+#define TSI0		(&host_TSI0)
+#define UART0		(&host_UART0)
+#define RCM			(&host_RCM)
+#define SysTick		(&host_SysTick)
+
+/*Core intrinsics, the interrupt mask is tracked so that critical sections can be checked*/
+extern uint32_t host_primask;
+extern uint8_t host_irq_priority[32];
+extern uint32_t host_irq_enabled;
+
+static inline uint32_t __get_PRIMASK(void)			{ return host_primask; }
+static inline void __set_PRIMASK(uint32_t primask)	{ host_primask = primask; }
+static inline void __disable_irq(void)				{ host_primask = 1; }
+static inline void __enable_irq(void)				{ host_primask = 0; }
+static inline void __NOP(void)						{ }
+static inline void __WFI(void)						{ }
+static inline void __DSB(void)						{ }
+static inline void __ISB(void)						{ }
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+	if (irq >= 0)
+	{
+		host_irq_priority[irq] = (uint8_t)priority;
+	}
+}
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq)	{ host_irq_enabled |= (1UL << irq); }
+static inline void NVIC_DisableIRQ(IRQn_Type irq)	{ host_irq_enabled &= ~(1UL << irq); }
+
+#endif /* HOST_MKL25Z4_H_ */
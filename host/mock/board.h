@@ -0,0 +1,15 @@
+/**
+ * @file    board.h
+ * @brief   Host stand-in for board/board.h, the board is initialized by the simulator
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef HOST_BOARD_H_
+#define HOST_BOARD_H_
+
+#include "clock_config.h"
+#include "fsl_debug_console.h"
+
+#endif /* HOST_BOARD_H_ */
@@ -0,0 +1,15 @@
+/**
+ * @file    clock_config.h
+ * @brief   Host stand-in for board/clock_config.h, only the clock frequencies are kept
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef HOST_CLOCK_CONFIG_H_
+#define HOST_CLOCK_CONFIG_H_
+
+#define BOARD_BOOTCLOCKRUN_CORE_CLOCK		48000000U
+#define BOARD_BOOTCLOCKVLPR_CORE_CLOCK		4000000U
+
+#endif /* HOST_CLOCK_CONFIG_H_ */
@@ -0,0 +1,21 @@
+/**
+ * @file    fsl_debug_console.h
+ * @brief   Host stand-in for utilities/fsl_debug_console.h, the console is stdout
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef HOST_FSL_DEBUG_CONSOLE_H_
+#define HOST_FSL_DEBUG_CONSOLE_H_
+
+#include <stdio.h>
+
+#define PRINTF		printf
+#define PUTCHAR		putchar
+
+#if defined(LOGFMT_BENCHMARK)
+int DbgConsole_BenchmarkSprintf(char *buffer, const char *fmt_s, ...); /*utilities/fsl_debug_console.c*/
+#endif
+
+#endif /* HOST_FSL_DEBUG_CONSOLE_H_ */
@@ -0,0 +1,12 @@
+/**
+ * @file    peripherals.h
+ * @brief   Host stand-in for board/peripherals.h
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef HOST_PERIPHERALS_H_
+#define HOST_PERIPHERALS_H_
+
+#endif /* HOST_PERIPHERALS_H_ */
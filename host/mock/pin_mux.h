@@ -0,0 +1,12 @@
+/**
+ * @file    pin_mux.h
+ * @brief   Host stand-in for board/pin_mux.h
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef HOST_PIN_MUX_H_
+#define HOST_PIN_MUX_H_
+
+#endif /* HOST_PIN_MUX_H_ */
@@ -0,0 +1,152 @@
+/**
+ * @file    phase_sim.c
+ * @brief   This source file consists of the host simulator of the ring and barrier phase
+ * 			controller which checks every tick of the signal group outputs against the
+ * 			conflict matrix of phase_table.h
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phase_controller.h"
+
+#define TICKS_PER_SECOND		(16)
+#define SECONDS_PER_HOUR		(3600)
+#define DEFAULT_SECONDS			(3600)
+#define DEFAULT_CALL_RATE		(60)	/*Calls per hour on every left turn*/
+#define RANDOM_RANGE			(1u << 24)
+
+static const char *const groupNames[PHASE_GROUPS] = {
+	"1", "2", "3", "4", "5", "6", "7", "8", "OA", "OB", "OC", "OD"
+};
+static const char colourNames[] = "RYG";
+
+static uint32_t randomState = 1;
+static uint32_t currentTick;
+static bool trace;
+static uint32_t greenTicks[PHASE_GROUPS];
+static uint32_t changes;
+
+/*
+ * @brief Linear congruential generator so that runs are reproducible on every host
+ *
+ * @return 24 bit pseudo random value
+ */
+static uint32_t sim_random(void)
+{
+	randomState = randomState * 1664525u + 1013904223u;
+	return randomState >> 8;
+}
+
+/*
+ * @brief Output sink of the simulator, prints the changes with --trace
+ *
+ * @param1 signal group
+ * @param2 colour of the signal group
+ * @return void
+ */
+static void host_output(uint8_t group, uint8_t colour)
+{
+	changes++;
+	if (trace)
+	{
+		printf("%8.2f s  %-2s %c\n", currentTick / (double)TICKS_PER_SECOND, groupNames[group], colourNames[colour]);
+	}
+}
+
+/*
+ * @brief Prints the command line options
+ *
+ * @return void
+ */
+static void usage(const char *program)
+{
+	printf("usage: %s [--seconds N] [--call-rate CALLS_PER_HOUR] [--seed N] [--trace]\n", program);
+}
+
+int main(int argc, char **argv)
+{
+	static phase_controller_t controller;
+	uint32_t seconds = DEFAULT_SECONDS;
+	uint32_t callRate = DEFAULT_CALL_RATE;
+	uint32_t threshold;
+	uint32_t totalTicks;
+	uint32_t faults = 0;
+	uint8_t group;
+	int index;
+
+	for (index = 1; index < argc; index++)
+	{
+		if (strcmp(argv[index], "--trace") == 0)
+		{
+			trace = true;
+		}
+		else if ((index + 1 < argc) && (strcmp(argv[index], "--seconds") == 0))
+		{
+			seconds = (uint32_t)strtoul(argv[++index], NULL, 0);
+		}
+		else if ((index + 1 < argc) && (strcmp(argv[index], "--call-rate") == 0))
+		{
+			callRate = (uint32_t)strtoul(argv[++index], NULL, 0);
+		}
+		else if ((index + 1 < argc) && (strcmp(argv[index], "--seed") == 0))
+		{
+			randomState = (uint32_t)strtoul(argv[++index], NULL, 0);
+		}
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	threshold = (uint32_t)((uint64_t)callRate * RANDOM_RANGE / (SECONDS_PER_HOUR * TICKS_PER_SECOND));
+	totalTicks = seconds * TICKS_PER_SECOND;
+	phase_controller_init(&controller, host_output, 0);
+
+	for (currentTick = 0; currentTick < totalTicks; currentTick++)
+	{
+		uint8_t phase;
+
+		for (phase = 1; phase <= PHASE_MAX; phase++)
+		{
+			if (!(PHASE_RECALL & PH(phase)) && (sim_random() < threshold))
+			{
+				phase_controller_call(&controller, PH(phase));
+			}
+		}
+		phase_controller_poll(&controller, currentTick);
+		if (!phase_controller_check(&controller))
+		{
+			faults++;
+			printf("conflict at %.2f s\n", currentTick / (double)TICKS_PER_SECOND);
+		}
+		for (group = 0; group < PHASE_GROUPS; group++)
+		{
+			if (controller.colours[group] == PHASE_GREEN)
+			{
+				greenTicks[group]++;
+			}
+		}
+	}
+
+	printf("\nsimulated %lu s, %lu cycles, average cycle %.1f s, %lu output changes, controller %lu bytes\n",
+		   (unsigned long)seconds, (unsigned long)controller.cycles,
+		   controller.cycles ? seconds / (double)controller.cycles : 0.0, (unsigned long)changes,
+		   (unsigned long)sizeof(controller));
+	printf("%-5s %8s %10s\n", "group", "greens", "green_%");
+	for (group = 0; group < PHASE_GROUPS; group++)
+	{
+		uint32_t greens = (group < PHASE_MAX) ? controller.greens[group] : 0;
+		if ((greenTicks[group] == 0) && (greens == 0))
+		{
+			continue;
+		}
+		printf("%-5s %8lu %10.1f\n", groupNames[group], (unsigned long)greens, 100.0 * greenTicks[group] / totalTicks);
+	}
+	printf("conflicts %lu\n", (unsigned long)faults);
+	return (faults == 0) ? 0 : 1;
+}
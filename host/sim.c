@@ -0,0 +1,1228 @@
+/**
+ * @file    sim.c
+ * @brief   This source file consists of the host simulator which runs the unmodified
+ * 			statemachine.c, timer.c, switch.c and pwm.c against simulated ticks and presses
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal_host.h"
+#include "statemachine.h"
+#include "timer.h"
+#include "switch.h"
+#include "pwm.h"
+#include "metrics.h"
+#include "traffic_host.h"
+#include "conflict_monitor.h"
+#include "faultlog.h"
+#include "watchdog.h"
+#include "inputrec.h"
+#include "telemetry.h"
+#include "night_mode.h"
+#include "touchslider.h"
+
+#define TICKS_PER_SECOND		(16)
+#define SECONDS_PER_HOUR		(3600)
+#define DEFAULT_SECONDS			(3600)
+#define RANDOM_RANGE			(1u << 24)
+#define NOT_SET					(-1)
+#define DEFAULT_CROSS_DEMAND	(300)	/*Vehicles per hour on the cross street, served during STOP*/
+#define ADAPTIVE_MIN_GO			(5)		/*Adaptive GO limits in seconds*/
+#define ADAPTIVE_MAX_GO			(40)
+#define ADAPTIVE_PASSAGE		(3)
+#define RECOVERY_MARGIN			(TICKS_PER_SECOND) /*Allowed on top of the deadline and the COP timeout*/
+#define MS_PER_SECOND			(1000)
+#define NS_PER_SECOND			(1000000000.0)
+#define SUB_TICK_RANGE_SHIFT	(16)	/*inputrec_event_t subTick is in 65536ths of a tick*/
+#define REPLAY_LINE_MAX			(128)
+#define REPLAY_WORDS_PER_LINE	(8)		/*Snapshot context words per line, as exported on the debug UART*/
+
+extern const char state[SM_STATE_COUNT][26]; /*State names in statemachine.c*/
+
+/*Simulation parameters from the command line*/
+typedef struct
+{
+	uint32_t seconds;			/*Simulated time*/
+	uint32_t pressesPerHour;	/*Mean rate of random crosswalk presses*/
+	uint32_t pressInterval;		/*Seconds between periodic presses, 0 for none*/
+	uint32_t seed;
+	bool quiet;
+	bool legacyPolicy;			/*Preempt at once and discard presses during the walk, as before the policy*/
+	int32_t minGreen;			/*Policy limits in seconds, NOT_SET keeps the firmware values*/
+	int32_t maxWait;
+	int32_t lateJoin;
+	uint32_t demand;			/*Vehicles per hour on the approach controlled by GO, 0 for no traffic*/
+	uint32_t crossDemand;		/*Vehicles per hour on the cross street*/
+	bool adaptive;				/*GO follows the detector instead of the fixed STOP_GO_TIME*/
+	bool sweep;					/*Compare fixed and adaptive timing over a range of demands*/
+	uint32_t injectFault;		/*Seconds after which a colour fade is corrupted, 0 for none*/
+	uint32_t injectHang;		/*Seconds after which the touch scan never returns, 0 for none*/
+	const char *recordPath;		/*Recording of the inputs written after the run, NULL for none*/
+	const char *replayPath;		/*Recording replayed instead of simulated inputs, NULL for none*/
+	bool fromSnapshot;			/*Replay from the snapshot even when no event was overwritten*/
+	const char *telemetryPath;	/*Telemetry uplink written as the UART would send it, NULL for none*/
+	bool night;					/*Night flash from nightStart to nightEnd*/
+	uint32_t nightStart;		/*Seconds of the day*/
+	uint32_t nightEnd;
+	uint32_t clock;				/*Second of the day at the start of the run*/
+} sim_options_t;
+
+/*Traffic measured in one run*/
+typedef struct
+{
+	traffic_approach_t main;
+	traffic_approach_t cross;
+	uint32_t presses;
+	uint32_t hangTick;			/*Tick the main loop hung, 0 for none*/
+	uint32_t resetTick;			/*Tick the COP reset the board, 0 for none*/
+	uint32_t recoveryTick;		/*Tick of the first LED commit after the reset, 0 for none*/
+} sim_result_t;
+
+static uint32_t randomState;
+static sim_result_t result;
+static inputrec_t replayRecording;	/*Read from the --replay file*/
+static uint32_t replayFirst;		/*Index of the first event of the replay*/
+static FILE *telemetryFile;			/*Opened from --telemetry*/
+static night_config_t nightConfig;	/*nightDefaultConfig with the --night schedule*/
+
+/*Demands in vehicles per hour compared by --sweep*/
+static const uint32_t sweepDemands[] = { 150, 300, 450, 600, 750, 900, 1050 };
+
+/*
+ * @brief Linear congruential generator so that runs are reproducible on every host
+ *
+ * @return 24 bit pseudo random value
+ */
+static uint32_t sim_random(void)
+{
+	randomState = randomState * 1664525u + 1013904223u;
+	return randomState >> 8;
+}
+
+/*
+ * @brief Prints the command line options
+ *
+ * @return void
+ */
+static void usage(const char *program)
+{
+	printf("usage: %s [--seconds N] [--press-rate PRESSES_PER_HOUR] [--press-every SECONDS]\n"
+		   "          [--seed N] [--quiet] [--policy legacy|default]\n"
+		   "          [--min-green SECONDS] [--max-wait SECONDS] [--late-join SECONDS]\n"
+		   "          [--demand VEHICLES_PER_HOUR] [--cross-demand VEHICLES_PER_HOUR]\n"
+		   "          [--timing fixed|adaptive] [--sweep] [--inject-fault SECONDS]\n"
+		   "          [--inject-hang SECONDS] [--record FILE] [--replay FILE [--from-snapshot]]\n"
+		   "          [--telemetry FILE] [--night HH:MM-HH:MM] [--clock HH:MM]\n", program);
+}
+
+/*
+ * @brief Reads a time of day
+ *
+ * @param1 HH:MM
+ * @param2 end of the time in the text
+ * @return seconds of the day
+ */
+static uint32_t parse_time_of_day(const char *text, char **end)
+{
+	uint32_t hours = (uint32_t)strtoul(text, end, 10);
+	uint32_t minutes = (**end == ':') ? (uint32_t)strtoul(*end + 1, end, 10) : 0;
+
+	return (hours * 60 + minutes) * 60 % SECONDS_PER_DAY;
+}
+
+/*
+ * @brief Reads the command line options
+ *
+ * @return true if the options are valid
+ */
+static bool parse_options(int argc, char **argv, sim_options_t *options)
+{
+	int index;
+
+	memset(options, 0, sizeof(*options));
+	options->seconds = DEFAULT_SECONDS;
+	options->seed = 1;
+	options->minGreen = NOT_SET;
+	options->maxWait = NOT_SET;
+	options->lateJoin = NOT_SET;
+	options->crossDemand = DEFAULT_CROSS_DEMAND;
+
+	for (index = 1; index < argc; index++)
+	{
+		const char *option = argv[index];
+		const char *value = (index + 1 < argc) ? argv[index + 1] : NULL;
+
+		if (strcmp(option, "--quiet") == 0)
+		{
+			options->quiet = true;
+			continue;
+		}
+		if (strcmp(option, "--sweep") == 0)
+		{
+			options->sweep = true;
+			continue;
+		}
+		if (strcmp(option, "--from-snapshot") == 0)
+		{
+			options->fromSnapshot = true;
+			continue;
+		}
+		if (value == NULL)
+		{
+			return false;
+		}
+		index++;
+		if (strcmp(option, "--seconds") == 0)
+		{
+			options->seconds = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--press-rate") == 0)
+		{
+			options->pressesPerHour = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--press-every") == 0)
+		{
+			options->pressInterval = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--seed") == 0)
+		{
+			options->seed = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--policy") == 0)
+		{
+			options->legacyPolicy = (strcmp(value, "legacy") == 0);
+		}
+		else if (strcmp(option, "--min-green") == 0)
+		{
+			options->minGreen = atoi(value);
+		}
+		else if (strcmp(option, "--max-wait") == 0)
+		{
+			options->maxWait = atoi(value);
+		}
+		else if (strcmp(option, "--late-join") == 0)
+		{
+			options->lateJoin = atoi(value);
+		}
+		else if (strcmp(option, "--demand") == 0)
+		{
+			options->demand = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--cross-demand") == 0)
+		{
+			options->crossDemand = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--inject-fault") == 0)
+		{
+			options->injectFault = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--inject-hang") == 0)
+		{
+			options->injectHang = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--record") == 0)
+		{
+			options->recordPath = value;
+		}
+		else if (strcmp(option, "--replay") == 0)
+		{
+			options->replayPath = value;
+		}
+		else if (strcmp(option, "--telemetry") == 0)
+		{
+			options->telemetryPath = value;
+		}
+		else if (strcmp(option, "--night") == 0)
+		{
+			char *end;
+
+			options->night = true;
+			options->nightStart = parse_time_of_day(value, &end);
+			if (*end != '-')
+			{
+				return false;
+			}
+			options->nightEnd = parse_time_of_day(end + 1, &end);
+		}
+		else if (strcmp(option, "--clock") == 0)
+		{
+			char *end;
+
+			options->clock = parse_time_of_day(value, &end);
+		}
+		else if (strcmp(option, "--timing") == 0)
+		{
+			options->adaptive = (strcmp(value, "adaptive") == 0);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * @brief Decides whether a crosswalk press arrives in the current tick
+ *
+ * @return true for a press
+ */
+static bool press_arrives(const sim_options_t *options, uint32_t tick)
+{
+	if ((options->pressInterval != 0) && (tick % (options->pressInterval * TICKS_PER_SECOND) == 0) && (tick != 0))
+	{
+		return true;
+	}
+	if (options->pressesPerHour != 0)
+	{
+		/*Bernoulli trial per tick approximating a Poisson arrival process*/
+		uint64_t threshold = (uint64_t)options->pressesPerHour * RANDOM_RANGE / (SECONDS_PER_HOUR * TICKS_PER_SECOND);
+		return sim_random() < threshold;
+	}
+	return false;
+}
+
+/*
+ * @brief The policy options on top of the firmware policy limits
+ *
+ * @return policy limits
+ */
+static crosswalk_policy_config_t policy_config(const sim_options_t *options)
+{
+	crosswalk_policy_config_t config = smDefaultConfig.policy;
+
+	if (options->legacyPolicy)
+	{
+		config.minGreenTicks = 0;
+		config.maxWaitTicks = 0;
+		config.lateJoinTicks = 0;
+		config.latchDuringWalk = false;
+	}
+	if (options->minGreen != NOT_SET)
+	{
+		config.minGreenTicks = (uint32_t)options->minGreen * TICKS_PER_SECOND;
+	}
+	if (options->maxWait != NOT_SET)
+	{
+		config.maxWaitTicks = (uint32_t)options->maxWait * TICKS_PER_SECOND;
+	}
+	if (options->lateJoin != NOT_SET)
+	{
+		config.lateJoinTicks = (uint32_t)options->lateJoin * TICKS_PER_SECOND;
+	}
+	return config;
+}
+
+/*
+ * @brief Checks that the maximum wait of the policy options covers the longest wait with the
+ * 		  minimum green as a floor, the legacy policy has no bound
+ *
+ * @return false if a press could wait longer than max_wait
+ */
+static bool check_policy(const sim_options_t *options)
+{
+	crosswalk_policy_config_t config = policy_config(options);
+	uint32_t bound = crosswalk_policy_wait_bound(&config, smDefaultConfig.crosswalkTicks, smDefaultConfig.transitionTicks);
+
+	if (!options->legacyPolicy && (config.maxWaitTicks < bound))
+	{
+		fprintf(stderr, "max_wait %.1f s is below the walk, the transitions and min_green, %.1f s\n",
+				config.maxWaitTicks / (double)TICKS_PER_SECOND, bound / (double)TICKS_PER_SECOND);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * @brief Applies the policy options on top of the firmware policy limits
+ *
+ * @return void
+ */
+static void configure_policy(const sim_options_t *options)
+{
+	crosswalk_policy_config_t config = policy_config(options);
+
+	crosswalk_policy_init(statemachine_crosswalk_policy(), &config);
+}
+
+/*
+ * @brief Replaces the fixed GO of the firmware with the detector driven limits
+ *
+ * @return void
+ */
+static void configure_timing(const sim_options_t *options)
+{
+	adaptive_timing_t *timing = statemachine_adaptive_timing();
+	adaptive_timing_config_t config = timing->config;
+
+	if (options->adaptive)
+	{
+		config.minGreenTicks = ADAPTIVE_MIN_GO * TICKS_PER_SECOND;
+		config.maxGreenTicks = ADAPTIVE_MAX_GO * TICKS_PER_SECOND;
+		config.passageTicks = ADAPTIVE_PASSAGE * TICKS_PER_SECOND;
+	}
+	adaptive_timing_init(timing, &config);
+}
+
+/*
+ * @brief Approach controlled by GO moves in GO and WARNING, the cross street in STOP
+ *
+ * @param1 state ID
+ * @param2 true for the approach controlled by GO
+ * @return true if the approach has green
+ */
+static bool approach_green(uint8_t stateId, bool mainApproach)
+{
+	if (mainApproach)
+	{
+		return (stateId == GO) || (stateId == TRANSITION_TO_WARNING) || (stateId == WARNING);
+	}
+	return stateId == STOP;
+}
+
+/*
+ * @brief Whether the state fades the LED colour
+ *
+ * @param state ID
+ * @return true for a transition state
+ */
+static bool is_transition(uint8_t stateId)
+{
+	return (stateId == TRANSITION_TO_GO) || (stateId == TRANSITION_TO_WARNING) || (stateId == TRANSITION_TO_STOP) ||
+		   (stateId == TRANSITION_TO_CROSSWALK) || (stateId == TRANSITION_FROM_CROSSWALK);
+}
+
+/*
+ * @brief Starts the firmware as after a reset with the given reset reason
+ *
+ * @return void
+ */
+static void simulate_reset(const sim_options_t *options, uint8_t srs0)
+{
+	host_reset(srs0, 0);
+	faultlog_init();
+	watchdog_init();
+	inputrec_init();
+	telemetry_init();
+	statemachine_init();
+	nightConfig = nightDefaultConfig;
+	nightConfig.startSecond = options->nightStart;
+	nightConfig.endSecond = options->nightEnd;
+	nightConfig.clockAtReset = options->clock;
+	night_mode_init(options->night ? &nightConfig : NULL);
+	configure_policy(options);
+	configure_timing(options);
+}
+
+/*
+ * @brief Takes the bytes the debug UART would have sent in the tick out of the telemetry
+ * ring, into the --telemetry file
+ *
+ * @return void
+ */
+static void capture_telemetry(void)
+{
+	uint8_t buffer[TELEMETRY_RING_BYTES];
+	uint32_t length = telemetry_read(buffer, sizeof(buffer));
+
+	if ((telemetryFile != NULL) && (length != 0))
+	{
+		fwrite(buffer, 1, length, telemetryFile);
+	}
+}
+
+/*
+ * @brief Runs the state machine from STOP for the simulated time
+ *
+ * @return void
+ */
+static void run_simulation(const sim_options_t *options)
+{
+	uint32_t totalTicks = options->seconds * TICKS_PER_SECOND;
+	uint32_t injectTick = options->injectFault * TICKS_PER_SECOND;
+	uint32_t hangTick = options->injectHang * TICKS_PER_SECOND;
+	uint32_t tick;
+
+	randomState = options->seed;
+	traffic_init(&result.main, options->demand);
+	traffic_init(&result.cross, options->demand ? options->crossDemand : 0);
+	result.presses = 0;
+	result.hangTick = 0;
+	result.resetTick = 0;
+	result.recoveryTick = 0;
+
+	metrics_reset();
+	faultlog_clear();
+	simulate_reset(options, RCM_SRS0_POR_MASK);
+
+	for (tick = 0; tick < totalTicks; tick++)
+	{
+		uint8_t stateId = statemachine_state();
+		int loop;
+
+		host_tick();
+		if (host_cop_tick())
+		{
+			host_touch_hang = false;
+			host_main_hung = false;
+			result.resetTick = tick;
+			simulate_reset(options, RCM_SRS0_WDOG_MASK);
+		}
+		if ((result.resetTick != 0) && (result.recoveryTick == 0) && (conflictMonitor.commits != 0))
+		{
+			result.recoveryTick = tick;
+		}
+		if ((hangTick != 0) && (tick >= hangTick))
+		{
+			host_touch_hang = true;
+			hangTick = 0;
+		}
+		if ((injectTick != 0) && (tick >= injectTick) && is_transition(stateId))
+		{
+			statemachine_context()->fadeStep = 64; /*Fades far past the target colour, as a bug in the fades would*/
+			injectTick = 0;
+		}
+		if (press_arrives(options, tick))
+		{
+			host_press_switch();
+			result.presses++;
+		}
+		if (options->demand != 0)
+		{
+			if (traffic_step(&result.main, tick, approach_green(stateId, true), sim_random()))
+			{
+				host_detect_vehicle();
+			}
+			traffic_step(&result.cross, tick, approach_green(stateId, false), sim_random());
+		}
+		for (loop = 0; (loop < HOST_LOOPS_PER_TICK) && !host_main_hung; loop++)
+		{
+			statemachine_poll();
+		}
+		capture_telemetry();
+		if (host_main_hung && (result.hangTick == 0))
+		{
+			result.hangTick = tick;
+		}
+	}
+	traffic_finish(&result.main, totalTicks);
+	traffic_finish(&result.cross, totalTicks);
+}
+
+/*
+ * @brief Event of a recording by the number of events recorded before it
+ *
+ * @param1 recording
+ * @param2 index since boot, one of the last INPUTREC_EVENTS
+ * @return event
+ */
+static const inputrec_event_t *recorded_event(const inputrec_t *recording, uint32_t index)
+{
+	return &recording->events[index % INPUTREC_EVENTS];
+}
+
+/*
+ * @brief Index of the oldest event kept by a recording
+ *
+ * @param recording
+ * @return index since boot
+ */
+static uint32_t oldest_event(const inputrec_t *recording)
+{
+	return (recording->count < INPUTREC_EVENTS) ? 0 : recording->count - INPUTREC_EVENTS;
+}
+
+/*
+ * @brief Writes the recording of the run in the format exported on the debug UART
+ *
+ * @return true if the file was written
+ */
+static bool write_recording(const char *path)
+{
+	const inputrec_snapshot_t *snapshot = &inputRec.snapshot;
+	uint32_t index;
+	FILE *file = fopen(path, "w");
+
+	if (file == NULL)
+	{
+		perror(path);
+		return false;
+	}
+	fprintf(file, "inputrec %lu %04lx\n", (unsigned long)inputRec.count, (unsigned long)inputRec.resetReason);
+	if (snapshot->taken != 0)
+	{
+		fprintf(file, "snap %lu %lu %06lx %08lx %lu %ld", (unsigned long)snapshot->count, (unsigned long)snapshot->tick,
+				(unsigned long)snapshot->outputColour, (unsigned long)snapshot->outputHash,
+				(unsigned long)snapshot->checkpointTick, (long)snapshot->touchPressed);
+		for (index = 0; index < INPUTREC_CONTEXT_WORDS; index++)
+		{
+			uint32_t word;
+
+			memcpy(&word, (const uint8_t *)&snapshot->context + inputrec_context_offset(index), sizeof(word));
+			fprintf(file, ((index % REPLAY_WORDS_PER_LINE) == 0) ? "\nctx %08lx" : " %08lx", (unsigned long)word);
+		}
+		fprintf(file, "\n");
+	}
+	for (index = oldest_event(&inputRec); index != inputRec.count; index++)
+	{
+		const inputrec_event_t *event = recorded_event(&inputRec, index);
+		fprintf(file, "ev %08lx %04x %04x\n", (unsigned long)event->stamp, event->subTick, event->value);
+	}
+	fprintf(file, "inputrec end\n");
+	return fclose(file) == 0;
+}
+
+/*
+ * @brief Reads the snapshot line of a recording, the state of the recorder at the snapshot
+ *
+ * @return true if the line is a snapshot
+ */
+static bool read_snapshot(const char *line, inputrec_snapshot_t *snapshot)
+{
+	unsigned long count, tick, colour, hash, checkpoint;
+	long touchPressed;
+
+	if (sscanf(line, "snap %lu %lu %lx %lx %lu %ld", &count, &tick, &colour, &hash, &checkpoint, &touchPressed) != 6)
+	{
+		return false;
+	}
+	snapshot->taken = 1;
+	snapshot->count = (uint32_t)count;
+	snapshot->tick = (ticktime)tick;
+	snapshot->outputColour = (uint32_t)colour;
+	snapshot->outputHash = (uint32_t)hash;
+	snapshot->checkpointTick = (ticktime)checkpoint;
+	snapshot->touchPressed = (int32_t)touchPressed;
+	return true;
+}
+
+/*
+ * @brief Reads the words of a context line of a snapshot into its instance
+ *
+ * @return words read, in all the context lines so far
+ */
+static uint32_t read_context(const char *line, inputrec_snapshot_t *snapshot, uint32_t words)
+{
+	const char *text = line + strlen("ctx");
+	char *end;
+
+	while (words < INPUTREC_CONTEXT_WORDS)
+	{
+		uint32_t word = (uint32_t)strtoul(text, &end, 16);
+
+		if (end == text)
+		{
+			break;
+		}
+		memcpy((uint8_t *)&snapshot->context + inputrec_context_offset(words), &word, sizeof(word));
+		words++;
+		text = end;
+	}
+	return words;
+}
+
+/*
+ * @brief Reads the first recording of a capture of the debug UART, other lines are skipped
+ *
+ * @return true if a complete recording was read
+ */
+static bool read_recording(const char *path, inputrec_t *recording)
+{
+	char line[REPLAY_LINE_MAX];
+	bool started = false;
+	uint32_t read = 0;
+	uint32_t contextWords = 0;
+	FILE *file = fopen(path, "r");
+
+	if (file == NULL)
+	{
+		perror(path);
+		return false;
+	}
+	memset(recording, 0, sizeof(*recording));
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		unsigned long count, reason, stamp;
+		unsigned int subTick, value;
+
+		if (strncmp(line, "inputrec end", strlen("inputrec end")) == 0)
+		{
+			if (started)
+			{
+				break;
+			}
+		}
+		else if (sscanf(line, "inputrec %lu %lx", &count, &reason) == 2)
+		{
+			recording->count = (uint32_t)count;
+			recording->resetReason = (uint32_t)reason;
+			started = true;
+		}
+		else if (!started)
+		{
+			continue;
+		}
+		else if (strncmp(line, "ctx ", strlen("ctx ")) == 0)
+		{
+			contextWords = read_context(line, &recording->snapshot, contextWords);
+		}
+		else if ((read < INPUTREC_EVENTS) && (sscanf(line, "ev %lx %x %x", &stamp, &subTick, &value) == 3))
+		{
+			inputrec_event_t *event = &recording->events[(oldest_event(recording) + read) % INPUTREC_EVENTS];
+
+			event->stamp = (uint32_t)stamp;
+			event->subTick = (uint16_t)subTick;
+			event->value = (uint16_t)value;
+			read++;
+		}
+		else
+		{
+			read_snapshot(line, &recording->snapshot);
+		}
+	}
+	fclose(file);
+	if (!started || (read != recording->count - oldest_event(recording)) ||
+		((recording->snapshot.taken != 0) && (contextWords != INPUTREC_CONTEXT_WORDS)))
+	{
+		printf("%s: no complete recording\n", path);
+		return false;
+	}
+	recording->next = recording->count % INPUTREC_EVENTS;
+	recording->magic = INPUTREC_MAGIC;
+	return true;
+}
+
+/*
+ * @brief Main loop iteration of the tick before which a recorded input is delivered
+ *
+ * The first iteration after a tick processes it, an interrupt later in the tick is seen at
+ * the next tick as on the board. The touch slider is scanned once per tick, so its value is
+ * set before the first iteration
+ *
+ * @return iteration, 0 to HOST_LOOPS_PER_TICK - 1
+ */
+static int replay_slot(const inputrec_event_t *event)
+{
+	if ((INPUTREC_TYPE(event) == INPUTREC_TOUCH) || (event->subTick == 0))
+	{
+		return 0;
+	}
+	return 1 + (int)(((uint32_t)event->subTick * (HOST_LOOPS_PER_TICK - 1)) >> SUB_TICK_RANGE_SHIFT);
+}
+
+/*
+ * @brief Delivers the recorded inputs of one main loop iteration
+ *
+ * @return void
+ */
+static void replay_inputs(const inputrec_t *recording, uint32_t first, uint32_t end, int slot)
+{
+	uint32_t index;
+
+	for (index = first; index < end; index++)
+	{
+		const inputrec_event_t *event = recorded_event(recording, index);
+
+		if (replay_slot(event) != slot)
+		{
+			continue;
+		}
+		switch (INPUTREC_TYPE(event))
+		{
+		case INPUTREC_SWITCH:
+			host_press_switch();
+			result.presses++;
+			break;
+		case INPUTREC_DETECTOR:
+			host_detect_vehicle();
+			break;
+		case INPUTREC_TOUCH:
+			host_touch_value = (int16_t)event->value;
+			break;
+		default:
+			break;		/*Output checkpoints are compared after the run*/
+		}
+	}
+}
+
+/*
+ * @brief Runs the main loop iterations of the current tick from the given one, with the
+ * recorded inputs of the tick
+ *
+ * @param1 recording
+ * @param2 index of the first event not delivered yet
+ * @param3 first iteration
+ * @return index of the first event of a later tick
+ */
+static uint32_t replay_tick(const inputrec_t *recording, uint32_t first, int firstLoop)
+{
+	uint32_t end;
+	int loop;
+
+	/*Inputs before the first tick are delivered with it*/
+	for (end = first; (end < recording->count) && (INPUTREC_TICK(recorded_event(recording, end)) <= now()); end++)
+	{
+	}
+	for (loop = firstLoop; loop < HOST_LOOPS_PER_TICK; loop++)
+	{
+		replay_inputs(recording, first, end, loop);
+		statemachine_poll();
+	}
+	return end;
+}
+
+/*
+ * @brief Loads the last snapshot of a recording at its tick, the replay goes on after the
+ * main loop iteration which took it
+ *
+ * Events of the snapshot tick recorded before the snapshot but placed after the first
+ * iteration by replay_slot(), an interrupt just after the inputs were sampled, are replayed
+ * as well
+ *
+ * @return true if the events after the snapshot were kept
+ */
+static bool replay_from_snapshot(const sim_options_t *options, const inputrec_t *recording)
+{
+	const inputrec_snapshot_t *snapshot = &recording->snapshot;
+	uint32_t oldest = oldest_event(recording);
+
+	if ((snapshot->taken == 0) || (snapshot->count < oldest) || (snapshot->count > recording->count))
+	{
+		printf("the recording has no snapshot after which all events were kept\n");
+		return false;
+	}
+	while (now() < snapshot->tick)
+	{
+		host_tick();		/*Nothing runs, the ticks are only counted*/
+	}
+	faultlog_clear();
+	simulate_reset(options, (uint8_t)recording->resetReason);
+	for (replayFirst = snapshot->count; (replayFirst > oldest) &&
+		 (INPUTREC_TICK(recorded_event(recording, replayFirst - 1)) == snapshot->tick) &&
+		 (replay_slot(recorded_event(recording, replayFirst - 1)) != 0); replayFirst--)
+	{
+	}
+	inputrec_restore(snapshot, replayFirst, statemachine_context());
+	host_touch_value = (snapshot->touchPressed > 0) ? (SLIDER_PRESSED_MINIMUM_VALUE + 1) : 0;
+	return true;
+}
+
+/*
+ * @brief Runs the state machine with the recorded inputs at their recorded ticks
+ *
+ * From a reset when every event was kept, else from the last snapshot. The run ends with the
+ * tick of the last event. --inject-fault applies as in a simulation, to check that a changed
+ * output is found
+ *
+ * @return true if the recording could be replayed
+ */
+static bool run_replay(const sim_options_t *options, const inputrec_t *recording)
+{
+	uint32_t lastTick = recording->count ? INPUTREC_TICK(recorded_event(recording, recording->count - 1)) : 0;
+	uint32_t injectTick = options->injectFault * TICKS_PER_SECOND;
+	uint32_t first;
+
+	memset(&result, 0, sizeof(result));
+	host_touch_value = 0;
+	metrics_reset();
+	if ((oldest_event(recording) == 0) && !options->fromSnapshot)
+	{
+		faultlog_clear();
+		simulate_reset(options, (uint8_t)recording->resetReason);
+		replayFirst = 0;
+		first = 0;
+	}
+	else if (replay_from_snapshot(options, recording))
+	{
+		first = replay_tick(recording, replayFirst, 1);
+	}
+	else
+	{
+		return false;
+	}
+
+	while (now() < lastTick)
+	{
+		host_tick();
+		if (host_cop_tick())
+		{
+			printf("COP reset at tick %lu, the recording ends at the reset\n", (unsigned long)now());
+			return true;
+		}
+		if ((injectTick != 0) && (now() >= injectTick) && is_transition(statemachine_state()))
+		{
+			statemachine_context()->fadeStep = 64;
+			injectTick = 0;
+		}
+		first = replay_tick(recording, first, 0);
+	}
+	return true;
+}
+
+/*
+ * @brief Compares the events the replay recorded with the recording, inputs and output
+ * checkpoints must be at the same tick with the same value. Sub-ticks are not compared, the
+ * host runs a fixed number of main loop iterations per tick
+ *
+ * @return true if the replay followed the recording
+ */
+static bool print_replay_summary(const inputrec_t *recording, double seconds)
+{
+	uint32_t ticks = now();
+	uint32_t checkpoints = 0;
+	uint32_t index;
+
+	printf("\nreplayed %lu of %lu events from %s, %.1f s in %.3f s, %.0fx real time\n",
+		   (unsigned long)(recording->count - replayFirst), (unsigned long)recording->count,
+		   (replayFirst == 0) ? "the reset" : "the snapshot", ticks / (double)TICKS_PER_SECOND, seconds,
+		   seconds > 0 ? ticks / (double)TICKS_PER_SECOND / seconds : 0.0);
+	for (index = replayFirst; index < recording->count; index++)
+	{
+		const inputrec_event_t *expected = recorded_event(recording, index);
+		const inputrec_event_t *actual = recorded_event(&inputRec, index);
+		bool replayed = (index < inputRec.count) && (index >= oldest_event(&inputRec));
+
+		if (!replayed || (expected->stamp != actual->stamp) || (expected->value != actual->value))
+		{
+			printf("DIVERGED at event %lu: recorded type %lu tick %lu value %04x, replay ",
+				   (unsigned long)index, (unsigned long)INPUTREC_TYPE(expected),
+				   (unsigned long)INPUTREC_TICK(expected), expected->value);
+			if (!replayed)
+			{
+				printf("has no event\n");
+			}
+			else
+			{
+				printf("type %lu tick %lu value %04x\n", (unsigned long)INPUTREC_TYPE(actual),
+					   (unsigned long)INPUTREC_TICK(actual), actual->value);
+			}
+			return false;
+		}
+		checkpoints += (INPUTREC_TYPE(expected) == INPUTREC_OUTPUT);
+	}
+	printf("replay matches the recording, %lu output checkpoints\n", (unsigned long)checkpoints);
+	return true;
+}
+
+/*
+ * @brief Average delay of all vehicles of both approaches
+ *
+ * @return delay in seconds
+ */
+static double overall_delay(void)
+{
+	uint32_t vehicles = result.main.departures + result.main.count + result.cross.departures + result.cross.count;
+
+	return vehicles ? (result.main.totalDelayTicks + result.cross.totalDelayTicks) /
+					  (double)vehicles / TICKS_PER_SECOND : 0.0;
+}
+
+/*
+ * @brief Prints the GO timing and the vehicle delay of one run
+ *
+ * @return void
+ */
+static void print_traffic_summary(const sim_options_t *options)
+{
+	const adaptive_timing_t *timing = statemachine_adaptive_timing();
+	const adaptive_timing_stats_t *stats = &timing->stats;
+
+	printf("\ntiming %s go %.1f-%.1f s passage %.1f s\n", options->adaptive ? "adaptive" : "fixed",
+		   timing->config.minGreenTicks / (double)TICKS_PER_SECOND,
+		   timing->config.maxGreenTicks / (double)TICKS_PER_SECOND,
+		   timing->config.passageTicks / (double)TICKS_PER_SECOND);
+	printf("go phases %lu gap-out %lu max-out %lu avg go %.1f s actuations %lu\n",
+		   (unsigned long)stats->phases, (unsigned long)stats->gapOuts, (unsigned long)stats->maxOuts,
+		   stats->phases ? stats->totalGreenTicks / (double)stats->phases / TICKS_PER_SECOND : 0.0,
+		   (unsigned long)stats->actuations);
+	printf("main  %4lu veh/h delay avg %6.1f s max queue %lu\n", (unsigned long)options->demand,
+		   traffic_average_delay(&result.main) / TICKS_PER_SECOND, (unsigned long)result.main.maxQueue);
+	printf("cross %4lu veh/h delay avg %6.1f s max queue %lu\n", (unsigned long)options->crossDemand,
+		   traffic_average_delay(&result.cross) / TICKS_PER_SECOND, (unsigned long)result.cross.maxQueue);
+	printf("overall delay avg %.1f s\n", overall_delay());
+}
+
+/*
+ * @brief Compares the average delay of fixed and adaptive GO timing over a range of demands
+ *
+ * @return void
+ */
+static void print_sweep(const sim_options_t *options)
+{
+	sim_options_t run = *options;
+	uint32_t index;
+
+	printf("cross street %lu veh/h, delays in seconds\n", (unsigned long)options->crossDemand);
+	printf("%6s | %7s %7s %7s | %7s %7s %7s %6s\n", "veh/h", "fixed", "cross", "all",
+		   "adapt", "cross", "all", "go_s");
+	for (index = 0; index < sizeof(sweepDemands) / sizeof(sweepDemands[0]); index++)
+	{
+		double fixedMain, fixedCross, fixedAll;
+		const adaptive_timing_stats_t *stats = &statemachine_adaptive_timing()->stats;
+
+		run.demand = sweepDemands[index];
+		run.adaptive = false;
+		run_simulation(&run);
+		fixedMain = traffic_average_delay(&result.main) / TICKS_PER_SECOND;
+		fixedCross = traffic_average_delay(&result.cross) / TICKS_PER_SECOND;
+		fixedAll = overall_delay();
+
+		run.adaptive = true;
+		run_simulation(&run);
+		printf("%6lu | %7.1f %7.1f %7.1f | %7.1f %7.1f %7.1f %6.1f\n", (unsigned long)run.demand,
+			   fixedMain, fixedCross, fixedAll,
+			   traffic_average_delay(&result.main) / TICKS_PER_SECOND,
+			   traffic_average_delay(&result.cross) / TICKS_PER_SECOND, overall_delay(),
+			   stats->phases ? stats->totalGreenTicks / (double)stats->phases / TICKS_PER_SECOND : 0.0);
+	}
+}
+
+/*
+ * @brief Prints the conflict monitor result and the fault log
+ *
+ * @return void
+ */
+static void print_monitor_summary(void)
+{
+	uint8_t red, green, blue;
+
+	host_led_colour(&red, &green, &blue);
+	printf("\nconflict monitor %s, %lu commits checked, led %02x%02x%02x\n",
+		   conflictMonitor.tripped ? "TRIPPED, flashing red" : "ok", (unsigned long)conflictMonitor.commits,
+		   red, green, blue);
+	if (faultLog.count != 0)
+	{
+		faultlog_report();
+	}
+}
+
+/*
+ * @brief Prints the frames and the bytes of the telemetry uplink
+ *
+ * @return void
+ */
+static void print_telemetry_summary(void)
+{
+	double seconds = (double)telemetry.frames * TELEMETRY_PERIOD_TICKS / TICKS_PER_SECOND;
+
+	printf("\ntelemetry %lu frames, %lu bytes, %.1f bytes/s, %lu frames lost\n", (unsigned long)telemetry.frames,
+		   (unsigned long)telemetry.bytes, (seconds > 0) ? telemetry.bytes / seconds : 0.0,
+		   (unsigned long)telemetry.framesLost);
+}
+
+/*
+ * @brief Prints the nights and the charge saved in VLPR, fails unless the schedule gave a
+ * night and the flash never tripped the conflict monitor
+ *
+ * @return true if the night flash ran
+ */
+static bool print_night_summary(const sim_options_t *options)
+{
+	double hours = nightMode.nightTicks / (double)(TICKS_PER_SECOND * SECONDS_PER_HOUR);
+	double runHours = options->seconds / (double)SECONDS_PER_HOUR - hours;
+	double microampHours = runHours * NIGHT_RUN_MICROAMPS + hours * NIGHT_VLPR_MICROAMPS;
+
+	printf("\nnight flash %lu nights, %lu flashes, %lu ended by a press, %.2f h in VLPR of %.2f h\n",
+		   (unsigned long)nightMode.nights, (unsigned long)nightMode.entries, (unsigned long)nightMode.pressExits, hours,
+		   options->seconds / (double)SECONDS_PER_HOUR);
+	printf("estimated %.1f mAh instead of %.1f mAh, %.1f %% saved (%u uA in RUN, %u uA in VLPR)\n",
+		   microampHours / 1000.0, (runHours + hours) * NIGHT_RUN_MICROAMPS / 1000.0,
+		   100.0 * night_mode_saved_microamp_hours() / ((runHours + hours) * NIGHT_RUN_MICROAMPS),
+		   NIGHT_RUN_MICROAMPS, NIGHT_VLPR_MICROAMPS);
+	return (nightMode.nights != 0) && !conflictMonitor.tripped;
+}
+
+/*
+ * @brief Prints the recovery from an injected hang, the bound is the supervisor deadline,
+ * the COP timeout and a margin for the first commit after the reset
+ *
+ * @return true if the board recovered within the bound
+ */
+static bool print_recovery_summary(void)
+{
+	uint32_t bound = WATCHDOG_DEADLINE + (WATCHDOG_COP_TIMEOUT_MS * TICKS_PER_SECOND) / MS_PER_SECOND +
+					 RECOVERY_MARGIN;
+	uint32_t recovery = result.recoveryTick - result.hangTick;
+
+	if ((result.hangTick == 0) || (result.recoveryTick == 0))
+	{
+		printf("\nhang at %.2f s, no recovery\n", result.hangTick / (double)TICKS_PER_SECOND);
+		return false;
+	}
+	printf("\nhang at %.2f s, COP reset after %.2f s, first light after %.2f s (bound %.2f s), %lu feeds\n",
+		   result.hangTick / (double)TICKS_PER_SECOND,
+		   (result.resetTick - result.hangTick) / (double)TICKS_PER_SECOND,
+		   recovery / (double)TICKS_PER_SECOND, bound / (double)TICKS_PER_SECOND,
+		   (unsigned long)watchdog.feeds);
+	return recovery <= bound;
+}
+
+/*
+ * @brief Prints pedestrian service and vehicle green share
+ *
+ * @return false if a press waited longer than the maximum wait of the policy or a
+ * 		   pedestrian phase cut a green short of the minimum green
+ */
+static bool print_policy_summary(const sim_options_t *options)
+{
+	const crosswalk_policy_t *policy = statemachine_crosswalk_policy();
+	const crosswalk_policy_stats_t *stats = &policy->stats;
+	uint32_t totalTicks = options->seconds * TICKS_PER_SECOND;
+	uint32_t greenTicks = metrics_time_in_state(TRANSITION_TO_GO) + metrics_time_in_state(GO) +
+						  metrics_time_in_state(TRANSITION_FROM_CROSSWALK);
+	double hours = options->seconds / (double)SECONDS_PER_HOUR;
+
+	printf("\npolicy min_green %.1f s max_wait %.1f s late_join %.1f s %s\n",
+		   policy->config.minGreenTicks / (double)TICKS_PER_SECOND,
+		   policy->config.maxWaitTicks / (double)TICKS_PER_SECOND,
+		   policy->config.lateJoinTicks / (double)TICKS_PER_SECOND,
+		   policy->config.latchDuringWalk ? "latch" : "discard");
+	printf("presses %lu requests %lu batched %lu discarded %lu served %lu\n",
+		   (unsigned long)stats->presses, (unsigned long)stats->requests, (unsigned long)stats->merged,
+		   (unsigned long)stats->discarded, (unsigned long)stats->served);
+	printf("pedestrian phases/h %.1f  served presses/h %.1f  vehicle green %.1f %%\n",
+		   stats->phases / hours, stats->served / hours, 100.0 * greenTicks / totalTicks);
+	printf("pedestrian wait avg %.2f s max %.2f s\n",
+		   stats->served ? stats->totalWaitTicks / (double)stats->served / TICKS_PER_SECOND : 0.0,
+		   stats->maxWaitTicks / (double)TICKS_PER_SECOND);
+	if (stats->shortestGreenTicks != UINT32_MAX)
+	{
+		printf("shortest green ended by a walk %.2f s\n", stats->shortestGreenTicks / (double)TICKS_PER_SECOND);
+	}
+	if (!options->legacyPolicy && (stats->maxWaitTicks > policy->config.maxWaitTicks))
+	{
+		printf("pedestrian wait over max_wait\n");
+		return false;
+	}
+	if ((stats->shortestGreenTicks != UINT32_MAX) && (stats->shortestGreenTicks < policy->config.minGreenTicks))
+	{
+		printf("green cut short of min_green\n");
+		return false;
+	}
+	return true;
+}
+
+/*
+ * @brief Prints the time spent in every state
+ *
+ * @return void
+ */
+static void print_summary(const sim_options_t *options)
+{
+	uint32_t totalTicks = options->seconds * TICKS_PER_SECOND;
+	uint8_t stateId;
+
+	printf("\nsimulated %lu s, %lu presses\n", (unsigned long)options->seconds, (unsigned long)result.presses);
+	printf("%-26s %8s %12s %8s\n", "state", "entries", "time_s", "share_%");
+	for (stateId = 0; stateId < SM_STATE_COUNT; stateId++)
+	{
+		uint32_t ticks = metrics_time_in_state(stateId);
+		if (smMetrics.entries[stateId] == 0)
+		{
+			continue;
+		}
+		printf("%-26s %8lu %12.1f %8.2f\n", state[stateId], (unsigned long)smMetrics.entries[stateId],
+			   ticks / (double)TICKS_PER_SECOND, 100.0 * ticks / totalTicks);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	sim_options_t options;
+
+	if (!parse_options(argc, argv, &options))
+	{
+		usage(argv[0]);
+		return 1;
+	}
+	if (!check_policy(&options))
+	{
+		return 1;
+	}
+
+	Init_Red_LED_PWM();
+	Init_Green_LED_PWM();
+	Init_Blue_LED_PWM();
+	Init_SysTick();
+	init_switch();
+	init_detector();
+	faultlog_init();
+
+	if (options.sweep)
+	{
+		print_sweep(&options);
+		return 0;
+	}
+	if (options.replayPath != NULL)
+	{
+		struct timespec start, end;
+		bool matched;
+
+		if (!read_recording(options.replayPath, &replayRecording))
+		{
+			return 1;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (!run_replay(&options, &replayRecording))
+		{
+			return 1;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		matched = print_replay_summary(&replayRecording, (end.tv_sec - start.tv_sec) +
+									   (end.tv_nsec - start.tv_nsec) / NS_PER_SECOND);
+		print_monitor_summary();
+		return matched ? 0 : 1;
+	}
+
+	if (options.telemetryPath != NULL)
+	{
+		telemetryFile = fopen(options.telemetryPath, "wb");
+		if (telemetryFile == NULL)
+		{
+			perror(options.telemetryPath);
+			return 1;
+		}
+	}
+	run_simulation(&options);
+	if (telemetryFile != NULL)
+	{
+		fclose(telemetryFile);
+		telemetryFile = NULL;
+	}
+	if ((options.recordPath != NULL) && !write_recording(options.recordPath))
+	{
+		return 1;
+	}
+	if (!options.quiet)
+	{
+		print_summary(&options);
+	}
+	metrics_report();
+	if (!print_policy_summary(&options))
+	{
+		return 1;
+	}
+	print_monitor_summary();
+	if (options.telemetryPath != NULL)
+	{
+		print_telemetry_summary();
+	}
+	if (options.demand != 0)
+	{
+		print_traffic_summary(&options);
+	}
+	if (options.night && !print_night_summary(&options))
+	{
+		return 1;
+	}
+	if ((options.injectHang != 0) && !print_recovery_summary())
+	{
+		return 1;
+	}
+	return 0;
+}
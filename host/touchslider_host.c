@@ -0,0 +1,41 @@
+/**
+ * @file    touchslider_host.c
+ * @brief   Host stand-in for source/touchslider.c, the slider value is set by the simulator
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include "touchslider.h"
+#include "hal_host.h"
+
+int host_touch_value = 0;
+bool host_touch_hang = false;
+bool host_main_hung = false;
+
+/**
+ * @brief To return the value of the touch slider's input
+ *
+ * A hang requested by the simulator is modelled by flagging the main loop as stuck, the
+ * simulator then stops calling it while interrupts keep running
+ *
+ * @return the value set by the simulator
+ */
+int Touch_Scan_LH(void)
+{
+	if (host_touch_hang)
+	{
+		host_main_hung = true;
+	}
+	return host_touch_value;
+}
+
+/**
+ * @brief Initializing the capacitive touch slider's input
+ *
+ * @return void
+ */
+void Touch_Init()
+{
+	SIM->SCGC5 |= SIM_SCGC5_TSI_MASK;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file    traffic_host.c
+ * @brief   This source file consists of the vehicle queue model of one approach used by the
+ * 			simulator to measure delay under the fixed and adaptive GO timing
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include <string.h>
+#include "traffic_host.h"
+
+#define TICKS_PER_HOUR			(3600u * 16u)
+#define RANDOM_RANGE			(1u << 24)
+
+/*
+ * @brief Initializes an empty approach
+ *
+ * @param1 approach
+ * @param2 mean arrivals per hour
+ * @return void
+ */
+void traffic_init(traffic_approach_t *approach, uint32_t vehiclesPerHour)
+{
+	memset(approach, 0, sizeof(*approach));
+	approach->threshold = (uint32_t)((uint64_t)vehiclesPerHour * RANDOM_RANGE / TICKS_PER_HOUR);
+}
+
+/*
+ * @brief Advances the approach by one tick
+ *
+ * @param1 approach
+ * @param2 current tick
+ * @param3 true if the approach has green
+ * @param4 24 bit random value deciding an arrival
+ * @return true if a vehicle crossed the stop line, which actuates the detector
+ */
+bool traffic_step(traffic_approach_t *approach, uint32_t tick, bool green, uint32_t random)
+{
+	bool departed = false;
+
+	if (random < approach->threshold)
+	{
+		approach->arrivals++;
+		if (approach->count < TRAFFIC_QUEUE_SIZE)
+		{
+			approach->queue[(approach->head + approach->count) % TRAFFIC_QUEUE_SIZE] = tick;
+			approach->count++;
+			if (approach->count > approach->maxQueue)
+			{
+				approach->maxQueue = approach->count;
+			}
+		}
+		else
+		{
+			approach->overflow++;
+		}
+	}
+
+	if (green && !approach->served)
+	{
+		approach->nextDeparture = tick + TRAFFIC_STARTUP_TICKS;
+	}
+	approach->served = green;
+
+	if (green && (approach->count != 0) && (tick >= approach->nextDeparture))
+	{
+		approach->totalDelayTicks += tick - approach->queue[approach->head];
+		approach->head = (approach->head + 1) % TRAFFIC_QUEUE_SIZE;
+		approach->count--;
+		approach->departures++;
+		approach->nextDeparture = tick + TRAFFIC_HEADWAY_TICKS;
+		departed = true;
+	}
+	return departed;
+}
+
+/*
+ * @brief Adds the delay of the vehicles still waiting at the end of the run
+ *
+ * @param1 approach
+ * @param2 last tick
+ * @return void
+ */
+void traffic_finish(traffic_approach_t *approach, uint32_t tick)
+{
+	uint32_t index;
+
+	for (index = 0; index < approach->count; index++)
+	{
+		approach->totalDelayTicks += tick - approach->queue[(approach->head + index) % TRAFFIC_QUEUE_SIZE];
+	}
+}
+
+/*
+ * @brief Average stop line delay of the vehicles which arrived
+ *
+ * @param approach
+ * @return delay in ticks
+ */
+double traffic_average_delay(const traffic_approach_t *approach)
+{
+	uint32_t vehicles = approach->departures + approach->count;
+
+	return vehicles ? approach->totalDelayTicks / (double)vehicles : 0.0;
+}
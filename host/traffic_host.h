@@ -0,0 +1,73 @@
+/**
+ * @file    traffic_host.h
+ * @brief   This header file consists of the vehicle queue model of one approach used by the
+ * 			simulator to measure delay under the fixed and adaptive GO timing
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#ifndef TRAFFIC_HOST_H_
+#define TRAFFIC_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRAFFIC_QUEUE_SIZE		(4096)	/*Vehicles waiting, arrivals beyond it are counted as overflow*/
+#define TRAFFIC_HEADWAY_TICKS	(32)	/*Saturation flow of one vehicle every 2 seconds*/
+#define TRAFFIC_STARTUP_TICKS	(16)	/*Lost time before the first vehicle moves at green*/
+
+/*One approach with random arrivals queued at the stop line, times are in ticks*/
+typedef struct
+{
+	uint32_t threshold;				/*Arrival probability per tick scaled to the 24 bit random range*/
+	uint32_t queue[TRAFFIC_QUEUE_SIZE];	/*Arrival ticks of the waiting vehicles*/
+	uint32_t head;
+	uint32_t count;
+	uint32_t nextDeparture;
+	bool served;					/*Approach had green in the previous tick*/
+	uint32_t arrivals;
+	uint32_t departures;
+	uint32_t overflow;
+	uint32_t maxQueue;
+	uint64_t totalDelayTicks;		/*Stop line delay of the departed and still waiting vehicles*/
+} traffic_approach_t;
+
+/*
+ * @brief Initializes an empty approach
+ *
+ * @param1 approach
+ * @param2 mean arrivals per hour
+ * @return void
+ */
+void traffic_init(traffic_approach_t *approach, uint32_t vehiclesPerHour);
+
+/*
+ * @brief Advances the approach by one tick
+ *
+ * @param1 approach
+ * @param2 current tick
+ * @param3 true if the approach has green
+ * @param4 24 bit random value deciding an arrival
+ * @return true if a vehicle crossed the stop line, which actuates the detector
+ */
+bool traffic_step(traffic_approach_t *approach, uint32_t tick, bool green, uint32_t random);
+
+/*
+ * @brief Adds the delay of the vehicles still waiting at the end of the run
+ *
+ * @param1 approach
+ * @param2 last tick
+ * @return void
+ */
+void traffic_finish(traffic_approach_t *approach, uint32_t tick);
+
+/*
+ * @brief Average stop line delay of the vehicles which arrived
+ *
+ * @param approach
+ * @return delay in ticks
+ */
+double traffic_average_delay(const traffic_approach_t *approach);
+
+#endif /* TRAFFIC_HOST_H_ */
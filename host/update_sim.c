@@ -0,0 +1,831 @@
+/**
+ * @file    update_sim.c
+ * @brief   This source file consists of the stand-in sender of the firmware update. It builds
+ * 			the binary delta of a new image against the running one, sends it frame by frame to
+ * 			update.c over a modelled UART and flash, copies the staged sectors as the RAM loop
+ * 			of update_flash.c does and checks the flash against the new image, a new image which
+ * 			secures the chip is refused. The time and
+ * 			bytes of the update are reported against a transfer of the full image
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on Linux
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "update.h"
+
+#define DEFAULT_BAUD			(115200)
+#define BITS_PER_BYTE			(10)	/*Start, 8 data and stop bit*/
+#define ERASE_US				(13000)	/*Sector erase, 113 ms at most*/
+#define PROGRAM_US				(65)	/*Longword program, 145 us at most*/
+#define CRC_NS_PER_BYTE			(400)	/*Nibble table CRC on the core, about 20 cycles at 48 MHz*/
+#define SECTOR_WORDS			(UPDATE_SECTOR_BYTES / sizeof(uint32_t))
+#define ERASED					(0xFF)
+#define MIN_MATCH				(8)		/*Shorter copies and fills cost more than literals*/
+#define HASH_BITS				(16)
+#define HASH_SIZE				(1u << HASH_BITS)
+#define MAX_CHAIN				(64)	/*Candidates tried per position*/
+#define NO_POSITION				(0xFFFFFFFFu)
+#define MAX_OPS					(UPDATE_SECTOR_BYTES + 2)	/*A long literal of the whole sector*/
+#define MAX_SENDS				(8)		/*Tries of a frame answered UPDATE_BAD_FRAME*/
+#define SYNTHETIC_BYTES			(40 * 1024)
+#define POINTER_SPACING			(96)	/*Average bytes between the addresses in the synthetic image*/
+#define INSERT_AT				(20000)	/*A function added to the new image, the code after it moves*/
+#define DEFAULT_INSERT			(36)
+#define GROWTH_BYTES			(600)	/*New constants at the end of the new image*/
+#define RANDOM_RANGE			(1u << 24)
+
+typedef struct
+{
+	const char *oldPath;
+	const char *newPath;
+	uint32_t baud;
+	uint32_t corrupt;			/*Every corrupt-th frame has a byte changed on the link, 0 for none*/
+	uint32_t seed;
+	uint32_t insert;			/*Bytes of the function inserted in the synthetic new image*/
+	bool badCrc;				/*The end frame carries a wrong CRC of the new image*/
+	bool secure;				/*The new image secures the chip in its flash configuration field*/
+} update_options_t;
+
+/*Bytes and time of one way of sending the new image*/
+typedef struct
+{
+	uint32_t frames;
+	uint32_t resent;
+	uint32_t bytesSent;
+	uint32_t bytesReceived;
+	uint32_t sectors;			/*Sector frames sent*/
+	uint32_t sectorsErased;
+	double linkUs;
+	double flashUs;
+	double crcUs;
+} transfer_t;
+
+static uint8_t flashMemory[UPDATE_FLASH_BYTES];
+static bool committing;			/*The copy over the running image has started*/
+static uint32_t lastCopied;		/*Image sector written last by the copy*/
+static update_t update;
+static transfer_t delta;
+static uint8_t *oldImage;
+static uint8_t *newImage;
+static uint32_t oldSize;
+static uint32_t newSize;
+static uint32_t hashHead[HASH_SIZE];
+static uint32_t *hashPrev;
+static uint32_t randomState;
+
+/*
+ * @brief Uniform random number
+ *
+ * @return value in [0, RANDOM_RANGE)
+ */
+static uint32_t random_next(void)
+{
+	randomState = randomState * 1664525u + 1013904223u;
+	return randomState >> 8;
+}
+
+/*
+ * @brief Start of the modelled flash, holding the running image
+ *
+ * @return address 0 of the flash
+ */
+const uint8_t *update_flash_base(void)
+{
+	return flashMemory;
+}
+
+/*
+ * @brief Erases and programs a sector of the modelled flash, programming can only clear
+ * 		  bits. The running image may only be written by the copy after the verification and
+ * 		  the flash records never
+ *
+ * @param1 flash address of the sector
+ * @param2 UPDATE_SECTOR_BYTES of data
+ * @return true if the sector was written
+ */
+bool update_flash_write_sector(uint32_t address, const uint32_t *data)
+{
+	const uint8_t *bytes = (const uint8_t *)data;
+	uint32_t index;
+
+	if ((address % UPDATE_SECTOR_BYTES != 0) || (address >= UPDATE_FLASH_BYTES) ||
+		((address >= UPDATE_RECORDS_START) && (address < UPDATE_STAGING_START)) ||
+		(!committing && (address < UPDATE_STAGING_START)))
+	{
+		printf("flash write at 0x%05lx refused\n", (unsigned long)address);
+		return false;
+	}
+	memset(&flashMemory[address], ERASED, UPDATE_SECTOR_BYTES);
+	for (index = 0; index < UPDATE_SECTOR_BYTES; index++)
+	{
+		flashMemory[address + index] &= bytes[index];
+	}
+	if (committing)
+	{
+		lastCopied = address >> UPDATE_SECTOR_SHIFT;
+	}
+	delta.sectorsErased++;
+	delta.flashUs += ERASE_US + SECTOR_WORDS * PROGRAM_US;
+	return true;
+}
+
+/*
+ * @brief Microseconds of bytes on the UART
+ *
+ * @param1 options
+ * @param2 bytes
+ * @return usec
+ */
+static double link_us(const update_options_t *options, uint32_t bytes)
+{
+	return (double)bytes * BITS_PER_BYTE * 1e6 / options->baud;
+}
+
+/*
+ * @brief Reads a whole file
+ *
+ * @param1 path
+ * @param2 bytes read
+ * @return buffer, NULL if the file cannot be read
+ */
+static uint8_t *read_file(const char *path, uint32_t *size)
+{
+	FILE *file = fopen(path, "rb");
+	uint8_t *data;
+	long length;
+
+	if (file == NULL)
+	{
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	length = ftell(file);
+	rewind(file);
+	data = malloc((size_t)length + 1);
+	if ((data == NULL) || (fread(data, 1, (size_t)length, file) != (size_t)length))
+	{
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	*size = (uint32_t)length;
+	return data;
+}
+
+/*
+ * @brief Stores a 32 bit value little endian
+ *
+ * @param1 where
+ * @param2 value
+ * @return void
+ */
+static void put_u32(uint8_t *where, uint32_t value)
+{
+	where[0] = (uint8_t)value;
+	where[1] = (uint8_t)(value >> 8);
+	where[2] = (uint8_t)(value >> 16);
+	where[3] = (uint8_t)(value >> 24);
+}
+
+/*
+ * @brief Builds an old image which looks like code, random bytes with the addresses of places
+ * 		  in the image among them and erased padding, and a new one with a function inserted,
+ * 		  the addresses after it moved, a few constants changed and more data at the end
+ *
+ * @param bytes of the function inserted, 0 for a change of constants only
+ * @return void
+ */
+static void synthetic_images(uint32_t insert)
+{
+	uint32_t *pointers = malloc(SYNTHETIC_BYTES / 4 * sizeof(uint32_t));
+	uint32_t pointerCount = 0;
+	uint32_t position = 0;
+	uint32_t index;
+
+	oldSize = SYNTHETIC_BYTES;
+	oldImage = malloc(oldSize);
+	while (position + 4 <= oldSize)
+	{
+		uint32_t gap = random_next() % (2 * POINTER_SPACING) + 1;
+
+		for (index = 0; (index < gap) && (position < oldSize); index++)
+		{
+			oldImage[position++] = (uint8_t)random_next();
+		}
+		if ((random_next() % 16 == 0) && (position + 64 <= oldSize))
+		{
+			memset(&oldImage[position], ERASED, 64);		/*Alignment padding*/
+			position += 64;
+		}
+		if (position + 4 <= oldSize)
+		{
+			pointers[pointerCount++] = position;
+			put_u32(&oldImage[position], random_next() % oldSize);
+			position += 4;
+		}
+	}
+
+	newSize = oldSize + insert + GROWTH_BYTES;
+	newImage = malloc(newSize);
+	memcpy(newImage, oldImage, INSERT_AT);
+	for (index = 0; index < insert; index++)
+	{
+		newImage[INSERT_AT + index] = (uint8_t)random_next();
+	}
+	memcpy(&newImage[INSERT_AT + insert], &oldImage[INSERT_AT], oldSize - INSERT_AT);
+	for (index = 0; index < GROWTH_BYTES; index++)
+	{
+		newImage[oldSize + insert + index] = (uint8_t)random_next();
+	}
+	for (index = 0; index < pointerCount; index++)
+	{
+		uint32_t at = pointers[index];
+		uint32_t target = (uint32_t)oldImage[at] | ((uint32_t)oldImage[at + 1] << 8) |
+						  ((uint32_t)oldImage[at + 2] << 16) | ((uint32_t)oldImage[at + 3] << 24);
+
+		if (at >= INSERT_AT)
+		{
+			at += insert;
+		}
+		if (target >= INSERT_AT)
+		{
+			put_u32(&newImage[at], target + insert);
+		}
+	}
+	memset(&oldImage[UPDATE_CONFIG_START], ERASED, UPDATE_CONFIG_BYTES);	/*Unsecured, unprotected*/
+	oldImage[UPDATE_CONFIG_FSEC] = UPDATE_FSEC_UNSECURE;
+	memcpy(&newImage[UPDATE_CONFIG_START], &oldImage[UPDATE_CONFIG_START], UPDATE_CONFIG_BYTES);
+	newImage[0x410] ^= 0x01;			/*A timing constant in the second sector*/
+	newImage[0x2C08] ^= 0x80;
+	free(pointers);
+}
+
+/*
+ * @brief Indexes every position of the old image by the hash of its next 4 bytes
+ *
+ * @return void
+ */
+static void hash_old_image(void)
+{
+	uint32_t position;
+
+	hashPrev = malloc((oldSize + 1) * sizeof(uint32_t));
+	memset(hashHead, 0xFF, sizeof(hashHead));
+	for (position = 0; position + 4 <= oldSize; position++)
+	{
+		uint32_t key = (uint32_t)oldImage[position] | ((uint32_t)oldImage[position + 1] << 8) |
+					   ((uint32_t)oldImage[position + 2] << 16) | ((uint32_t)oldImage[position + 3] << 24);
+		uint32_t hash = (key * 2654435761u) >> (32 - HASH_BITS);
+
+		hashPrev[position] = hashHead[hash];
+		hashHead[hash] = position;
+	}
+}
+
+/*
+ * @brief Longest match of the old image for the next bytes of a sector
+ *
+ * @param1 bytes of the sector from the position
+ * @param2 bytes left in the sector
+ * @param3 position of the match in the old image
+ * @return length of the match, 0 if none
+ */
+static uint32_t find_match(const uint8_t *data, uint32_t left, uint32_t *source)
+{
+	uint32_t best = 0;
+	uint32_t chain = 0;
+	uint32_t candidate;
+	uint32_t key;
+
+	if (left < 4)
+	{
+		return 0;
+	}
+	key = (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+	for (candidate = hashHead[(key * 2654435761u) >> (32 - HASH_BITS)];
+		 (candidate != NO_POSITION) && (chain < MAX_CHAIN); candidate = hashPrev[candidate], chain++)
+	{
+		uint32_t length = 0;
+
+		while ((length < left) && (candidate + length < oldSize) && (oldImage[candidate + length] == data[length]))
+		{
+			length++;
+		}
+		if (length > best)
+		{
+			best = length;
+			*source = candidate;
+		}
+	}
+	return best;
+}
+
+/*
+ * @brief Appends an op header
+ *
+ * @param1 ops
+ * @param2 bytes of ops
+ * @param3 UPDATE_OP_ kind
+ * @param4 bytes the op builds
+ * @return void
+ */
+static void put_op(uint8_t *ops, uint32_t *length, uint8_t kind, uint32_t count)
+{
+	if (count <= UPDATE_OP_SHORT_MAX)
+	{
+		ops[(*length)++] = (uint8_t)((kind << UPDATE_OP_SHIFT) | (count - 1));
+	}
+	else
+	{
+		ops[(*length)++] = (uint8_t)((kind << UPDATE_OP_SHIFT) | UPDATE_OP_LONG | ((count - 1) >> 8));
+		ops[(*length)++] = (uint8_t)(count - 1);
+	}
+}
+
+/*
+ * @brief Appends the literal bytes collected
+ *
+ * @param1 ops
+ * @param2 bytes of ops
+ * @param3 literal bytes
+ * @param4 number of literal bytes
+ * @return void
+ */
+static void put_literal(uint8_t *ops, uint32_t *length, const uint8_t *literal, uint32_t count)
+{
+	if (count != 0)
+	{
+		put_op(ops, length, UPDATE_OP_LITERAL, count);
+		memcpy(&ops[*length], literal, count);
+		*length += count;
+	}
+}
+
+/*
+ * @brief Delta ops of a sector against the old image: fills, copies and literals, or the
+ * 		  whole sector as one literal when that is shorter
+ *
+ * @param1 sector of the new image padded with ERASED
+ * @param2 MAX_OPS bytes
+ * @return bytes of ops
+ */
+static uint32_t encode_sector(const uint8_t *sector, uint8_t *ops)
+{
+	uint32_t length = 0;
+	uint32_t literalStart = 0;
+	uint32_t position = 0;
+
+	while (position < UPDATE_SECTOR_BYTES)
+	{
+		uint32_t left = UPDATE_SECTOR_BYTES - position;
+		uint32_t run = 1;
+		uint32_t source = 0;
+		uint32_t match;
+
+		while ((run < left) && (sector[position + run] == sector[position]))
+		{
+			run++;
+		}
+		match = find_match(&sector[position], left, &source);
+		if ((run < MIN_MATCH) && (match < MIN_MATCH))
+		{
+			position++;
+			continue;
+		}
+		put_literal(ops, &length, &sector[literalStart], position - literalStart);
+		if (run >= match)
+		{
+			put_op(ops, &length, UPDATE_OP_FILL, run);
+			ops[length++] = sector[position];
+			position += run;
+		}
+		else
+		{
+			put_op(ops, &length, UPDATE_OP_COPY, match);
+			ops[length++] = (uint8_t)source;
+			ops[length++] = (uint8_t)(source >> 8);
+			ops[length++] = (uint8_t)(source >> 16);
+			position += match;
+		}
+		literalStart = position;
+		if (length > MAX_OPS)
+		{
+			break;
+		}
+	}
+	if (length <= MAX_OPS)
+	{
+		put_literal(ops, &length, &sector[literalStart], position - literalStart);
+	}
+	if (length > MAX_OPS)
+	{
+		length = 0;
+		put_literal(ops, &length, sector, UPDATE_SECTOR_BYTES);
+	}
+	return length;
+}
+
+/*
+ * @brief Decodes a COBS reply from the receiver
+ *
+ * @param1 reply with its 0 delimiter
+ * @param2 bytes of reply
+ * @param3 UPDATE_REPLY_BYTES decoded
+ * @return true if it is a reply with a good CRC
+ */
+static bool decode_reply(const uint8_t *reply, uint32_t length, uint8_t *payload)
+{
+	uint8_t decoded[UPDATE_REPLY_MAX];
+	uint32_t in = 0;
+	uint32_t out = 0;
+
+	length--;
+	while (in < length)
+	{
+		uint32_t code = reply[in++];
+
+		while ((--code != 0) && (in < length) && (out < sizeof(decoded)))
+		{
+			decoded[out++] = reply[in++];
+		}
+		if ((in < length) && (out < sizeof(decoded)))
+		{
+			decoded[out++] = 0;
+		}
+	}
+	if ((out != UPDATE_REPLY_BYTES + UPDATE_CRC_BYTES) ||
+		(update_crc32(0, decoded, UPDATE_REPLY_BYTES) !=
+		 ((uint32_t)decoded[9] | ((uint32_t)decoded[10] << 8) | ((uint32_t)decoded[11] << 16) |
+		  ((uint32_t)decoded[12] << 24))))
+	{
+		return false;
+	}
+	memcpy(payload, decoded, UPDATE_REPLY_BYTES);
+	return (payload[0] == UPDATE_FRAME_REPLY);
+}
+
+/*
+ * @brief Sends a frame byte by byte and waits for its reply, a frame answered
+ * 		  UPDATE_BAD_FRAME is sent again
+ *
+ * @param1 options
+ * @param2 payload
+ * @param3 bytes of payload
+ * @param4 value of the reply
+ * @return status of the reply
+ */
+static uint8_t send_frame(const update_options_t *options, const uint8_t *payload, uint32_t length, uint32_t *value)
+{
+	static uint8_t frame[UPDATE_FRAME_MAX + 1];
+	uint32_t sends;
+
+	for (sends = 0; sends < MAX_SENDS; sends++)
+	{
+		uint32_t frameLength = update_frame_encode(payload, length, frame);
+		uint8_t status = UPDATE_BAD_FRAME;
+		uint32_t index;
+
+		delta.frames++;
+		delta.resent += (sends != 0);
+		if ((options->corrupt != 0) && ((delta.frames % options->corrupt) == 0))
+		{
+			uint8_t *byte = &frame[frameLength / 2];
+
+			*byte ^= (*byte == 0x55) ? 0xAA : 0x55;		/*Not a 0, the frame keeps its delimiter*/
+		}
+		delta.bytesSent += frameLength;
+		delta.linkUs += link_us(options, frameLength);
+		for (index = 0; index < frameLength; index++)
+		{
+			uint8_t reply[UPDATE_REPLY_MAX];
+			uint8_t answer[UPDATE_REPLY_BYTES];
+			uint32_t replyLength = update_receive(&update, frame[index], reply);
+
+			if (replyLength == 0)
+			{
+				continue;
+			}
+			delta.bytesReceived += replyLength;
+			delta.linkUs += link_us(options, replyLength);
+			if (!decode_reply(reply, replyLength, answer))
+			{
+				printf("bad reply\n");
+				return UPDATE_BAD_FRAME;
+			}
+			status = answer[2];
+			*value = (uint32_t)answer[5] | ((uint32_t)answer[6] << 8) | ((uint32_t)answer[7] << 16) |
+					 ((uint32_t)answer[8] << 24);
+			if (status == UPDATE_BAD_FRAME)
+			{
+				break;		/*Both parts of a frame split by the error are answered*/
+			}
+		}
+		if (status != UPDATE_BAD_FRAME)
+		{
+			return status;
+		}
+	}
+	return UPDATE_BAD_FRAME;
+}
+
+/*
+ * @brief Sends the delta of the new image: the begin frame, the sectors which differ from the
+ * 		  old image and the end frame
+ *
+ * @param1 options
+ * @return UPDATE_OK if the receiver verified the staged image
+ */
+static uint8_t send_update(const update_options_t *options)
+{
+	uint8_t payload[UPDATE_SECTOR_HEADER_BYTES + MAX_OPS];
+	uint32_t newCrc = update_crc32(0, newImage, newSize);
+	uint32_t sectors = (newSize + UPDATE_SECTOR_BYTES - 1) / UPDATE_SECTOR_BYTES;
+	uint32_t value = 0;
+	uint32_t sector;
+	uint8_t status;
+
+	payload[0] = UPDATE_FRAME_BEGIN;
+	put_u32(&payload[1], newSize);
+	put_u32(&payload[5], options->badCrc ? ~newCrc : newCrc);
+	put_u32(&payload[9], oldSize);
+	put_u32(&payload[13], update_crc32(0, oldImage, oldSize));
+	status = send_frame(options, payload, UPDATE_BEGIN_BYTES, &value);
+	delta.crcUs += oldSize * CRC_NS_PER_BYTE / 1000.0;
+	if (status != UPDATE_OK)
+	{
+		printf("begin refused, status %u, running image CRC 0x%08lx\n", status, (unsigned long)value);
+		return status;
+	}
+
+	for (sector = 0; sector < sectors; sector++)
+	{
+		uint8_t data[UPDATE_SECTOR_BYTES];
+		uint32_t address = sector * UPDATE_SECTOR_BYTES;
+		uint32_t bytes = (newSize - address < UPDATE_SECTOR_BYTES) ? newSize - address : UPDATE_SECTOR_BYTES;
+
+		memset(data, ERASED, sizeof(data));
+		memcpy(data, &newImage[address], bytes);
+		if (memcmp(data, &flashMemory[address], UPDATE_SECTOR_BYTES) == 0)
+		{
+			continue;		/*Unchanged, the receiver keeps it*/
+		}
+		delta.sectors++;
+		payload[0] = UPDATE_FRAME_SECTOR;
+		payload[1] = (uint8_t)sector;
+		payload[2] = (uint8_t)(sector >> 8);
+		status = send_frame(options, payload,
+							UPDATE_SECTOR_HEADER_BYTES + encode_sector(data, &payload[UPDATE_SECTOR_HEADER_BYTES]),
+							&value);
+		if (status != UPDATE_OK)
+		{
+			printf("sector %lu refused, status %u\n", (unsigned long)sector, status);
+			return status;
+		}
+	}
+
+	payload[0] = UPDATE_FRAME_END;
+	status = send_frame(options, payload, 1, &value);
+	delta.crcUs += newSize * CRC_NS_PER_BYTE / 1000.0;
+	if (status != UPDATE_OK)
+	{
+		printf("end refused, status %u, staged image CRC 0x%08lx\n", status, (unsigned long)value);
+	}
+	return status;
+}
+
+/*
+ * @brief Copies the staged sectors over the running image, as ram_commit() of update_flash.c:
+ * 		  the vector table after every other sector
+ *
+ * @return void
+ */
+static void commit(void)
+{
+	uint8_t pass;
+	uint8_t index;
+
+	committing = true;
+	for (pass = 0; pass < 2; pass++)
+	{
+		for (index = 0; index < update.staged; index++)
+		{
+			if ((update.stagedSector[index] == UPDATE_VECTOR_SECTOR) != (pass == 1))
+			{
+				continue;		/*The vector table in the second pass*/
+			}
+			memcpy(update.sector, &flashMemory[UPDATE_STAGING_START + ((uint32_t)index << UPDATE_SECTOR_SHIFT)],
+				   UPDATE_SECTOR_BYTES);
+			(void)update_flash_write_sector((uint32_t)update.stagedSector[index] << UPDATE_SECTOR_SHIFT,
+											update.sector);
+		}
+	}
+}
+
+/*
+ * @brief Whether an image sector was staged
+ *
+ * @param image sector
+ * @return true if one of the staging sectors holds it
+ */
+static bool staging_holds(uint32_t sector)
+{
+	uint8_t index;
+
+	for (index = 0; index < update.staged; index++)
+	{
+		if (update.stagedSector[index] == sector)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * @brief Prints the usage
+ *
+ * @param program name
+ * @return void
+ */
+static void usage(const char *program)
+{
+	printf("usage: %s [--old FILE --new FILE] [--baud N] [--corrupt FRAMES] [--bad-crc on|off]\n"
+		   "          [--secure on|off] [--insert BYTES] [--seed N]\n",
+		   program);
+}
+
+/*
+ * @brief Reads the command line options
+ *
+ * @return true if the options are valid
+ */
+static bool parse_options(int argc, char **argv, update_options_t *options)
+{
+	int index;
+
+	memset(options, 0, sizeof(*options));
+	options->baud = DEFAULT_BAUD;
+	options->seed = 1;
+	options->insert = DEFAULT_INSERT;
+
+	for (index = 1; index + 1 < argc; index += 2)
+	{
+		const char *option = argv[index];
+		const char *value = argv[index + 1];
+
+		if (strcmp(option, "--old") == 0)
+		{
+			options->oldPath = value;
+		}
+		else if (strcmp(option, "--new") == 0)
+		{
+			options->newPath = value;
+		}
+		else if (strcmp(option, "--baud") == 0)
+		{
+			options->baud = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--corrupt") == 0)
+		{
+			options->corrupt = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--bad-crc") == 0)
+		{
+			options->badCrc = (strcmp(value, "off") != 0);
+		}
+		else if (strcmp(option, "--secure") == 0)
+		{
+			options->secure = (strcmp(value, "off") != 0);
+		}
+		else if (strcmp(option, "--insert") == 0)
+		{
+			options->insert = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(option, "--seed") == 0)
+		{
+			options->seed = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return (index == argc) && (options->baud != 0) && ((options->oldPath == NULL) == (options->newPath == NULL));
+}
+
+int main(int argc, char **argv)
+{
+	update_options_t options;
+	static uint8_t records[UPDATE_STAGING_START - UPDATE_RECORDS_START];
+	transfer_t full;
+	uint32_t sectors;
+	uint32_t index;
+	uint8_t status;
+	bool intact;
+	bool verified;
+	bool kept;
+	bool ordered;
+
+	if (!parse_options(argc, argv, &options))
+	{
+		usage(argv[0]);
+		return 1;
+	}
+	randomState = options.seed;
+	if (options.oldPath != NULL)
+	{
+		oldImage = read_file(options.oldPath, &oldSize);
+		newImage = read_file(options.newPath, &newSize);
+		if ((oldImage == NULL) || (newImage == NULL))
+		{
+			printf("cannot read %s or %s\n", options.oldPath, options.newPath);
+			return 1;
+		}
+	}
+	else
+	{
+		synthetic_images(options.insert);
+	}
+	if (options.secure && (newSize > UPDATE_CONFIG_FSEC))
+	{
+		newImage[UPDATE_CONFIG_FSEC] = (uint8_t)~UPDATE_FSEC_UNSECURE;	/*SEC = 01, secured*/
+	}
+	if ((oldSize > UPDATE_RECORDS_START) || (newSize > UPDATE_RECORDS_START) || (newSize == 0))
+	{
+		printf("images of %lu and %lu bytes, at most %lu bytes below the flash records\n",
+			   (unsigned long)oldSize, (unsigned long)newSize, (unsigned long)UPDATE_RECORDS_START);
+		return 1;
+	}
+	sectors = (newSize + UPDATE_SECTOR_BYTES - 1) / UPDATE_SECTOR_BYTES;
+	memset(flashMemory, ERASED, sizeof(flashMemory));
+	memcpy(flashMemory, oldImage, oldSize);
+	for (index = UPDATE_RECORDS_START; index < UPDATE_STAGING_START; index++)
+	{
+		flashMemory[index] = (uint8_t)random_next();		/*A saved crash dump and recording*/
+	}
+	memcpy(records, &flashMemory[UPDATE_RECORDS_START], sizeof(records));
+	hash_old_image();
+	update_init(&update, oldSize);
+	printf("old image %lu bytes, new image %lu bytes in %lu sectors, %lu baud",
+		   (unsigned long)oldSize, (unsigned long)newSize, (unsigned long)sectors, (unsigned long)options.baud);
+	if (options.corrupt != 0)
+	{
+		printf(", a byte corrupted every %lu frames", (unsigned long)options.corrupt);
+	}
+	printf("\n");
+
+	status = send_update(&options);
+	intact = (memcmp(flashMemory, oldImage, oldSize) == 0);
+	if (update.commit)
+	{
+		commit();
+	}
+	verified = update.commit && (memcmp(flashMemory, newImage, newSize) == 0);
+	ordered = (staging_holds(UPDATE_VECTOR_SECTOR) == (lastCopied == UPDATE_VECTOR_SECTOR));
+	kept = (memcmp(records, &flashMemory[UPDATE_RECORDS_START], sizeof(records)) == 0);
+
+	/*Full image: every sector as one literal, erased and programmed once in place*/
+	memset(&full, 0, sizeof(full));
+	full.frames = sectors + 2;
+	full.sectors = sectors;
+	full.bytesSent = sectors * (UPDATE_SECTOR_HEADER_BYTES + MAX_OPS + UPDATE_CRC_BYTES + 7) +
+					 UPDATE_BEGIN_BYTES + 1 + 2 * (UPDATE_CRC_BYTES + 2);
+	full.bytesReceived = full.frames * UPDATE_REPLY_MAX;
+	full.linkUs = link_us(&options, full.bytesSent + full.bytesReceived);
+	full.sectorsErased = sectors;
+	full.flashUs = sectors * (ERASE_US + SECTOR_WORDS * PROGRAM_US);
+	full.crcUs = newSize * CRC_NS_PER_BYTE / 1000.0;
+
+	printf("\n%-10s %6s %6s %10s %8s %8s %8s %8s %8s\n", "transfer", "frames", "resent", "bytes sent",
+		   "erased", "link s", "flash s", "crc s", "total s");
+	printf("%-10s %6lu %6s %10lu %8lu %8.2f %8.2f %8.2f %8.2f\n", "full", (unsigned long)full.frames, "-",
+		   (unsigned long)full.bytesSent, (unsigned long)full.sectorsErased, full.linkUs / 1e6, full.flashUs / 1e6,
+		   full.crcUs / 1e6, (full.linkUs + full.flashUs + full.crcUs) / 1e6);
+	printf("%-10s %6lu %6lu %10lu %8lu %8.2f %8.2f %8.2f %8.2f\n", "delta", (unsigned long)delta.frames,
+		   (unsigned long)delta.resent, (unsigned long)delta.bytesSent, (unsigned long)delta.sectorsErased,
+		   delta.linkUs / 1e6, delta.flashUs / 1e6, delta.crcUs / 1e6,
+		   (delta.linkUs + delta.flashUs + delta.crcUs) / 1e6);
+	printf("changed sectors %lu of %lu, staged %u, received unchanged %lu, bad frames %lu\n",
+		   (unsigned long)delta.sectors, (unsigned long)sectors, update.staged,
+		   (unsigned long)update.stats.sectorsUnchanged, (unsigned long)update.stats.badFrames);
+	printf("delta sends %.1f%% of the bytes in %.1f%% of the time of the full image\n",
+		   100.0 * delta.bytesSent / full.bytesSent,
+		   100.0 * (delta.linkUs + delta.flashUs + delta.crcUs) / (full.linkUs + full.flashUs + full.crcUs));
+
+	if (status != UPDATE_OK)
+	{
+		printf("update refused, running image %s\n", intact ? "intact" : "CHANGED");
+		return 1;
+	}
+	if (!intact || !verified || !kept || !ordered)
+	{
+		printf("FAILED: running image written before the verification, new image not in flash, "
+			   "flash records changed or vector table not copied last\n");
+		return 1;
+	}
+	printf("new image verified in flash, vector table copied last, saved crash dump and recording kept\n");
+	return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file    adaptive_timing.c
+ * @brief   This source file consists of function definitions of the demand adaptive GO timing
+ * 			which extends or shortens the green from vehicle detector actuations
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "adaptive_timing.h"
+
+/*
+ * @brief Initializes the adaptive timing with the given limits
+ *
+ * @param1 adaptive timing instance
+ * @param2 GO limits, copied
+ * @return void
+ */
+void adaptive_timing_init(adaptive_timing_t *timing, const adaptive_timing_config_t *config)
+{
+	memset(timing, 0, sizeof(*timing));
+	timing->config = *config;
+	if (timing->config.maxGreenTicks < timing->config.minGreenTicks)
+	{
+		timing->config.maxGreenTicks = timing->config.minGreenTicks;
+	}
+	if ((timing->config.passageTicks == 0) && (timing->config.minGreenTicks < timing->config.maxGreenTicks))
+	{
+		timing->config.passageTicks = 1;
+	}
+}
+
+/*
+ * @brief Records the detector actuations counted since the previous call
+ *
+ * @param1 adaptive timing instance
+ * @param2 current tick
+ * @param3 actuations counted by the detector input
+ * @return void
+ */
+void adaptive_timing_detector(adaptive_timing_t *timing, ticktime now, uint32_t actuations)
+{
+	if (actuations != 0)
+	{
+		timing->stats.actuations += actuations;
+		timing->lastActuation = now;
+	}
+}
+
+/*
+ * @brief Starts timing a GO phase
+ *
+ * @param1 adaptive timing instance
+ * @param2 current tick
+ * @return void
+ */
+void adaptive_timing_green_start(adaptive_timing_t *timing, ticktime now)
+{
+	timing->greenStart = now;
+	timing->lastActuation = now; /*Demand seen before GO does not extend it*/
+}
+
+/*
+ * @brief Decides whether the GO phase ends now
+ *
+ * @param1 adaptive timing instance
+ * @param2 current tick
+ * @return true to change to TRANSITION_TO_WARNING
+ */
+bool adaptive_timing_green_done(adaptive_timing_t *timing, ticktime now)
+{
+	uint32_t elapsed = now - timing->greenStart;
+
+	if (elapsed >= timing->config.maxGreenTicks)
+	{
+		timing->stats.maxOuts++;
+	}
+	else if ((elapsed >= timing->config.minGreenTicks) &&
+			 ((now - timing->lastActuation) >= timing->config.passageTicks))
+	{
+		timing->stats.gapOuts++;
+	}
+	else
+	{
+		return false;
+	}
+	timing->stats.phases++;
+	timing->stats.totalGreenTicks += elapsed;
+	return true;
+}
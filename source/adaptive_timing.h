@@ -0,0 +1,91 @@
+/**
+ * @file    adaptive_timing.h
+ * @brief   This header file consists of the demand adaptive GO timing which extends or
+ * 			shortens the green from vehicle detector actuations with gap-out and max-out
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef ADAPTIVE_TIMING_H_
+#define ADAPTIVE_TIMING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+/*
+ * GO limits in ticks of 62.5 msec. Setting minGreenTicks equal to maxGreenTicks gives the
+ * fixed time GO of the original sequence, every green then ends by max-out
+ */
+typedef struct
+{
+	uint32_t minGreenTicks;		/*GO always runs this long*/
+	uint32_t maxGreenTicks;		/*GO never runs longer, even with continuous demand*/
+	uint32_t passageTicks;		/*Each actuation extends GO by this long after the minimum green*/
+} adaptive_timing_config_t;
+
+/*Green phase statistics, times are in ticks*/
+typedef struct
+{
+	uint32_t actuations;		/*Detector actuations seen in any state*/
+	uint32_t phases;			/*Greens ended*/
+	uint32_t gapOuts;			/*Greens ended by a gap in the demand*/
+	uint32_t maxOuts;			/*Greens ended by the maximum green*/
+	uint32_t totalGreenTicks;
+} adaptive_timing_stats_t;
+
+typedef struct
+{
+	adaptive_timing_config_t config;
+	adaptive_timing_stats_t stats;
+	ticktime greenStart;		/*Tick at which GO was entered*/
+	ticktime lastActuation;		/*Latest actuation, never earlier than greenStart*/
+} adaptive_timing_t;
+
+/*
+ * @brief Initializes the adaptive timing with the given limits
+ *
+ * @param1 adaptive timing instance
+ * @param2 GO limits, copied. A passage time of 0 with a minimum below the maximum is
+ * 		   raised to one tick so that a gap-out needs at least one tick without demand
+ * @return void
+ */
+void adaptive_timing_init(adaptive_timing_t *timing, const adaptive_timing_config_t *config);
+
+/*
+ * @brief Records the detector actuations counted since the previous call
+ *
+ * Called once per tick, so the cost does not depend on the traffic
+ *
+ * @param1 adaptive timing instance
+ * @param2 current tick
+ * @param3 actuations counted by the detector input
+ * @return void
+ */
+void adaptive_timing_detector(adaptive_timing_t *timing, ticktime now, uint32_t actuations);
+
+/*
+ * @brief Starts timing a GO phase
+ *
+ * @param1 adaptive timing instance
+ * @param2 current tick
+ * @return void
+ */
+void adaptive_timing_green_start(adaptive_timing_t *timing, ticktime now);
+
+/*
+ * @brief Decides whether the GO phase ends now
+ *
+ * GO ends by max-out at the maximum green, or by gap-out once the minimum green has run
+ * and no actuation has been seen for the passage time
+ *
+ * @param1 adaptive timing instance
+ * @param2 current tick
+ * @return true to change to TRANSITION_TO_WARNING
+ */
+bool adaptive_timing_green_done(adaptive_timing_t *timing, ticktime now);
+
+#endif /* ADAPTIVE_TIMING_H_ */
@@ -0,0 +1,302 @@
+/**
+ * @file    boot.c
+ * @brief   This source file consists of function definitions of the boot sequencer: the
+ * 			crystal and the PLL start in ResetISR and lock during the RAM initialization and the
+ * 			board configuration, the LED flashes the fail-safe red on the reset clock from the
+ * 			boot timer and the console reports wait for the first frame of the sequence
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 24 Multipurpose Clock Generator
+ */
+
+#include "MKL25Z4.h"
+#include "fsl_clock.h"
+#include "clock_config.h"
+#include "boot.h"
+#include "timebase.h"
+#include "pwm.h"
+#include "faultlog.h"
+#include "crashdump.h"
+#include "conflict_monitor.h"
+#include "logfmt.h"
+
+#define BOOT_COUNTER_MASK			(SysTick_LOAD_RELOAD_Msk) /*24 bit down counter*/
+#define US_PER_SECOND				(1000000U)
+#define US_PER_TICK					(62500U)
+#define OSC_RANGE_HIGH				(1)		/*RANGE0 of a 3 to 8 MHz crystal*/
+#define CLKST_EXTERNAL				(2)		/*MCG_S CLKST of the external reference*/
+#define OSC_MODE_MASK				(MCG_C2_EREFS0_MASK | MCG_C2_HGO0_MASK | MCG_C2_RANGE0_MASK)
+/*Slowest core clock of the switch to PEE, the 8 MHz crystal in FBE divided by OUTDIV1*/
+#define SWITCH_CORE_CLOCK			(4000000U)
+/*The red flashes as the fail-safe of the conflict monitor does, once a second*/
+#define BOOT_FLASH_PERIOD_US		(MONITOR_FLASH_PERIOD * US_PER_TICK)
+#define BOOT_FLASH_ON_US			(MONITOR_FLASH_ON * US_PER_TICK)
+
+boot_t boot;
+
+static const char *const markNames[BOOT_MARKS] = { "first light", "clocks", "first frame", "deferred" };
+
+/*
+ * @brief Starts the SysTick on the core clock as the boot timer, called first in ResetISR
+ *
+ * The count wraps every 2^24 core cycles, 0.8 s on the reset clock, boot_elapsed_us() is
+ * called more often than that until boot_handover()
+ *
+ * @return void
+ */
+void boot_timer_start(void)
+{
+	SysTick->LOAD = BOOT_COUNTER_MASK;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;	/*No interrupt*/
+}
+
+/*
+ * @brief Takes the reset clock for the boot timer, called first in main()
+ *
+ * SystemCoreClock holds the FEI clock, 20.97 MHz, until the clocks are set up. lastCount is 0
+ * after the bss is cleared, which the counter equals when it is started
+ *
+ * @return void
+ */
+void boot_init(void)
+{
+	boot.coreClock = SystemCoreClock;
+}
+
+/*
+ * @brief Time since ResetISR
+ *
+ * Before boot_handover() the cycles since the last call are added at the clock they ran on,
+ * and the red of boot_first_light() is turned on or off for the time. After it the ticks
+ * since the handover and the cycles in the current tick
+ *
+ * @return microseconds
+ */
+uint32_t boot_elapsed_us(void)
+{
+	uint32_t count;
+	bool lit;
+
+	if (boot.ticking)
+	{
+		return boot.elapsedUs + (now() - boot.handoverTick) * US_PER_TICK +
+			   (uint32_t)(((uint64_t)cycles_in_tick() * US_PER_SECOND) / timebase.coreClock);
+	}
+	count = SysTick->VAL;
+	boot.elapsedUs += (uint32_t)(((uint64_t)((boot.lastCount - count) & BOOT_COUNTER_MASK) * US_PER_SECOND) /
+								 boot.coreClock);
+	boot.lastCount = count;
+
+	if (boot.flashing)
+	{
+		lit = ((boot.elapsedUs - boot.marks[BOOT_MARK_FIRST_LIGHT]) % BOOT_FLASH_PERIOD_US) < BOOT_FLASH_ON_US;
+		if (lit != boot.lit)
+		{
+			boot.lit = lit;
+			show_led_colour(lit ? BOOT_RED : 0, 0, 0);
+		}
+	}
+	return boot.elapsedUs;
+}
+
+/*
+ * @brief Notes the time of a step of the boot, the first time only
+ *
+ * @param BOOT_MARK_
+ * @return void
+ */
+void boot_mark(uint8_t mark)
+{
+	if (boot.marks[mark] == 0)
+	{
+		boot.marks[mark] = boot_elapsed_us();
+	}
+}
+
+/*
+ * @brief Starts the fail-safe red flash on the reset clock: the TPM modules run from the 4 MHz
+ * 		  fast internal reference, which needs no crystal or PLL
+ *
+ * The FLL keeps the slow internal reference, only MCGIRCLK moves to the fast one. The red is
+ * the flash of the conflict monitor on a fault, on for the first half second. The boot
+ * timer has no interrupt, every boot_elapsed_us() until boot_handover() turns the red on or
+ * off, a boot which stalls in the clock waits keeps flashing
+ *
+ * @return void
+ */
+void boot_first_light(void)
+{
+	CLOCK_SetInternalRefClkConfig(kMCG_IrclkEnable, kMCG_IrcFast, 0);
+	timebase_configure(SystemCoreClock, TIMEBASE_TPM_MCGIRCLK, CLOCK_GetFreq(kCLOCK_McgInternalRefClk));
+	Init_Red_LED_PWM();
+	Init_Green_LED_PWM();
+	Init_Blue_LED_PWM();
+	show_led_colour(BOOT_RED, 0, 0);	/*Not an output of the sequence, the recording starts later*/
+	boot_mark(BOOT_MARK_FIRST_LIGHT);
+	boot.lit = true;
+	boot.flashing = true;
+}
+
+/*
+ * @brief Adds the cycles counted on the clock before a switch, the cycles counted during it
+ * 		  are converted at its slowest clock
+ *
+ * @return void
+ */
+static void switch_begin(void)
+{
+	boot_elapsed_us();
+	boot.coreClock = SWITCH_CORE_CLOCK;
+}
+
+/*
+ * @brief Adds the cycles counted during a switch and takes the new SystemCoreClock
+ *
+ * @return void
+ */
+static void switch_end(void)
+{
+	boot_elapsed_us();
+	boot.coreClock = SystemCoreClock;
+}
+
+/*
+ * @brief Starts the crystal and the PLL of the RUN profile without waiting for them, the
+ * 		  core stays on the FLL. Called in ResetISR before the RAM initialization
+ *
+ * The same settings as CLOCK_InitOsc0() and CLOCK_EnablePll0() in BOARD_BootClockRUN(),
+ * without their waits for OSCINIT0 and LOCK0. With PLLCLKEN0 the PLL locks on the crystal
+ * as soon as it runs, before PLLS selects it. Only registers are written, the crystal
+ * frequency of the clock driver is set by boot_clock_finish()
+ *
+ * @return void
+ */
+void boot_clock_start(void)
+{
+	const osc_config_t *osc = &oscConfig_BOARD_BootClockRUN;
+	const mcg_pll_config_t *pll = &mcgConfig_BOARD_BootClockRUN.pll0Config;
+
+	OSC_SetCapLoad(OSC0, osc->capLoad);
+	OSC_SetExtRefClkConfig(OSC0, &osc->oscerConfig);
+	MCG->C2 = (MCG->C2 & ~OSC_MODE_MASK) | MCG_C2_RANGE0(OSC_RANGE_HIGH) | (uint8_t)osc->workMode;
+
+	MCG->C5 = MCG_C5_PRDIV0(pll->prdiv);
+	MCG->C6 = (MCG->C6 & ~MCG_C6_VDIV0_MASK) | MCG_C6_VDIV0(pll->vdiv);
+	MCG->C5 |= (uint8_t)kMCG_PllEnableIndependent | pll->enableMode;
+}
+
+/*
+ * @brief Moves the MCG from FEI through FBE and PBE to PEE once the PLL is locked, then the
+ * 		  TPM modules to MCGPLLCLK/2 and the internal reference back to the RUN profile
+ *
+ * The waits left are the rest of the crystal start up and of the PLL lock, the SysTick
+ * counts through the switch are converted at the slowest clock of it, an upper bound. The
+ * flash ends here with the red on: the console, inputrec_init() and the MTB export up to
+ * boot_handover() do not call boot_elapsed_us() and would hold the red in its off half
+ *
+ * @return void
+ */
+void boot_clock_finish(void)
+{
+	const mcg_config_t *mcg = &mcgConfig_BOARD_BootClockRUN;
+
+	CLOCK_SetXtal0Freq(oscConfig_BOARD_BootClockRUN.freq);
+	switch_begin();
+	CLOCK_SetSimSafeDivs();
+	MCG->C1 = (MCG->C1 & ~(MCG_C1_CLKS_MASK | MCG_C1_FRDIV_MASK | MCG_C1_IREFS_MASK)) |
+			  MCG_C1_CLKS(kMCG_ClkOutSrcExternal) | MCG_C1_FRDIV(mcg->frdiv);
+	while ((MCG->S & (MCG_S_IREFST_MASK | MCG_S_CLKST_MASK)) !=
+		   (MCG_S_IREFST(kMCG_FllSrcExternal) | MCG_S_CLKST(CLKST_EXTERNAL)))
+	{
+		boot_elapsed_us();		/*Keeps the red flashing*/
+	}
+	while (!(MCG->S & MCG_S_LOCK0_MASK))
+	{
+		boot_elapsed_us();
+	}
+	MCG->C6 |= MCG_C6_PLLS_MASK;
+	while (!(MCG->S & MCG_S_PLLST_MASK))
+	{
+	}
+	CLOCK_SetPeeMode();
+	CLOCK_SetSimConfig(&simConfig_BOARD_BootClockRUN);
+	SystemCoreClock = BOARD_BOOTCLOCKRUN_CORE_CLOCK;
+	switch_end();
+
+	/*The TPM leaves MCGIRCLK before it goes back to the 32 kHz slow reference*/
+	timebase_configure(SystemCoreClock, TIMEBASE_TPM_PLLFLL, CLOCK_GetFreq(kCLOCK_PllFllSelClk));
+	retime_pwm();
+	CLOCK_SetInternalRefClkConfig(mcg->irclkEnableMode, mcg->ircs, mcg->fcrdiv);
+	boot_mark(BOOT_MARK_CLOCKS);
+	boot.flashing = false;
+	boot.lit = true;
+	show_led_colour(BOOT_RED, 0, 0);	/*Steady until the first frame*/
+}
+
+/*
+ * @brief Sets up the RUN profile with BOARD_InitBootClocks(), waiting for the crystal and the
+ * 		  PLL in turn, for the sequential boot
+ *
+ * @return void
+ */
+void boot_clock_sequential(void)
+{
+	switch_begin();
+	BOARD_InitBootClocks();
+	switch_end();
+	boot_mark(BOOT_MARK_CLOCKS);
+}
+
+/*
+ * @brief Hands the SysTick over to Init_SysTick(), the boot time is then counted in ticks
+ *
+ * @return void
+ */
+void boot_handover(void)
+{
+	boot_elapsed_us();
+	boot.flashing = false;		/*Of the sequential boot, the first frame of the sequence follows*/
+	boot.ticking = true;
+	boot.handoverTick = now();
+}
+
+/*
+ * @brief Prints the fault log and a crash dump of the previous run, saves the dump to flash
+ * 		  and prints the boot times, called after the first frame
+ *
+ * @return void
+ */
+void boot_deferred(void)
+{
+	if (faultLog.count != 0)
+	{
+		faultlog_report();
+	}
+	crashdump_init();
+	boot_mark(BOOT_MARK_DEFERRED);
+	boot_report();
+}
+
+/*
+ * @brief Prints the time of every step of the boot reached
+ *
+ * @return void
+ */
+void boot_report(void)
+{
+	uint8_t mark;
+
+	logfmt_printf("\r\nboot from ResetISR:");
+	for (mark = 0; mark < BOOT_MARKS; mark++)
+	{
+		if (boot.marks[mark] != 0)		/*The sequential boot has no deferred step*/
+		{
+			logfmt_printf(" %s %lu us", markNames[mark], (unsigned long)boot.marks[mark]);
+		}
+	}
+	logfmt_printf("\r\n");
+}
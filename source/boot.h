@@ -0,0 +1,130 @@
+/**
+ * @file    boot.h
+ * @brief   This header file consists of the boot sequencer: the LED shows the fail-safe red on
+ * 			the reset clock before anything else is set up, the crystal and the PLL lock while
+ * 			the rest of the board is configured and the console reports wait for the first
+ * 			frame of the sequence. The time of each step is measured from ResetISR
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 24 Multipurpose Clock Generator
+ */
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+/*Steps of the boot, in microseconds from ResetISR*/
+#define BOOT_MARK_FIRST_LIGHT		(0) /*The LED shows red*/
+#define BOOT_MARK_CLOCKS			(1) /*48 MHz RUN profile, PLL locked*/
+#define BOOT_MARK_FIRST_FRAME		(2) /*First pass of the sequence, the LED shows its colour*/
+#define BOOT_MARK_DEFERRED			(3) /*Console reports done*/
+#define BOOT_MARKS					(4)
+
+#define BOOT_RED					(0xFF) /*Colour of the fail-safe flash*/
+
+typedef struct
+{
+	uint32_t coreClock;				/*Hz of the core while the SysTick counts for the boot*/
+	uint32_t lastCount;				/*SysTick count at the last update of elapsedUs*/
+	uint32_t elapsedUs;				/*Up to lastCount*/
+	bool ticking;					/*The SysTick counts ticks of 62.5 msec since handoverTick*/
+	bool flashing;					/*From first light until the PLL switch or the handover*/
+	bool lit;						/*The red of the flash is on*/
+	ticktime handoverTick;
+	uint32_t marks[BOOT_MARKS];		/*0 for a step not reached*/
+} boot_t;
+
+extern boot_t boot;
+
+/*
+ * @brief Starts the SysTick on the core clock as the boot timer, called first in ResetISR
+ *
+ * Writes no RAM, the data and bss sections are not initialized yet
+ *
+ * @return void
+ */
+void boot_timer_start(void);
+
+/*
+ * @brief Takes the reset clock for the boot timer, called first in main()
+ *
+ * @return void
+ */
+void boot_init(void);
+
+/*
+ * @brief Time since ResetISR
+ *
+ * @return microseconds
+ */
+uint32_t boot_elapsed_us(void);
+
+/*
+ * @brief Notes the time of a step of the boot, the first time only
+ *
+ * @param BOOT_MARK_
+ * @return void
+ */
+void boot_mark(uint8_t mark);
+
+/*
+ * @brief Starts the fail-safe red flash on the reset clock: the TPM modules run from the 4 MHz
+ * 		  fast internal reference, which needs no crystal or PLL
+ *
+ * @return void
+ */
+void boot_first_light(void);
+
+/*
+ * @brief Starts the crystal and the PLL of the RUN profile without waiting for them, the
+ * 		  core stays on the FLL. Called in ResetISR, writes no RAM
+ *
+ * @return void
+ */
+void boot_clock_start(void);
+
+/*
+ * @brief Moves the MCG from FEI through FBE and PBE to PEE once the PLL is locked, then the
+ * 		  TPM modules to MCGPLLCLK/2 and the internal reference back to the RUN profile
+ *
+ * @return void
+ */
+void boot_clock_finish(void);
+
+/*
+ * @brief Sets up the RUN profile with BOARD_InitBootClocks(), waiting for the crystal and the
+ * 		  PLL in turn, for the sequential boot
+ *
+ * @return void
+ */
+void boot_clock_sequential(void);
+
+/*
+ * @brief Hands the SysTick over to Init_SysTick(), the boot time is then counted in ticks
+ *
+ * @return void
+ */
+void boot_handover(void);
+
+/*
+ * @brief Prints the fault log and a crash dump of the previous run, saves the dump to flash
+ * 		  and prints the boot times, called after the first frame
+ *
+ * @return void
+ */
+void boot_deferred(void);
+
+/*
+ * @brief Prints the time of every step of the boot reached
+ *
+ * @return void
+ */
+void boot_report(void);
+
+#endif /* BOOT_H_ */
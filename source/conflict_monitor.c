@@ -0,0 +1,121 @@
+/**
+ * @file    conflict_monitor.c
+ * @brief   This source file consists of function definitions of the conflict monitor which
+ * 			checks every colour committed to the LED PWM and forces a flashing red fail-safe
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <stddef.h>
+#include "conflict_monitor.h"
+#include "faultlog.h"
+#include "pwm.h"
+
+#define BYTE_SHIFT			(8)
+#define BYTE_MASK			(0xFF)
+
+conflict_monitor_t conflictMonitor;
+
+/*
+ * @brief Starts checking the commits of a sequence against its allowed colours
+ *
+ * @param1 state variable of the sequence
+ * @param2 allowed colours indexed by the state
+ * @param3 number of rules
+ * @return void
+ */
+void conflict_monitor_init(const volatile uint8_t *state, const conflict_monitor_rule_t *rules, uint8_t ruleCount)
+{
+	conflictMonitor.state = state;
+	conflictMonitor.rules = rules;
+	conflictMonitor.ruleCount = ruleCount;
+	conflictMonitor.lastState = *state;
+	conflictMonitor.tripped = false;
+	conflictMonitor.commits = 0;
+	conflictMonitor.flashTicks = 0;
+}
+
+/*
+ * @brief Trips the monitor: logs the fault and hands the LED to the fail-safe
+ *
+ * @return void
+ */
+static void conflict_monitor_trip(uint8_t state, uint16_t red, uint16_t green, uint16_t blue)
+{
+	conflictMonitor.tripped = true;
+	faultlog_record(FAULT_CONFLICT, state, conflictMonitor.lastState,
+					((uint32_t)(red & BYTE_MASK) << (2 * BYTE_SHIFT)) |
+					((uint32_t)(green & BYTE_MASK) << BYTE_SHIFT) | (blue & BYTE_MASK));
+	conflictMonitor.flashTicks = 0;
+	force_led_colour(MONITOR_FLASH_RED, 0, 0);
+}
+
+/*
+ * @brief Checks a colour about to be committed to the LED PWM
+ *
+ * @param1 red value
+ * @param2 green value
+ * @param3 blue value
+ * @return true if the colour may be written
+ */
+bool conflict_monitor_commit(uint16_t red, uint16_t green, uint16_t blue)
+{
+	const conflict_monitor_rule_t *rule;
+	uint32_t colour;
+	uint8_t state;
+
+	if (conflictMonitor.tripped)
+	{
+		return false;
+	}
+	if (conflictMonitor.state == NULL)
+	{
+		return true;
+	}
+
+	state = *conflictMonitor.state;
+	if (((red | green | blue) > MONITOR_CHANNEL_MAX) || (state >= conflictMonitor.ruleCount))
+	{
+		conflict_monitor_trip(state, red, green, blue);
+		return false;
+	}
+
+	rule = &conflictMonitor.rules[state];
+	colour = MONITOR_PACK(red, green, blue);
+	if (((((colour | MONITOR_GUARD) - rule->low) & ((rule->high | MONITOR_GUARD) - colour) & MONITOR_GUARD) == MONITOR_GUARD) ||
+		(colour == rule->exactA) || (colour == rule->exactB))
+	{
+		conflictMonitor.lastState = state;
+		conflictMonitor.commits++;
+		return true;
+	}
+
+	conflict_monitor_trip(state, red, green, blue);
+	return false;
+}
+
+/*
+ * @brief Flashes the LED red once the monitor has tripped, called from the SysTick handler
+ *
+ * @return void
+ */
+void conflict_monitor_tick(void)
+{
+	if (!conflictMonitor.tripped)
+	{
+		return;
+	}
+	conflictMonitor.flashTicks++;
+	if (conflictMonitor.flashTicks == MONITOR_FLASH_ON)
+	{
+		force_led_colour(0, 0, 0);
+	}
+	else if (conflictMonitor.flashTicks >= MONITOR_FLASH_PERIOD)
+	{
+		conflictMonitor.flashTicks = 0;
+		force_led_colour(MONITOR_FLASH_RED, 0, 0);
+	}
+}
@@ -0,0 +1,107 @@
+/**
+ * @file    conflict_monitor.h
+ * @brief   This header file consists of the conflict monitor which checks every colour
+ * 			committed to the LED PWM against the colours allowed in the current state and
+ * 			forces a flashing red fail-safe on a violation
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef CONFLICT_MONITOR_H_
+#define CONFLICT_MONITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * A colour is packed with each channel in a 9 bit lane, the top bit of every lane is a guard
+ * bit. A subtraction then compares all three channels at once: the guard bit of a lane
+ * stays set only if that channel did not borrow, so a box check is two subtractions and
+ * two ANDs whatever the state
+ */
+#define MONITOR_LANE_BITS			(9)
+#define MONITOR_PACK(red, green, blue)	(((uint32_t)(red) << (2 * MONITOR_LANE_BITS)) | \
+										 ((uint32_t)(green) << MONITOR_LANE_BITS) | (uint32_t)(blue))
+#define MONITOR_GUARD				MONITOR_PACK(0x100, 0x100, 0x100)
+#define MONITOR_NO_COLOUR			(0xFFFFFFFFu) /*Never equal to a packed colour*/
+#define MONITOR_CHANNEL_MAX			(0xFF)
+
+#define MONITOR_MIN(a, b)			(((a) < (b)) ? (a) : (b))
+#define MONITOR_MAX(a, b)			(((a) > (b)) ? (a) : (b))
+
+/*Colours allowed in one state: a box of colours and up to two exact colours*/
+typedef struct
+{
+	uint32_t low;				/*Packed lowest value of every channel*/
+	uint32_t high;				/*Packed highest value of every channel*/
+	uint32_t exactA;			/*Packed colours allowed outside the box, MONITOR_NO_COLOUR if unused*/
+	uint32_t exactB;
+} conflict_monitor_rule_t;
+
+/*Any colour between two colours, for the transitions which fade from one to the other*/
+#define MONITOR_RULE_BETWEEN(r1, g1, b1, r2, g2, b2)												\
+	{ MONITOR_PACK(MONITOR_MIN(r1, r2), MONITOR_MIN(g1, g2), MONITOR_MIN(b1, b2)),					\
+	  MONITOR_PACK(MONITOR_MAX(r1, r2), MONITOR_MAX(g1, g2), MONITOR_MAX(b1, b2)),					\
+	  MONITOR_NO_COLOUR, MONITOR_NO_COLOUR }
+
+/*Only the given colours*/
+#define MONITOR_RULE_EXACT(r1, g1, b1, r2, g2, b2)													\
+	{ MONITOR_PACK(MONITOR_CHANNEL_MAX, MONITOR_CHANNEL_MAX, MONITOR_CHANNEL_MAX), 0,				\
+	  MONITOR_PACK(r1, g1, b1), MONITOR_PACK(r2, g2, b2) }
+
+/*No colour may be committed in the state*/
+#define MONITOR_RULE_NONE																			\
+	{ MONITOR_PACK(MONITOR_CHANNEL_MAX, MONITOR_CHANNEL_MAX, MONITOR_CHANNEL_MAX), 0,				\
+	  MONITOR_NO_COLOUR, MONITOR_NO_COLOUR }
+
+#define MONITOR_FLASH_PERIOD		(16) /*Fail-safe flashes red once a second*/
+#define MONITOR_FLASH_ON			(8)
+#define MONITOR_FLASH_RED			(0xFF)
+
+typedef struct
+{
+	const volatile uint8_t *state;	/*State variable of the sequence, NULL while not monitoring*/
+	const conflict_monitor_rule_t *rules; /*Allowed colours indexed by the state*/
+	uint8_t ruleCount;
+	uint8_t lastState;			/*State of the previous commit*/
+	volatile bool tripped;		/*Latched until reset, the fail-safe owns the LED*/
+	uint32_t commits;			/*Colours checked*/
+	uint32_t flashTicks;
+} conflict_monitor_t;
+
+extern conflict_monitor_t conflictMonitor;
+
+/*
+ * @brief Starts checking the commits of a sequence against its allowed colours
+ *
+ * @param1 state variable of the sequence
+ * @param2 allowed colours indexed by the state
+ * @param3 number of rules
+ * @return void
+ */
+void conflict_monitor_init(const volatile uint8_t *state, const conflict_monitor_rule_t *rules, uint8_t ruleCount);
+
+/*
+ * @brief Checks a colour about to be committed to the LED PWM
+ *
+ * On a violation the fault is logged, the monitor trips and the LED is forced red, every
+ * later commit is refused. The check is a handful of loads, compares and two subtractions
+ *
+ * @param1 red value
+ * @param2 green value
+ * @param3 blue value
+ * @return true if the colour may be written
+ */
+bool conflict_monitor_commit(uint16_t red, uint16_t green, uint16_t blue);
+
+/*
+ * @brief Flashes the LED red once the monitor has tripped, called from the SysTick handler
+ *
+ * @return void
+ */
+void conflict_monitor_tick(void);
+
+#endif /* CONFLICT_MONITOR_H_ */
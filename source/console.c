@@ -0,0 +1,87 @@
+/**
+ * @file    console.c
+ * @brief   This source file consists of the function definitions of the debug console, which
+ * 			looks up a character received on the debug UART in the table of the registered
+ * 			commands and runs its handler
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <stddef.h>
+#include "MKL25Z4.h"
+#include "console.h"
+#include "watchdog.h"
+#include "telemetry.h"
+
+typedef struct
+{
+	uint8_t command;
+	console_handler_t handler;
+} console_command_t;
+
+/*All zero, commands are registered by the inits which run before the main loop*/
+static console_command_t consoleCommands[CONSOLE_COMMANDS_MAX];
+static uint8_t consoleCommandCount;
+
+/*
+ * @brief Adds a command to the console, or changes the handler of a registered one
+ *
+ * @param1 character received on the debug UART
+ * @param2 function which runs the command
+ * @return false if the table is full
+ */
+bool console_register(uint8_t command, console_handler_t handler)
+{
+	uint8_t index;
+
+	for (index = 0; index < consoleCommandCount; index++)
+	{
+		if (consoleCommands[index].command == command)
+		{
+			consoleCommands[index].handler = handler;
+			return true;
+		}
+	}
+	if (consoleCommandCount >= CONSOLE_COMMANDS_MAX)
+	{
+		return false;
+	}
+	consoleCommands[consoleCommandCount].command = command;
+	consoleCommands[consoleCommandCount].handler = handler;
+	consoleCommandCount++;
+	return true;
+}
+
+/*
+ * @brief Runs the command of a character received on the debug UART
+ *
+ * The cost per iteration without a character is the read of the UART status
+ *
+ * @return void
+ */
+void console_poll(void)
+{
+	uint8_t command;
+	uint8_t index;
+
+	watchdog_checkin(WATCHDOG_TASK_CONSOLE);
+	if (!(UART0->S1 & UART0_S1_RDRF_MASK))
+	{
+		return;
+	}
+	command = UART0->D;
+#if defined(TELEMETRY)
+	telemetry_flush();			/*The reply goes after the frame being sent*/
+#endif
+	for (index = 0; index < consoleCommandCount; index++)
+	{
+		if (consoleCommands[index].command == command)
+		{
+			consoleCommands[index].handler();
+			return;
+		}
+	}
+}
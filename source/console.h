@@ -0,0 +1,41 @@
+/**
+ * @file    console.h
+ * @brief   This header file consists of the debug console, the table of the one character
+ * 			commands received on the debug UART which the features register into
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONSOLE_COMMANDS_MAX		(12) /*Commands of all the features built together fit*/
+
+/*Runs a command in the main loop, it may print and block*/
+typedef void (*console_handler_t)(void);
+
+/*
+ * @brief Adds a command to the console, or changes the handler of a registered one, so that
+ * an init run again after a simulated reset registers it once
+ *
+ * @param1 character received on the debug UART
+ * @param2 function which runs the command
+ * @return false if the table is full
+ */
+bool console_register(uint8_t command, console_handler_t handler);
+
+/*
+ * @brief Runs the command of a character received on the debug UART, other characters are
+ * 		  ignored, called every main loop iteration
+ *
+ * @return void
+ */
+void console_poll(void);
+
+#endif /* CONSOLE_H_ */
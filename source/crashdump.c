@@ -0,0 +1,213 @@
+/**
+ * @file    crashdump.c
+ * @brief   This source file consists of function definitions of the crash dump captured by
+ * 			the HardFault handler, reported and saved to flash on the next boot
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) ARMv6-M Architecture Reference Manual, B1.5.6 Exception entry behavior
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "MKL25Z4.h"
+#include "fsl_flash.h"
+#include "crashdump.h"
+#include "faultlog.h"
+#include "statemachine.h"
+#include "mtb.h"
+#include "console.h"
+
+#define FRAME_ALIGN_BIT			(1u << 9) /*xPSR bit 9, the core added a word to align the frame*/
+#define FRAME_ALIGN_BYTES		(4)
+#define FNV_OFFSET				(2166136261u)
+#define FNV_PRIME				(16777619u)
+
+extern const uint32_t _image_start[];	/*The running image, from the linker script*/
+extern const uint32_t _image_end[];
+
+/*Placed in the .noinit section of the linker script, which the startup code does not clear*/
+crashdump_t crashDump FAULTLOG_SECTION;
+
+/*Flash sector holding the dump of the last crash, starts erased. In the FLASH_RECORDS memory
+ *region of the MCU settings, outside the image, so that a firmware update keeps it and its base
+ *CRC does not change with it. Read through a volatile pointer since the compiler would
+ *otherwise use the initial value. Being volatile it is writable data to the assembler, so it
+ *takes the .text_<region> input section of the managed script, .rodata.$<region> would warn*/
+static const volatile uint8_t crashDumpFlash[CRASHDUMP_FLASH_SIZE]
+	__attribute__((section(".text_FLASH_RECORDS.crashDumpFlash"), aligned(CRASHDUMP_FLASH_SIZE), used)) =
+	{ [0 ... CRASHDUMP_FLASH_SIZE - 1] = 0xFF };
+
+_Static_assert((sizeof(crashdump_t) % sizeof(uint32_t)) == 0, "flash is programmed in words");
+_Static_assert(sizeof(crashdump_t) <= CRASHDUMP_FLASH_SIZE, "crash dump does not fit its flash sector");
+
+/*
+ * @brief Identifies the running image by an FNV-1a of its words. The log records of a dump
+ * 		  are the addresses of their format strings, which only hold in the image that wrote
+ * 		  them. About 60k cycles for 40 KB, so it runs at a fault and when a dump is printed
+ *
+ * @return hash of the image
+ */
+static uint32_t crashdump_image_id(void)
+{
+	const uint32_t *word;
+	uint32_t hash = FNV_OFFSET;
+
+	for (word = _image_start; word < _image_end; word++)
+	{
+		hash = (hash ^ *word) * FNV_PRIME;
+	}
+	return hash;
+}
+
+/*
+ * @brief Saves the crash context and resets the board, called by HardFault_Handler
+ *
+ * Runs on whatever stack faulted, so it only copies words and calls nothing that prints
+ *
+ * @param1 exception frame pushed by the core
+ * @param2 EXC_RETURN value of LR on entry to the handler
+ * @return does not return
+ */
+void crashdump_capture(const crashdump_frame_t *frame, uint32_t excReturn)
+{
+	uint32_t index;
+
+	mtb_trace_freeze();		/*The branches up to the fault, exported on the next boot*/
+	crashDump.frame = *frame;
+	crashDump.excReturn = excReturn;
+	crashDump.sp = (uint32_t)frame + sizeof(crashdump_frame_t);
+	if (frame->xpsr & FRAME_ALIGN_BIT)
+	{
+		crashDump.sp += FRAME_ALIGN_BYTES;
+	}
+	crashDump.msp = __get_MSP();
+	crashDump.psp = __get_PSP();
+	crashDump.tick = now();
+	crashDump.state = statemachine_state();
+	crashDump.logCount = logfmtHistoryCount;
+	for (index = 0; index < LOGFMT_HISTORY; index++)
+	{
+		crashDump.log[index] = logfmtHistory[(logfmtHistoryCount + index) % LOGFMT_HISTORY];
+	}
+	crashDump.imageId = crashdump_image_id();
+	crashDump.magic = CRASHDUMP_MAGIC;
+	faultlog_record(FAULT_HARDFAULT, crashDump.state, crashDump.state, frame->pc);
+
+	NVIC_SystemReset();		/*Back to a known state in microseconds instead of hanging*/
+	while (1)
+	{
+	}
+}
+
+/*
+ * @brief Prints a dump to the console. The log records are printed as their format strings
+ * 		  only if the dump was written by the running image, after an update or a rebuild
+ * 		  their addresses would point at other strings or code
+ *
+ * @param dump to be printed
+ * @return void
+ */
+static void crashdump_report(const crashdump_t *dump)
+{
+	uint32_t first = (dump->logCount > LOGFMT_HISTORY) ? 0 : (LOGFMT_HISTORY - dump->logCount);
+	bool sameImage = (dump->imageId == crashdump_image_id());
+	uint32_t index;
+
+	logfmt_printf("\r\ncrash at tick %lu in state %u, pc 0x%08lx lr 0x%08lx xpsr 0x%08lx",
+				  (unsigned long)dump->tick, dump->state, (unsigned long)dump->frame.pc,
+				  (unsigned long)dump->frame.lr, (unsigned long)dump->frame.xpsr);
+	logfmt_printf("\r\nr0 0x%08lx r1 0x%08lx r2 0x%08lx r3 0x%08lx r12 0x%08lx",
+				  (unsigned long)dump->frame.r0, (unsigned long)dump->frame.r1, (unsigned long)dump->frame.r2,
+				  (unsigned long)dump->frame.r3, (unsigned long)dump->frame.r12);
+	logfmt_printf("\r\nexc_return 0x%08lx sp 0x%08lx on %s, msp 0x%08lx psp 0x%08lx",
+				  (unsigned long)dump->excReturn, (unsigned long)dump->sp,
+				  (dump->excReturn & CRASHDUMP_EXC_RETURN_PSP) ? "psp" : "msp",
+				  (unsigned long)dump->msp, (unsigned long)dump->psp);
+	logfmt_printf("\r\nimage 0x%08lx%s", (unsigned long)dump->imageId,
+				  sameImage ? "" : ", not the running image, log records as addresses");
+	for (index = first; index < LOGFMT_HISTORY; index++)
+	{
+#if defined(LOG_TOKENIZED)
+		logfmt_printf("\r\nlog token 0x%04lx", (unsigned long)dump->log[index]);
+#else
+		if (sameImage && (dump->log[index] < (uintptr_t)_image_end))
+		{
+			logfmt_printf("\r\nlog \"%s\"", (const char *)dump->log[index]);
+		}
+		else
+		{
+			logfmt_printf("\r\nlog 0x%08lx", (unsigned long)dump->log[index]);
+		}
+#endif
+	}
+	logfmt_printf("\r\n");
+}
+
+/*
+ * @brief Writes the dump to its flash sector
+ *
+ * @return true if the sector was erased and programmed
+ */
+static bool crashdump_save(void)
+{
+	flash_config_t flash;
+	uint32_t address = (uint32_t)crashDumpFlash;
+	uint32_t masking_state = __get_PRIMASK();
+	status_t status;
+
+	memset(&flash, 0, sizeof(flash));
+	if (FLASH_Init(&flash) != kStatus_FLASH_Success)
+	{
+		return false;
+	}
+
+	__disable_irq();		/*Nothing may run from flash while it is being erased*/
+	status = FLASH_Erase(&flash, address, CRASHDUMP_FLASH_SIZE, kFLASH_ApiEraseKey);
+	if (status == kStatus_FLASH_Success)
+	{
+		status = FLASH_Program(&flash, address, (uint32_t *)&crashDump, sizeof(crashDump));
+	}
+	__set_PRIMASK(masking_state);
+	return (status == kStatus_FLASH_Success);
+}
+
+/*
+ * @brief Reports a dump left by the previous run and saves it to flash
+ *
+ * @return void
+ */
+void crashdump_init(void)
+{
+	console_register(CRASHDUMP_REPORT_COMMAND, crashdump_report_saved);
+	if (crashDump.magic != CRASHDUMP_MAGIC)
+	{
+		return;
+	}
+	crashdump_report(&crashDump);
+	if (!crashdump_save())
+	{
+		logfmt_printf("\r\ncrash dump not saved to flash\r\n");
+	}
+	crashDump.magic = 0;		/*Reported once, the flash copy is kept until the next crash*/
+}
+
+/*
+ * @brief Prints the dump saved in flash to the console
+ *
+ * @return void
+ */
+void crashdump_report_saved(void)
+{
+	crashdump_t saved;
+
+	memcpy(&saved, (const void *)crashDumpFlash, sizeof(saved));
+	if (saved.magic != CRASHDUMP_MAGIC)		/*Erased, no crash yet*/
+	{
+		logfmt_printf("\r\nno crash dump saved\r\n");
+		return;
+	}
+	crashdump_report(&saved);
+}
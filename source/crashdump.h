@@ -0,0 +1,84 @@
+/**
+ * @file    crashdump.h
+ * @brief   This header file consists of the crash dump captured by the HardFault handler into
+ * 			RAM that is not cleared by a reset, reported and saved to flash on the next boot
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) ARMv6-M Architecture Reference Manual, B1.5.6 Exception entry behavior
+ */
+
+#ifndef CRASHDUMP_H_
+#define CRASHDUMP_H_
+
+#include <stdint.h>
+#include "logfmt.h"
+#include "timer.h"
+
+#define CRASHDUMP_MAGIC				(0xC4A5D00Eu) /*Changed with the layout, an older dump reads as none*/
+#define CRASHDUMP_REPORT_COMMAND	('d') /*Character received on the debug UART which prints the saved dump*/
+#define CRASHDUMP_FLASH_SIZE		(1024) /*One flash sector holds the saved dump*/
+
+/*EXC_RETURN bit 2, the exception frame was pushed on the process stack*/
+#define CRASHDUMP_EXC_RETURN_PSP	(0x4u)
+
+/*Registers pushed by the core on exception entry, in stack order*/
+typedef struct
+{
+	uint32_t r0;
+	uint32_t r1;
+	uint32_t r2;
+	uint32_t r3;
+	uint32_t r12;
+	uint32_t lr;
+	uint32_t pc;				/*Instruction which faulted*/
+	uint32_t xpsr;
+} crashdump_frame_t;
+
+typedef struct
+{
+	uint32_t magic;				/*CRASHDUMP_MAGIC while the dump has not been saved*/
+	crashdump_frame_t frame;
+	uint32_t excReturn;			/*LR on entry to the handler*/
+	uint32_t sp;				/*Stack pointer before the frame was pushed*/
+	uint32_t msp;
+	uint32_t psp;
+	ticktime tick;				/*now() at the fault*/
+	uint8_t state;				/*State machine state at the fault*/
+	uint8_t reserved[3];
+	uint32_t logCount;			/*Log records written before the fault*/
+	uint32_t imageId;			/*Hash of the image which faulted, the log records are its addresses*/
+	uintptr_t log[LOGFMT_HISTORY]; /*Most recent log records, oldest first*/
+} crashdump_t;
+
+extern crashdump_t crashDump;
+
+/*
+ * @brief Saves the crash context and resets the board, called by HardFault_Handler
+ *
+ * @param1 exception frame pushed by the core
+ * @param2 EXC_RETURN value of LR on entry to the handler
+ * @return does not return
+ */
+void crashdump_capture(const crashdump_frame_t *frame, uint32_t excReturn) __attribute__((noreturn));
+
+/*
+ * @brief Reports a dump left by the previous run and saves it to flash
+ *
+ * Called once at startup after faultlog_init() and before the interrupts are enabled, the
+ * flash erase and program take about 25 msec
+ *
+ * @return void
+ */
+void crashdump_init(void);
+
+/*
+ * @brief Prints the dump saved in flash to the console
+ *
+ * @return void
+ */
+void crashdump_report_saved(void);
+
+#endif /* CRASHDUMP_H_ */
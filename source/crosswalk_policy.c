@@ -0,0 +1,152 @@
+/**
+ * @file    crosswalk_policy.c
+ * @brief   This source file consists of function definitions of the crosswalk policy engine
+ * 			which latches crosswalk requests and decides when the pedestrian phase may start
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "crosswalk_policy.h"
+#include "statemachine.h"
+
+/*
+ * @brief Green for the vehicles, including the transitions into GO
+ *
+ * @param state ID
+ * @return true for a green state
+ */
+static bool is_green(uint8_t state)
+{
+	return (state == TRANSITION_TO_GO) || (state == GO) || (state == TRANSITION_FROM_CROSSWALK);
+}
+
+/*
+ * @brief Initializes the policy with the given limits and no pending request
+ *
+ * @param1 policy instance
+ * @param2 policy limits, copied
+ * @return void
+ */
+void crosswalk_policy_init(crosswalk_policy_t *policy, const crosswalk_policy_config_t *config)
+{
+	memset(policy, 0, sizeof(*policy));
+	policy->config = *config;
+	policy->state = START;
+	policy->stats.shortestGreenTicks = UINT32_MAX;
+}
+
+/*
+ * @brief Longest press to walk time of a policy, the maximum wait has to be at least this
+ *
+ * @param1 policy limits
+ * @param2 ticks of the walk, CROSSWALK
+ * @param3 ticks of TRANSITION_FROM_CROSSWALK
+ * @return ticks
+ */
+uint32_t crosswalk_policy_wait_bound(const crosswalk_policy_config_t *config, uint32_t walkTicks, uint32_t exitTicks)
+{
+	return walkTicks + exitTicks + config->minGreenTicks + config->leadTicks;
+}
+
+/*
+ * @brief Records a crosswalk press
+ *
+ * @param1 policy instance
+ * @param2 current tick
+ * @param3 current state of the state machine
+ * @return true if the press latched a new request
+ */
+bool crosswalk_policy_press(crosswalk_policy_t *policy, ticktime now, uint8_t state)
+{
+	policy->stats.presses++;
+
+	if ((state == CROSSWALK) && ((now - policy->walkSince) < policy->config.lateJoinTicks))
+	{
+		policy->stats.merged++;		/*Still time to cross with the running phase*/
+		policy->stats.served++;
+		return false;
+	}
+	if ((state == CROSSWALK) && !policy->config.latchDuringWalk)
+	{
+		policy->stats.discarded++;
+		return false;
+	}
+
+	policy->batchPresses++;
+	policy->batchTickSum += now;
+	if (policy->pending || (state == TRANSITION_TO_CROSSWALK))
+	{
+		policy->stats.merged++;		/*Served by the phase already requested*/
+		return false;
+	}
+	policy->pending = true;
+	policy->requestTick = now;
+	policy->stats.requests++;
+	return true;
+}
+
+/*
+ * @brief Decides whether the pending request may start the pedestrian phase now
+ *
+ * @param1 policy instance
+ * @param2 current tick
+ * @param3 current state of the state machine, called once per tick
+ * @return true to change to TRANSITION_TO_CROSSWALK
+ */
+bool crosswalk_policy_should_start(crosswalk_policy_t *policy, ticktime now, uint8_t state)
+{
+	if (is_green(state) && !is_green(policy->state))
+	{
+		policy->greenSince = now;
+	}
+	policy->state = state;
+
+	if (!policy->pending || (state == TRANSITION_TO_CROSSWALK) || (state == CROSSWALK))
+	{
+		return false;
+	}
+	if (!is_green(state))
+	{
+		return true;
+	}
+	if ((now - policy->greenSince) < policy->config.minGreenTicks)
+	{
+		return false;
+	}
+	if ((now - policy->greenSince) < policy->stats.shortestGreenTicks)
+	{
+		policy->stats.shortestGreenTicks = now - policy->greenSince;
+	}
+	return true;
+}
+
+/*
+ * @brief Closes the pending request when the CROSSWALK state is entered
+ *
+ * @param1 policy instance
+ * @param2 current tick
+ * @return void
+ */
+void crosswalk_policy_served(crosswalk_policy_t *policy, ticktime now)
+{
+	policy->walkSince = now;
+	policy->stats.phases++;
+	if (policy->batchPresses != 0)
+	{
+		uint32_t longestWait = now - policy->requestTick; /*The first press of the batch waited longest*/
+
+		policy->stats.served += policy->batchPresses;
+		policy->stats.totalWaitTicks += (uint64_t)now * policy->batchPresses - policy->batchTickSum;
+		if (longestWait > policy->stats.maxWaitTicks)
+		{
+			policy->stats.maxWaitTicks = longestWait;
+		}
+	}
+	policy->pending = false;
+	policy->batchPresses = 0;
+	policy->batchTickSum = 0;
+}
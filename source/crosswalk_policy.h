@@ -0,0 +1,114 @@
+/**
+ * @file    crosswalk_policy.h
+ * @brief   This header file consists of the crosswalk policy engine which latches crosswalk
+ * 			requests and decides when the pedestrian phase may start
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef CROSSWALK_POLICY_H_
+#define CROSSWALK_POLICY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+/*Policy limits in ticks of 62.5 msec*/
+typedef struct
+{
+	uint32_t minGreenTicks;		/*Green time no request cuts short*/
+	uint32_t maxWaitTicks;		/*Longest press to walk time, see crosswalk_policy_wait_bound()*/
+	uint32_t leadTicks;			/*Start of the pedestrian phase to the walk, TRANSITION_TO_CROSSWALK*/
+	uint32_t lateJoinTicks;		/*Presses this early in the walk are served by the running phase*/
+	bool latchDuringWalk;		/*Later presses in the walk are latched for the next phase, else discarded*/
+} crosswalk_policy_config_t;
+
+/*Pedestrian service statistics, waits are in ticks*/
+typedef struct
+{
+	uint32_t presses;			/*Every press seen*/
+	uint32_t requests;			/*Presses which latched a new request*/
+	uint32_t merged;			/*Presses batched into a pending request or the running phase*/
+	uint32_t discarded;			/*Presses during the walk with latchDuringWalk false*/
+	uint32_t served;			/*Presses whose pedestrian phase has started*/
+	uint32_t phases;			/*Pedestrian phases started*/
+	uint64_t totalWaitTicks;	/*Sum over the served presses of press to walk time*/
+	uint32_t maxWaitTicks;
+	uint32_t shortestGreenTicks;	/*Of the greens ended by a pedestrian phase, UINT32_MAX for none*/
+} crosswalk_policy_stats_t;
+
+typedef struct
+{
+	crosswalk_policy_config_t config;
+	crosswalk_policy_stats_t stats;
+	bool pending;				/*A request is latched*/
+	uint8_t state;				/*Last state seen by crosswalk_policy_should_start()*/
+	ticktime requestTick;		/*Press which latched the pending request*/
+	ticktime greenSince;		/*Start of the current green, including its transition*/
+	ticktime walkSince;			/*Start of the running pedestrian phase*/
+	uint32_t batchPresses;		/*Presses in the pending request*/
+	uint64_t batchTickSum;		/*Sum of their press ticks*/
+} crosswalk_policy_t;
+
+/*
+ * @brief Initializes the policy with the given limits and no pending request
+ *
+ * @param1 policy instance
+ * @param2 policy limits, copied
+ * @return void
+ */
+void crosswalk_policy_init(crosswalk_policy_t *policy, const crosswalk_policy_config_t *config);
+
+/*
+ * @brief Records a crosswalk press
+ *
+ * Presses while a request is pending, during TRANSITION_TO_CROSSWALK or early in the walk
+ * are batched into that pedestrian phase
+ *
+ * @param1 policy instance
+ * @param2 current tick
+ * @param3 current state of the state machine
+ * @return true if the press latched a new request
+ */
+bool crosswalk_policy_press(crosswalk_policy_t *policy, ticktime now, uint8_t state);
+
+/*
+ * @brief Longest press to walk time of a policy, the maximum wait has to be at least this
+ *
+ * A press latched at the start of a walk waits out the walk, the transition out of it, the
+ * minimum green and the transition into the next walk
+ *
+ * @param1 policy limits
+ * @param2 ticks of the walk, CROSSWALK
+ * @param3 ticks of TRANSITION_FROM_CROSSWALK
+ * @return ticks
+ */
+uint32_t crosswalk_policy_wait_bound(const crosswalk_policy_config_t *config, uint32_t walkTicks, uint32_t exitTicks);
+
+/*
+ * @brief Decides whether the pending request may start the pedestrian phase now
+ *
+ * Outside green the request is served at once. During green it waits for the minimum
+ * green, which nothing cuts short. The maximum wait is not a trigger: a configuration
+ * whose maxWaitTicks covers crosswalk_policy_wait_bound() keeps every press within it
+ *
+ * @param1 policy instance
+ * @param2 current tick
+ * @param3 current state of the state machine, called once per tick
+ * @return true to change to TRANSITION_TO_CROSSWALK
+ */
+bool crosswalk_policy_should_start(crosswalk_policy_t *policy, ticktime now, uint8_t state);
+
+/*
+ * @brief Closes the pending request when the CROSSWALK state is entered
+ *
+ * @param1 policy instance
+ * @param2 current tick
+ * @return void
+ */
+void crosswalk_policy_served(crosswalk_policy_t *policy, ticktime now);
+
+#endif /* CROSSWALK_POLICY_H_ */
@@ -0,0 +1,307 @@
+/**
+ * @file    cycle_bench.c
+ * @brief   This source file consists of the cycle count benchmark image which times the control
+ * 			hot paths on the board with a free running TPM counter
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, Chapter 31 Timer/PWM Module (TPM)
+ */
+
+/*Allow the benchmark image to be built by setting a define (via command line)*/
+#if defined(CYCLE_BENCHMARK)
+
+#include <stdio.h>
+#include <stdint.h>
+#include "MKL25Z4.h"
+#include "cycle_bench.h"
+#include "statemachine.h"
+#include "conflict_monitor.h"
+#include "timer.h"
+#include "pwm.h"
+#include "telemetry.h"
+
+#define FADE_STEPS					(16) /*fadeStep of a transition runs 0 to 15*/
+#define TPM_COUNTER_MASK			(0xFFFFu)
+#define TPM_COUNTER_BITS			(16)
+
+
+typedef void (*cycle_bench_fn_t)(uint32_t index);
+
+typedef struct
+{
+	const char *name;
+	cycle_bench_fn_t run;
+	void (*setup)(void);		/*Called once before the routine is timed*/
+} cycle_bench_t;
+
+volatile uint32_t cycleBenchSink;	/*Keeps results of the reads alive*/
+static uint8_t cycleBenchState;
+static sm_ctx_t *cycleBenchContext;	/*Instance of the firmware, its fade step is set by the fade benchmarks*/
+/*Every colour is allowed, so commits take the full check and never trip the monitor*/
+static const conflict_monitor_rule_t cycleBenchRules[] = { MONITOR_RULE_BETWEEN(0, 0, 0, 255, 255, 255) };
+
+#if defined(__arm__)
+static volatile uint32_t cycleOverflows;	/*TPM1 wraps, the upper bits of read_cycles()*/
+
+/*
+ * @brief Counts a wrap of TPM1, every 65536 core cycles, 1.37 msec
+ *
+ * @return void
+ */
+void TPM1_IRQHandler(void)
+{
+	TPM1->SC |= TPM_SC_TOF_MASK;	/*Write 1 to clear*/
+	cycleOverflows++;
+}
+
+/*
+ * @brief Starts TPM1 counting core clocks up to its full 16 bits with the overflow interrupt,
+ * 		  TPM0 and TPM2 drive the led
+ *
+ * @return void
+ */
+static void cycle_counter_init(void)
+{
+	SIM->SCGC6 |= SIM_SCGC6_TPM1_MASK;
+	SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK); /*48 MHz, same as the core*/
+	TPM1->SC = 0;
+	TPM1->MOD = TPM_COUNTER_MASK;
+	TPM1->CNT = 0;
+	cycleOverflows = 0;
+	TPM1->SC = TPM_SC_TOF_MASK | TPM_SC_TOIE_MASK | TPM_SC_CMOD(1) | TPM_SC_PS(0);
+	NVIC_EnableIRQ(TPM1_IRQn);
+}
+
+/*
+ * @brief Reads the free running counter with the wraps counted above its 16 bits
+ *
+ * A wrap whose interrupt has not run yet is seen in TOF, the counter is then read again
+ * since it may have been read before the wrap
+ *
+ * @return core cycles, wrapping at 32 bits
+ */
+static inline uint32_t read_cycles(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t high;
+	uint32_t low;
+
+	__disable_irq();
+	high = cycleOverflows;
+	low = TPM1->CNT;
+	if (TPM1->SC & TPM_SC_TOF_MASK)
+	{
+		low = TPM1->CNT;
+		high++;
+	}
+	__set_PRIMASK(primask);
+	return (high << TPM_COUNTER_BITS) | low;
+}
+
+/*
+ * @brief Cycles between two read_cycles() values
+ *
+ * @return elapsed core cycles
+ */
+static inline uint32_t elapsed_cycles(uint32_t start, uint32_t end)
+{
+	return end - start;
+}
+#else
+#include <time.h>
+
+/*The mocked TPM1 does not count, the host build only checks that the image runs*/
+static void cycle_counter_init(void)
+{
+}
+
+static inline uint32_t read_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return (uint32_t)__builtin_ia32_rdtsc(); /*x86intrin.h clashes with __I of MKL25Z4.h*/
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)now.tv_nsec; /*Nanoseconds where no cycle counter is available*/
+#endif
+}
+
+static inline uint32_t elapsed_cycles(uint32_t start, uint32_t end)
+{
+	return end - start;
+}
+#endif
+
+/*
+ * @brief Empty call, its cost is subtracted from every routine
+ *
+ * @return void
+ */
+static void bench_empty(uint32_t index)
+{
+	(void)index;
+}
+
+/*
+ * @brief set_led_colour() of one transition at the fade step given by the call index
+ *
+ * @return void
+ */
+static void bench_fade(uint8_t previousState, uint32_t index)
+{
+	cycleBenchContext->fadeStep = (int8_t)(index & (FADE_STEPS - 1));
+	set_led_colour(previousState);
+}
+
+static void bench_set_led_stop(uint32_t index) { bench_fade(START, index); }
+static void bench_set_led_to_go(uint32_t index) { bench_fade(STOP, index); }
+static void bench_set_led_to_warning(uint32_t index) { bench_fade(GO, index); }
+static void bench_set_led_to_stop(uint32_t index) { bench_fade(WARNING, index); }
+static void bench_set_led_to_crosswalk(uint32_t index) { bench_fade(TRANSITION_TO_CROSSWALK, index); }
+static void bench_set_led_from_crosswalk(uint32_t index) { bench_fade(CROSSWALK, index); }
+
+static void bench_update_led(uint32_t index)
+{
+	update_led_colour(index & 0xFF, (index >> 1) & 0xFF, (index >> 2) & 0xFF);
+}
+
+static void bench_conflict_commit(uint32_t index)
+{
+	cycleBenchSink += conflict_monitor_commit(index & 0xFF, (index >> 1) & 0xFF, (index >> 2) & 0xFF);
+}
+
+static void bench_check_button(uint32_t index)
+{
+	(void)index;
+	cycleBenchSink += check_button_pressed();
+}
+
+static void bench_timer_read(uint32_t index)
+{
+	(void)index;
+	cycleBenchSink += now() + get_timer() + current_time();
+}
+
+static void bench_statemachine_poll(uint32_t index)
+{
+	(void)index;
+	statemachine_poll();
+}
+
+/*
+ * @brief Commits are checked against rules which allow every colour
+ *
+ * @return void
+ */
+static void setup_bench_rules(void)
+{
+	conflict_monitor_init(&cycleBenchState, cycleBenchRules, 1);
+	cycleBenchContext = statemachine_context();
+}
+
+/*A frame of a busy second: two state changes and counters past 8 bits*/
+static const telemetry_sample_t cycleBenchSample = {
+	.tick = 12345, .state = GO, .timeInState = 40, .presses = 300, .ignored = 12, .actuations = 4000,
+	.tsiScans = 20000, .loopIterations = 900, .tsiScanCycles = 25000
+};
+static const uint8_t cycleBenchEvents[2][2] = { { 0x2A, TRANSITION_TO_GO }, { 0x30, GO } };
+
+static void bench_telemetry_frame(uint32_t index)
+{
+	uint8_t frame[TELEMETRY_FRAME_MAX];
+
+	cycleBenchSink += telemetry_encode(&cycleBenchSample, (uint8_t)index, cycleBenchEvents, 2, frame);
+}
+
+static const cycle_bench_t cycleBenches[] = {
+	{ "empty call", bench_empty, setup_bench_rules },
+	{ "set_led_colour/stop", bench_set_led_stop, setup_bench_rules },
+	{ "set_led_colour/to_go", bench_set_led_to_go, setup_bench_rules },
+	{ "set_led_colour/to_warning", bench_set_led_to_warning, setup_bench_rules },
+	{ "set_led_colour/to_stop", bench_set_led_to_stop, setup_bench_rules },
+	{ "set_led_colour/to_crosswalk", bench_set_led_to_crosswalk, setup_bench_rules },
+	{ "set_led_colour/from_crosswalk", bench_set_led_from_crosswalk, setup_bench_rules },
+	{ "update_led_colour", bench_update_led, setup_bench_rules },
+	{ "conflict_monitor_commit", bench_conflict_commit, setup_bench_rules },
+	{ "check_button_pressed", bench_check_button, setup_bench_rules },
+	{ "timer_read", bench_timer_read, setup_bench_rules },
+	{ "statemachine_poll", bench_statemachine_poll, statemachine_init }, /*From STOP with its own rules*/
+	{ "telemetry_frame", bench_telemetry_frame, setup_bench_rules },
+};
+
+/*
+ * @brief Times every call of one routine
+ *
+ * @param1 routine
+ * @param2 minimum cycles of one call
+ * @param3 calls of more than 65535 cycles, past a wrap of the 16 bit TPM1, they include the
+ * 		   cost of its overflow interrupt
+ * @return total cycles of CYCLE_BENCH_ITERATIONS calls
+ */
+static uint64_t time_routine(const cycle_bench_t *bench, uint32_t *minimum, uint32_t *wrapped)
+{
+	uint64_t total = 0;
+	uint32_t index;
+
+	bench->setup();
+	*minimum = UINT32_MAX;
+	*wrapped = 0;
+	for (index = 0; index < CYCLE_BENCH_ITERATIONS; index++)
+	{
+		uint32_t start = read_cycles();
+		uint32_t cycles;
+
+		bench->run(index);
+		cycles = elapsed_cycles(start, read_cycles());
+		total += cycles;
+		if (cycles < *minimum)
+		{
+			*minimum = cycles;
+		}
+		if (cycles > TPM_COUNTER_MASK)
+		{
+			(*wrapped)++;
+		}
+	}
+	return total;
+}
+
+/*
+ * @brief Times every hot routine CYCLE_BENCH_ITERATIONS times and prints cycles per call
+ *
+ * The minimum of an empty call is subtracted from the minimum and the mean alike, so the
+ * mean is never below the minimum. A routine with calls past a TPM1 wrap is flagged
+ *
+ * @return void
+ */
+void cycle_benchmark(void)
+{
+	uint32_t overhead;
+	uint32_t wrapped;
+	uint32_t index;
+
+	cycle_counter_init();
+	(void)time_routine(&cycleBenches[0], &overhead, &wrapped);
+
+	printf("\nroutine                          min cycles  mean cycles  (%d calls, less %lu of an empty call)",
+			CYCLE_BENCH_ITERATIONS, (unsigned long)overhead);
+	for (index = 1; index < sizeof(cycleBenches) / sizeof(cycleBenches[0]); index++)
+	{
+		uint32_t minimum;
+		uint32_t mean = (uint32_t)(time_routine(&cycleBenches[index], &minimum, &wrapped) / CYCLE_BENCH_ITERATIONS);
+
+		minimum = (minimum > overhead) ? (minimum - overhead) : 0;
+		mean = (mean > overhead) ? (mean - overhead) : 0;
+		printf("\n%-32s %10lu  %11lu", cycleBenches[index].name, (unsigned long)minimum, (unsigned long)mean);
+		if (wrapped != 0)
+		{
+			printf("  %lu calls over 16 bits of TPM1", (unsigned long)wrapped);
+		}
+	}
+	printf("\ncycle benchmark done\n");
+}
+
+#endif /* defined(CYCLE_BENCHMARK) */
@@ -0,0 +1,32 @@
+/**
+ * @file    cycle_bench.h
+ * @brief   This header file consists of the cycle count benchmark image which times the control
+ * 			hot paths on the board with a free running TPM counter
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, Chapter 31 Timer/PWM Module (TPM)
+ */
+
+#ifndef CYCLE_BENCH_H_
+#define CYCLE_BENCH_H_
+
+#define CYCLE_BENCH_ITERATIONS		(4096) /*Calls timed of every routine*/
+
+/*
+ * @brief Times every hot routine CYCLE_BENCH_ITERATIONS times and prints cycles per call
+ *
+ * Built only when CYCLE_BENCHMARK is defined, called by main() after the modules are
+ * initialized in place of the state machine. TPM1 counts core clocks, its overflow interrupt
+ * counts the wraps above 16 bits. Each call is timed on its own and the minimum cost of an
+ * empty call is subtracted from the minimum and the mean. The minimum is the cost without the
+ * SysTick interrupt, the mean includes it. Routines with calls over 65535 cycles are flagged,
+ * those calls include the TPM1 overflow interrupt
+ *
+ * @return void
+ */
+void cycle_benchmark(void);
+
+#endif /* CYCLE_BENCH_H_ */
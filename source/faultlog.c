@@ -0,0 +1,92 @@
+/**
+ * @file    faultlog.c
+ * @brief   This source file consists of function definitions of the fault log which keeps the
+ * 			last faults in RAM that is not cleared by a reset
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "faultlog.h"
+#include "logfmt.h"
+#include "console.h"
+
+faultlog_t faultLog FAULTLOG_SECTION;
+
+/*
+ * @brief Keeps the log if it survived the reset, else clears it
+ *
+ * @return void
+ */
+void faultlog_init(void)
+{
+	console_register(FAULTLOG_REPORT_COMMAND, faultlog_report);
+	if ((faultLog.magic != FAULTLOG_MAGIC) || (faultLog.count > (UINT32_MAX - 1)))
+	{
+		faultlog_clear();
+		return;
+	}
+	faultLog.boots++;
+}
+
+/*
+ * @brief Records a fault, overwriting the oldest entry when the log is full
+ *
+ * @param1 FAULT_ code
+ * @param2 state machine state at the fault
+ * @param3 state before it
+ * @param4 code specific value
+ * @return void
+ */
+void faultlog_record(uint8_t code, uint8_t state, uint8_t previousState, uint32_t data)
+{
+	uint32_t masking_state = __get_PRIMASK();
+	faultlog_entry_t *entry;
+
+	__disable_irq();
+	entry = &faultLog.entries[faultLog.count % FAULTLOG_ENTRIES];
+	entry->tick = now();
+	entry->code = code;
+	entry->state = state;
+	entry->previousState = previousState;
+	entry->reserved = 0;
+	entry->data = data;
+	faultLog.count++;
+	__set_PRIMASK(masking_state);
+}
+
+/*
+ * @brief Prints the recorded faults to the console, oldest first
+ *
+ * @return void
+ */
+void faultlog_report(void)
+{
+	uint32_t first = (faultLog.count > FAULTLOG_ENTRIES) ? (faultLog.count - FAULTLOG_ENTRIES) : 0;
+	uint32_t index;
+
+	logfmt_printf("\r\nfault log: %lu faults, %lu resets, last reset 0x%04lx", (unsigned long)faultLog.count,
+				  (unsigned long)faultLog.boots, (unsigned long)faultLog.resetReason);
+	for (index = first; index < faultLog.count; index++)
+	{
+		const faultlog_entry_t *entry = &faultLog.entries[index % FAULTLOG_ENTRIES];
+		logfmt_printf("\r\n%lu: code %u state %u from %u at tick %lu data 0x%08lx", (unsigned long)index,
+					  entry->code, entry->state, entry->previousState, (unsigned long)entry->tick,
+					  (unsigned long)entry->data);
+	}
+	logfmt_printf("\r\n");
+}
+
+/*
+ * @brief Clears every entry of the log
+ *
+ * @return void
+ */
+void faultlog_clear(void)
+{
+	memset(&faultLog, 0, sizeof(faultLog));
+	faultLog.magic = FAULTLOG_MAGIC;
+}
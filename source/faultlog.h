@@ -0,0 +1,89 @@
+/**
+ * @file    faultlog.h
+ * @brief   This header file consists of the fault log which keeps the last faults in RAM
+ * 			that is not cleared by a reset, so they can be read after the fail-safe or a reboot
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef FAULTLOG_H_
+#define FAULTLOG_H_
+
+#include <stdint.h>
+#include "timer.h"
+
+#define FAULTLOG_ENTRIES			(8) /*Most recent faults kept, older ones are overwritten*/
+#define FAULTLOG_MAGIC				(0xFA17106Bu)
+#define FAULTLOG_REPORT_COMMAND		('f') /*Character received on the debug UART which prints the log*/
+
+/*Fault codes*/
+#define FAULT_NONE					(0)
+#define FAULT_CONFLICT				(1) /*Conflict monitor saw an illegal colour, data is 0xRRGGBB*/
+#define FAULT_RESET					(2) /*Abnormal reset, data is RCM SRS1 << 8 | SRS0*/
+#define FAULT_WATCHDOG				(3) /*Supervised tasks missed their deadline, data is the task mask*/
+#define FAULT_HARDFAULT				(4) /*HardFault, data is the faulting pc, see crashdump.h*/
+
+/*Placed in the .noinit section of the linker script, which the startup code does not clear*/
+#define FAULTLOG_SECTION			__attribute__((section(".noinit")))
+
+typedef struct
+{
+	ticktime tick;				/*now() when the fault was recorded*/
+	uint8_t code;				/*FAULT_ code*/
+	uint8_t state;				/*State machine state at the fault*/
+	uint8_t previousState;		/*State before it, the offending transition is previousState to state*/
+	uint8_t reserved;
+	uint32_t data;				/*Code specific value*/
+} faultlog_entry_t;
+
+typedef struct
+{
+	uint32_t magic;				/*FAULTLOG_MAGIC once the log has been initialized*/
+	uint32_t count;				/*Faults recorded since the log was cleared, entries wrap*/
+	uint32_t boots;				/*Resets seen with a valid log*/
+	uint32_t resetReason;		/*RCM SRS1 << 8 | SRS0 of the last reset*/
+	faultlog_entry_t entries[FAULTLOG_ENTRIES];
+} faultlog_t;
+
+extern faultlog_t faultLog;
+
+/*
+ * @brief Keeps the log if it survived the reset, else clears it
+ *
+ * Called once at startup before anything can record a fault
+ *
+ * @return void
+ */
+void faultlog_init(void);
+
+/*
+ * @brief Records a fault, overwriting the oldest entry when the log is full
+ *
+ * Safe to call from an interrupt handler
+ *
+ * @param1 FAULT_ code
+ * @param2 state machine state at the fault
+ * @param3 state before it
+ * @param4 code specific value
+ * @return void
+ */
+void faultlog_record(uint8_t code, uint8_t state, uint8_t previousState, uint32_t data);
+
+/*
+ * @brief Prints the recorded faults to the console, oldest first
+ *
+ * @return void
+ */
+void faultlog_report(void);
+
+/*
+ * @brief Clears every entry of the log
+ *
+ * @return void
+ */
+void faultlog_clear(void);
+
+#endif /* FAULTLOG_H_ */
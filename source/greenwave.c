@@ -0,0 +1,360 @@
+/**
+ * @file    greenwave.c
+ * @brief   This source file consists of function definitions of the green wave coordination:
+ * 			the sync message framing, the offset and drift estimate against the reference and
+ * 			the STOP trim. Reads nothing but the instance, the UART is in greenwave_uart.c
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "greenwave.h"
+
+#define FRACTION_ONE				(1 << GREENWAVE_FRACTION_BITS)
+#define DRIFT_SCALE					(65536)		/*drift is per 65536 ticks*/
+#define DRIFT_MAX					(16777)		/*1000 ppm*/
+#define OFFSET_BITS					(8)		/*offset keeps 8 more bits, the drift moves it 1/256 tick in minutes*/
+#define OFFSET_STEP_LIMIT			(2 << (GREENWAVE_FRACTION_BITS + OFFSET_BITS)) /*Larger residuals set the offset at once*/
+#define DRIFT_GAIN					(256)	/*Of the residual per time since the last message*/
+#define FRAME_SEQUENCE				(2)
+#define FRAME_HOPS					(3)
+#define FRAME_PHASE					(4)
+#define FRAME_CHECKSUM				(7)
+
+/*
+ * @brief Cycle length in 1/256 tick
+ *
+ * @param instance
+ * @return length
+ */
+static int32_t cycle_length(const greenwave_t *gw)
+{
+	return (int32_t)(gw->config.cycleTicks << GREENWAVE_FRACTION_BITS);
+}
+
+/*
+ * @brief A phase difference as the shortest way round the cycle
+ *
+ * @param1 difference
+ * @param2 cycle length in the same unit
+ * @return difference in (-cycle/2, cycle/2]
+ */
+static int32_t wrap(int32_t difference, int32_t cycle)
+{
+	difference %= cycle;
+	if (difference > cycle / 2)
+	{
+		difference -= cycle;
+	}
+	else if (difference <= -cycle / 2)
+	{
+		difference += cycle;
+	}
+	return difference;
+}
+
+/*
+ * @brief Phase of the local clock in its own cycle. The tick counter wraps after 8 years,
+ * 		  which moves the cycle once
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @return phase 0 to cycleTicks*256-1
+ */
+static int32_t local_phase(const greenwave_t *gw, ticktime now, uint8_t fraction)
+{
+	return (int32_t)(((now % gw->config.cycleTicks) << GREENWAVE_FRACTION_BITS) | fraction);
+}
+
+/*
+ * @brief Whether the offset still holds, the reference always does
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @return true if the reference phase can be used
+ */
+static bool holds(const greenwave_t *gw, ticktime now)
+{
+	return gw->config.reference || (gw->locked && ((now - gw->syncTick) <= gw->config.holdoverTicks));
+}
+
+/*
+ * @brief Time since the last message in 1/256 tick, at most the holdover
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @return elapsed time
+ */
+static int32_t since_sync(const greenwave_t *gw, ticktime now, uint8_t fraction)
+{
+	ticktime elapsed = now - gw->syncTick;
+
+	if (elapsed >= gw->config.holdoverTicks)
+	{
+		return (int32_t)(gw->config.holdoverTicks << GREENWAVE_FRACTION_BITS);
+	}
+	return (int32_t)((elapsed << GREENWAVE_FRACTION_BITS) + fraction) - gw->syncFraction;
+}
+
+/*
+ * @brief Offset to the reference at a local time, the last offset moved by the drift since.
+ * 		  64 bit, as the product exceeds 32 bits over the holdover, once per message and trim
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @return offset in 1/65536 tick
+ */
+static int32_t predicted_offset(const greenwave_t *gw, ticktime now, uint8_t fraction)
+{
+	int64_t moved = (int64_t)gw->drift * since_sync(gw, now, fraction);
+
+	return gw->offset + (int32_t)(moved / DRIFT_SCALE);
+}
+
+/*
+ * @brief Starts an instance without a reference, or as the reference
+ *
+ * @param1 instance
+ * @param2 limits, copied
+ * @param3 current tick
+ * @return void
+ */
+void greenwave_init(greenwave_t *gw, const greenwave_config_t *config, ticktime now)
+{
+	memset(gw, 0, sizeof(*gw));
+	gw->config = *config;
+	gw->syncTick = now;
+	gw->txTick = now - config->syncTicks;		/*The reference sends at once*/
+}
+
+/*
+ * @brief Phase of the shared cycle at a local time, from the offset and the drift estimate
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @return phase 0 to cycleTicks*256-1
+ */
+uint32_t greenwave_reference_phase(const greenwave_t *gw, ticktime now, uint8_t fraction)
+{
+	int32_t offset = (predicted_offset(gw, now, fraction) + (1 << (OFFSET_BITS - 1))) >> OFFSET_BITS;
+	int32_t phase = wrap(local_phase(gw, now, fraction) + offset, cycle_length(gw));
+
+	return (uint32_t)((phase < 0) ? phase + cycle_length(gw) : phase);
+}
+
+/*
+ * @brief Whether a sync message is to be sent downstream, once every syncTicks while locked
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @return true to call greenwave_frame()
+ */
+bool greenwave_sync_due(const greenwave_t *gw, ticktime now)
+{
+	return holds(gw, now) && ((now - gw->txTick) >= gw->config.syncTicks);
+}
+
+/*
+ * @brief Builds a sync message carrying the reference phase at the time its first byte is sent
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @param4 GREENWAVE_FRAME_BYTES bytes
+ * @return bytes in frame
+ */
+uint8_t greenwave_frame(greenwave_t *gw, ticktime now, uint8_t fraction, uint8_t *frame)
+{
+	uint32_t phase = greenwave_reference_phase(gw, now, fraction);
+	uint8_t sum = 0;
+	uint8_t index;
+
+	frame[0] = GREENWAVE_SYNC1;
+	frame[1] = GREENWAVE_SYNC2;
+	frame[FRAME_SEQUENCE] = gw->txSequence++;
+	frame[FRAME_HOPS] = gw->config.reference ? 0 : (uint8_t)(gw->rxHops + 1);
+	frame[FRAME_PHASE] = (uint8_t)phase;
+	frame[FRAME_PHASE + 1] = (uint8_t)(phase >> 8);
+	frame[FRAME_PHASE + 2] = (uint8_t)(phase >> 16);
+	for (index = FRAME_SEQUENCE; index < FRAME_CHECKSUM; index++)
+	{
+		sum += frame[index];
+	}
+	frame[FRAME_CHECKSUM] = (uint8_t)-sum;
+
+	gw->txTick = now;
+	gw->stats.framesSent++;
+	gw->stats.bytesSent += GREENWAVE_FRAME_BYTES;
+	return GREENWAVE_FRAME_BYTES;
+}
+
+/*
+ * @brief Corrects the offset and the drift estimate from a sync message
+ *
+ * The residual against the offset predicted from the last message moves the offset half the
+ * way and the drift 1/DRIFT_GAIN of the residual per tick since. A large residual, the first
+ * message or one after the holdover sets the offset to the measurement
+ *
+ * @param1 instance
+ * @param2 reference phase of the message when its first byte was sent
+ * @param3 tick at which it was received
+ * @param4 time within the tick in 1/256
+ * @return void
+ */
+static void sync_received(greenwave_t *gw, uint32_t phase, ticktime now, uint8_t fraction)
+{
+	int32_t cycle = cycle_length(gw) << OFFSET_BITS;
+	int32_t measured = wrap((int32_t)phase + gw->config.linkDelay - local_phase(gw, now, fraction), cycle_length(gw)) << OFFSET_BITS;
+	int32_t elapsed = since_sync(gw, now, fraction);
+
+	if (!holds(gw, now))
+	{
+		gw->offset = measured;
+		gw->locked = true;
+		gw->stats.steps++;
+	}
+	else
+	{
+		int32_t predicted = predicted_offset(gw, now, fraction);
+		int32_t residual = wrap(measured - predicted, cycle);
+
+		if ((residual > OFFSET_STEP_LIMIT) || (residual < -OFFSET_STEP_LIMIT))
+		{
+			gw->offset = measured;
+			gw->stats.steps++;
+		}
+		else
+		{
+			gw->offset = wrap(predicted + residual / 2, cycle);
+			if (gw->config.driftCorrection && (elapsed > 0))
+			{
+				gw->drift += (int32_t)(((int64_t)residual * DRIFT_SCALE) / elapsed / DRIFT_GAIN);
+				if (gw->drift > DRIFT_MAX)
+				{
+					gw->drift = DRIFT_MAX;
+				}
+				else if (gw->drift < -DRIFT_MAX)
+				{
+					gw->drift = -DRIFT_MAX;
+				}
+			}
+		}
+	}
+	gw->syncTick = now;
+	gw->syncFraction = fraction;
+}
+
+/*
+ * @brief Takes a byte received from the upstream link, a complete sync message corrects the
+ * 		  offset to the reference and the drift estimate
+ *
+ * @param1 instance
+ * @param2 byte
+ * @param3 tick at which it was received
+ * @param4 time within the tick in 1/256
+ * @return true if the byte completed a valid sync message
+ */
+bool greenwave_receive(greenwave_t *gw, uint8_t byte, ticktime now, uint8_t fraction)
+{
+	uint8_t *frame = gw->rxFrame;
+	uint8_t sum = 0;
+	uint32_t phase;
+	uint8_t index;
+
+	gw->stats.bytesReceived++;
+	if (gw->rxCount == 0)
+	{
+		gw->rxCount = (byte == GREENWAVE_SYNC1) ? 1 : 0;
+		frame[0] = byte;
+		return false;
+	}
+	if (gw->rxCount == 1)
+	{
+		if (byte == GREENWAVE_SYNC2)
+		{
+			frame[gw->rxCount++] = byte;
+		}
+		else
+		{
+			gw->rxCount = (byte == GREENWAVE_SYNC1) ? 1 : 0;
+		}
+		return false;
+	}
+	frame[gw->rxCount++] = byte;
+	if (gw->rxCount < GREENWAVE_FRAME_BYTES)
+	{
+		return false;
+	}
+	gw->rxCount = 0;
+
+	for (index = FRAME_SEQUENCE; index <= FRAME_CHECKSUM; index++)
+	{
+		sum += frame[index];
+	}
+	phase = frame[FRAME_PHASE] | ((uint32_t)frame[FRAME_PHASE + 1] << 8) | ((uint32_t)frame[FRAME_PHASE + 2] << 16);
+	if ((sum != 0) || (phase >= (uint32_t)cycle_length(gw)))
+	{
+		gw->stats.badFrames++;
+		return false;
+	}
+	if (gw->config.reference)
+	{
+		return false;			/*The reference keeps its own cycle*/
+	}
+
+	if (gw->stats.framesReceived != 0)
+	{
+		gw->stats.lostFrames += (uint8_t)(frame[FRAME_SEQUENCE] - gw->rxSequence - 1);
+	}
+	gw->stats.framesReceived++;
+	gw->rxSequence = frame[FRAME_SEQUENCE];
+	gw->rxHops = frame[FRAME_HOPS];
+	sync_received(gw, phase, now, fraction);
+	return true;
+}
+
+/*
+ * @brief Ticks to add to the STOP just entered so that the next GO starts at the offset
+ *
+ * The error of the GO start without a trim is taken the shortest way round the cycle and
+ * corrected as far as the limits allow, the rest is corrected in the next cycles
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @param4 ticks from now to the GO start without a trim, the STOP and its transition
+ * @return ticks added to the STOP, negative to shorten it, 0 when not locked
+ */
+int32_t greenwave_stop_trim(greenwave_t *gw, ticktime now, uint8_t fraction, uint32_t ticksToGo)
+{
+	int32_t goPhase;
+	int32_t error;
+	int32_t trim;
+
+	if (!holds(gw, now))
+	{
+		gw->stats.lastTrim = 0;
+		return 0;			/*Runs free until a message comes*/
+	}
+	goPhase = (int32_t)greenwave_reference_phase(gw, now, fraction) + (int32_t)(ticksToGo << GREENWAVE_FRACTION_BITS);
+	error = wrap(goPhase - (int32_t)(gw->config.offsetTicks << GREENWAVE_FRACTION_BITS), cycle_length(gw));
+	trim = -((error + ((error < 0) ? -FRACTION_ONE / 2 : FRACTION_ONE / 2)) / FRACTION_ONE);
+	if (trim < -(int32_t)gw->config.maxShortenTicks)
+	{
+		trim = -(int32_t)gw->config.maxShortenTicks;
+	}
+	else if (trim > (int32_t)gw->config.maxExtendTicks)
+	{
+		trim = (int32_t)gw->config.maxExtendTicks;
+	}
+	gw->stats.lastError = error;
+	gw->stats.lastTrim = trim;
+	return trim;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file    greenwave.h
+ * @brief   This header file consists of the green wave coordination between neighbouring
+ * 			controllers: cycle offset sync messages over UART and the STOP trim which moves
+ * 			the GO start of the intersection to its offset in the shared cycle
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef GREENWAVE_H_
+#define GREENWAVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+/*Sync message: 2 sync bytes, sequence, hops from the reference, reference phase (24 bit little
+  endian, 1/256 tick) at the first byte and a checksum making the sum of bytes 2-7 zero*/
+#define GREENWAVE_FRAME_BYTES			(8)
+#define GREENWAVE_SYNC1					(0xA5)
+#define GREENWAVE_SYNC2					(0x5A)
+#define GREENWAVE_FRACTION_BITS			(8)		/*Phases and offsets are in 1/256 tick*/
+#define GREENWAVE_BAUD					(9600)	/*UART1 and UART2 have no FIFO, a byte every msec*/
+/*Time from the first byte written to the last byte received, in 1/256 tick of 62.5 msec*/
+#define GREENWAVE_FRAME_DELAY(baud)		((GREENWAVE_FRAME_BYTES * 10 * 16 * 256 + (baud) / 2) / (baud))
+
+/*Coordination limits in ticks of 62.5 msec*/
+typedef struct
+{
+	uint32_t cycleTicks;			/*Shared cycle, phase 0 is the GO start of the reference*/
+	uint32_t offsetTicks;			/*GO start of this intersection in the cycle*/
+	uint32_t syncTicks;				/*Interval of the sync messages sent downstream*/
+	uint32_t holdoverTicks;			/*Runs on the drift estimate this long after the last message*/
+	uint32_t maxShortenTicks;		/*Limits of the STOP trim of one cycle*/
+	uint32_t maxExtendTicks;
+	uint16_t linkDelay;				/*GREENWAVE_FRAME_DELAY() of the upstream link*/
+	bool reference;					/*Keeps the cycle reference, nothing is received*/
+	bool driftCorrection;			/*Estimates the clock drift against the reference*/
+} greenwave_config_t;
+
+/*Link statistics and the last alignment*/
+typedef struct
+{
+	uint32_t framesSent;
+	uint32_t framesReceived;
+	uint32_t badFrames;				/*Checksum errors, and frames cut by a sync pattern*/
+	uint32_t lostFrames;			/*Gaps in the sequence numbers, modulo 256*/
+	uint32_t bytesSent;
+	uint32_t bytesReceived;
+	uint32_t steps;					/*Offset set from a message instead of filtered*/
+	int32_t lastError;				/*GO start minus its offset before the last trim, 1/256 tick*/
+	int32_t lastTrim;				/*Ticks added to the last STOP*/
+} greenwave_stats_t;
+
+typedef struct
+{
+	greenwave_config_t config;
+	greenwave_stats_t stats;
+	bool locked;					/*offset holds, a message came within holdoverTicks*/
+	int32_t offset;					/*Reference phase minus the local phase at syncTick, 1/65536 tick*/
+	int32_t drift;					/*Change of offset per 65536 ticks, 1/256 tick*/
+	ticktime syncTick;				/*Local time of the last message*/
+	uint8_t syncFraction;
+	ticktime txTick;				/*Last sync message sent*/
+	uint8_t txSequence;
+	uint8_t rxSequence;
+	uint8_t rxHops;
+	uint8_t rxCount;				/*Bytes of the frame being received*/
+	uint8_t rxFrame[GREENWAVE_FRAME_BYTES];
+} greenwave_t;
+
+/*
+ * @brief Starts an instance without a reference, or as the reference
+ *
+ * @param1 instance
+ * @param2 limits, copied
+ * @param3 current tick
+ * @return void
+ */
+void greenwave_init(greenwave_t *gw, const greenwave_config_t *config, ticktime now);
+
+/*
+ * @brief Phase of the shared cycle at a local time, from the offset and the drift estimate
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @return phase 0 to cycleTicks*256-1, meaningless unless the instance is locked
+ */
+uint32_t greenwave_reference_phase(const greenwave_t *gw, ticktime now, uint8_t fraction);
+
+/*
+ * @brief Whether a sync message is to be sent downstream, once every syncTicks while locked
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @return true to call greenwave_frame()
+ */
+bool greenwave_sync_due(const greenwave_t *gw, ticktime now);
+
+/*
+ * @brief Builds a sync message carrying the reference phase at the time its first byte is sent
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @param4 GREENWAVE_FRAME_BYTES bytes
+ * @return bytes in frame
+ */
+uint8_t greenwave_frame(greenwave_t *gw, ticktime now, uint8_t fraction, uint8_t *frame);
+
+/*
+ * @brief Takes a byte received from the upstream link, a complete sync message corrects the
+ * 		  offset to the reference and the drift estimate
+ *
+ * @param1 instance
+ * @param2 byte
+ * @param3 tick at which it was received
+ * @param4 time within the tick in 1/256
+ * @return true if the byte completed a valid sync message
+ */
+bool greenwave_receive(greenwave_t *gw, uint8_t byte, ticktime now, uint8_t fraction);
+
+/*
+ * @brief Ticks to add to the STOP just entered so that the next GO starts at the offset
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 time within the tick in 1/256
+ * @param4 ticks from now to the GO start without a trim, the STOP and its transition
+ * @return ticks added to the STOP, negative to shorten it, 0 when not locked
+ */
+int32_t greenwave_stop_trim(greenwave_t *gw, ticktime now, uint8_t fraction, uint32_t ticksToGo);
+
+/*
+ * @brief Initializes UART1 (upstream, PTE0/PTE1) and UART2 (downstream, PTE22/PTE23) at
+ * 		  GREENWAVE_BAUD and the instance of the firmware, defined in greenwave_uart.c
+ *
+ * @return void
+ */
+void greenwave_uart_init(void);
+
+/*
+ * @brief Moves the bytes of the sync messages, called every main loop iteration
+ *
+ * @return void
+ */
+void greenwave_poll(void);
+
+/*
+ * @brief greenwave_stop_trim() of the instance of the firmware at the current time
+ *
+ * @param ticks from now to the GO start without a trim
+ * @return ticks added to the STOP
+ */
+int32_t greenwave_trim(uint32_t ticksToGo);
+
+#endif /* GREENWAVE_H_ */
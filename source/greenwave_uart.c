@@ -0,0 +1,173 @@
+/**
+ * @file    greenwave_uart.c
+ * @brief   This source file consists of the UART links of the green wave coordination. Sync
+ * 			messages come from the upstream controller on UART1 and go to the downstream one
+ * 			on UART2, both polled from the main loop through drivers/fsl_uart.c
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+/*Allow the coordination to be built by setting a define (via command line)*/
+#if defined(GREEN_WAVE)
+
+#include "MKL25Z4.h"
+#include "fsl_clock.h"
+#include "fsl_port.h"
+#include "fsl_uart.h"
+#include "greenwave.h"
+#include "statemachine.h"
+#include "timer.h"
+
+#define UPSTREAM_UART				UART1
+#define DOWNSTREAM_UART				UART2
+#define UPSTREAM_TX_PIN				(0)		/*PTE0, ALT3*/
+#define UPSTREAM_RX_PIN				(1)		/*PTE1, ALT3*/
+#define DOWNSTREAM_TX_PIN			(22)	/*PTE22, ALT4*/
+#define DOWNSTREAM_RX_PIN			(23)	/*PTE23, ALT4*/
+
+/*Defining GREEN_WAVE_REFERENCE makes this controller the reference of the cycle, the others
+  start their GO GREEN_WAVE_OFFSET ticks after it, the travel time from the reference*/
+#ifndef GREEN_WAVE_OFFSET
+#define GREEN_WAVE_OFFSET				(0)
+#endif
+#if defined(GREEN_WAVE_REFERENCE)
+#define GREEN_WAVE_IS_REFERENCE			(true)
+#else
+#define GREEN_WAVE_IS_REFERENCE			(false)
+#endif
+
+#define SYNC_TICKS						(16)		/*One sync message every second*/
+#define HOLDOVER_TICKS					(16*600)	/*10 minutes on the drift estimate*/
+
+static greenwave_t greenWave;
+static uint8_t txFrame[GREENWAVE_FRAME_BYTES];
+static uint8_t txLength;
+static uint8_t txIndex;
+
+/*
+ * @brief Current tick and the time within it in 1/256 from the SysTick down counter, read
+ * 		  again if a tick came in between
+ *
+ * @param time within the tick
+ * @return current tick
+ */
+static ticktime now_fraction(uint8_t *fraction)
+{
+	ticktime tick;
+	uint32_t cycles;
+
+	do
+	{
+		tick=now();
+		cycles=cycles_in_tick();
+	} while(tick != now());
+	*fraction=(uint8_t)((cycles << GREENWAVE_FRACTION_BITS)/cycles_per_tick());
+	return tick;
+}
+
+/*
+ * @brief Initializes UART1 (upstream, PTE0/PTE1) and UART2 (downstream, PTE22/PTE23) at
+ * 		  GREENWAVE_BAUD and the instance of the firmware
+ *
+ * The cycle is the fixed sequence of statemachine.c: STOP, GO and WARNING with their three
+ * transitions. STOP may be trimmed by half the STOP_GO_TIME either way in one cycle
+ *
+ * @return void
+ */
+void greenwave_uart_init(void)
+{
+	uart_config_t uartConfig;
+	greenwave_config_t config={
+		.cycleTicks=2*smDefaultConfig.stopTicks+smDefaultConfig.warningTicks+3*smDefaultConfig.transitionTicks,
+		.offsetTicks=GREEN_WAVE_OFFSET,
+		.syncTicks=SYNC_TICKS,
+		.holdoverTicks=HOLDOVER_TICKS,
+		.maxShortenTicks=smDefaultConfig.stopTicks/2,
+		.maxExtendTicks=smDefaultConfig.stopTicks/2,
+		.linkDelay=GREENWAVE_FRAME_DELAY(GREENWAVE_BAUD),
+		.reference=GREEN_WAVE_IS_REFERENCE,
+		.driftCorrection=true
+	};
+
+	CLOCK_EnableClock(kCLOCK_PortE);
+	PORT_SetPinMux(PORTE, UPSTREAM_TX_PIN, kPORT_MuxAlt3);
+	PORT_SetPinMux(PORTE, UPSTREAM_RX_PIN, kPORT_MuxAlt3);
+	PORT_SetPinMux(PORTE, DOWNSTREAM_TX_PIN, kPORT_MuxAlt4);
+	PORT_SetPinMux(PORTE, DOWNSTREAM_RX_PIN, kPORT_MuxAlt4);
+
+	UART_GetDefaultConfig(&uartConfig);
+	uartConfig.baudRate_Bps=GREENWAVE_BAUD;
+	uartConfig.enableTx=true;
+	uartConfig.enableRx=true;
+	UART_Init(UPSTREAM_UART, &uartConfig, CLOCK_GetFreq(kCLOCK_BusClk));		/*UART1 and UART2 run from the bus clock*/
+	UART_Init(DOWNSTREAM_UART, &uartConfig, CLOCK_GetFreq(kCLOCK_BusClk));
+
+	greenwave_init(&greenWave, &config, now());
+	txLength=0;
+	txIndex=0;
+}
+
+/*
+ * @brief Moves the bytes of the sync messages, called every main loop iteration
+ *
+ * A byte is taken from UART1 when one is waiting, an overrun drops the frame being received
+ * and the next sync pattern starts again. A due sync message is stamped when its first byte
+ * is written to UART2, the next bytes follow whenever the data register is empty
+ *
+ * @return void
+ */
+void greenwave_poll(void)
+{
+	uint32_t status=UART_GetStatusFlags(UPSTREAM_UART);
+	uint8_t fraction;
+	ticktime tick;
+
+	if(status & kUART_RxOverrunFlag)
+	{
+		UART_ClearStatusFlags(UPSTREAM_UART, kUART_RxOverrunFlag);
+		greenWave.rxCount=0;
+		greenWave.stats.badFrames++;
+	}
+	if(status & kUART_RxDataRegFullFlag)
+	{
+		uint8_t byte=UART_ReadByte(UPSTREAM_UART);
+
+		tick=now_fraction(&fraction);
+		(void)greenwave_receive(&greenWave, byte, tick, fraction);
+	}
+
+	if(!(UART_GetStatusFlags(DOWNSTREAM_UART) & kUART_TxDataRegEmptyFlag))
+	{
+		return;
+	}
+	if(txIndex < txLength)
+	{
+		UART_WriteByte(DOWNSTREAM_UART, txFrame[txIndex++]);
+	}
+	else if(greenwave_sync_due(&greenWave, now()))
+	{
+		tick=now_fraction(&fraction);
+		txLength=greenwave_frame(&greenWave, tick, fraction, txFrame);
+		txIndex=0;
+		UART_WriteByte(DOWNSTREAM_UART, txFrame[txIndex++]);
+	}
+}
+
+/*
+ * @brief greenwave_stop_trim() of the instance of the firmware at the current time
+ *
+ * @param ticks from now to the GO start without a trim
+ * @return ticks added to the STOP
+ */
+int32_t greenwave_trim(uint32_t ticksToGo)
+{
+	uint8_t fraction;
+	ticktime tick=now_fraction(&fraction);
+
+	return greenwave_stop_trim(&greenWave, tick, fraction, ticksToGo);
+}
+
+#endif /* defined(GREEN_WAVE) */
@@ -0,0 +1,387 @@
+/**
+ * @file    inputrec.c
+ * @brief   This source file consists of function definitions of the recorder of the external
+ * 			inputs, the LED output checkpoints and the state machine snapshots, kept in RAM not
+ * 			cleared by a reset and saved to flash on the next boot
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+/*Allow the input recorder to be added by setting a define (via command line)*/
+#if defined(INPUT_RECORD)
+
+#include <stddef.h>
+#include <string.h>
+#include "MKL25Z4.h"
+#include "inputrec.h"
+#include "faultlog.h"
+#include "touchslider.h"
+#include "logfmt.h"
+#include "console.h"
+
+#define SUB_TICK_SHIFT			(4)		/*cycles_in_tick() << 4 fits 32 bits for 3 M cycles per tick*/
+#define SUB_TICK_DIVIDER_SHIFT	(12)	/*16 - SUB_TICK_SHIFT, result in 65536ths of a tick*/
+#define FNV_OFFSET				(2166136261u)
+#define FNV_PRIME				(16777619u)
+#define NO_COLOUR				(0xFFFFFFFFu)
+#define HASH_FOLD_SHIFT			(16)
+#define COLOUR_SHIFT			(8)
+#define INPUTREC_WORDS_PER_LINE	(8)		/*Context words per exported line*/
+
+/*Placed in the .noinit section of the linker script, which the startup code does not clear*/
+inputrec_t inputRec FAULTLOG_SECTION;
+
+#if defined(__arm__)
+#include "fsl_flash.h"
+
+/*Flash sectors holding the recording of the run before the last reset, start erased. In the
+ *FLASH_RECORDS memory region as the crash dump, kept by a firmware update. Sector aligned, the
+ *region holds the two records with no gap. Read through a volatile pointer since the compiler
+ *would otherwise use the initial value*/
+static const volatile uint8_t inputRecFlash[INPUTREC_FLASH_SIZE]
+	__attribute__((section(".text_FLASH_RECORDS.inputRecFlash"),
+				   aligned(FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE), used)) =
+	{ [0 ... INPUTREC_FLASH_SIZE - 1] = 0xFF };
+#else
+static volatile uint8_t inputRecFlash[INPUTREC_FLASH_SIZE]; /*No flash driver on the host*/
+#endif
+
+_Static_assert((sizeof(inputrec_t) % sizeof(uint32_t)) == 0, "flash is programmed in words");
+_Static_assert(sizeof(inputrec_t) <= INPUTREC_FLASH_SIZE, "recording does not fit its flash sectors");
+_Static_assert((INPUTREC_CONTEXT_STATE_BYTES % sizeof(uint32_t)) == 0, "context is exported in words");
+
+static int8_t touchPressed;			/*Side of the threshold of the last value, -1 before the first scan*/
+static uint32_t outputColour;		/*Last colour written, 0xRRGGBB*/
+static uint32_t outputHash;			/*FNV-1a of the colour changes since the last checkpoint*/
+static ticktime checkpointTick;
+static uint32_t snapshots;			/*Snapshots taken since boot*/
+
+/*
+ * @brief Writes the recording to its flash sectors
+ *
+ * @return true if the sectors were erased and programmed
+ */
+static bool inputrec_save(void)
+{
+#if defined(__arm__)
+	flash_config_t flash;
+	uint32_t address = (uint32_t)inputRecFlash;
+	uint32_t masking_state = __get_PRIMASK();
+	status_t status;
+
+	memset(&flash, 0, sizeof(flash));
+	if (FLASH_Init(&flash) != kStatus_FLASH_Success)
+	{
+		return false;
+	}
+
+	__disable_irq();		/*Nothing may run from flash while it is being erased*/
+	status = FLASH_Erase(&flash, address, INPUTREC_FLASH_SIZE, kFLASH_ApiEraseKey);
+	if (status == kStatus_FLASH_Success)
+	{
+		status = FLASH_Program(&flash, address, (uint32_t *)&inputRec, sizeof(inputRec));
+	}
+	__set_PRIMASK(masking_state);
+	return (status == kStatus_FLASH_Success);
+#else
+	memcpy((void *)inputRecFlash, &inputRec, sizeof(inputRec));
+	return true;
+#endif
+}
+
+/*
+ * @brief Prints the recording of this run to the console
+ *
+ * @return void
+ */
+static void inputrec_export_run(void)
+{
+	inputrec_export(&inputRec);
+}
+
+/*
+ * @brief Saves the recording of the previous run to flash and starts a new one
+ *
+ * @return void
+ */
+void inputrec_init(void)
+{
+	console_register(INPUTREC_EXPORT_COMMAND, inputrec_export_run);
+	console_register(INPUTREC_SAVED_COMMAND, inputrec_export_saved);
+	if ((inputRec.magic == INPUTREC_MAGIC) && !inputrec_save())
+	{
+		logfmt_printf("\r\ninput recording not saved to flash\r\n");
+	}
+	memset(&inputRec, 0, sizeof(inputRec));
+	inputRec.resetReason = faultLog.resetReason;
+	inputRec.magic = INPUTREC_MAGIC;
+	touchPressed = -1;
+	outputColour = NO_COLOUR;
+	outputHash = FNV_OFFSET;
+	checkpointTick = 0;
+	snapshots = 0;
+}
+
+/*
+ * @brief Adds an event, safe to call from an interrupt handler
+ *
+ * @param1 INPUTREC_ type
+ * @param2 type specific value
+ * @return void
+ */
+static void inputrec_add(uint8_t type, uint16_t value)
+{
+	uint32_t masking_state = __get_PRIMASK();
+	uint32_t subTick = (cycles_in_tick() << SUB_TICK_SHIFT) / ((cycles_per_tick() >> SUB_TICK_DIVIDER_SHIFT) + 1);
+
+	inputrec_event_t *event;
+
+	__disable_irq();
+	event = &inputRec.events[inputRec.next];
+	event->stamp = INPUTREC_STAMP(now(), type);
+	event->subTick = (uint16_t)subTick;
+	event->value = value;
+	if (++inputRec.next == INPUTREC_EVENTS)
+	{
+		inputRec.next = 0;
+	}
+	inputRec.count++;
+	__set_PRIMASK(masking_state);
+}
+
+/*
+ * @brief Records an input interrupt, called from PORTD_IRQHandler
+ *
+ * @param1 INPUTREC_SWITCH or INPUTREC_DETECTOR
+ * @param2 type specific value
+ * @return void
+ */
+void inputrec_record(uint8_t type, uint16_t value)
+{
+	inputrec_add(type, value);
+}
+
+/*
+ * @brief Records a touch slider value when it is on the other side of the press threshold
+ *
+ * @param value returned by Touch_Scan_LH()
+ * @return void
+ */
+void inputrec_touch(int value)
+{
+	int8_t pressed = (value > SLIDER_PRESSED_MINIMUM_VALUE);
+
+	if (pressed != touchPressed)
+	{
+		touchPressed = pressed;
+		inputrec_add(INPUTREC_TOUCH, (uint16_t)value);
+	}
+}
+
+/*
+ * @brief Adds a colour written to the LEDs to the output checkpoint
+ *
+ * Called for every write, also by the fail-safe from the SysTick handler. A checkpoint holds
+ * the changes of at least INPUTREC_CHECKPOINT_TICKS, it is written at the first change after
+ *
+ * @param1 red value
+ * @param2 green value
+ * @param3 blue value
+ * @return void
+ */
+void inputrec_output(uint16_t red, uint16_t green, uint16_t blue)
+{
+	uint32_t colour = ((uint32_t)(red & 0xFF) << (2 * COLOUR_SHIFT)) | ((uint32_t)(green & 0xFF) << COLOUR_SHIFT) |
+					  (blue & 0xFF);
+	uint32_t masking_state = __get_PRIMASK();
+	ticktime tick;
+
+	__disable_irq();
+	if (colour != outputColour)
+	{
+		tick = now();
+		if ((tick - checkpointTick) >= INPUTREC_CHECKPOINT_TICKS)
+		{
+			inputrec_add(INPUTREC_OUTPUT, (uint16_t)(outputHash ^ (outputHash >> HASH_FOLD_SHIFT)));
+			outputHash = FNV_OFFSET;
+			checkpointTick = tick;
+		}
+		outputColour = colour;
+		outputHash = (outputHash ^ tick) * FNV_PRIME;
+		outputHash = (outputHash ^ colour) * FNV_PRIME;
+	}
+	__set_PRIMASK(masking_state);
+}
+
+/*
+ * @brief Byte offset in sm_ctx_t of a word of the exported context
+ *
+ * @param index of the word, below INPUTREC_CONTEXT_WORDS
+ * @return offset
+ */
+uint32_t inputrec_context_offset(uint32_t index)
+{
+	uint32_t offset = index * sizeof(uint32_t);
+
+	if (offset < INPUTREC_CONTEXT_STATE_BYTES)
+	{
+		return offsetof(sm_ctx_t, stateStart) + offset;
+	}
+	offset -= INPUTREC_CONTEXT_STATE_BYTES;
+	if (offset < sizeof(crosswalk_policy_t))
+	{
+		return offsetof(sm_ctx_t, policy) + offset;
+	}
+	return offsetof(sm_ctx_t, timing) + offset - sizeof(crosswalk_policy_t);
+}
+
+/*
+ * @brief Takes a snapshot of the state machine when one is due
+ *
+ * Every INPUTREC_SNAPSHOT_TICKS, or after INPUTREC_SNAPSHOT_EVENTS events so that the events
+ * after the snapshot are still kept. taken is cleared while it is written, a reset in between
+ * leaves no snapshot rather than a torn one
+ *
+ * @param1 instance of the firmware
+ * @param2 tick of the iteration
+ * @return void
+ */
+void inputrec_snapshot(const sm_ctx_t *context, ticktime tick)
+{
+	inputrec_snapshot_t *snapshot = &inputRec.snapshot;
+	uint32_t masking_state = __get_PRIMASK();
+
+	if ((snapshots != 0) && ((tick - snapshot->tick) < INPUTREC_SNAPSHOT_TICKS) &&
+		((inputRec.count - snapshot->count) < INPUTREC_SNAPSHOT_EVENTS))
+	{
+		return;
+	}
+	snapshot->taken = 0;
+	__disable_irq();		/*The event count and the output checkpoint of the same moment*/
+	snapshot->count = inputRec.count;
+	snapshot->outputColour = outputColour;
+	snapshot->outputHash = outputHash;
+	snapshot->checkpointTick = checkpointTick;
+	__set_PRIMASK(masking_state);
+	snapshot->tick = tick;
+	snapshot->touchPressed = touchPressed;
+	snapshot->context = *context;
+	snapshot->taken = ++snapshots;
+}
+
+/*
+ * @brief Loads a snapshot into the recorder and an instance, for a replay which starts from it
+ *
+ * @param1 snapshot
+ * @param2 events recorded before the replay starts
+ * @param3 instance, its config is kept
+ * @return void
+ */
+void inputrec_restore(const inputrec_snapshot_t *snapshot, uint32_t count, sm_ctx_t *context)
+{
+	uint32_t index;
+
+	inputRec.count = count;
+	inputRec.next = count % INPUTREC_EVENTS;
+	inputRec.snapshot = *snapshot;
+	outputColour = snapshot->outputColour;
+	outputHash = snapshot->outputHash;
+	checkpointTick = snapshot->checkpointTick;
+	touchPressed = (int8_t)snapshot->touchPressed;
+	snapshots = snapshot->taken;
+	for (index = 0; index < INPUTREC_CONTEXT_WORDS; index++)
+	{
+		uint32_t offset = inputrec_context_offset(index);
+
+		memcpy((uint8_t *)context + offset, (const uint8_t *)&snapshot->context + offset, sizeof(uint32_t));
+	}
+}
+
+/*
+ * @brief Reads a word of a recording
+ *
+ * @param1 recording in RAM or flash
+ * @param2 byte offset of the word
+ * @return word
+ */
+static uint32_t inputrec_word(const uint8_t *recording, uint32_t offset)
+{
+	uint32_t word;
+
+	memcpy(&word, &recording[offset], sizeof(word));
+	return word;
+}
+
+/*
+ * @brief Prints a recording, oldest event first, read a word or an event at a time so that
+ * the 2 KB recording saved in flash is not copied to RAM
+ *
+ * @param recording in RAM or flash
+ * @return void
+ */
+static void inputrec_export_from(const uint8_t *recording)
+{
+	uint32_t count = inputrec_word(recording, offsetof(inputrec_t, count));
+	uint32_t kept = (count < INPUTREC_EVENTS) ? count : INPUTREC_EVENTS;
+	inputrec_event_t event;
+	uint32_t index;
+
+	logfmt_printf("\r\ninputrec %lu %04lx", (unsigned long)count,
+				  (unsigned long)inputrec_word(recording, offsetof(inputrec_t, resetReason)));
+	if (inputrec_word(recording, offsetof(inputrec_t, snapshot.taken)) != 0)
+	{
+		logfmt_printf("\r\nsnap %lu %lu %06lx %08lx %lu %ld",
+					  (unsigned long)inputrec_word(recording, offsetof(inputrec_t, snapshot.count)),
+					  (unsigned long)inputrec_word(recording, offsetof(inputrec_t, snapshot.tick)),
+					  (unsigned long)inputrec_word(recording, offsetof(inputrec_t, snapshot.outputColour)),
+					  (unsigned long)inputrec_word(recording, offsetof(inputrec_t, snapshot.outputHash)),
+					  (unsigned long)inputrec_word(recording, offsetof(inputrec_t, snapshot.checkpointTick)),
+					  (long)(int32_t)inputrec_word(recording, offsetof(inputrec_t, snapshot.touchPressed)));
+		for (index = 0; index < INPUTREC_CONTEXT_WORDS; index++)
+		{
+			uint32_t word = inputrec_word(recording, offsetof(inputrec_t, snapshot.context) + inputrec_context_offset(index));
+
+			logfmt_printf(((index % INPUTREC_WORDS_PER_LINE) == 0) ? "\r\nctx %08lx" : " %08lx", (unsigned long)word);
+		}
+	}
+	for (index = count - kept; index != count; index++)
+	{
+		memcpy(&event, &recording[offsetof(inputrec_t, events) + (index % INPUTREC_EVENTS) * sizeof(event)], sizeof(event));
+		logfmt_printf("\r\nev %08lx %04x %04x", (unsigned long)event.stamp, event.subTick, event.value);
+	}
+	logfmt_printf("\r\ninputrec end\r\n");
+}
+
+/*
+ * @brief Prints a recording to the console, the format read by "sim --replay"
+ *
+ * @param recording to be printed
+ * @return void
+ */
+void inputrec_export(const inputrec_t *recording)
+{
+	inputrec_export_from((const uint8_t *)recording);
+}
+
+/*
+ * @brief Prints the recording saved in flash to the console
+ *
+ * @return void
+ */
+void inputrec_export_saved(void)
+{
+	uint32_t magic;
+
+	memcpy(&magic, (const void *)inputRecFlash, sizeof(magic));
+	if (magic != INPUTREC_MAGIC)		/*Erased, no reset yet*/
+	{
+		logfmt_printf("\r\nno input recording saved\r\n");
+		return;
+	}
+	inputrec_export_from((const uint8_t *)inputRecFlash);
+}
+
+#endif /* defined(INPUT_RECORD) */
@@ -0,0 +1,162 @@
+/**
+ * @file    inputrec.h
+ * @brief   This header file consists of the recorder of the external inputs, switch and detector
+ * 			interrupts and touch slider values with their time, checkpoints of the LED output and
+ * 			snapshots of the state machine so that a run can be replayed by the host simulator
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef INPUTREC_H_
+#define INPUTREC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "statemachine.h"
+
+#define INPUTREC_MAGIC				(0x1A9E7EC1u) /*Changed with the layout*/
+#define INPUTREC_EXPORT_COMMAND		('r') /*Character received on the debug UART which exports this run*/
+#define INPUTREC_SAVED_COMMAND		('p') /*Exports the run before the last reset, saved in flash*/
+#define INPUTREC_FLASH_SIZE			(2048) /*Two flash sectors hold the saved recording*/
+#define INPUTREC_EVENTS				(226) /*The latest events are kept, older ones are overwritten*/
+#define INPUTREC_CHECKPOINT_TICKS	(160) /*Output checkpoint at most every 10 seconds*/
+#define INPUTREC_SNAPSHOT_TICKS		(960) /*State machine snapshot every 60 seconds...*/
+#define INPUTREC_SNAPSHOT_EVENTS	(INPUTREC_EVENTS / 2) /*...or sooner, before the events after it are overwritten*/
+
+/*Event types*/
+#define INPUTREC_SWITCH				(1) /*PORTD interrupt of the switch on PTD3*/
+#define INPUTREC_DETECTOR			(2) /*PORTD interrupt of the vehicle detector on PTD2*/
+#define INPUTREC_TOUCH				(3) /*Touch_Scan_LH() value, when it crosses SLIDER_PRESSED_MINIMUM_VALUE*/
+#define INPUTREC_OUTPUT				(4) /*Hash of the LED colour changes since the last checkpoint*/
+
+#define INPUTREC_TYPE_BITS			(4)
+#define INPUTREC_STAMP(tick, type)	(((uint32_t)(tick) << INPUTREC_TYPE_BITS) | (type))
+#define INPUTREC_TICK(event)		((event)->stamp >> INPUTREC_TYPE_BITS)
+#define INPUTREC_TYPE(event)		((event)->stamp & ((1u << INPUTREC_TYPE_BITS) - 1))
+
+typedef struct
+{
+	uint32_t stamp;				/*now() << INPUTREC_TYPE_BITS | INPUTREC_ type*/
+	uint16_t subTick;			/*Time since the tick in 65536ths of a tick*/
+	uint16_t value;				/*Type specific value*/
+} inputrec_event_t;
+
+/*Bytes of sm_ctx_t from stateStart to fadeStep, exported with the crosswalk policy and the GO
+  timing. The config pointer and the padding after fadeStep differ between the board and the host*/
+#define INPUTREC_CONTEXT_STATE_BYTES	(offsetof(sm_ctx_t, fadeStep) + sizeof(int8_t) - offsetof(sm_ctx_t, stateStart))
+#define INPUTREC_CONTEXT_WORDS		((INPUTREC_CONTEXT_STATE_BYTES + sizeof(crosswalk_policy_t) + \
+									  sizeof(adaptive_timing_t)) / sizeof(uint32_t))
+
+/*State at the end of a main loop iteration which sampled the inputs, a replay starts from it
+  when the events before it were overwritten*/
+typedef struct
+{
+	uint32_t taken;				/*Snapshots taken since boot, 0 for none or one being written*/
+	uint32_t count;				/*Events recorded before it*/
+	ticktime tick;
+	uint32_t outputColour;		/*Output checkpoint of the recorder*/
+	uint32_t outputHash;
+	ticktime checkpointTick;
+	int32_t touchPressed;		/*Side of the press threshold of the last touch slider value*/
+	sm_ctx_t context;			/*Instance of the firmware*/
+} inputrec_snapshot_t;
+
+typedef struct
+{
+	uint32_t magic;				/*INPUTREC_MAGIC while recording*/
+	uint32_t count;				/*Events recorded since boot, the last INPUTREC_EVENTS of them are kept*/
+	uint32_t resetReason;		/*RCM SRS1 << 8 | SRS0 of the reset which started the recording*/
+	uint32_t next;				/*Index of events written next, the oldest once count wrapped*/
+	inputrec_snapshot_t snapshot;
+	inputrec_event_t events[INPUTREC_EVENTS];
+} inputrec_t;
+
+extern inputrec_t inputRec;
+
+/*
+ * @brief Saves the recording of the previous run to flash and starts a new one
+ *
+ * Called once at startup after watchdog_init() and before the interrupts are enabled. A
+ * recording survives every reset but power on, the flash erase and program take about 50 msec
+ *
+ * @return void
+ */
+void inputrec_init(void);
+
+/*
+ * @brief Records an input interrupt, called from PORTD_IRQHandler
+ *
+ * @param1 INPUTREC_SWITCH or INPUTREC_DETECTOR
+ * @param2 type specific value
+ * @return void
+ */
+void inputrec_record(uint8_t type, uint16_t value);
+
+/*
+ * @brief Records a touch slider value when it is on the other side of the press threshold
+ * than the previous one, the state machine only compares it with the threshold
+ *
+ * @param value returned by Touch_Scan_LH()
+ * @return void
+ */
+void inputrec_touch(int value);
+
+/*
+ * @brief Adds a colour written to the LEDs to the output checkpoint, only changes count so
+ * that the number of main loop iterations in a tick does not matter
+ *
+ * @param1 red value
+ * @param2 green value
+ * @param3 blue value
+ * @return void
+ */
+void inputrec_output(uint16_t red, uint16_t green, uint16_t blue);
+
+/*
+ * @brief Takes a snapshot of the state machine when one is due, called at the end of every
+ * main loop iteration which sampled the inputs
+ *
+ * @param1 instance of the firmware
+ * @param2 tick of the iteration
+ * @return void
+ */
+void inputrec_snapshot(const sm_ctx_t *context, ticktime tick);
+
+/*
+ * @brief Loads a snapshot into the recorder and an instance, for a replay which starts from it
+ *
+ * @param1 snapshot
+ * @param2 events recorded before the replay starts
+ * @param3 instance, its config is kept
+ * @return void
+ */
+void inputrec_restore(const inputrec_snapshot_t *snapshot, uint32_t count, sm_ctx_t *context);
+
+/*
+ * @brief Byte offset in sm_ctx_t of a word of the exported context
+ *
+ * @param index of the word, below INPUTREC_CONTEXT_WORDS
+ * @return offset
+ */
+uint32_t inputrec_context_offset(uint32_t index);
+
+/*
+ * @brief Prints a recording to the console, the format read by "sim --replay"
+ *
+ * @param recording to be printed
+ * @return void
+ */
+void inputrec_export(const inputrec_t *recording);
+
+/*
+ * @brief Prints the recording saved in flash to the console
+ *
+ * @return void
+ */
+void inputrec_export_saved(void);
+
+#endif /* INPUTREC_H_ */
@@ -17,11 +17,39 @@
 
 
 #include <stdio.h>
+#include "logfmt.h"
+#include "logtok.h"
+#if defined(TELEMETRY)
+#include "telemetry.h"
+#endif
 
-#ifdef DEBUG
-#  define LOG printf
+/*
+ * Defining LOG_TOKENIZED sends a 16 bit token and the arguments of every message instead of
+ * the text, tools/detokenize.py turns the captured UART stream back into text using the .axf.
+ * Strings passed to %s must be declared with LOG_STRINGS so that they are tokenized as well
+ *
+ * With TELEMETRY the frames share the debug UART. A text message waits for the frame being
+ * sent and the next frame starts with a 0 byte, so tools/telemetry_collect.py skips the text as
+ * a console reply. Tokens are binary and would read as broken frames, they are compiled out
+ */
+#if defined(DEBUG) && defined(LOG_TOKENIZED)
+#  if defined(TELEMETRY)
+#    define LOG(...)
+#    define LOG_STRINGS
+#  else
+#    define LOG LOGTOK
+#    define LOG_STRINGS LOGTOK_SECTION
+#  endif
+#elif defined(DEBUG)
+#  if defined(TELEMETRY)
+#    define LOG(...) do { telemetry_flush(); logfmt_printf(__VA_ARGS__); } while (0)
+#  else
+#    define LOG logfmt_printf /*Integer-only formatter, see logfmt.h for the supported conversions*/
+#  endif
+#  define LOG_STRINGS
 #else
 #  define LOG(...)
+#  define LOG_STRINGS
 #endif
 
 
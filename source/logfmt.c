@@ -0,0 +1,394 @@
+/**
+ * @file    logfmt.c
+ * @brief   This source file consists of function definitions of a lightweight integer-only
+ * 			formatter used by the LOG macro in place of the general purpose printf
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "logfmt.h"
+
+#define MAX_DECIMAL_DIGITS		(10) /*Digits in 4294967295*/
+#define MAX_HEX_DIGITS			(8)
+#define NIBBLE_MASK				(0x0F)
+#define BITS_PER_NIBBLE			(4)
+#define BILLIONS_INDEX			(0)  /*8 times 10^9 does not fit in 32 bits*/
+#define WORD_BYTES				(4)
+#define WORD_ONES				(0x01010101u)
+#define WORD_HIGHS				(0x80808080u)
+#define WORD_PERCENTS			(0x25252525u) /*'%' in every byte*/
+
+/*Non zero if a byte of the word is 0*/
+#define HAS_ZERO_BYTE(word)		(((word) - WORD_ONES) & ~(word) & WORD_HIGHS)
+
+#if defined(__REDLIB__)
+extern int __sys_write(int handle, char *buffer, int size); /*Retargeted to the debug UART in fsl_debug_console.c*/
+#define STDOUT_HANDLE			(1)
+#endif
+
+/*Powers of ten from the most significant digit of a 32 bit value*/
+static const uint32_t powersOfTen[MAX_DECIMAL_DIGITS] = {
+	1000000000u, 100000000u, 10000000u, 1000000u, 100000u,
+	10000u, 1000u, 100u, 10u, 1u
+};
+
+uintptr_t logfmtHistory[LOGFMT_HISTORY];
+uint32_t logfmtHistoryCount;
+
+static const char hexDigitsLower[] = "0123456789abcdef";
+static const char hexDigitsUpper[] = "0123456789ABCDEF";
+
+/*
+ * @brief Converts an unsigned value to decimal without using division
+ *
+ * Every digit is found by subtracting 8, 4, 2 and 1 times its power of ten, so a
+ * 32 bit value costs at most 40 compares irrespective of the value
+ *
+ * @param1 buffer of at least 10 characters, no null character is appended
+ * @param2 value to be converted
+ * @return number of digits stored
+ */
+uint32_t logfmt_u32_to_dec(char *buffer, uint32_t value)
+{
+	uint32_t digits = 0;
+	int index = 0;
+
+	while ((index < MAX_DECIMAL_DIGITS - 1) && (value < powersOfTen[index])) /*No leading zeros*/
+	{
+		index++;
+	}
+
+	for (; index < MAX_DECIMAL_DIGITS; index++)
+	{
+		uint32_t power = powersOfTen[index];
+		uint32_t digit = 0;
+
+		if ((index != BILLIONS_INDEX) && (value >= (power << 3)))
+		{
+			value -= (power << 3);
+			digit = 8;
+		}
+		if (value >= (power << 2))
+		{
+			value -= (power << 2);
+			digit += 4;
+		}
+		if (value >= (power << 1))
+		{
+			value -= (power << 1);
+			digit += 2;
+		}
+		if (value >= power)
+		{
+			value -= power;
+			digit += 1;
+		}
+		buffer[digits++] = (char)('0' + digit);
+	}
+	return digits;
+}
+
+/*
+ * @brief Converts an unsigned value to hexadecimal
+ *
+ * @param1 buffer of at least 8 characters, no null character is appended
+ * @param2 value to be converted
+ * @param3 true for upper case digits
+ * @return number of digits stored
+ */
+static uint32_t u32_to_hex(char *buffer, uint32_t value, bool upperCase)
+{
+	const char *hexDigits = upperCase ? hexDigitsUpper : hexDigitsLower;
+	uint32_t digits = 0;
+	int shift;
+
+	for (shift = (MAX_HEX_DIGITS - 1) * BITS_PER_NIBBLE; shift >= 0; shift -= BITS_PER_NIBBLE)
+	{
+		uint32_t nibble = (value >> shift) & NIBBLE_MASK;
+		if ((nibble != 0) || (digits != 0) || (shift == 0))
+		{
+			buffer[digits++] = hexDigits[nibble];
+		}
+	}
+	return digits;
+}
+
+/*
+ * @brief Copies the text of the format up to the next conversion or its end
+ *
+ * The words of the format are checked for a '%' or a 0 four characters at a time, a byte
+ * loop takes three compares per character. The format is read in aligned words, which never
+ * cross the end of the memory holding it
+ *
+ * @param1 where the text goes
+ * @param2 format at the text
+ * @param3 characters which fit
+ * @return characters copied
+ */
+static uint32_t copy_text(char *out, const char *format, uint32_t space)
+{
+	uint32_t count = 0;
+	char c;
+
+	while ((((uintptr_t)&format[count] % WORD_BYTES) != 0) && (count < space))
+	{
+		c = format[count];
+		if ((c == '%') || (c == '\0'))
+		{
+			return count;
+		}
+		out[count++] = c;
+	}
+	while ((space - count) >= WORD_BYTES)
+	{
+		uint32_t word;
+
+		memcpy(&word, __builtin_assume_aligned(&format[count], WORD_BYTES), WORD_BYTES);
+		if (HAS_ZERO_BYTE(word) || HAS_ZERO_BYTE(word ^ WORD_PERCENTS))
+		{
+			break;
+		}
+		memcpy(&out[count], &word, WORD_BYTES);
+		count += WORD_BYTES;
+	}
+	while ((count < space) && ((c = format[count]) != '%') && (c != '\0'))
+	{
+		out[count++] = c;
+	}
+	return count;
+}
+
+/*
+ * @brief va_list version of logfmt_snprintf()
+ *
+ * @param1 buffer to store the formatted line
+ * @param2 size of the buffer including the terminating null character
+ * @param3 format string
+ * @param4 arguments matching the format string
+ * @return number of characters stored excluding the terminating null character
+ */
+int logfmt_vsnprintf(char *buffer, uint32_t size, const char *format, va_list args)
+{
+	uint32_t length = 0;
+	uint32_t last;
+
+	if ((buffer == NULL) || (size == 0))
+	{
+		return 0;
+	}
+	last = size - 1; /*Space for the null character*/
+
+	while ((*format != '\0') && (length < last))
+	{
+		char digits[MAX_DECIMAL_DIGITS + 1]; /*Sign and digits of a converted number*/
+		const char *field = digits;
+		uint32_t fieldLength = 0;
+		uint32_t width = 0;
+		char pad = ' ';
+		bool leftAlign = false;
+		bool negative = false;
+		bool isLong = false;
+
+		if (*format != '%')
+		{
+			uint32_t count = copy_text(&buffer[length], format, last - length);
+
+			length += count;
+			format += count;
+			continue;
+		}
+		format++;
+
+		if ((format[0] == 'l') && (format[1] == 'd'))	/*The time of every message, no flags or width*/
+		{
+			long value = va_arg(args, long);
+			uint32_t magnitude = (uint32_t)value;
+
+			if (value < 0)
+			{
+				digits[fieldLength++] = '-';
+				magnitude = 0u - magnitude;
+			}
+			fieldLength += logfmt_u32_to_dec(&digits[fieldLength], magnitude);
+			format += 2;
+			while ((fieldLength > 0) && (length < last))
+			{
+				buffer[length++] = *field++;
+				fieldLength--;
+			}
+			continue;
+		}
+
+		while ((*format == '-') || (*format == '0'))
+		{
+			if (*format == '-')
+			{
+				leftAlign = true;
+			}
+			else
+			{
+				pad = '0';
+			}
+			format++;
+		}
+		if (leftAlign)
+		{
+			pad = ' ';		/*Zeros are never added on the right*/
+		}
+		while ((*format >= '0') && (*format <= '9'))
+		{
+			width = (width << 3) + (width << 1) + (uint32_t)(*format++ - '0'); /*width*10 without multiply*/
+		}
+		if (*format == 'l')
+		{
+			isLong = true;
+			format++;
+		}
+
+		switch (*format)
+		{
+			case 'd':
+			case 'i':
+			{
+				long value = isLong ? va_arg(args, long) : va_arg(args, int);
+				uint32_t magnitude = (uint32_t)value;
+				if (value < 0)
+				{
+					negative = true;
+					digits[fieldLength++] = '-';
+					magnitude = 0u - magnitude;
+				}
+				fieldLength += logfmt_u32_to_dec(&digits[fieldLength], magnitude);
+			}
+			break;
+
+			case 'u':
+				fieldLength = logfmt_u32_to_dec(digits, isLong ? (uint32_t)va_arg(args, unsigned long)
+															   : va_arg(args, unsigned int));
+			break;
+
+			case 'x':
+			case 'X':
+				fieldLength = u32_to_hex(digits, isLong ? (uint32_t)va_arg(args, unsigned long)
+													: va_arg(args, unsigned int), (*format == 'X'));
+			break;
+
+			case 'c':
+				digits[0] = (char)va_arg(args, int);
+				fieldLength = 1;
+			break;
+
+			case 's':
+				field = va_arg(args, const char *);
+				if (field == NULL)
+				{
+					field = "(null)";
+				}
+				while (field[fieldLength] != '\0')
+				{
+					fieldLength++;
+				}
+			break;
+
+			case '%':
+				digits[0] = '%';
+				fieldLength = 1;
+			break;
+
+			default: /*Unsupported conversion, copied as it is*/
+				digits[0] = '%';
+				fieldLength = 1;
+				format--;
+				width = 0;
+			break;
+		}
+		format++;
+
+		width = (width > fieldLength) ? (width - fieldLength) : 0;
+		if (negative && (pad == '0') && (length < last))
+		{
+			buffer[length++] = *field++;	/*The sign goes before the zeros*/
+			fieldLength--;
+		}
+		while (!leftAlign && (width > 0) && (length < last))
+		{
+			buffer[length++] = pad;
+			width--;
+		}
+		while ((fieldLength > 0) && (length < last))
+		{
+			buffer[length++] = *field++;
+			fieldLength--;
+		}
+		while ((width > 0) && (length < last))
+		{
+			buffer[length++] = ' ';
+			width--;
+		}
+	}
+	buffer[length] = '\0';
+	return (int)length;
+}
+
+/*
+ * @brief Formats a log line into the buffer
+ *
+ * @param1 buffer to store the formatted line
+ * @param2 size of the buffer including the terminating null character
+ * @param3 format string
+ * @return number of characters stored excluding the terminating null character
+ */
+int logfmt_snprintf(char *buffer, uint32_t size, const char *format, ...)
+{
+	va_list args;
+	int length;
+
+	va_start(args, format);
+	length = logfmt_vsnprintf(buffer, size, format, args);
+	va_end(args);
+	return length;
+}
+
+/*
+ * @brief Formats a log line on the stack and sends it to the console through logfmt_write()
+ *
+ * @param format string followed by the arguments
+ * @return number of characters written
+ */
+int logfmt_printf(const char *format, ...)
+{
+	char line[LOGFMT_LINE_MAX];
+	va_list args;
+	int length;
+
+	logfmt_history_push((uintptr_t)format);
+	va_start(args, format);
+	length = logfmt_vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	logfmt_write(line, (uint32_t)length);
+	return length;
+}
+
+/*
+ * @brief Sends a formatted line to the console
+ *
+ * The whole line is handed to the UART in one call instead of one call per character
+ *
+ * @param1 characters to be sent
+ * @param2 number of characters
+ * @return void
+ */
+__attribute__((weak)) void logfmt_write(const char *buffer, uint32_t length)
+{
+#if defined(__REDLIB__)
+	__sys_write(STDOUT_HANDLE, (char *)buffer, (int)length);
+#else
+	fwrite(buffer, 1, length, stdout);
+#endif
+}
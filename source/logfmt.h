@@ -0,0 +1,119 @@
+/**
+ * @file    logfmt.h
+ * @brief   This header file consists of function prototypes of a lightweight integer-only
+ * 			formatter used by the LOG macro in place of the general purpose printf
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef LOGFMT_H_
+#define LOGFMT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#define LOGFMT_LINE_MAX		(96) /*Longest log line formatted in one call, longer lines are truncated*/
+#define LOGFMT_HISTORY		(8)  /*Most recent log records kept for the crash dump*/
+
+/*
+ * Format string address of the most recent log records, or the token in a LOG_TOKENIZED
+ * build, indexed by logfmtHistoryCount modulo LOGFMT_HISTORY
+ */
+extern uintptr_t logfmtHistory[LOGFMT_HISTORY];
+extern uint32_t logfmtHistoryCount;
+
+/*
+ * @brief Formats a log line into the buffer
+ *
+ * Only the conversions used by the log messages are supported: %d %i %u %x %X %c %s %%
+ * with an optional 'l' length modifier, '-' and '0' flags and field width. The format string is
+ * checked against the arguments at compile time through the printf format attribute and
+ * decimal conversion is done without division since the M0+ has no divide instruction
+ *
+ * @param1 buffer to store the formatted line
+ * @param2 size of the buffer including the terminating null character
+ * @param3 format string
+ * @return number of characters stored excluding the terminating null character
+ */
+int logfmt_snprintf(char *buffer, uint32_t size, const char *format, ...)
+	__attribute__((format(printf, 3, 4)));
+
+/*
+ * @brief va_list version of logfmt_snprintf()
+ *
+ * @param1 buffer to store the formatted line
+ * @param2 size of the buffer including the terminating null character
+ * @param3 format string
+ * @param4 arguments matching the format string
+ * @return number of characters stored excluding the terminating null character
+ */
+int logfmt_vsnprintf(char *buffer, uint32_t size, const char *format, va_list args);
+
+/*
+ * @brief Formats a log line on the stack and sends it to the console through logfmt_write()
+ *
+ * @param format string followed by the arguments
+ * @return number of characters written
+ */
+int logfmt_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/*
+ * @brief Converts an unsigned value to decimal without using division
+ *
+ * Every digit is found by subtracting 8, 4, 2 and 1 times its power of ten, so a
+ * 32 bit value costs at most 40 compares irrespective of the value
+ *
+ * @param1 buffer of at least 10 characters, no null character is appended
+ * @param2 value to be converted
+ * @return number of digits stored
+ */
+uint32_t logfmt_u32_to_dec(char *buffer, uint32_t value);
+
+/*
+ * @brief Remembers a log record for the crash dump
+ *
+ * @param record format string address or token
+ * @return void
+ */
+static inline void logfmt_history_push(uintptr_t record)
+{
+	logfmtHistory[logfmtHistoryCount % LOGFMT_HISTORY] = record;
+	logfmtHistoryCount++;
+}
+
+/*
+ * @brief Sends a formatted line to the console
+ *
+ * Defined weak so that a buffered or tokenized back end can replace it
+ *
+ * @param1 characters to be sent
+ * @param2 number of characters
+ * @return void
+ */
+void logfmt_write(const char *buffer, uint32_t length);
+
+/*
+ * @brief Checks logfmt_snprintf() against snprintf() for the conversions, flags and widths it
+ * 		  supports, negative numbers with width and zero padding among them
+ *
+ * Built only when LOGFMT_BENCHMARK is defined, prints the lines which differ
+ *
+ * @return true if every line matches
+ */
+bool logfmt_check(void);
+
+/*
+ * @brief Measures cycles per log line of logfmt_snprintf() against the SDK formatter of
+ * 		  DbgConsole_Printf(), the PRINTF of the SDK console, and the library snprintf()
+ *
+ * Built only when LOGFMT_BENCHMARK is defined, prints the result table to the console
+ *
+ * @return true if the output of the formatters matched
+ */
+bool logfmt_benchmark(void);
+
+#endif /* LOGFMT_H_ */
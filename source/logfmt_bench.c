@@ -0,0 +1,288 @@
+/**
+ * @file    logfmt_bench.c
+ * @brief   This source file consists of the microbenchmark comparing cycles per log line of
+ * 			logfmt_snprintf() against the SDK formatter behind PRINTF (DbgConsole_Printf) and
+ * 			the library snprintf(), and of the check of its output against snprintf()
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+/*Allow the benchmark to be added by setting a define (via command line)*/
+#if defined(LOGFMT_BENCHMARK)
+
+#include <stdio.h>
+#include <string.h>
+#include "logfmt.h"
+#include "timebase.h"
+#include "fsl_debug_console.h"
+
+#define BENCHMARK_ITERATIONS		(1000)
+#define LINES_PER_PASS				(3)
+
+/*Formatters compared*/
+#define FORMATTER_SDK				(0)		/*DbgConsole_PrintfFormattedData() of fsl_debug_console.c*/
+#define FORMATTER_LIBRARY			(1)
+#define FORMATTER_LOGFMT			(2)
+#define FORMATTERS					(3)
+
+#if defined(__arm__)
+#include "MKL25Z4.h"
+
+/*
+ * @brief Reads the SysTick down counter as a core cycle count
+ *
+ * @return core cycles, with a resolution of 16 cycles
+ */
+static uint32_t read_cycles(void)
+{
+	return (SysTick->LOAD - SysTick->VAL) * TIMEBASE_SYSTICK_DIVIDER;
+}
+
+/*
+ * @brief Cycles between two read_cycles() values, allowing for one SysTick reload
+ *
+ * @return elapsed core cycles
+ */
+static uint32_t elapsed_cycles(uint32_t start, uint32_t end)
+{
+	uint32_t period = (SysTick->LOAD + 1) * TIMEBASE_SYSTICK_DIVIDER;
+	return (end >= start) ? (end - start) : (end + period - start);
+}
+#else
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static uint32_t read_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return (uint32_t)__rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)now.tv_nsec; /*Nanoseconds where no cycle counter is available*/
+#endif
+}
+
+static uint32_t elapsed_cycles(uint32_t start, uint32_t end)
+{
+	return end - start;
+}
+#endif
+
+/*Representative lines from statemachine.c*/
+static const char lineState[] = "\nChanging from STOP to TRANSITION_TO_GO state at %ld msec";
+static const char lineName[] = "\n Currently in %s STATE at %ld msec";
+static const char lineHex[] = "\nColour 0x%02x%02x%02x at %ld msec";
+
+static const char *const formatterNames[FORMATTERS] = { "DbgConsole", "snprintf", "logfmt" };
+
+/*
+ * @brief Formats a line with an int argument and checks it against snprintf()
+ *
+ * @param1 format string
+ * @param2 argument
+ * @return true if logfmt_snprintf() gives the same text
+ */
+static bool check_int(const char *format, int value)
+{
+	char expected[LOGFMT_LINE_MAX];
+	char actual[LOGFMT_LINE_MAX];
+
+	snprintf(expected, sizeof(expected), format, value);
+	logfmt_snprintf(actual, sizeof(actual), format, value);
+	if (strcmp(expected, actual) != 0)
+	{
+		printf("\nlogfmt \"%s\" of %d: \"%s\" != \"%s\"", format, value, actual, expected);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * @brief Checks logfmt_snprintf() against snprintf() for the conversions, flags and widths it
+ * 		  supports, negative numbers with width and zero padding among them
+ *
+ * @return true if every line matches
+ */
+bool logfmt_check(void)
+{
+	static const char *const intFormats[] = {
+		"%d", "%5d", "%05d", "%-5d", "%-05d", "%2d", "%02d", "%i", "%u", "%8u", "%08u", "%-8u",
+		"%x", "%4x", "%04x", "%-4x", "%X", "%08X", "%c|"
+	};
+	static const int values[] = { 0, 7, -7, 42, -42, 12345, -12345, 0x7FFFFFFF, -0x7FFFFFFF - 1 };
+	char expected[LOGFMT_LINE_MAX];
+	char actual[LOGFMT_LINE_MAX];
+	bool passed = true;
+	uint32_t format;
+	uint32_t value;
+
+	for (format = 0; format < sizeof(intFormats) / sizeof(intFormats[0]); format++)
+	{
+		for (value = 0; value < sizeof(values) / sizeof(values[0]); value++)
+		{
+			if ((intFormats[format][1] == 'c') && ((values[value] < ' ') || (values[value] > '~')))
+			{
+				continue;
+			}
+			passed &= check_int(intFormats[format], values[value]);
+		}
+	}
+
+	snprintf(expected, sizeof(expected), "%-6s|%6s|%ld|%08lx|%5lu%%", "GO", "STOP", -123456L, 0xBEEFUL, 99UL);
+	logfmt_snprintf(actual, sizeof(actual), "%-6s|%6s|%ld|%08lx|%5lu%%", "GO", "STOP", -123456L, 0xBEEFUL, 99UL);
+	if (strcmp(expected, actual) != 0)
+	{
+		printf("\nlogfmt strings and longs: \"%s\" != \"%s\"", actual, expected);
+		passed = false;
+	}
+	return passed;
+}
+
+/*
+ * @brief Formats a representative line
+ *
+ * @param1 FORMATTER_ ID
+ * @param2 buffer of LOGFMT_LINE_MAX characters
+ * @param3 line 0 to LINES_PER_PASS - 1
+ * @param4 time argument
+ * @return void
+ */
+static void format_line(uint32_t formatter, char *line, uint32_t lineId, long timeMs)
+{
+	if (formatter == FORMATTER_SDK)
+	{
+		if (lineId == 0)
+		{
+			DbgConsole_BenchmarkSprintf(line, lineState, timeMs);
+		}
+		else if (lineId == 1)
+		{
+			DbgConsole_BenchmarkSprintf(line, lineName, "TRANSITION_TO_CROSSWALK", timeMs);
+		}
+		else
+		{
+			DbgConsole_BenchmarkSprintf(line, lineHex, 0x61u, 0x1Eu, 0x3Cu, timeMs);
+		}
+	}
+	else if (formatter == FORMATTER_LIBRARY)
+	{
+		if (lineId == 0)
+		{
+			snprintf(line, LOGFMT_LINE_MAX, lineState, timeMs);
+		}
+		else if (lineId == 1)
+		{
+			snprintf(line, LOGFMT_LINE_MAX, lineName, "TRANSITION_TO_CROSSWALK", timeMs);
+		}
+		else
+		{
+			snprintf(line, LOGFMT_LINE_MAX, lineHex, 0x61u, 0x1Eu, 0x3Cu, timeMs);
+		}
+	}
+	else
+	{
+		if (lineId == 0)
+		{
+			logfmt_snprintf(line, LOGFMT_LINE_MAX, lineState, timeMs);
+		}
+		else if (lineId == 1)
+		{
+			logfmt_snprintf(line, LOGFMT_LINE_MAX, lineName, "TRANSITION_TO_CROSSWALK", timeMs);
+		}
+		else
+		{
+			logfmt_snprintf(line, LOGFMT_LINE_MAX, lineHex, 0x61u, 0x1Eu, 0x3Cu, timeMs);
+		}
+	}
+}
+
+/*
+ * @brief Runs every representative line through a formatter
+ *
+ * @param1 FORMATTER_ ID
+ * @param2 time argument, varied so that no call is optimised away
+ * @return cycles taken by the three lines
+ */
+static uint32_t format_lines(uint32_t formatter, long timeMs)
+{
+	char line[LOGFMT_LINE_MAX];
+	uint32_t start = read_cycles();
+	uint32_t lineId;
+
+	for (lineId = 0; lineId < LINES_PER_PASS; lineId++)
+	{
+		format_line(formatter, line, lineId, timeMs);
+	}
+	return elapsed_cycles(start, read_cycles());
+}
+
+/*
+ * @brief Measures cycles per log line of logfmt_snprintf() against the SDK formatter of
+ * 		  DbgConsole_Printf(), the PRINTF of the SDK console, and the library snprintf()
+ *
+ * Every formatter must give the text of snprintf() for the comparison to count, the result
+ * table is printed to the console. The SDK formatter is timed without its UART, it calls a
+ * function for every character which here stores it
+ *
+ * @return true if the output of the formatters matched
+ */
+bool logfmt_benchmark(void)
+{
+	char expected[LOGFMT_LINE_MAX];
+	char actual[LOGFMT_LINE_MAX];
+	uint32_t cycles[FORMATTERS];
+	uint32_t formatter;
+	uint32_t lineId;
+	long timeMs;
+
+	if (!logfmt_check())
+	{
+		return false;
+	}
+	for (formatter = 0; formatter < FORMATTERS; formatter++)
+	{
+		for (lineId = 0; lineId < LINES_PER_PASS; lineId++)
+		{
+			format_line(FORMATTER_LIBRARY, expected, lineId, 123456L);
+			format_line(formatter, actual, lineId, 123456L);
+			if (strcmp(expected, actual) != 0)
+			{
+				printf("\n%s output mismatch: \"%s\" != \"%s\"", formatterNames[formatter], actual, expected);
+				return false;
+			}
+		}
+	}
+
+	memset(cycles, 0xFF, sizeof(cycles));
+	for (timeMs = 0; timeMs < BENCHMARK_ITERATIONS; timeMs++)
+	{
+		for (formatter = 0; formatter < FORMATTERS; formatter++)
+		{
+			uint32_t passCycles = format_lines(formatter, timeMs * 62);
+
+			if (passCycles < cycles[formatter])
+			{
+				cycles[formatter] = passCycles; /*Fastest pass, without the interrupts and preemption*/
+			}
+		}
+	}
+
+	printf("\nformatter   cycles/line  vs DbgConsole");
+	for (formatter = 0; formatter < FORMATTERS; formatter++)
+	{
+		uint32_t perLine = cycles[formatter] / LINES_PER_PASS;
+
+		printf("\n%-11s %11lu  %3lu%%", formatterNames[formatter], (unsigned long)perLine,
+			   (unsigned long)(100u * (uint64_t)cycles[formatter] / cycles[FORMATTER_SDK]));
+	}
+	printf("\n");
+	return true;
+}
+
+#endif /* defined(LOGFMT_BENCHMARK) */
@@ -0,0 +1,86 @@
+/**
+ * @file    logtok.c
+ * @brief   This source file consists of function definitions which encode tokenized log
+ * 			records and send them to the console
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+/*Allow tokenized logging to be added by setting a define (via command line)*/
+#if defined(LOG_TOKENIZED)
+
+#include "logtok.h"
+#include "logfmt.h"
+
+#define VARINT_MORE			(0x80) /*Set in every varint byte except the last one*/
+#define VARINT_MASK			(0x7F)
+#define VARINT_SHIFT		(7)
+#define BYTE_MASK			(0xFF)
+#define BYTE_SHIFT			(8)
+
+/*
+ * @brief Encodes a log record into the buffer without sending it
+ *
+ * @param1 buffer of at least LOGTOK_RECORD_MAX bytes
+ * @param2 token of the format string
+ * @param3 arguments of the log message
+ * @param4 number of arguments
+ * @return number of bytes stored
+ */
+uint32_t logtok_encode(uint8_t *buffer, uint16_t token, const uintptr_t *args, uint32_t count)
+{
+	uint32_t length = 0;
+	uint32_t index;
+
+	if (count > LOGTOK_MAX_ARGS)
+	{
+		count = LOGTOK_MAX_ARGS;
+	}
+
+	buffer[length++] = LOGTOK_SYNC;
+	buffer[length++] = (uint8_t)(token & BYTE_MASK);
+	buffer[length++] = (uint8_t)(token >> BYTE_SHIFT);
+
+	for (index = 0; index < count; index++)
+	{
+		uintptr_t arg = args[index];
+		uint32_t value;
+
+		/*Strings in the token section are sent as their token*/
+		if ((arg >= (uintptr_t)__start_log_tokens) && (arg < (uintptr_t)__stop_log_tokens))
+		{
+			arg = LOGTOK_TOKEN(arg);
+		}
+		value = (uint32_t)arg;
+
+		while (value > VARINT_MASK)
+		{
+			buffer[length++] = (uint8_t)((value & VARINT_MASK) | VARINT_MORE);
+			value >>= VARINT_SHIFT;
+		}
+		buffer[length++] = (uint8_t)value;
+	}
+	return length;
+}
+
+/*
+ * @brief Encodes a log record and sends it to the console through logfmt_write()
+ *
+ * @param1 token of the format string
+ * @param2 arguments of the log message
+ * @param3 number of arguments
+ * @return void
+ */
+void logtok_emit(uint16_t token, const uintptr_t *args, uint32_t count)
+{
+	uint8_t record[LOGTOK_RECORD_MAX];
+	uint32_t length = logtok_encode(record, token, args, count);
+
+	logfmt_history_push(token);
+	logfmt_write((const char *)record, length);
+}
+
+#endif /* defined(LOG_TOKENIZED) */
@@ -0,0 +1,83 @@
+/**
+ * @file    logtok.h
+ * @brief   This header file consists of the tokenized log macro and function prototypes which
+ * 			send a 16 bit token and the arguments instead of the formatted log line
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef LOGTOK_H_
+#define LOGTOK_H_
+
+#include <stdint.h>
+
+/*
+ * Format strings are placed in the log_tokens section which ld/log_tokens.ld marks as INFO
+ * at address 0, so it is kept in the .axf for tools/detokenize.py but never loaded into
+ * flash. The token of a string is its offset in the section
+ */
+#define LOGTOK_SECTION				__attribute__((section("log_tokens")))
+
+#define LOGTOK_SYNC					(0xA5) /*First byte of every record*/
+#define LOGTOK_MAX_ARGS				(4)
+#define LOGTOK_RECORD_MAX			(3 + LOGTOK_MAX_ARGS * 5) /*Sync, token and 5 varint bytes per argument*/
+
+extern const char __start_log_tokens[];
+extern const char __stop_log_tokens[];
+
+/*Token of a string placed in the log_tokens section*/
+#define LOGTOK_TOKEN(string)		((uint16_t)((uintptr_t)(string) - (uintptr_t)__start_log_tokens))
+
+/*Counting and casting up to LOGTOK_MAX_ARGS arguments*/
+#define LOGTOK_NARGS(...)			LOGTOK_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOGTOK_NARGS_(z, a, b, c, d, n, ...) n
+#define LOGTOK_CAT(a, b)			LOGTOK_CAT_(a, b)
+#define LOGTOK_CAT_(a, b)			a##b
+#define LOGTOK_ARGS_0()
+#define LOGTOK_ARGS_1(a)			, (uintptr_t)(a)
+#define LOGTOK_ARGS_2(a, b)			, (uintptr_t)(a), (uintptr_t)(b)
+#define LOGTOK_ARGS_3(a, b, c)		, (uintptr_t)(a), (uintptr_t)(b), (uintptr_t)(c)
+#define LOGTOK_ARGS_4(a, b, c, d)	, (uintptr_t)(a), (uintptr_t)(b), (uintptr_t)(c), (uintptr_t)(d)
+
+/*
+ * @brief Sends a log record made of the format string token and the arguments
+ *
+ * The format string never reaches the target memory, %s arguments must point into the
+ * log_tokens section (see LOG_STRINGS in log.h) and are sent as tokens as well
+ */
+#define LOGTOK(format, ...)																\
+	do																					\
+	{																					\
+		static const char logtokFormat[] LOGTOK_SECTION = format;						\
+		const uintptr_t logtokArgs[] = { 0 LOGTOK_CAT(LOGTOK_ARGS_, LOGTOK_NARGS(__VA_ARGS__))(__VA_ARGS__) }; \
+		logtok_emit(LOGTOK_TOKEN(logtokFormat), &logtokArgs[1], LOGTOK_NARGS(__VA_ARGS__));	\
+	} while (0)
+
+/*
+ * @brief Encodes a log record and sends it to the console through logfmt_write()
+ *
+ * The record is the sync byte, the token in little endian and every argument as an
+ * unsigned LEB128 varint, so a time in msec costs 3 bytes instead of its decimal text
+ *
+ * @param1 token of the format string
+ * @param2 arguments of the log message
+ * @param3 number of arguments
+ * @return void
+ */
+void logtok_emit(uint16_t token, const uintptr_t *args, uint32_t count);
+
+/*
+ * @brief Encodes a log record into the buffer without sending it
+ *
+ * @param1 buffer of at least LOGTOK_RECORD_MAX bytes
+ * @param2 token of the format string
+ * @param3 arguments of the log message
+ * @param4 number of arguments
+ * @return number of bytes stored
+ */
+uint32_t logtok_encode(uint8_t *buffer, uint16_t token, const uintptr_t *args, uint32_t count);
+
+#endif /* LOGTOK_H_ */
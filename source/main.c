@@ -18,6 +18,7 @@
 #include "peripherals.h"
 #include "pin_mux.h"
 #include "clock_config.h"
+#include "fsl_clock.h"
 #include "MKL25Z4.h"
 #include "fsl_debug_console.h"
 #include <stdbool.h>
@@ -26,6 +27,21 @@
 #include "timer.h"
 #include "statemachine.h"
 #include "log.h"
+#include "phase_controller.h"
+#include "faultlog.h"
+#include "watchdog.h"
+#include "crashdump.h"
+#include "mtb.h"
+#include "cycle_bench.h"
+#include "inputrec.h"
+#include "greenwave.h"
+#include "telemetry.h"
+#include "night_mode.h"
+#include "timebase.h"
+#include "boot.h"
+#include "console.h"
+#include "metrics.h"
+#include "update.h"
 
 /*
  * @brief The main function initializes various modules and calls the state machine
@@ -39,41 +55,117 @@
 
 int main(void)
 {
+    boot_init();	/*The boot is timed from ResetISR, boot_report() prints the steps*/
+
+/*Allow the boot without the sequencer to be built by setting a define (via command line),
+  to measure the time to first light the sequencer saves*/
+#if defined(BOOT_SEQUENTIAL)
+  	/*Initialize board hardware, Auto Generated Code */
+    BOARD_InitBootPins(); /*Configures pin routing and optionally pin electrical features*/
+    boot_clock_sequential(); /*BOARD_InitBootClocks(), waits for the crystal and the PLL lock*/
+    BOARD_InitBootPeripherals(); /*Set up and initialize all required blocks and functions
+    							 related to the peripherals hardware*/
+#else
+    /*
+     * @brief Flashes the fail-safe red on the reset clock. The crystal and the PLL started in
+     * ResetISR lock while the pins, the fault log and the watchdog are set up
+     *
+     * @return void
+     */
+    boot_first_light();
   	/*Initialize board hardware, Auto Generated Code */
     BOARD_InitBootPins(); /*Configures pin routing and optionally pin electrical features*/
-    BOARD_InitBootClocks(); /*Initialize clock divider registers and setting up oscillators*/
     BOARD_InitBootPeripherals(); /*Set up and initialize all required blocks and functions
     							 related to the peripherals hardware*/
+#endif
+
+    /*
+     * @brief Keeps the fault log of the previous run, printed when it holds faults. The reason
+     * of this reset is added to it and the COP is started when WATCHDOG is defined
+     *
+     * @return void
+     */
+    faultlog_init();
+    watchdog_init();
+
+    /*
+     * @brief Debug console commands of the features without an init, the others register
+     * theirs in their init
+     *
+     * @return void
+     */
+    console_register(METRICS_REPORT_COMMAND,metrics_report);
+    console_register(MTB_EXPORT_COMMAND,mtb_trace_export);
+#if defined(FIRMWARE_UPDATE)
+    console_register(UPDATE_COMMAND,update_run);
+#endif
+
+#if !defined(BOOT_SEQUENTIAL)
+    /*
+     * @brief Waits for the rest of the PLL lock and moves to the 48 MHz RUN profile, the LED
+     * moves to MCGPLLCLK/2 with its colour
+     *
+     * @return void
+     */
+    boot_clock_finish();
+#endif
 #ifndef BOARD_INIT_DEBUG_CONSOLE_PERIPHERAL
     BOARD_InitDebugConsole();  /* Initialize FSL debug console. */
 #endif
+#if defined(BOOT_SEQUENTIAL)
+    crashdump_init();		/*Prints a crash dump of the HardFault handler and saves it to flash*/
+#endif
+#if defined(INPUT_RECORD)
+    inputrec_init();		/*Saves the inputs of the previous run to flash and records this run*/
+#endif
+    if(mtbFrozen.magic == MTB_FROZEN_MAGIC)
+    {
+    	mtb_trace_export();		/*Branches up to the fault of the previous run*/
+    }
+#if !defined(MTB_TRACE_PREEMPTION)
+    mtb_trace_start(false);		/*Keeps the latest branches until a fault freezes them*/
+#endif
+
+#if defined(BOOT_SEQUENTIAL)
+    if(faultLog.count != 0)
+    {
+    	faultlog_report();
+    }
 
+    /*
+     * @brief: Derives the SysTick reload and the TPM prescaler and MOD from the clocks set by
+     * BOARD_InitBootClocks(), the TPM runs from MCGPLLCLK/2
+     *
+     * @return:false if the clocks cannot give a 62.5 ms tick and 500 Hz PWM, the 48 MHz
+     * values are kept
+     */
+    timebase_configure(SystemCoreClock,TIMEBASE_TPM_PLLFLL,CLOCK_GetFreq(kCLOCK_PllFllSelClk));
 
     /*
      * @brief: Initializes the Timer PWM module 2 channel 0 connected to red led (Port B 18)
-     * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
      * @return:void
      */
-    Init_Red_LED_PWM(PWM_PERIOD);
+    Init_Red_LED_PWM();
     /*
      * @brief: Initializes the Timer PWM module 2 channel 1 connected to green led (Port B 19)
-     * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
      * @return:void
      */
-    Init_Green_LED_PWM(PWM_PERIOD);
+    Init_Green_LED_PWM();
 
     /*
      * @brief: Initializes the Timer PWM module 0 channel 1 connected to blue led (Port D 1)
-     * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
      * @return:void
      */
-    Init_Blue_LED_PWM(PWM_PERIOD);
+    Init_Blue_LED_PWM();
+#endif
 
     /*
-     * @brief: Initializes the Systick timer Module with external clock frequency
+     * @brief: Initializes the Systick timer Module with external clock frequency, the boot
+     * timer until then
      *
      * @return:void
      */
+    boot_handover();
     Init_SysTick();
 
     /*
@@ -89,14 +181,106 @@ int main(void)
      * @return void
      */
     init_switch();
+
+#ifdef ADAPTIVE_TIMING
+    /*
+     * @brief Initializes the vehicle detector connected to PORTD 2 pin for the adaptive GO
+     *
+     * @return void
+     */
+    init_detector();
+#endif
+
+#ifdef GREEN_WAVE
+    /*
+     * @brief Initializes UART1 and UART2 for the cycle offset sync messages of the neighbouring
+     * controllers, the GO start follows the shared cycle
+     *
+     * @return void
+     */
+    greenwave_uart_init();
+#endif
+
+#ifdef TELEMETRY
+    /*
+     * @brief Empties the telemetry ring, a frame is sent to the debug UART every second from
+     * the main loop
+     *
+     * @return void
+     */
+    telemetry_init();
+#endif
+
+#ifdef NIGHT_MODE
+    /*
+     * @brief Follows the night schedule of night_mode.h, the LED flashes amber in VLPR at night
+     *
+     * @return void
+     */
+    night_mode_init(&nightDefaultConfig);
+#endif
+
+#ifdef LOGFMT_BENCHMARK
+    /*
+     * @brief Prints cycles per log line of the LOG formatter against the library printf
+     *
+     * @return void
+     */
+    logfmt_benchmark();
+#endif
+
+#ifdef CYCLE_BENCHMARK
+    /*
+     * @brief Prints cycles per call of the control hot paths and stops, the benchmark image
+     * built by "make -C Release cycle-bench"
+     *
+     * @return void
+     */
+    cycle_benchmark();
+    return 0;
+#endif
+
+#ifndef PHASE_CONTROLLER
+    /*
+     * @brief Shows the first frame of the traffic light sequence before the boot reports, the
+     * sequential boot lights the LED only here
+     *
+     * @return void
+     */
+    statemachine_init();
+    statemachine_poll();
+    boot_mark(BOOT_MARK_FIRST_FRAME);
+    boot_mark(BOOT_MARK_FIRST_LIGHT);
+#endif
+
+#if defined(BOOT_SEQUENTIAL)
+    boot_report();
+#else
+    /*
+     * @brief Prints the fault log and a crash dump of the previous run, saves the dump to
+     * flash and prints the boot times
+     *
+     * @return void
+     */
+    boot_deferred();
+#endif
     LOG("\nMain loop is starting");
 
+#ifdef PHASE_CONTROLLER
+    /*
+     * @brief Executes the ring and barrier phases of phase_table.h, phase 2 shown on the led
+     *
+     * @return void
+     */
+    phase_controller_run();
+#else
     /*
      * @brief Executes the traffic light sequence with cross-walk functionality
      *
      * @return void
      */
     statemachine();
+#endif
 
     return 0;
 }
@@ -0,0 +1,178 @@
+/**
+ * @file    metrics.c
+ * @brief   This source file consists of the function definitions which update and report the
+ * 			state machine metrics block
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "metrics.h"
+#include "logfmt.h"
+
+/*All zero, so that it is cleared with the .bss instead of being copied from flash*/
+sm_metrics_t smMetrics;
+
+/*
+ * @brief Records the entry of a new state and closes the time spent in the previous one
+ *
+ * @param state being entered
+ * @return void
+ */
+void metrics_state_enter(uint8_t newState)
+{
+	ticktime tick = now();
+	uint32_t stay = tick - smMetrics.stateEntered;
+
+	if (smMetrics.entries[smMetrics.state] != 0)
+	{
+		smMetrics.totalTicks[smMetrics.state] += stay;
+		if (stay > smMetrics.maxTicks[smMetrics.state])
+		{
+			smMetrics.maxTicks[smMetrics.state] = stay;
+		}
+	}
+	smMetrics.state = newState;
+	smMetrics.stateEntered = tick;
+	smMetrics.entries[newState]++;
+}
+
+/*
+ * @brief Records a crosswalk request
+ *
+ * @param true if the request was ignored because the crosswalk is already in progress
+ * @return void
+ */
+void metrics_crosswalk_request(bool ignored)
+{
+	smMetrics.crosswalkRequests++;
+	if (ignored)
+	{
+		smMetrics.crosswalkIgnored++;
+	}
+}
+
+/*
+ * @brief Records vehicle detector actuations
+ *
+ * @param actuations since the last sample
+ * @return void
+ */
+void metrics_actuations(uint32_t count)
+{
+	smMetrics.actuations += count;
+}
+
+/*
+ * @brief Counts one main loop iteration, the count is latched at every tick
+ *
+ * @return void
+ */
+void metrics_loop_iteration(void)
+{
+	ticktime tick = now();
+
+	if (tick != smMetrics.loopTick)
+	{
+		if (smMetrics.loopCounting)
+		{
+			/*No iteration at all when more than one tick has passed*/
+			uint32_t count = (tick == smMetrics.loopTick + 1) ? smMetrics.loopCount : 0;
+
+			smMetrics.loopIterations = count;
+			if (count > smMetrics.maxLoopIterations)
+			{
+				smMetrics.maxLoopIterations = count;
+			}
+			if ((count < smMetrics.minLoopIterations) || !smMetrics.loopMeasured)
+			{
+				smMetrics.minLoopIterations = count;
+			}
+			smMetrics.loopMeasured = true;
+		}
+		smMetrics.loopCounting = true;
+		smMetrics.loopTick = tick;
+		smMetrics.loopCount = 0;
+	}
+	smMetrics.loopCount++;
+}
+
+/*
+ * @brief Records the duration of a touch slider scan
+ *
+ * @param1 cycles_in_tick() before the scan
+ * @param2 cycles_in_tick() after the scan
+ * @return void
+ */
+void metrics_tsi_scan(uint32_t startCycles, uint32_t endCycles)
+{
+	uint32_t cycles = (endCycles >= startCycles) ? (endCycles - startCycles)
+												 : (endCycles + cycles_per_tick() - startCycles);
+
+	smMetrics.tsiScans++;
+	smMetrics.tsiScanCycles = cycles;
+	if (cycles > smMetrics.maxTsiScanCycles)
+	{
+		smMetrics.maxTsiScanCycles = cycles;
+	}
+}
+
+/*
+ * @brief Ticks spent in a state including the stay in progress
+ *
+ * @param state ID
+ * @return total ticks in the state
+ */
+uint32_t metrics_time_in_state(uint8_t stateId)
+{
+	uint32_t total = smMetrics.totalTicks[stateId];
+
+	if ((stateId == smMetrics.state) && (smMetrics.entries[stateId] != 0))
+	{
+		total += now() - smMetrics.stateEntered;
+	}
+	return total;
+}
+
+/*
+ * @brief Prints the metrics block to the console
+ *
+ * @return void
+ */
+void metrics_report(void)
+{
+	uint8_t stateId;
+
+	logfmt_printf("\r\nstate entries total_ticks max_ticks");
+	for (stateId = 0; stateId < SM_STATE_COUNT; stateId++)
+	{
+		if (smMetrics.entries[stateId] != 0)
+		{
+			logfmt_printf("\r\n%5u %7lu %11lu %9lu", stateId,
+						  (unsigned long)smMetrics.entries[stateId],
+						  (unsigned long)metrics_time_in_state(stateId),
+						  (unsigned long)smMetrics.maxTicks[stateId]);
+		}
+	}
+	logfmt_printf("\r\ncrosswalk requests %lu ignored %lu", (unsigned long)smMetrics.crosswalkRequests,
+				  (unsigned long)smMetrics.crosswalkIgnored);
+	logfmt_printf("\r\ndetector actuations %lu", (unsigned long)smMetrics.actuations);
+	logfmt_printf("\r\nloop iterations per tick %lu min %lu max %lu", (unsigned long)smMetrics.loopIterations,
+				  (unsigned long)smMetrics.minLoopIterations,
+				  (unsigned long)smMetrics.maxLoopIterations);
+	logfmt_printf("\r\ntsi scans %lu cycles %lu max %lu\r\n", (unsigned long)smMetrics.tsiScans,
+				  (unsigned long)smMetrics.tsiScanCycles, (unsigned long)smMetrics.maxTsiScanCycles);
+}
+
+/*
+ * @brief Clears all counters
+ *
+ * @return void
+ */
+void metrics_reset(void)
+{
+	memset(&smMetrics, 0, sizeof(smMetrics));
+}
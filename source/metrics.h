@@ -0,0 +1,109 @@
+/**
+ * @file    metrics.h
+ * @brief   This header file consists of the state machine metrics block and the function
+ * 			prototypes which update it from the transition sites in statemachine.c
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "statemachine.h"
+#include "timer.h"
+
+#define METRICS_REPORT_COMMAND		('m') /*Character received on the debug UART which prints the metrics*/
+
+/*Counters for capacity planning and field diagnostics, times are in ticks of 62.5 msec*/
+typedef struct
+{
+	uint32_t entries[SM_STATE_COUNT];		/*Number of times each state was entered*/
+	uint32_t totalTicks[SM_STATE_COUNT];	/*Total time spent in each state*/
+	uint32_t maxTicks[SM_STATE_COUNT];		/*Longest single stay in each state*/
+	uint32_t crosswalkRequests;				/*Button or slider presses seen*/
+	uint32_t crosswalkIgnored;				/*Presses batched into a pending or running pedestrian phase*/
+	uint32_t actuations;					/*Vehicle detector actuations*/
+	uint32_t loopIterations;				/*Main loop iterations in the last complete tick*/
+	uint32_t maxLoopIterations;
+	uint32_t minLoopIterations;				/*Valid once loopMeasured is set*/
+	uint32_t tsiScans;
+	uint32_t tsiScanCycles;					/*Duration of the last touch slider scan*/
+	uint32_t maxTsiScanCycles;
+	ticktime stateEntered;					/*Tick at which the state being timed was entered*/
+	ticktime loopTick;						/*Tick being counted by loopIterations*/
+	uint32_t loopCount;
+	uint8_t  state;							/*State being timed*/
+	bool     loopCounting;					/*Set once the first, partial, tick has passed*/
+	bool     loopMeasured;					/*Set once the first complete tick has been counted*/
+} sm_metrics_t;
+
+extern sm_metrics_t smMetrics;
+
+/*
+ * @brief Records the entry of a new state and closes the time spent in the previous one
+ *
+ * @param state being entered
+ * @return void
+ */
+void metrics_state_enter(uint8_t state);
+
+/*
+ * @brief Records a crosswalk request
+ *
+ * @param true if the request was ignored because the crosswalk is already in progress
+ * @return void
+ */
+void metrics_crosswalk_request(bool ignored);
+
+/*
+ * @brief Records vehicle detector actuations
+ *
+ * @param actuations since the last sample
+ * @return void
+ */
+void metrics_actuations(uint32_t count);
+
+/*
+ * @brief Counts one main loop iteration, the count is latched at every tick
+ *
+ * @return void
+ */
+void metrics_loop_iteration(void);
+
+/*
+ * @brief Records the duration of a touch slider scan
+ *
+ * @param1 cycles_in_tick() before the scan
+ * @param2 cycles_in_tick() after the scan
+ * @return void
+ */
+void metrics_tsi_scan(uint32_t startCycles, uint32_t endCycles);
+
+/*
+ * @brief Ticks spent in a state including the stay in progress
+ *
+ * @param state ID
+ * @return total ticks in the state
+ */
+uint32_t metrics_time_in_state(uint8_t state);
+
+/*
+ * @brief Prints the metrics block to the console
+ *
+ * @return void
+ */
+void metrics_report(void);
+
+/*
+ * @brief Clears all counters
+ *
+ * @return void
+ */
+void metrics_reset(void);
+
+#endif /* METRICS_H_ */
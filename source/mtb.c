@@ -47,6 +47,10 @@
  *     		Allows MTB Buffer to be placed into specific RAM bank. When 
  *     		this is not defined, the "default" (first if there are 
  *     		several) RAM bank is used.
+ *
+ * 			The runtime control declared in mtb.h starts, stops and freezes the
+ * 			trace and exports it over the debug UART. Without a buffer it does
+ * 			nothing
  */
  
 /* This is a template for board specific configuration created by MCUXpresso IDE Project Wizard.*/
@@ -79,3 +83,117 @@
 
 #endif // !defined (__MTB_DISABLE)
 
+#include "MKL25Z4.h"
+#include "mtb.h"
+#include "logfmt.h"
+#include "faultlog.h"
+
+#if !defined (__MTB_DISABLE) && (__MTB_BUFFER_SIZE > 0)
+#define MTB_TRACE_ENABLED
+/*Buffer of 2^(MASK + 4) bytes*/
+#define MTB_MASK_VALUE				(__builtin_ctz(__MTB_BUFFER_SIZE) - 4)
+extern char __mtb_buffer__[];		/*Defined by __CR_MTB_BUFFER(), aligned to its size*/
+#endif
+
+#define MTB_ADDRESS_MASK			(0xFFFFFFFEu) /*Bit 0 of every packet word is a flag*/
+
+/*Placed in the .noinit section of the linker script, the buffer itself is NOLOAD too*/
+mtb_frozen_t mtbFrozen FAULTLOG_SECTION;
+
+/*
+ * @brief Starts recording branches from the start of the buffer
+ *
+ * @param oneShot true to stop automatically once the buffer is full, false to wrap
+ * @return void
+ */
+void mtb_trace_start(bool oneShot)
+{
+#if defined(MTB_TRACE_ENABLED)
+	uint32_t offset = (uint32_t)__mtb_buffer__ - MTB->BASE; /*POSITION and FLOW are offsets from BASE*/
+
+	if (mtbFrozen.magic == MTB_FROZEN_MAGIC)
+	{
+		return;		/*The trace of a fault is kept until exported*/
+	}
+	MTB->MASTER = 0;
+	MTB->POSITION = offset & MTB_POSITION_POINTER_MASK;
+	MTB->FLOW = oneShot ? (((offset + __MTB_BUFFER_SIZE - MTB_PACKET_BYTES) & MTB_FLOW_WATERMARK_MASK) |
+						   MTB_FLOW_AUTOSTOP_MASK) : 0;
+	MTB->MASTER = MTB_MASTER_EN_MASK | MTB_MASTER_MASK(MTB_MASK_VALUE);
+#else
+	(void)oneShot;
+#endif
+}
+
+/*
+ * @brief Stops recording, the buffer keeps the branches until the next start
+ *
+ * @return void
+ */
+void mtb_trace_stop(void)
+{
+#if defined(MTB_TRACE_ENABLED)
+	MTB->MASTER &= ~MTB_MASTER_EN_MASK;
+#endif
+}
+
+/*
+ * @brief Stops recording and keeps the position across a reset, called on a fault
+ *
+ * @return void
+ */
+void mtb_trace_freeze(void)
+{
+#if defined(MTB_TRACE_ENABLED)
+	MTB->MASTER &= ~MTB_MASTER_EN_MASK;
+	mtbFrozen.position = MTB->POSITION;
+	mtbFrozen.magic = MTB_FROZEN_MAGIC;
+#endif
+}
+
+/*
+ * @brief Sends the recorded branches to the console, oldest first
+ *
+ * @return void
+ */
+void mtb_trace_export(void)
+{
+#if defined(MTB_TRACE_ENABLED)
+	const uint32_t *packets = (const uint32_t *)__mtb_buffer__;
+	uint32_t packetCount = __MTB_BUFFER_SIZE / MTB_PACKET_BYTES;
+	uint32_t position;
+	uint32_t next;
+	uint32_t count;
+	uint32_t index;
+	bool frozen = (mtbFrozen.magic == MTB_FROZEN_MAGIC);
+	bool wrapping = ((MTB->MASTER & MTB_MASTER_EN_MASK) != 0) && ((MTB->FLOW & MTB_FLOW_AUTOSTOP_MASK) == 0);
+
+	mtb_trace_stop();
+	position = frozen ? mtbFrozen.position : MTB->POSITION;
+	next = ((position & MTB_POSITION_POINTER_MASK) & (__MTB_BUFFER_SIZE - 1)) / MTB_PACKET_BYTES;
+	/*After a wrap the oldest packet is the next one to be written*/
+	count = (position & MTB_POSITION_WRAP_MASK) ? packetCount : next;
+	index = (position & MTB_POSITION_WRAP_MASK) ? next : 0;
+
+	logfmt_printf("\r\nmtb trace %lu branches%s", (unsigned long)count, frozen ? " frozen by fault" : "");
+	for (; count > 0; count--)
+	{
+		uint32_t source = packets[2 * index];
+		uint32_t destination = packets[2 * index + 1];
+		logfmt_printf("\r\nmtb %08lx %08lx%s%s", (unsigned long)(source & MTB_ADDRESS_MASK),
+					  (unsigned long)(destination & MTB_ADDRESS_MASK),
+					  (source & MTB_PACKET_EXCEPTION) ? " exception" : "",
+					  (destination & MTB_PACKET_START) ? " start" : "");
+		index = (index + 1) & (packetCount - 1);
+	}
+	logfmt_printf("\r\n");
+	mtbFrozen.magic = 0;
+	if (wrapping)
+	{
+		mtb_trace_start(false);		/*A continuous trace goes on*/
+	}
+#else
+	logfmt_printf("\r\nmtb trace disabled\r\n");
+#endif
+}
+
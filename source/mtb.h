@@ -0,0 +1,72 @@
+/**
+ * @file    mtb.h
+ * @brief   This header file consists of the runtime control of the Micro Trace Buffer which
+ * 			records the branches of the core into the __MTB_BUFFER reserved in mtb.c
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) KL25 Sub-Family Reference Manual, chapter 17 Micro Trace Buffer
+ * 2) ARM CoreSight MTB-M0+ Technical Reference Manual, 3.3 Trace packet format
+ */
+
+#ifndef MTB_H_
+#define MTB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MTB_EXPORT_COMMAND			('t') /*Character received on the debug UART which exports the trace*/
+#define MTB_PACKET_BYTES			(8)   /*Source and destination address of one branch*/
+#define MTB_FROZEN_MAGIC			(0x7EACE0F2u)
+
+/*Bit 0 of the source word, the branch was an exception entry or return*/
+#define MTB_PACKET_EXCEPTION		(0x1u)
+/*Bit 0 of the destination word, first branch after the trace was started*/
+#define MTB_PACKET_START			(0x1u)
+
+/*Trace state kept across a reset so that a trace frozen by a fault can be exported on the next boot*/
+typedef struct
+{
+	uint32_t magic;				/*MTB_FROZEN_MAGIC once frozen*/
+	uint32_t position;			/*MTB POSITION register when frozen*/
+} mtb_frozen_t;
+
+extern mtb_frozen_t mtbFrozen;
+
+/*
+ * @brief Starts recording branches from the start of the buffer
+ *
+ * @param oneShot true to stop automatically once the buffer is full, keeping the first
+ * branches after the start, false to wrap and keep the latest branches
+ * @return void
+ */
+void mtb_trace_start(bool oneShot);
+
+/*
+ * @brief Stops recording, the buffer keeps the branches until the next start
+ *
+ * @return void
+ */
+void mtb_trace_stop(void);
+
+/*
+ * @brief Stops recording and keeps the position across a reset, called on a fault
+ *
+ * Later starts are refused until the trace has been exported
+ *
+ * @return void
+ */
+void mtb_trace_freeze(void);
+
+/*
+ * @brief Sends the recorded branches to the console, oldest first
+ *
+ * Every branch is a line "mtb <source> <destination>" in hex, tools/mtb_decode.py maps
+ * them to source lines using the .axf. Clears a freeze, a wrapping trace is restarted
+ *
+ * @return void
+ */
+void mtb_trace_export(void);
+
+#endif /* MTB_H_ */
@@ -0,0 +1,272 @@
+/**
+ * @file    night_mode.c
+ * @brief   This source file consists of function definitions of the scheduled night flash
+ * 			mode: the sequence stops in STOP, the core drops to the 4 MHz VLPR profile and the
+ * 			LED flashes amber until the schedule ends or a crosswalk press
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <stddef.h>
+#include "night_mode.h"
+#include "power_mode.h"
+#include "conflict_monitor.h"
+#include "crosswalk_policy.h"
+#include "metrics.h"
+#include "watchdog.h"
+#include "switch.h"
+#include "pwm.h"
+#include "log.h"
+#include "logfmt.h"
+#include "timebase.h"
+#include "console.h"
+
+#define SECONDS_PER_HOUR			(3600)
+
+/*Flashing amber, the colour of WARNING, once a second*/
+#define NIGHT_FLASH_RED				(0xFF)
+#define NIGHT_FLASH_GREEN			(0xB2)
+#define NIGHT_FLASH_BLUE			(0x00)
+#define NIGHT_FLASH_PERIOD			(16)
+#define NIGHT_FLASH_ON				(8)
+
+night_mode_t nightMode;
+
+const night_config_t nightDefaultConfig={
+	.startSecond=NIGHT_MODE_START,
+	.endSecond=NIGHT_MODE_END,
+	.clockAtReset=NIGHT_MODE_CLOCK,
+	.flashPeriodTicks=NIGHT_FLASH_PERIOD,
+	.flashOnTicks=NIGHT_FLASH_ON,
+	.colour={NIGHT_FLASH_RED,NIGHT_FLASH_GREEN,NIGHT_FLASH_BLUE}
+};
+
+/*
+ * @brief Second of the day at a tick
+ *
+ * @param1 schedule
+ * @param2 tick
+ * @return 0 to SECONDS_PER_DAY-1
+ */
+uint32_t night_second_of_day(const night_config_t *config, ticktime now)
+{
+	return (config->clockAtReset+now/TIMEBASE_TICKS_PER_SECOND)%SECONDS_PER_DAY;
+}
+
+/*
+ * @brief Whether a tick falls in the night of the schedule
+ *
+ * @param1 schedule
+ * @param2 tick
+ * @return true from startSecond to endSecond, never if they are equal
+ */
+bool night_mode_scheduled(const night_config_t *config, ticktime now)
+{
+	uint32_t second=night_second_of_day(config,now);
+
+	if(config->startSecond <= config->endSecond)
+	{
+		return (second >= config->startSecond) && (second < config->endSecond);
+	}
+	return (second >= config->startSecond) || (second < config->endSecond);	/*Across midnight*/
+}
+
+/*
+ * @brief Whether the flash is lit a number of ticks into the night
+ *
+ * @param1 schedule
+ * @param2 ticks since the flash started
+ * @return true for the on part of the period
+ */
+bool night_flash_lit(const night_config_t *config, ticktime ticksInNight)
+{
+	return (ticksInNight%config->flashPeriodTicks) < config->flashOnTicks;
+}
+
+/*
+ * @brief Estimated charge saved by the flashing time in VLPR instead of RUN
+ *
+ * @return microampere hours
+ */
+uint32_t night_mode_saved_microamp_hours(void)
+{
+	uint64_t microampTicks=(uint64_t)nightMode.nightTicks*(NIGHT_RUN_MICROAMPS-NIGHT_VLPR_MICROAMPS);
+
+	return (uint32_t)(microampTicks/(TIMEBASE_TICKS_PER_SECOND*SECONDS_PER_HOUR));
+}
+
+/*Allow the night flash mode to be built by setting a define (via command line)*/
+#if defined(NIGHT_MODE)
+
+/*The flash colour and black are the only colours while flashing*/
+static const conflict_monitor_rule_t nightRule=
+	MONITOR_RULE_EXACT(NIGHT_FLASH_RED,NIGHT_FLASH_GREEN,NIGHT_FLASH_BLUE,0,0,0);
+
+/*
+ * @brief Starts following a schedule, the flash starts at the next STOP in the night
+ *
+ * @param schedule, used by reference, NULL for no night mode
+ * @return void
+ */
+void night_mode_init(const night_config_t *config)
+{
+	console_register(NIGHT_REPORT_COMMAND,night_mode_report);
+	nightMode.config=config;
+	nightMode.active=false;
+	nightMode.inNight=false;
+}
+
+/*
+ * @brief Shows the flash colour or black when the part of the period changes
+ *
+ * @param current tick
+ * @return void
+ */
+static void show_flash(ticktime now)
+{
+	const sm_colour_t *colour=&nightMode.config->colour;
+	bool lit=night_flash_lit(nightMode.config,now-nightMode.entered);
+
+	if(lit != nightMode.lit)
+	{
+		nightMode.lit=lit;
+		if(lit)
+		{
+			update_led_colour(colour->red,colour->green,colour->blue);
+		}
+		else
+		{
+			update_led_colour(0,0,0);
+		}
+	}
+}
+
+/*
+ * @brief Drops to VLPR and starts the flash with its own conflict monitor rule
+ *
+ * @return void
+ */
+static void enter_night(void)
+{
+	uint32_t latency;
+
+	LOG("\nNight flash starts at %ld msec",(long)current_time());
+	latency=power_mode_vlpr();
+	nightMode.enterLatencyUs=latency;
+	if(latency > nightMode.maxEnterLatencyUs)
+	{
+		nightMode.maxEnterLatencyUs=latency;
+	}
+	conflict_monitor_init(&nightMode.monitorState,&nightRule,1);
+	nightMode.active=true;
+	nightMode.lit=false;
+	nightMode.entered=now();
+	nightMode.lastTick=nightMode.entered;
+	nightMode.entries++;
+	if(!nightMode.inNight)
+	{
+		nightMode.inNight=true;
+		nightMode.nights++;
+	}
+	show_flash(nightMode.entered);
+}
+
+/*
+ * @brief Returns to RUN and restarts the STOP the sequence was held in, a press is latched
+ * 		  as a request so that the walk follows
+ *
+ * @param the night ends on a crosswalk press
+ * @return void
+ */
+static void leave_night(bool pressed)
+{
+	uint32_t latency=power_mode_run();
+
+	nightMode.exitLatencyUs=latency;
+	if(latency > nightMode.maxExitLatencyUs)
+	{
+		nightMode.maxExitLatencyUs=latency;
+	}
+	nightMode.active=false;
+	(void)detector_actuations();		/*Vehicles counted overnight do not extend the first GO*/
+	statemachine_resume();
+	if(pressed)
+	{
+		nightMode.pressExits++;
+		metrics_crosswalk_request(!crosswalk_policy_press(statemachine_crosswalk_policy(),now(),STOP));
+	}
+	LOG("\nNight flash ends at %ld msec%s",(long)current_time(),pressed ? " on a crosswalk press" : "");
+}
+
+/*
+ * @brief Enters, runs and leaves the night flash, called at the top of statemachine_poll()
+ *
+ * The flash starts in STOP with no walk pending and the conflict monitor not tripped, so
+ * the main approach goes from steady red to flashing. At night the main loop only takes the
+ * inputs and draws the flash once a tick. A walk served after a press ends in STOP, and the
+ * flash starts again there while the night lasts
+ *
+ * @param current tick
+ * @return true while flashing and in the pass which enters or leaves the night, the
+ * 		   sequence is not stepped
+ */
+bool night_mode_poll(ticktime now)
+{
+	bool pressed;
+
+	if(nightMode.config == NULL)
+	{
+		return false;
+	}
+	if(!nightMode.active)
+	{
+		if(!night_mode_scheduled(nightMode.config,now))
+		{
+			nightMode.inNight=false;
+			return false;
+		}
+		if((statemachine_state() != STOP) || conflictMonitor.tripped || statemachine_crosswalk_policy()->pending)
+		{
+			return false;
+		}
+		enter_night();
+		return true;
+	}
+	if(now == nightMode.lastTick)
+	{
+		return true;
+	}
+	nightMode.nightTicks+=now-nightMode.lastTick;
+	nightMode.lastTick=now;
+	watchdog_checkin(WATCHDOG_TASK_TICK);
+	pressed=check_button_pressed();
+	if(pressed || !night_mode_scheduled(nightMode.config,now))
+	{
+		leave_night(pressed);
+		return true;		/*The tick of this pass is older than the restarted STOP*/
+	}
+	show_flash(now);
+	return true;
+}
+
+/*
+ * @brief Prints the nights and flashes, the switch latencies and the estimated charge saved
+ *
+ * @return void
+ */
+void night_mode_report(void)
+{
+	logfmt_printf("\r\nnight flash %s, %lu nights, %lu flashes, %lu ended by a press, %lu s flashing",
+				  nightMode.active ? "on" : "off",(unsigned long)nightMode.nights,(unsigned long)nightMode.entries,
+				  (unsigned long)nightMode.pressExits,(unsigned long)(nightMode.nightTicks/TIMEBASE_TICKS_PER_SECOND));
+	logfmt_printf("\r\nswitch to VLPR %lu us max %lu, to RUN %lu us max %lu",
+				  (unsigned long)nightMode.enterLatencyUs,(unsigned long)nightMode.maxEnterLatencyUs,
+				  (unsigned long)nightMode.exitLatencyUs,(unsigned long)nightMode.maxExitLatencyUs);
+	logfmt_printf("\r\nestimated %lu uAh saved at %u uA in RUN and %u uA in VLPR\r\n",
+				  (unsigned long)night_mode_saved_microamp_hours(),NIGHT_RUN_MICROAMPS,NIGHT_VLPR_MICROAMPS);
+}
+
+#endif /* defined(NIGHT_MODE) */
@@ -0,0 +1,131 @@
+/**
+ * @file    night_mode.h
+ * @brief   This header file consists of the scheduled night flash mode: the sequence stops in
+ * 			STOP, the core drops to the 4 MHz VLPR profile and the LED flashes amber until the
+ * 			schedule ends or a crosswalk press
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef NIGHT_MODE_H_
+#define NIGHT_MODE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "statemachine.h"
+
+#define NIGHT_REPORT_COMMAND		('n') /*Character received on the debug UART which prints the night mode*/
+#define SECONDS_PER_DAY				(86400)
+
+/*The board has no calendar clock: the time of day at reset is given at build time and the
+  schedule is in seconds of the day, 22:00 to 06:00 by default*/
+#ifndef NIGHT_MODE_CLOCK
+#define NIGHT_MODE_CLOCK			(12 * 3600)
+#endif
+#ifndef NIGHT_MODE_START
+#define NIGHT_MODE_START			(22 * 3600)
+#endif
+#ifndef NIGHT_MODE_END
+#define NIGHT_MODE_END				(6 * 3600)
+#endif
+
+/*Typical supply currents of the KL25 datasheet at 3 V with the peripherals of the firmware
+  clocked, to be replaced by a measurement across J4 of the board (IDD)*/
+#define NIGHT_RUN_MICROAMPS			(6400)	/*48 MHz core, 24 MHz bus*/
+#define NIGHT_VLPR_MICROAMPS		(500)	/*4 MHz core, 800 kHz bus*/
+
+typedef struct
+{
+	uint32_t startSecond;			/*Second of the day the flash starts*/
+	uint32_t endSecond;				/*Second of the day it ends, before startSecond across midnight*/
+	uint32_t clockAtReset;			/*Second of the day at tick 0*/
+	uint32_t flashPeriodTicks;
+	uint32_t flashOnTicks;
+	sm_colour_t colour;				/*Shown for flashOnTicks of every period, black for the rest*/
+} night_config_t;
+
+typedef struct
+{
+	const night_config_t *config;	/*NULL for no night mode*/
+	bool active;
+	bool lit;
+	bool inNight;					/*In a scheduled night, flashing or served a press in it*/
+	uint8_t monitorState;			/*State variable of the conflict monitor while flashing*/
+	ticktime entered;				/*Tick the flash started*/
+	ticktime lastTick;
+	uint32_t nights;				/*Scheduled nights the flash started in*/
+	uint32_t entries;				/*Flash starts, again after every press served in a night*/
+	uint32_t pressExits;			/*Flashes ended early by a crosswalk press*/
+	uint32_t nightTicks;			/*Ticks spent flashing, nights in progress included*/
+	uint32_t enterLatencyUs;		/*Last switch to VLPR*/
+	uint32_t exitLatencyUs;			/*Last switch back to RUN*/
+	uint32_t maxEnterLatencyUs;
+	uint32_t maxExitLatencyUs;
+} night_mode_t;
+
+extern night_mode_t nightMode;
+extern const night_config_t nightDefaultConfig;
+
+/*
+ * @brief Second of the day at a tick
+ *
+ * @param1 schedule
+ * @param2 tick
+ * @return 0 to SECONDS_PER_DAY-1
+ */
+uint32_t night_second_of_day(const night_config_t *config, ticktime now);
+
+/*
+ * @brief Whether a tick falls in the night of the schedule
+ *
+ * @param1 schedule
+ * @param2 tick
+ * @return true from startSecond to endSecond, never if they are equal
+ */
+bool night_mode_scheduled(const night_config_t *config, ticktime now);
+
+/*
+ * @brief Whether the flash is lit a number of ticks into the night
+ *
+ * @param1 schedule
+ * @param2 ticks since the flash started
+ * @return true for the on part of the period
+ */
+bool night_flash_lit(const night_config_t *config, ticktime ticksInNight);
+
+/*
+ * @brief Starts following a schedule, the flash starts at the next STOP in the night
+ *
+ * @param schedule, used by reference, NULL for no night mode
+ * @return void
+ */
+void night_mode_init(const night_config_t *config);
+
+/*
+ * @brief Enters, runs and leaves the night flash, called at the top of statemachine_poll()
+ *
+ * @param current tick
+ * @return true while flashing and in the pass which enters or leaves the night, the
+ * 		   sequence is not stepped
+ */
+bool night_mode_poll(ticktime now);
+
+/*
+ * @brief Estimated charge saved by the flashing time in VLPR instead of RUN
+ *
+ * @return microampere hours
+ */
+uint32_t night_mode_saved_microamp_hours(void);
+
+/*
+ * @brief Prints the nights and flashes, the switch latencies and the estimated charge saved
+ *
+ * @return void
+ */
+void night_mode_report(void);
+
+#endif /* NIGHT_MODE_H_ */
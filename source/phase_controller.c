@@ -0,0 +1,495 @@
+/**
+ * @file    phase_controller.c
+ * @brief   This source file consists of function definitions of the ring and barrier phase
+ * 			controller and the build time checks of the phase table
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "phase_controller.h"
+#include "statemachine.h"
+#include "pwm.h"
+#include "metrics.h"
+#include "watchdog.h"
+#include "console.h"
+
+#define PHASE_MIN_YELLOW			(48) /*3 seconds*/
+
+/*Colours of the on-board LED, the same as the STOP, GO and WARNING states*/
+#define LED_RED_RED					(0x61)
+#define LED_RED_GREEN				(0x1E)
+#define LED_RED_BLUE				(0x3C)
+#define LED_YELLOW_RED				(0xFF)
+#define LED_YELLOW_GREEN			(0xB2)
+#define LED_YELLOW_BLUE				(0x00)
+#define LED_GREEN_RED				(0x22)
+#define LED_GREEN_GREEN				(0x96)
+#define LED_GREEN_BLUE				(0x22)
+
+/*
+ * Build time checks of phase_table.h. The macros expand to constant expressions over the
+ * 8 NEMA phases so that a table error stops the build instead of reaching an intersection
+ */
+#define PHASE_BIT(mask, phase)		(((uint32_t)(mask) >> ((phase) - 1)) & 1u)
+#define PHASE_COLUMN(phase)			((PHASE_BIT(PHASE_CONFLICTS_1, phase) << 0) | (PHASE_BIT(PHASE_CONFLICTS_2, phase) << 1) | \
+									 (PHASE_BIT(PHASE_CONFLICTS_3, phase) << 2) | (PHASE_BIT(PHASE_CONFLICTS_4, phase) << 3) | \
+									 (PHASE_BIT(PHASE_CONFLICTS_5, phase) << 4) | (PHASE_BIT(PHASE_CONFLICTS_6, phase) << 5) | \
+									 (PHASE_BIT(PHASE_CONFLICTS_7, phase) << 6) | (PHASE_BIT(PHASE_CONFLICTS_8, phase) << 7))
+#define PHASE_RING_OF(phase)		((PH(phase) & PHASE_RING_1) ? PHASE_RING_1 : PHASE_RING_2)
+#define PHASE_BARRIER_OF(phase)		((PH(phase) & PHASE_BARRIER_1) ? PHASE_BARRIER_1 : PHASE_BARRIER_2)
+#define PHASE_CONCURRENT(phase)		(PHASE_USED & PHASE_BARRIER_OF(phase) & ~PHASE_RING_OF(phase)) /*Run together by the rings*/
+#define PHASE_WITH(parents, phase)	(PHASE_BIT(parents, phase) ? (PH(phase) | PHASE_CONCURRENT(phase)) : 0u)
+#define PHASE_ALLOWED_WITH(parents)	(PHASE_WITH(parents, 1) | PHASE_WITH(parents, 2) | PHASE_WITH(parents, 3) | \
+									 PHASE_WITH(parents, 4) | PHASE_WITH(parents, 5) | PHASE_WITH(parents, 6) | \
+									 PHASE_WITH(parents, 7) | PHASE_WITH(parents, 8))
+
+#define PHASE_CHECK(phase, conflicts)																\
+	_Static_assert(((conflicts) & PH(phase)) == 0, "phase " #phase " conflicts with itself");		\
+	_Static_assert((conflicts) == PHASE_COLUMN(phase), "conflict matrix is not symmetric for phase " #phase); \
+	_Static_assert(((conflicts) & PHASE_CONCURRENT(phase)) == 0,									\
+				   "phase " #phase " conflicts with a phase its ring and barrier run it with");
+
+#define OVERLAP_CHECK(overlap, parents, conflicts)													\
+	_Static_assert(((parents) & ~PHASE_USED) == 0, "overlap " #overlap " has an unused parent");	\
+	_Static_assert(((conflicts) & PHASE_ALLOWED_WITH(parents)) == 0,								\
+				   "overlap " #overlap " conflicts with a phase it can be green with");
+
+#define PHASE_TIME_CHECK(phase, green, yellow, redClear)											\
+	_Static_assert((yellow) >= PHASE_MIN_YELLOW, "phase " #phase " yellow is shorter than 3 seconds");
+
+_Static_assert((PHASE_USED >> PHASE_MAX) == 0, "only phases 1-8 are supported");
+_Static_assert(((PHASE_RING_1 & PHASE_RING_2) == 0) && (((PHASE_RING_1 | PHASE_RING_2) & PHASE_USED) == PHASE_USED),
+			   "every phase in use must be in exactly one ring");
+_Static_assert(((PHASE_BARRIER_1 & PHASE_BARRIER_2) == 0) && (((PHASE_BARRIER_1 | PHASE_BARRIER_2) & PHASE_USED) == PHASE_USED),
+			   "every phase in use must be in exactly one barrier group");
+PHASE_CHECK(1, PHASE_CONFLICTS_1)
+PHASE_CHECK(2, PHASE_CONFLICTS_2)
+PHASE_CHECK(3, PHASE_CONFLICTS_3)
+PHASE_CHECK(4, PHASE_CONFLICTS_4)
+PHASE_CHECK(5, PHASE_CONFLICTS_5)
+PHASE_CHECK(6, PHASE_CONFLICTS_6)
+PHASE_CHECK(7, PHASE_CONFLICTS_7)
+PHASE_CHECK(8, PHASE_CONFLICTS_8)
+OVERLAP_CHECK(A, OVERLAP_PARENTS_A, OVERLAP_CONFLICTS_A)
+OVERLAP_CHECK(B, OVERLAP_PARENTS_B, OVERLAP_CONFLICTS_B)
+OVERLAP_CHECK(C, OVERLAP_PARENTS_C, OVERLAP_CONFLICTS_C)
+OVERLAP_CHECK(D, OVERLAP_PARENTS_D, OVERLAP_CONFLICTS_D)
+PHASE_TIMES(PHASE_TIME_CHECK)
+
+typedef struct
+{
+	uint16_t green;
+	uint16_t yellow;
+	uint16_t redClear;
+} phase_times_t;
+
+#define PHASE_TIME_ENTRY(phase, green, yellow, redClear)	[(phase) - 1] = { (green), (yellow), (redClear) },
+static const phase_times_t phaseTimes[PHASE_MAX] = { PHASE_TIMES(PHASE_TIME_ENTRY) };
+
+static const uint32_t ringPhases[PHASE_RINGS] = { PHASE_RING_1 & PHASE_USED, PHASE_RING_2 & PHASE_USED };
+static const uint32_t barrierPhases[2] = { PHASE_BARRIER_1, PHASE_BARRIER_2 };
+static const uint32_t overlapParents[OVERLAP_MAX] = {
+	OVERLAP_PARENTS_A, OVERLAP_PARENTS_B, OVERLAP_PARENTS_C, OVERLAP_PARENTS_D
+};
+
+/*Overlap groups which conflict with a phase*/
+#define OVERLAP_BITS(phase)			((PHASE_BIT(OVERLAP_CONFLICTS_A, phase) << OVERLAP_GROUP(0)) | \
+									 (PHASE_BIT(OVERLAP_CONFLICTS_B, phase) << OVERLAP_GROUP(1)) | \
+									 (PHASE_BIT(OVERLAP_CONFLICTS_C, phase) << OVERLAP_GROUP(2)) | \
+									 (PHASE_BIT(OVERLAP_CONFLICTS_D, phase) << OVERLAP_GROUP(3)))
+
+const uint32_t phaseGroupConflicts[PHASE_GROUPS] = {
+	PHASE_CONFLICTS_1 | OVERLAP_BITS(1), PHASE_CONFLICTS_2 | OVERLAP_BITS(2),
+	PHASE_CONFLICTS_3 | OVERLAP_BITS(3), PHASE_CONFLICTS_4 | OVERLAP_BITS(4),
+	PHASE_CONFLICTS_5 | OVERLAP_BITS(5), PHASE_CONFLICTS_6 | OVERLAP_BITS(6),
+	PHASE_CONFLICTS_7 | OVERLAP_BITS(7), PHASE_CONFLICTS_8 | OVERLAP_BITS(8),
+	OVERLAP_CONFLICTS_A, OVERLAP_CONFLICTS_B, OVERLAP_CONFLICTS_C, OVERLAP_CONFLICTS_D
+};
+
+/*
+ * @brief Whether a phase is to be served
+ *
+ * @param1 controller instance
+ * @param2 phase 1-8
+ * @return true for a phase on recall or with a call
+ */
+static bool phase_demanded(const phase_controller_t *controller, uint8_t phase)
+{
+	return ((PHASE_RECALL | controller->calls) & PHASE_USED & PH(phase)) != 0;
+}
+
+/*
+ * @brief First demanded phase of a ring in a barrier group, after a phase in ring order
+ *
+ * @param1 controller instance
+ * @param2 phases of the ring
+ * @param3 phases of the barrier group
+ * @param4 phase to search after, 0 to search from the start of the ring
+ * @return phase 1-8, 0 if none is demanded
+ */
+static uint8_t first_demanded(const phase_controller_t *controller, uint32_t ring, uint32_t barrier, uint8_t after)
+{
+	uint8_t phase;
+
+	for (phase = after + 1; phase <= PHASE_MAX; phase++)
+	{
+		if ((ring & barrier & PH(phase)) && phase_demanded(controller, phase))
+		{
+			return phase;
+		}
+	}
+	return 0;
+}
+
+/*
+ * @brief Starts the green of a phase
+ *
+ * @return void
+ */
+static void start_green(phase_controller_t *controller, phase_ring_t *ring, uint8_t phase, ticktime now)
+{
+	ring->phase = phase;
+	ring->next = 0;
+	ring->interval = RING_GREEN;
+	ring->intervalStart = now;
+	controller->calls &= ~PH(phase);
+	controller->greens[phase - 1]++;
+}
+
+/*
+ * @brief Times one ring, a ring leaves its barrier group only in phase_controller_poll()
+ *
+ * @return void
+ */
+static void time_ring(phase_controller_t *controller, uint8_t index, ticktime now)
+{
+	phase_ring_t *ring = &controller->rings[index];
+	const phase_times_t *times = &phaseTimes[ring->phase - 1];
+	uint32_t elapsed = now - ring->intervalStart;
+	uint32_t barrier = barrierPhases[controller->barrier];
+
+	switch (ring->interval)
+	{
+		case RING_GREEN:
+			if (elapsed >= times->green)
+			{
+				controller->calls &= ~PH(ring->phase); /*Calls during green are served by it*/
+				ring->next = first_demanded(controller, ringPhases[index], barrier, ring->phase);
+				if (ring->next == 0)
+				{
+					ring->next = first_demanded(controller, ringPhases[index], barrierPhases[controller->barrier ^ 1], 0);
+				}
+				ring->interval = RING_YELLOW;
+				ring->intervalStart = now;
+			}
+		break;
+
+		case RING_YELLOW:
+			if (elapsed >= times->yellow)
+			{
+				ring->interval = RING_RED_CLEAR;
+				ring->intervalStart = now;
+			}
+		break;
+
+		case RING_RED_CLEAR:
+			if (elapsed >= times->redClear)
+			{
+				if ((ring->next != 0) && (barrier & PH(ring->next)))
+				{
+					start_green(controller, ring, ring->next, now);
+				}
+				else
+				{
+					ring->interval = RING_BARRIER;
+					ring->intervalStart = now;
+				}
+			}
+		break;
+
+		default:
+		break;
+	}
+}
+
+/*
+ * @brief Crosses the barrier once every ring has reached it
+ *
+ * @return void
+ */
+static void cross_barrier(phase_controller_t *controller, ticktime now)
+{
+	uint8_t index;
+	bool started = false;
+
+	for (index = 0; index < PHASE_RINGS; index++)
+	{
+		if (controller->rings[index].interval != RING_BARRIER)
+		{
+			return;
+		}
+	}
+
+	controller->barrier ^= 1;
+	for (index = 0; index < PHASE_RINGS; index++)
+	{
+		phase_ring_t *ring = &controller->rings[index];
+		uint32_t barrier = barrierPhases[controller->barrier];
+		uint8_t phase = ring->next;
+
+		if ((phase == 0) || !(barrier & PH(phase)))
+		{
+			phase = first_demanded(controller, ringPhases[index], barrier, 0);
+		}
+		if (phase != 0)
+		{
+			start_green(controller, ring, phase, now);
+			started = true;
+		}
+	}
+	if (started && (controller->barrier == 0))
+	{
+		controller->cycles++;
+	}
+}
+
+/*
+ * @brief Colour of a phase from the interval of its ring
+ *
+ * @return PHASE_RED, PHASE_YELLOW or PHASE_GREEN
+ */
+static uint8_t phase_colour(const phase_controller_t *controller, uint8_t phase)
+{
+	uint8_t index;
+
+	for (index = 0; index < PHASE_RINGS; index++)
+	{
+		const phase_ring_t *ring = &controller->rings[index];
+		if (ring->phase == phase)
+		{
+			if (ring->interval == RING_GREEN)
+			{
+				return PHASE_GREEN;
+			}
+			return (ring->interval == RING_YELLOW) ? PHASE_YELLOW : PHASE_RED;
+		}
+	}
+	return PHASE_RED;
+}
+
+/*
+ * @brief Colour of an overlap, green while a parent is green or changes to another parent
+ *
+ * @return PHASE_RED, PHASE_YELLOW or PHASE_GREEN
+ */
+static uint8_t overlap_colour(const phase_controller_t *controller, uint32_t parents)
+{
+	uint8_t colour = PHASE_RED;
+	uint8_t index;
+
+	for (index = 0; index < PHASE_RINGS; index++)
+	{
+		const phase_ring_t *ring = &controller->rings[index];
+		if ((ring->phase == 0) || !(parents & PH(ring->phase)))
+		{
+			continue;
+		}
+		if ((ring->interval == RING_GREEN) || ((ring->next != 0) && (parents & PH(ring->next))))
+		{
+			return PHASE_GREEN;
+		}
+		if (ring->interval == RING_YELLOW)
+		{
+			colour = PHASE_YELLOW;
+		}
+	}
+	return colour;
+}
+
+/*
+ * @brief Updates every signal group and reports the changes to the output sink
+ *
+ * @return void
+ */
+static void update_outputs(phase_controller_t *controller)
+{
+	uint8_t group;
+
+	for (group = 0; group < PHASE_GROUPS; group++)
+	{
+		uint8_t colour;
+
+		if (group < PHASE_MAX)
+		{
+			colour = (PHASE_USED & PH(group + 1)) ? phase_colour(controller, group + 1) : PHASE_RED;
+		}
+		else
+		{
+			colour = overlap_colour(controller, overlapParents[group - PHASE_MAX]);
+		}
+		if (colour != controller->colours[group])
+		{
+			controller->colours[group] = colour;
+			if (controller->output != NULL)
+			{
+				controller->output(group, colour);
+			}
+		}
+	}
+}
+
+/*
+ * @brief Starts the controller with both rings at the barrier before the main street
+ *
+ * @param1 controller instance
+ * @param2 output sink, NULL for none
+ * @param3 current tick
+ * @return void
+ */
+void phase_controller_init(phase_controller_t *controller, phase_output_t output, ticktime now)
+{
+	uint8_t index;
+
+	memset(controller, 0, sizeof(*controller));
+	controller->output = output;
+	controller->barrier = 1; /*Crossed into PHASE_BARRIER_1 by the first poll*/
+	for (index = 0; index < PHASE_RINGS; index++)
+	{
+		controller->rings[index].interval = RING_BARRIER;
+		controller->rings[index].intervalStart = now;
+	}
+	if (output != NULL)
+	{
+		uint8_t group;
+		for (group = 0; group < PHASE_GROUPS; group++)
+		{
+			output(group, PHASE_RED);
+		}
+	}
+}
+
+/*
+ * @brief Places a call on phases which are not on recall
+ *
+ * @param1 controller instance
+ * @param2 mask of the called phases, see PH()
+ * @return void
+ */
+void phase_controller_call(phase_controller_t *controller, uint32_t phases)
+{
+	controller->calls |= phases & PHASE_USED & ~PHASE_RECALL;
+}
+
+/*
+ * @brief Times the rings and updates the signal group outputs, called once per tick
+ *
+ * @param1 controller instance
+ * @param2 current tick
+ * @return void
+ */
+void phase_controller_poll(phase_controller_t *controller, ticktime now)
+{
+	uint8_t index;
+
+	for (index = 0; index < PHASE_RINGS; index++)
+	{
+		if (controller->rings[index].interval != RING_BARRIER)
+		{
+			time_ring(controller, index, now);
+		}
+	}
+	cross_barrier(controller, now);
+	update_outputs(controller);
+}
+
+/*
+ * @brief Checks the displayed colours against the conflict matrix
+ *
+ * @param controller instance
+ * @return true if no two conflicting signal groups are green or yellow together
+ */
+bool phase_controller_check(const phase_controller_t *controller)
+{
+	uint32_t showing = 0;
+	uint8_t group;
+
+	for (group = 0; group < PHASE_GROUPS; group++)
+	{
+		if (controller->colours[group] != PHASE_RED)
+		{
+			showing |= (1u << group);
+		}
+	}
+	for (group = 0; group < PHASE_GROUPS; group++)
+	{
+		if ((showing & (1u << group)) && (showing & phaseGroupConflicts[group]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * @brief Output sink which shows signal group PHASE_LED_GROUP on the on-board LED
+ *
+ * @param1 signal group
+ * @param2 colour of the signal group
+ * @return void
+ */
+void phase_controller_led_output(uint8_t group, uint8_t colour)
+{
+	if (group != PHASE_LED_GROUP)
+	{
+		return;
+	}
+	if (colour == PHASE_GREEN)
+	{
+		update_led_colour(LED_GREEN_RED, LED_GREEN_GREEN, LED_GREEN_BLUE);
+	}
+	else if (colour == PHASE_YELLOW)
+	{
+		update_led_colour(LED_YELLOW_RED, LED_YELLOW_GREEN, LED_YELLOW_BLUE);
+	}
+	else
+	{
+		update_led_colour(LED_RED_RED, LED_RED_GREEN, LED_RED_BLUE);
+	}
+}
+
+/*Allow the phase controller to replace the state machine by setting a define (via command line)*/
+#if defined(PHASE_CONTROLLER)
+
+static phase_controller_t phaseController;
+
+/*
+ * @brief Runs the phase controller in place of statemachine(), never returns
+ *
+ * @return void
+ */
+void phase_controller_run(void)
+{
+	ticktime lastTick = now();
+
+	phase_controller_init(&phaseController, phase_controller_led_output, lastTick);
+	while (1)
+	{
+		console_poll();
+		if (lastTick != now())
+		{
+			lastTick = now();
+			watchdog_checkin(WATCHDOG_TASK_TICK);
+			if (check_button_pressed())
+			{
+				phase_controller_call(&phaseController, PHASE_BUTTON_CALLS);
+			}
+			phase_controller_poll(&phaseController, lastTick);
+		}
+	}
+}
+
+#endif /* defined(PHASE_CONTROLLER) */
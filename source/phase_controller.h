@@ -0,0 +1,116 @@
+/**
+ * @file    phase_controller.h
+ * @brief   This header file consists of the ring and barrier phase controller which times
+ * 			the signal groups of phase_table.h
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef PHASE_CONTROLLER_H_
+#define PHASE_CONTROLLER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "phase_table.h"
+
+/*Colour of a signal group*/
+#define PHASE_RED					(0)
+#define PHASE_YELLOW				(1)
+#define PHASE_GREEN					(2)
+
+/*Interval being timed by a ring*/
+#define RING_GREEN					(0)
+#define RING_YELLOW					(1)
+#define RING_RED_CLEAR				(2)
+#define RING_BARRIER				(3) /*All red, waiting for the other rings to reach the barrier*/
+
+#define OVERLAP_GROUP(index)		(PHASE_MAX + (index)) /*Signal group of overlap A-D as 0-3*/
+
+#define PHASE_LED_GROUP				(1) /*Signal group shown on the on-board LED, phase 2*/
+#define PHASE_BUTTON_CALLS			(PH(1) | PH(3) | PH(5) | PH(7)) /*Phases called by the switch or slider*/
+
+/*Called with every change of a signal group colour*/
+typedef void (*phase_output_t)(uint8_t group, uint8_t colour);
+
+typedef struct
+{
+	uint8_t phase;				/*Phase 1-8 being timed, or the last one served while at the barrier*/
+	uint8_t next;				/*Phase chosen at the end of green, 0 for none*/
+	uint8_t interval;
+	ticktime intervalStart;
+} phase_ring_t;
+
+/*Controller state, a fixed size of under 100 bytes whatever the number of phases in use*/
+typedef struct
+{
+	phase_ring_t rings[PHASE_RINGS];
+	uint8_t barrier;			/*Barrier group being served, 0 for PHASE_BARRIER_1*/
+	uint32_t calls;				/*Phases called by a detector and not yet served*/
+	uint8_t colours[PHASE_GROUPS];
+	phase_output_t output;
+	uint32_t cycles;			/*Crossings into PHASE_BARRIER_1*/
+	uint32_t greens[PHASE_MAX];	/*Greens served by every phase*/
+} phase_controller_t;
+
+/*Conflicting signal groups of every signal group, bit n for group n*/
+extern const uint32_t phaseGroupConflicts[PHASE_GROUPS];
+
+/*
+ * @brief Starts the controller with both rings at the barrier before the main street
+ *
+ * @param1 controller instance
+ * @param2 output sink, NULL for none
+ * @param3 current tick
+ * @return void
+ */
+void phase_controller_init(phase_controller_t *controller, phase_output_t output, ticktime now);
+
+/*
+ * @brief Places a call on phases which are not on recall
+ *
+ * @param1 controller instance
+ * @param2 mask of the called phases, see PH()
+ * @return void
+ */
+void phase_controller_call(phase_controller_t *controller, uint32_t phases);
+
+/*
+ * @brief Times the rings and updates the signal group outputs, called once per tick
+ *
+ * @param1 controller instance
+ * @param2 current tick
+ * @return void
+ */
+void phase_controller_poll(phase_controller_t *controller, ticktime now);
+
+/*
+ * @brief Checks the displayed colours against the conflict matrix
+ *
+ * @param controller instance
+ * @return true if no two conflicting signal groups are green or yellow together
+ */
+bool phase_controller_check(const phase_controller_t *controller);
+
+/*
+ * @brief Output sink which shows signal group PHASE_LED_GROUP on the on-board LED
+ *
+ * @param1 signal group
+ * @param2 colour of the signal group
+ * @return void
+ */
+void phase_controller_led_output(uint8_t group, uint8_t colour);
+
+/*
+ * @brief Runs the phase controller in place of statemachine(), never returns
+ *
+ * Built only when PHASE_CONTROLLER is defined, the switch and slider call the left turns
+ *
+ * @return void
+ */
+void phase_controller_run(void);
+
+#endif /* PHASE_CONTROLLER_H_ */
@@ -0,0 +1,80 @@
+/**
+ * @file    phase_table.h
+ * @brief   This header file consists of the phase table of the intersection: the signal
+ * 			groups, their ring and barrier, conflicting groups, overlaps and interval times
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef PHASE_TABLE_H_
+#define PHASE_TABLE_H_
+
+/*
+ * Phases use the NEMA numbering: 1-4 in ring 1, 5-8 in ring 2, with the barrier between
+ * the main street (1, 2, 5, 6) and the side street (3, 4, 7, 8). Even phases are through
+ * movements and odd phases the protected left turns. Every table entry is a constant
+ * expression so that phase_controller.c can check the table with _Static_assert, a wrong
+ * table does not build
+ */
+#define PH(phase)					(1u << ((phase) - 1))	/*Bit of a phase in a phase mask*/
+
+#define PHASE_MAX					(8)
+#define PHASE_RINGS					(2)
+#define OVERLAP_MAX					(4)
+#define PHASE_GROUPS				(PHASE_MAX + OVERLAP_MAX) /*Signal group outputs, phases then overlaps A-D*/
+
+/*Phases wired at this intersection, unused phases are skipped*/
+#define PHASE_USED					(PH(1) | PH(2) | PH(3) | PH(4) | PH(5) | PH(6) | PH(7) | PH(8))
+
+/*Phases served every cycle without a call, the others only when called by a detector*/
+#define PHASE_RECALL				(PH(2) | PH(4) | PH(6) | PH(8))
+
+#define PHASE_RING_1				(PH(1) | PH(2) | PH(3) | PH(4))
+#define PHASE_RING_2				(PH(5) | PH(6) | PH(7) | PH(8))
+#define PHASE_BARRIER_1				(PH(1) | PH(2) | PH(5) | PH(6))
+#define PHASE_BARRIER_2				(PH(3) | PH(4) | PH(7) | PH(8))
+
+/*Conflicting phases of every phase, the matrix must be symmetric*/
+#define PHASE_CONFLICTS_1			(PH(2) | PHASE_BARRIER_2)
+#define PHASE_CONFLICTS_2			(PH(1) | PHASE_BARRIER_2)
+#define PHASE_CONFLICTS_3			(PH(4) | PHASE_BARRIER_1)
+#define PHASE_CONFLICTS_4			(PH(3) | PHASE_BARRIER_1)
+#define PHASE_CONFLICTS_5			(PH(6) | PHASE_BARRIER_2)
+#define PHASE_CONFLICTS_6			(PH(5) | PHASE_BARRIER_2)
+#define PHASE_CONFLICTS_7			(PH(8) | PHASE_BARRIER_1)
+#define PHASE_CONFLICTS_8			(PH(7) | PHASE_BARRIER_1)
+
+/*
+ * Overlaps are green while any parent phase is green and through the change between two
+ * parents, 0 parents for an unused overlap. Overlap A is the right turn from the side
+ * street which runs with its through phase 4 and carries on into the main street left turn 1
+ */
+#define OVERLAP_PARENTS_A			(PH(1) | PH(4))
+#define OVERLAP_PARENTS_B			(0)
+#define OVERLAP_PARENTS_C			(0)
+#define OVERLAP_PARENTS_D			(0)
+
+/*Phases an overlap must never be green or yellow with*/
+#define OVERLAP_CONFLICTS_A			(PH(2) | PH(3))
+#define OVERLAP_CONFLICTS_B			(0)
+#define OVERLAP_CONFLICTS_C			(0)
+#define OVERLAP_CONFLICTS_D			(0)
+
+/*
+ * Interval times of every phase in ticks of 62.5 msec
+ *		   phase  green  yellow  red clearance
+ */
+#define PHASE_TIMES(X)				\
+	X(1,	  96,		48,		16)		\
+	X(2,	 320,		64,		32)		\
+	X(3,	  80,		48,		16)		\
+	X(4,	 240,		64,		32)		\
+	X(5,	  96,		48,		16)		\
+	X(6,	 320,		64,		32)		\
+	X(7,	  80,		48,		16)		\
+	X(8,	 240,		64,		32)
+
+#endif /* PHASE_TABLE_H_ */
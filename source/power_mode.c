@@ -0,0 +1,136 @@
+/**
+ * @file    power_mode.c
+ * @brief   This source file consists of the switches between the 48 MHz RUN clock profile and
+ * 			the 4 MHz VLPR profile of board/clock_config.c, with the SysTick and the TPM
+ * 			modules moved to the new clock
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 15 System Mode Controller and chapter 24
+ * 	  Multipurpose Clock Generator
+ */
+
+/*Allow the night flash mode to be built by setting a define (via command line)*/
+#if defined(NIGHT_MODE)
+
+#include "MKL25Z4.h"
+#include "fsl_clock.h"
+#include "fsl_smc.h"
+#include "fsl_lpsci.h"
+#include "board.h"
+#include "clock_config.h"
+#include "power_mode.h"
+#include "timer.h"
+#include "timebase.h"
+#define SLOWEST_CORE_MHZ			(BOARD_BOOTCLOCKVLPR_CORE_CLOCK / 1000000U)
+#define UART0_CLOCK_PLLFLL			(1)		/*SOPT2 UART0SRC, MCGPLLCLK/2 in RUN*/
+#define UART0_CLOCK_MCGIRCLK		(3)		/*4 MHz internal reference, on in VLPR*/
+
+/*
+ * @brief Waits for the start of the next tick
+ *
+ * @return void
+ */
+static void wait_for_tick(void)
+{
+	ticktime tick = now();
+
+	while (tick == now())
+	{
+	}
+}
+
+/*
+ * @brief Time since the tick started from the SysTick count, read before it is reloaded
+ *
+ * The count ran on both clocks during the switch, it is converted with the slower one
+ *
+ * @return microseconds, an upper bound
+ */
+static uint32_t switch_latency_us(void)
+{
+	return (SysTick->LOAD - SysTick->VAL) * TIMEBASE_SYSTICK_DIVIDER / SLOWEST_CORE_MHZ;
+}
+
+/*
+ * @brief Moves the debug UART to a new clock at the same baud rate, once the last byte is out
+ *
+ * @param1 SOPT2 UART0SRC
+ * @param2 clock in Hz
+ * @return void
+ */
+static void retime_debug_uart(uint32_t source, uint32_t clockHz)
+{
+	while (!(UART0->S1 & UART0_S1_TC_MASK))
+	{
+	}
+	CLOCK_SetLpsci0Clock(source);
+	(void)LPSCI_SetBaudRate(UART0, BOARD_DEBUG_UART_BAUDRATE, clockHz);
+}
+
+/*
+ * @brief Enters VLPR: BLPI mode of the MCG on the 4 MHz fast internal reference, 800 kHz bus
+ *
+ * CLOCK_SetMcgConfig() walks PEE, PBE, FBE, FBI to BLPI. The core may only enter VLPR once it
+ * runs at 4 MHz or less and the bus at 1 MHz or less. The PLL is off in BLPI, the debug UART
+ * moves from it to MCGIRCLK, 115200 baud is 114286 there (0.8 %, OSR 7 and SBR 5)
+ *
+ * @return microseconds from the tick to the new clock, an upper bound
+ */
+uint32_t power_mode_vlpr(void)
+{
+	uint32_t latency;
+
+	wait_for_tick();
+	CLOCK_SetSimSafeDivs();
+	CLOCK_SetMcgConfig(&mcgConfig_BOARD_BootClockVLPR);
+	CLOCK_SetSimConfig(&simConfig_BOARD_BootClockVLPR);
+	SMC_SetPowerModeProtection(SMC, kSMC_AllowPowerModeAll);
+#if (defined(FSL_FEATURE_SMC_HAS_LPWUI) && FSL_FEATURE_SMC_HAS_LPWUI)
+	SMC_SetPowerModeVlpr(SMC, false);
+#else
+	SMC_SetPowerModeVlpr(SMC);
+#endif
+	while (SMC_GetPowerModeState(SMC) != kSMC_PowerStateVlpr)
+	{
+	}
+	SystemCoreClock = BOARD_BOOTCLOCKVLPR_CORE_CLOCK;
+
+	latency = switch_latency_us();
+	/*The TPM runs from the internal reference, the PLL is off, and stays at 500 Hz*/
+	timebase_switch(SystemCoreClock, TIMEBASE_TPM_MCGIRCLK, CLOCK_GetFreq(kCLOCK_McgInternalRefClk));
+	retime_debug_uart(UART0_CLOCK_MCGIRCLK, CLOCK_GetFreq(kCLOCK_McgInternalRefClk));
+	return latency;
+}
+
+/*
+ * @brief Returns to RUN: PEE mode of the MCG on the 8 MHz crystal, 48 MHz core
+ *
+ * VLPR is left first, the clocks may only go up in RUN. CLOCK_SetMcgConfig() goes back
+ * through FEI, FBE and PBE and waits for the PLL to lock
+ *
+ * @return microseconds from the tick to the new clock, an upper bound
+ */
+uint32_t power_mode_run(void)
+{
+	uint32_t latency;
+
+	wait_for_tick();
+	SMC_SetPowerModeRun(SMC);
+	while (SMC_GetPowerModeState(SMC) != kSMC_PowerStateRun)
+	{
+	}
+	CLOCK_SetSimSafeDivs();
+	CLOCK_SetMcgConfig(&mcgConfig_BOARD_BootClockRUN);
+	CLOCK_SetSimConfig(&simConfig_BOARD_BootClockRUN);
+	SystemCoreClock = BOARD_BOOTCLOCKRUN_CORE_CLOCK;
+
+	latency = switch_latency_us();
+	timebase_switch(SystemCoreClock, TIMEBASE_TPM_PLLFLL, CLOCK_GetFreq(kCLOCK_PllFllSelClk));
+	retime_debug_uart(UART0_CLOCK_PLLFLL, CLOCK_GetFreq(kCLOCK_PllFllSelClk));
+	return latency;
+}
+
+#endif /* defined(NIGHT_MODE) */
@@ -0,0 +1,37 @@
+/**
+ * @file    power_mode.h
+ * @brief   This header file consists of the switches between the 48 MHz RUN clock profile and
+ * 			the 4 MHz VLPR profile of board/clock_config.c, with the SysTick and the TPM
+ * 			modules moved to the new clock
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 15 System Mode Controller and chapter 24
+ * 	  Multipurpose Clock Generator
+ */
+
+#ifndef POWER_MODE_H_
+#define POWER_MODE_H_
+
+#include <stdint.h>
+
+/*
+ * @brief Enters VLPR: BLPI mode of the MCG on the 4 MHz fast internal reference, 800 kHz bus
+ *
+ * Waits for the next tick first, so the tick is stretched by the switch alone. The debug
+ * UART is clocked from the PLL and stays silent until power_mode_run()
+ *
+ * @return microseconds from the tick to the new clock, an upper bound
+ */
+uint32_t power_mode_vlpr(void);
+
+/*
+ * @brief Returns to RUN: PEE mode of the MCG on the 8 MHz crystal, 48 MHz core
+ *
+ * @return microseconds from the tick to the new clock, an upper bound
+ */
+uint32_t power_mode_run(void);
+
+#endif /* POWER_MODE_H_ */
@@ -13,6 +13,9 @@
 
 #include <MKL25Z4.h>
 #include <pwm.h>
+#include "timebase.h"
+#include "conflict_monitor.h"
+#include "inputrec.h"
 
 #define RED_LED_PIN (18)								/*Macro for port B 18th pin to access it as red led*/
 #define RED_LED_PIN_CTRL_REG PORTB->PCR[RED_LED_PIN]/*Program control Register macro for port B 18th pin*/
@@ -28,12 +31,38 @@
 #define CHANNEL_0 	(0)
 
 #define CONTINUE_OPERATION (3)
+#define COLOUR_SHIFT		(8) /*A colour value is loaded as value << 8 counts of the 48 MHz period*/
+#define DUTY_SCALE_SHIFT	(16)
+
+static uint16_t ledColour[3]; /*Red, green, blue last written, loaded again on a clock switch*/
+
+/*
+ * @brief: Selects the TPM clock source of the timebase, PLLFLLSEL picks MCGPLLCLK/2 for the
+ * 		   PLL/FLL source
+ * @return:void
+ */
+static void select_tpm_clock(void)
+{
+	SIM->SOPT2 = (SIM->SOPT2 & ~SIM_SOPT2_TPMSRC_MASK) | SIM_SOPT2_TPMSRC(timebase.tpmSource) |
+				 SIM_SOPT2_PLLFLLSEL_MASK;
+}
+
+/*
+ * @brief: Counts of the timebase PWM period for a colour value, timebase_compute() keeps the
+ * 		   dutyScale at most one so the product fits 32 bits
+ * @param: colour value ranging from 0-255
+ * @return:CnV value
+ */
+static uint16_t duty_counts(uint16_t value)
+{
+	return (uint16_t)(((uint32_t)(value << COLOUR_SHIFT) * timebase.dutyScale) >> DUTY_SCALE_SHIFT);
+}
 /*
  * @brief: Initializes the Timer PWM module 0 channel 1 connected to blue led (Port D 1)
  * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
  * @return:void
  */
-void Init_Blue_LED_PWM(uint16_t period)
+void Init_Blue_LED_PWM(void)
 {
 	/*Initialization of clock for port D and configuration of port D 1st pin for TPM*/
 
@@ -47,10 +76,9 @@ void Init_Blue_LED_PWM(uint16_t period)
 	/*Configuring the TPM0 module with channel 1 */
 	SIM->SCGC6 |= SIM_SCGC6_TPM0_MASK;/*Setting the clock controlled by the System Integration Module
 	 	 	 	 	 	 	 	 	 	 for TPM module*/
-	SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK); /*Setting the clock source for
-																	TPM as 48 MHz*/
-	TPM0->MOD = period-1; /*Loading the MOD value with 47999 for 500 Hz PWM frequency*/
-	TPM0->SC =  TPM_SC_PS(1);/*Configuring TPM as UP counter with a prescaler of 2*/
+	select_tpm_clock(); /*Setting the clock source for TPM, 48 MHz at boot*/
+	TPM0->MOD = timebase.tpmMod; /*Loading the MOD value, 47999 at 48 MHz for 500 Hz PWM frequency*/
+	TPM0->SC =  TPM_SC_PS(timebase.tpmPrescaler);/*Configuring TPM as UP counter, a prescaler of 2 at 48 MHz*/
 	TPM0->CONF |= TPM_CONF_DBGMODE(CONTINUE_OPERATION);/*Continuing operation in debug mode*/
 	TPM0->CONTROLS[CHANNEL_1].CnSC = TPM_CnSC_MSB_MASK | TPM_CnSC_ELSA_MASK; /*Setting channel 1 of TPM0
 																			to edge-aligned low-true PWM*/
@@ -65,7 +93,7 @@ void Init_Blue_LED_PWM(uint16_t period)
  * @return:void
  */
 
-void Init_Red_LED_PWM(uint16_t period)
+void Init_Red_LED_PWM(void)
 {
 	/*Initialization of clock for port B and configuration of port B 18th pin for TPM*/
 
@@ -79,10 +107,9 @@ void Init_Red_LED_PWM(uint16_t period)
 	/*Configuring the TPM2 module with channel 0 */
 	SIM->SCGC6 |= SIM_SCGC6_TPM2_MASK; /*Setting the clock controlled by the System Integration Module
 	 	 	 	 	 	 	 	 	 	 for TPM module*/
-	SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK);/*Setting the clock source
-	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 for TPM as 48 MHz*/
-	TPM2->MOD = period-1;/*Loading the MOD value with 47999 for 500 Hz PWM frequency*/
-	TPM2->SC =  TPM_SC_PS(1);/*Configuring TPM as UP counter with a prescaler of 2*/
+	select_tpm_clock();/*Setting the clock source for TPM, 48 MHz at boot*/
+	TPM2->MOD = timebase.tpmMod;/*Loading the MOD value, 47999 at 48 MHz for 500 Hz PWM frequency*/
+	TPM2->SC =  TPM_SC_PS(timebase.tpmPrescaler);/*Configuring TPM as UP counter, a prescaler of 2 at 48 MHz*/
 	TPM2->CONF |= TPM_CONF_DBGMODE(CONTINUE_OPERATION);/*Continuing operation in debug mode*/
 	TPM2->CONTROLS[CHANNEL_0].CnSC = TPM_CnSC_MSB_MASK | TPM_CnSC_ELSA_MASK; /*Setting channel 0 of TPM2
 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 to edge-aligned low-true PWM*/
@@ -95,7 +122,7 @@ void Init_Red_LED_PWM(uint16_t period)
  * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
  * @return:void
  */
-void Init_Green_LED_PWM(uint16_t period)
+void Init_Green_LED_PWM(void)
 {
 	/*Configuration of port B 19th pin for TPM*/
 	GREEN_LED_PIN_CTRL_REG &= ~PORT_PCR_MUX_MASK; /*Masking PortB 18 Pin Control Register with 0x700
@@ -106,10 +133,9 @@ void Init_Green_LED_PWM(uint16_t period)
 	/*Configuring the TPM2 module with channel 1 */
 	SIM->SCGC6 |= SIM_SCGC6_TPM2_MASK;/*Setting the clock controlled by the System Integration Module
 	 	 	 	 	 	 	 	 	 	 for TPM module*/
-	SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK);/*Setting the clock source
-	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 for TPM as 48 MHz*/
-	TPM2->MOD = period-1;/*Loading the MOD value with 47999 for 500 Hz PWM frequency*/
-	TPM2->SC =  TPM_SC_PS(1);/*Configuring TPM as UP counter with a prescaler of 2*/
+	select_tpm_clock();/*Setting the clock source for TPM, 48 MHz at boot*/
+	TPM2->MOD = timebase.tpmMod;/*Loading the MOD value, 47999 at 48 MHz for 500 Hz PWM frequency*/
+	TPM2->SC =  TPM_SC_PS(timebase.tpmPrescaler);/*Configuring TPM as UP counter, a prescaler of 2 at 48 MHz*/
 	TPM2->CONF |= TPM_CONF_DBGMODE(CONTINUE_OPERATION);/*Continuing operation in debug mode*/
 	TPM2->CONTROLS[CHANNEL_1].CnSC = TPM_CnSC_MSB_MASK | TPM_CnSC_ELSA_MASK;/*Setting channel 0 of TPM2
 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 to edge-aligned low-true PWM*/
@@ -117,11 +143,42 @@ void Init_Green_LED_PWM(uint16_t period)
 	TPM2->SC |= TPM_SC_CMOD(1);/*Enabling the TPM module*/
 }
 
+/*
+ * @brief: Moves TPM0 and TPM2 to the clock source, prescaler and MOD of the timebase after
+ * 		   a clock switch, the colour on the LEDs is kept
+ *
+ * The PWM stays at 500 Hz, the duty cycles are loaded again in counts of the new period
+ *
+ * @return:void
+ */
+void retime_pwm(void)
+{
+	/*The clock source and the prescaler may only change while the counters are disabled*/
+	TPM0->SC &= ~TPM_SC_CMOD_MASK;
+	TPM2->SC &= ~TPM_SC_CMOD_MASK;
+	while ((TPM0->SC & TPM_SC_CMOD_MASK) || (TPM2->SC & TPM_SC_CMOD_MASK))
+	{
+	}
+	select_tpm_clock();
+	TPM0->MOD = timebase.tpmMod;
+	TPM2->MOD = timebase.tpmMod;
+	TPM0->CNT = 0;		/*Any write clears the counter, a count past the new MOD would run to 0xFFFF*/
+	TPM2->CNT = 0;
+	TPM2->CONTROLS[0].CnV = duty_counts(ledColour[0]);
+	TPM2->CONTROLS[1].CnV = duty_counts(ledColour[1]);
+	TPM0->CONTROLS[1].CnV = duty_counts(ledColour[2]);
+	TPM0->SC = TPM_SC_PS(timebase.tpmPrescaler);
+	TPM2->SC = TPM_SC_PS(timebase.tpmPrescaler);
+	TPM0->SC |= TPM_SC_CMOD(1);
+	TPM2->SC |= TPM_SC_CMOD(1);
+}
+
 /*
  * @brief: Updating the on-board Red, Blue, Green colors through PWM signal
  *
  * According to the state machine, the red, blue, green values are updated according to
- * the PWM frequency and multiplied with 0xFF for more led brightness
+ * the PWM frequency and multiplied with 0xFF for more led brightness. Every colour is
+ * checked by the conflict monitor first, an illegal colour is never written
  *
  * @param1: Red value to be loaded with TPM 2 Channel 0 ranging from 0-255
  * @param2: Green value to be loaded with TPM 2 Channel 1 ranging from 0-255
@@ -131,9 +188,49 @@ void Init_Green_LED_PWM(uint16_t period)
 
 void update_led_colour(uint16_t redValue1,uint16_t greenValue1,uint16_t blueValue1)
 {
-	/*Setting the duty cycle for Red, Green, Blue each ranging from 0-255 */
+	if(!conflict_monitor_commit(redValue1,greenValue1,blueValue1))
+	{
+		return;		/*Illegal colour or the fail-safe is running*/
+	}
+	force_led_colour(redValue1,greenValue1,blueValue1);
+}
+
+/*
+ * @brief: Writes the on-board Red, Blue, Green colors without the conflict monitor check and
+ * 		   without recording them, the boot shows its red before the recording starts
+ *
+ * @param1: Red value to be loaded with TPM 2 Channel 0 ranging from 0-255
+ * @param2: Green value to be loaded with TPM 2 Channel 1 ranging from 0-255
+ * @param3: Blue value to be loaded with TPM 0 Channel 1 ranging from 0-255
+ * @return:void
+ */
+void show_led_colour(uint16_t redValue1,uint16_t greenValue1,uint16_t blueValue1)
+{
+	/*Setting the duty cycle for Red, Green, Blue each ranging from 0-255, scaled to the PWM
+	 period of the active clock*/
+
+   	ledColour[0] = redValue1;
+   	ledColour[1] = greenValue1;
+   	ledColour[2] = blueValue1;
+   	TPM2->CONTROLS[0].CnV = duty_counts(redValue1);
+   	TPM2->CONTROLS[1].CnV = duty_counts(greenValue1);
+   	TPM0->CONTROLS[1].CnV = duty_counts(blueValue1);
+}
 
-   	TPM2->CONTROLS[0].CnV = redValue1 << 0x08;
-   	TPM2->CONTROLS[1].CnV = greenValue1 << 0x08;
-   	TPM0->CONTROLS[1].CnV = blueValue1 << 0x08;
+/*
+ * @brief: Writes the on-board Red, Blue, Green colors without the conflict monitor check
+ *
+ * Used by update_led_colour() once the colour is checked and by the fail-safe
+ *
+ * @param1: Red value to be loaded with TPM 2 Channel 0 ranging from 0-255
+ * @param2: Green value to be loaded with TPM 2 Channel 1 ranging from 0-255
+ * @param3: Blue value to be loaded with TPM 0 Channel 1 ranging from 0-255
+ * @return:void
+ */
+void force_led_colour(uint16_t redValue1,uint16_t greenValue1,uint16_t blueValue1)
+{
+   	show_led_colour(redValue1,greenValue1,blueValue1);
+#if defined(INPUT_RECORD)
+   	inputrec_output(redValue1,greenValue1,blueValue1);	/*Checkpoints of the output for the replay*/
+#endif
 }
@@ -14,37 +14,44 @@
 #ifndef TIMERS_H_
 #define TIMERS_H_
 
+#include <stdbool.h>
 #include "MKL25Z4.h"
 
-#define PWM_PERIOD (48000) /*To load MOD value with 48000 for 500 Hz PWM frequency*/
-
 /*
  * @brief: Initializes the Timer PWM module 0 channel 1 connected to blue led (Port D 1)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * 		   with the clock source, prescaler and MOD of the timebase for 500 Hz PWM frequency
  * @return:void
  */
-void Init_Blue_LED_PWM(uint16_t period);
+void Init_Blue_LED_PWM(void);
 
 /*
  * @brief: Initializes the Timer PWM module 2 channel 0 connected to red led (Port B 18)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * 		   with the clock source, prescaler and MOD of the timebase for 500 Hz PWM frequency
  * @return:void
  */
-void Init_Red_LED_PWM(uint16_t period);
+void Init_Red_LED_PWM(void);
 
 /*
  * @brief: Initializes the Timer PWM module 2 channel 1 connected to green led (Port B 19)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * 		   with the clock source, prescaler and MOD of the timebase for 500 Hz PWM frequency
+ * @return:void
+ */
+void Init_Green_LED_PWM(void);
+
+/*
+ * @brief: Moves TPM0 and TPM2 to the clock source, prescaler and MOD of the timebase after
+ * 		   a clock switch, the colour on the LEDs is kept
  * @return:void
  */
-void Init_Green_LED_PWM(uint16_t period);
+void retime_pwm(void);
 
 
 /*
  * @brief: Updating the on-board Red, Blue, Green colors through PWM signal
  *
  * According to the state machine, the red, blue, green values are updated according to
- * the PWM frequency and multiplied with 0xFF for more led brightness
+ * the PWM frequency and multiplied with 0xFF for more led brightness. Every colour is
+ * checked by the conflict monitor first, an illegal colour is never written
  *
  * @param1: Red value to be loaded with TPM 2 Channel 0 ranging from 0-255
  * @param2: Green value to be loaded with TPM 2 Channel 1 ranging from 0-255
@@ -53,5 +60,28 @@ void Init_Green_LED_PWM(uint16_t period);
  */
 void update_led_colour(uint16_t redValue,uint16_t greenValue,uint16_t blueValue);
 
+/*
+ * @brief: Writes the on-board Red, Blue, Green colors without the conflict monitor check
+ *
+ * Used by update_led_colour() once the colour is checked and by the fail-safe
+ *
+ * @param1: Red value to be loaded with TPM 2 Channel 0 ranging from 0-255
+ * @param2: Green value to be loaded with TPM 2 Channel 1 ranging from 0-255
+ * @param3: Blue value to be loaded with TPM 0 Channel 1 ranging from 0-255
+ * @return:void
+ */
+void force_led_colour(uint16_t redValue,uint16_t greenValue,uint16_t blueValue);
+
+/*
+ * @brief: Writes the on-board Red, Blue, Green colors without the conflict monitor check and
+ * 		   without recording them, the boot shows its red before the recording starts
+ *
+ * @param1: Red value to be loaded with TPM 2 Channel 0 ranging from 0-255
+ * @param2: Green value to be loaded with TPM 2 Channel 1 ranging from 0-255
+ * @param3: Blue value to be loaded with TPM 0 Channel 1 ranging from 0-255
+ * @return:void
+ */
+void show_led_colour(uint16_t redValue,uint16_t greenValue,uint16_t blueValue);
+
 
 #endif /* TIMERS_H_ */
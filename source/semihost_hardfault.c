@@ -77,8 +77,11 @@ void HardFault_Handler(void){
             "LDR    R3,=0xBEAB \n"
             "CMP     R2,R3 \n"
             "BEQ    _semihost_return \n"
-        // Wasn't semihosting instruction so enter infinite loop
-            "B . \n"
+        // Wasn't semihosting instruction so save a crash dump and reset,
+        // crashdump_capture(frame in R0, EXC_RETURN in R1) does not return
+            "MOV    R1, LR \n"
+            "LDR    R2,=crashdump_capture \n"
+            "BX     R2 \n"
         // Was semihosting instruction, so adjust location to
         // return to by 1 instruction (2 bytes), then exit function
         "_semihost_return: \n"
@@ -18,6 +18,17 @@
 #include "switch.h"
 #include "pwm.h"
 #include "log.h"
+#include "metrics.h"
+#include "crosswalk_policy.h"
+#include "adaptive_timing.h"
+#include "conflict_monitor.h"
+#include "watchdog.h"
+#include "mtb.h"
+#include "inputrec.h"
+#include "greenwave.h"
+#include "telemetry.h"
+#include "night_mode.h"
+#include "console.h"
 
 
 #define STOP_RED_VALUE 	 			(0x61)
@@ -37,240 +48,574 @@
 #define WARNING_GREEN_VALUE 		(0xB2)
 #define WARNING_BLUE_VALUE			(0x00)
 
-#define START							(0)
-#define STOP							(1)
-#define TRANSITION_TO_GO				(2)
-#define GO				 				(3)
-#define TRANSITION_TO_WARNING			(4)
-#define WARNING							(5)
-#define TRANSITION_TO_STOP				(6)
-#define CROSSWALK 						(7)
-#define TRANSITION_TO_CROSSWALK			(8)
-#define TRANSITION_FROM_CROSSWALK		(9)
-#define CROSSWALK_LED_ON				(10)
-#define CROSSWALK_LED_OFF				(11)
-
 #ifdef DEBUG
 #define STOP_GO_TIME					(80)
 #define WARNING_TIME					(48)
+#define MAX_PEDESTRIAN_WAIT			   (224)	/*Longest press to walk time, 14 seconds*/
 #else
 #define STOP_GO_TIME					(320)
 #define WARNING_TIME					 (80)
+#define MAX_PEDESTRIAN_WAIT			   (272)	/*Longest press to walk time, 17 seconds*/
 #endif
 
 #define TRANSITION_TIME 				(16)
 #define CROSSWALK_TIME 				   (160)
 
-#define RESET 							(0)
-#define SET								(1)
+#define MIN_GREEN_TIME		   (STOP_GO_TIME/4)	/*GO protected from crosswalk preemption*/
+#define LATE_JOIN_TIME					(48)	/*Presses in the first 3 seconds of the walk are served by it*/
+
+/*A press latched at the start of a walk waits for it, the transition out, MIN_GREEN_TIME and
+  the transition into the next walk, crosswalk_policy_wait_bound()*/
+_Static_assert(MAX_PEDESTRIAN_WAIT >= CROSSWALK_TIME + 2*TRANSITION_TIME + MIN_GREEN_TIME,
+			   "a press can wait longer than MAX_PEDESTRIAN_WAIT");
+
+/*Allow the GO to follow the vehicle detector by setting a define (via command line)*/
+#if defined(ADAPTIVE_TIMING)
+#define GO_MIN_TIME		   (STOP_GO_TIME/4)
+#define GO_MAX_TIME		   (STOP_GO_TIME*2)
+#define GO_PASSAGE_TIME					(32)	/*2 seconds of green per vehicle after the minimum*/
+#else
+#define GO_MIN_TIME				(STOP_GO_TIME)	/*Fixed time GO*/
+#define GO_MAX_TIME				(STOP_GO_TIME)
+#define GO_PASSAGE_TIME					(0)
+#endif
 
 #define PRESSED							(1)
 #define NOT_PRESSSED					(0)
 
-#define SCALING_FACTOR					(0.0625)
-#define TICKS_FOR_SECOND				(16)
-#define TICKS_FOR_750MS					(12)
+#define FADE_SHIFT						(4)		/*Fades move in sixteenths of the way*/
+
+static const sm_colour_t stopColour={STOP_RED_VALUE,STOP_GREEN_VALUE,STOP_BLUE_VALUE};
+static const sm_colour_t goColour={GO_RED_VALUE,GO_GREEN_VALUE,GO_BLUE_VALUE};
+static const sm_colour_t warningColour={WARNING_RED_VALUE,WARNING_GREEN_VALUE,WARNING_BLUE_VALUE};
+static const sm_colour_t crosswalkColour={CROSSWALK_RED_VALUE,CROSSWALK_GREEN_VALUE,CROSSWALK_BLUE_VALUE};
+static const sm_colour_t offColour={0,0,0};
+
+const sm_config_t smDefaultConfig={
+	.stopTicks=STOP_GO_TIME,
+	.warningTicks=WARNING_TIME,
+	.transitionTicks=TRANSITION_TIME,
+	.crosswalkTicks=CROSSWALK_TIME,
+	.policy={
+		.minGreenTicks=MIN_GREEN_TIME,
+		.maxWaitTicks=MAX_PEDESTRIAN_WAIT,
+		.leadTicks=TRANSITION_TIME,
+		.lateJoinTicks=LATE_JOIN_TIME,
+		.latchDuringWalk=true
+	},
+	/*Ends the GO from the vehicle detector actuations, or after STOP_GO_TIME by default*/
+	.timing={
+		.minGreenTicks=GO_MIN_TIME,
+		.maxGreenTicks=GO_MAX_TIME,
+		.passageTicks=GO_PASSAGE_TIME
+	}
+};
+
+/*Instance run by statemachine_poll()*/
+static sm_ctx_t smContext;
+
+/*Colours the conflict monitor allows to be committed in every state, the transitions may
+  show any colour between the two colours they fade between*/
+static const conflict_monitor_rule_t colourRules[SM_STATE_COUNT]={
+	[START]=MONITOR_RULE_EXACT(STOP_RED_VALUE,STOP_GREEN_VALUE,STOP_BLUE_VALUE,
+							   STOP_RED_VALUE,STOP_GREEN_VALUE,STOP_BLUE_VALUE),
+	[STOP]=MONITOR_RULE_EXACT(STOP_RED_VALUE,STOP_GREEN_VALUE,STOP_BLUE_VALUE,
+							  STOP_RED_VALUE,STOP_GREEN_VALUE,STOP_BLUE_VALUE),
+	[TRANSITION_TO_GO]=MONITOR_RULE_BETWEEN(STOP_RED_VALUE,STOP_GREEN_VALUE,STOP_BLUE_VALUE,
+											GO_RED_VALUE,GO_GREEN_VALUE,GO_BLUE_VALUE),
+	[GO]=MONITOR_RULE_NONE,
+	[TRANSITION_TO_WARNING]=MONITOR_RULE_BETWEEN(GO_RED_VALUE,GO_GREEN_VALUE,GO_BLUE_VALUE,
+												 WARNING_RED_VALUE,WARNING_GREEN_VALUE,WARNING_BLUE_VALUE),
+	[WARNING]=MONITOR_RULE_NONE,
+	[TRANSITION_TO_STOP]=MONITOR_RULE_BETWEEN(WARNING_RED_VALUE,WARNING_GREEN_VALUE,WARNING_BLUE_VALUE,
+											  STOP_RED_VALUE,STOP_GREEN_VALUE,STOP_BLUE_VALUE),
+	[CROSSWALK]=MONITOR_RULE_EXACT(CROSSWALK_RED_VALUE,CROSSWALK_GREEN_VALUE,CROSSWALK_BLUE_VALUE,0,0,0),
+	/*Starts from the colour of any state, or black before the first commit*/
+	[TRANSITION_TO_CROSSWALK]=MONITOR_RULE_BETWEEN(0,0,0,WARNING_RED_VALUE,WARNING_GREEN_VALUE,STOP_BLUE_VALUE),
+	[TRANSITION_FROM_CROSSWALK]=MONITOR_RULE_BETWEEN(CROSSWALK_RED_VALUE,CROSSWALK_GREEN_VALUE,CROSSWALK_BLUE_VALUE,
+													 GO_RED_VALUE,GO_GREEN_VALUE,GO_BLUE_VALUE),
+	[CROSSWALK_LED_ON]=MONITOR_RULE_NONE,
+	[CROSSWALK_LED_OFF]=MONITOR_RULE_NONE
+};
+
+/*States stored as string, indexed by the state number. Kept in flash, or only in the .axf
+  when LOG_TOKENIZED is defined*/
+const char state[12][26] LOG_STRINGS={"START","STOP","TRANSITION_TO_GO","GO","TRANSITION_TO_WARNING",
+			  	  	 "WARNING","TRANSITION_TO_STOP","CROSSWALK","TRANSITION_TO_CROSSWALK",
+			  	  	 "TRANSITION_FROM_CROSSWALK","CROSSWALK_LED_ON","CROSSWALK_LED_OFF"};
 
-extern bool checkCrosswalkflag;/*Variable initialized in timer.c and if it is set, check whether
- 	 	 	 	 	 	 	 	 the user has pressed has the button*/
-extern volatile uint16_t checkTimeoutFlag;/*variable initialized in timer.c to check if 1ms is passed*/
+/*
+ * @brief Executes the traffic light sequence with cross-walk functionality
+ *
+ * The traffic light sequence consists of 9 states including STOP, GO, WARNING states
+ * with cross-walk state triggered through touch silder or gpio push button. Runs the
+ * sequence started by statemachine_init(), main() shows its first frame before the boot
+ * reports
+ *
+ * @return void
+ */
 
-/*To store the red, blue, green Values to be loaded to TPM modules*/
-int16_t redValue = 0;
-int16_t greenValue = 0;
-int16_t blueValue = 0;
+void statemachine()
+{
+  while(1)
+  {
+	statemachine_poll();
+  }
+}
 
-/*To store the previous red, blue, green Values when there is a transition*/
-int16_t redPreviousValue = 0;
-int16_t greenPreviousValue = 0;
-int16_t bluePreviousValue = 0;
+/*
+ * @brief Starts an instance of the traffic light sequence in the STOP state
+ *
+ * @param1 instance
+ * @param2 timings, used by reference and to be kept alive as long as the instance
+ * @param3 current tick
+ * @return void
+ */
+void sm_init(sm_ctx_t *ctx, const sm_config_t *config, ticktime now)
+{
+  ctx->config=config;
+  ctx->state=STOP;
+  ctx->stateStart=now;
+  ctx->inputTick=now;
+  ctx->fadeTick=now;
+  ctx->fadeStep=0;
+  ctx->colour=offColour;
+  ctx->fadeFrom=offColour;
+  ctx->stopTrim=0;
+  crosswalk_policy_init(&ctx->policy,&config->policy);
+  adaptive_timing_init(&ctx->timing,&config->timing);
+}
 
-/*To calculate the colour value periodically every 62.5 msec when there is a transition*/
-int16_t percentageIncrement=0;
+/*
+ * @brief Whether the next sm_step() takes the inputs, they are sampled once every tick
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @return true if the inputs are to be sampled for the next step
+ */
+bool sm_inputs_due(const sm_ctx_t *ctx, ticktime now)
+{
+  return now != ctx->inputTick;
+}
 
-/*States stored as string*/
-char state[9][26]={"START","STOP","TRANSITION_TO_GO","GO","TRANSITION_TO_WARNING","TRANSITION_TO_STOP",
-			  	  	 "CROSSWALK","TRANSITION_TO_CROSSWALK","TRANSITION_FROM_CROSSWALK"};
+/*
+ * @brief Current state of an instance
+ *
+ * @param1 instance
+ * @return one of the state IDs defined in statemachine.h
+ */
+uint8_t sm_state(const sm_ctx_t *ctx)
+{
+  return ctx->state;
+}
 
 /*
- * @brief Executes the traffic light sequence with cross-walk functionality
+ * @brief Colours a state shows, for callers which compute them without sm_step()
  *
- * The traffic light sequence consists of 9 states including STOP, GO, WARNING states
- * with cross-walk state triggered through touch silder or gpio push button
+ * @param1 state
+ * @param2 colour at the start of the state
+ * @param3 colour at its end
+ * @return true if the state shows a colour, false for black
+ */
+bool sm_state_colours(uint8_t stateId, sm_colour_t *from, sm_colour_t *to)
+{
+  *from=*to=offColour;
+  switch(stateId)
+  {
+	case STOP:
+		*from=*to=stopColour;
+	break;
+	case TRANSITION_TO_GO:
+		*from=stopColour;
+		*to=goColour;
+	break;
+	case TRANSITION_TO_WARNING:
+		*from=goColour;
+		*to=warningColour;
+	break;
+	case TRANSITION_TO_STOP:
+		*from=warningColour;
+		*to=stopColour;
+	break;
+	case TRANSITION_TO_CROSSWALK:
+		*to=crosswalkColour;
+	break;
+	case CROSSWALK:
+		*from=*to=crosswalkColour;
+	break;
+	case TRANSITION_FROM_CROSSWALK:
+		*from=crosswalkColour;
+		*to=goColour;
+	break;
+	default:
+		return false;
+  }
+  return true;
+}
+
+/*
+ * @brief Enters a state, its duration and a fade in it start from the current tick
  *
+ * @param1 instance
+ * @param2 state entered
+ * @param3 current tick
  * @return void
  */
+static void sm_enter(sm_ctx_t *ctx, uint8_t nextState, ticktime now)
+{
+  ctx->state=nextState;
+  ctx->stateStart=now;
+  ctx->fadeStep=0;			/*Resetting to 0 to calculate colour from 0 to 1000 msec*/
+}
 
-void statemachine()
+/*
+ * @brief One step of a fade, step sixteenths of the way from one value to the other
+ *
+ * Eg: For a Red colour to tansition fro STOP to GO
+ * Assume Start Value : 0x61, End Value:0x22
+ * Formula = (0x61*16 + (0x22 - 0x61)*1) >> 4 = 0x5D
+ * Integer only, it gives the same values as (end - start)*0.0625*step + start in floating point
+ *
+ * @param1 value at step 0
+ * @param2 value at step 16
+ * @param3 step
+ * @return value
+ */
+static inline int16_t sm_fade(int16_t from, int16_t to, int16_t step)
 {
-  uint8_t currentState=STOP; /*The initial state will be stop*/
+  return (int16_t)(((from<<FADE_SHIFT)+(to-from)*step)>>FADE_SHIFT);
+}
 
-  reset_timer();
-  LOG("\n Currently in %s STATE at %ld msec",state+currentState,current_time());
-  while(1)
-  {
-	if(checkCrosswalkflag == SET)		/*Checking every 62.5 msec whether crosswalk is enabled */
+/*
+ * @brief The red, green and blue values to be loaded with TPM modules, one step of a fade,
+ * 		  or the colour of a state which does not fade when both colours are the same
+ *
+ * The colour is stored from registers to both the instance and the caller, reading back a
+ * colour just stored a field at a time stalls the store forwarding of the host
+ *
+ * @param1 instance
+ * @param2 colour at the start of the fade
+ * @param3 colour at its end
+ * @param4 colour computed
+ * @return void
+ */
+static inline void sm_set_colour(sm_ctx_t *ctx, const sm_colour_t *from, const sm_colour_t *to, sm_colour_t *colour)
+{
+	int16_t red, green, blue;
+
+	if(from == to)
 	{
-	   if(currentState!=CROSSWALK && currentState!=TRANSITION_TO_CROSSWALK /*Conditions for crosswalk*/
-		  && check_button_pressed())									   /*to be implemented*/
-	   {
-		   LOG("\nButton press is detected at %ld msec",current_time());
-		   redPreviousValue=redValue;
-		   greenPreviousValue=greenValue;
-		   bluePreviousValue=blueValue;
-		   percentageIncrement=0;
-		   currentState=TRANSITION_TO_CROSSWALK;
-		   reset_timer();
-		   LOG("\nChanging from %s to TRANSITION_TO_CROSSWALK state at %ld msec",state[currentState],current_time());
-	   }
-	 checkCrosswalkflag=RESET;
+		red=from->red;
+		green=from->green;
+		blue=from->blue;
+	}
+	else
+	{
+		int16_t step=ctx->fadeStep++;
+
+		red=sm_fade(from->red,to->red,step);
+		green=sm_fade(from->green,to->green,step);
+		blue=sm_fade(from->blue,to->blue,step);
 	}
+	ctx->colour.red=colour->red=(uint8_t)red;
+	ctx->colour.green=colour->green=(uint8_t)green;
+	ctx->colour.blue=colour->blue=(uint8_t)blue;
+}
 
-   	switch(currentState)
-   	{
-   		case STOP:
-
-   			if(get_timer() < STOP_GO_TIME)			/*To be in stop state till 5 seconds is reached*/
-   			{
-   				set_led_colour(START);
-   			}
-   			else if(get_timer() >= STOP_GO_TIME)
-   			{
-   				reset_timer();					/**/
-   				percentageIncrement=0;			/*Resetting to 0 to calculate colour from 0 to 1000 msec*/
-   				currentState=TRANSITION_TO_GO;
-   				LOG("\nChanging from STOP to TRANSITION_TO_GO state at %ld msec",current_time());
-   			}
-   		break;
-
-   		case TRANSITION_TO_GO:
-
-   			if((checkTimeoutFlag == SET) && (get_timer() < TRANSITION_TIME))
-   			{
-   				checkTimeoutFlag = RESET;
-   				set_led_colour(STOP);		/*Setting the led colour with previous state
-   				 	 	 	 	 	 	 	 value passed as an argument*/
-   			}
-   			else if(get_timer() >= TRANSITION_TIME)
-   			{
-   				reset_timer();
-   				currentState=GO;
-   				LOG("\nChanging from TRANSITION_TO_GO to GO state at %ld msec",current_time());
-
-   			}
-   		break;
-
-   		case GO:
-   			if(get_timer() >= STOP_GO_TIME)
-   			{
-   			    percentageIncrement=0;
-   			    currentState=TRANSITION_TO_WARNING;
-   			    reset_timer();
-				LOG("\nChanging from GO to TRANSIITON_TO_WARNING state at %ld msec",current_time());
-
-   			}
-   		break;
-
-   		case TRANSITION_TO_WARNING:
-   			 if( (checkTimeoutFlag == SET) && get_timer() < TRANSITION_TIME)
-   			 {
-   				 checkTimeoutFlag =RESET;
-   			     set_led_colour(GO);
-
-   			 }
-   			 else if(get_timer() >= TRANSITION_TIME)
-   			 {
-   			     reset_timer();
-   			     currentState=WARNING;
-   			     LOG("\nChanging from TRANSITION_TO_WARNING to WARNING state at %ld msec",current_time());
-   			 }
-   		break;
-
-   		case WARNING:
-   			if(get_timer() >= WARNING_TIME)
-   		    {
-   				percentageIncrement=0;
-   		    	reset_timer();
-   		    	currentState=TRANSITION_TO_STOP;
-   		    	LOG("\nChanging from WARNING to TRANSITION_TO_STOP state at %ld msec",current_time());
-   		    }
-   		break;
-
-   		case TRANSITION_TO_STOP:
-   			if((checkTimeoutFlag == SET) && get_timer() < TRANSITION_TIME)
-   			{
-   			    checkTimeoutFlag=RESET;
-   			    set_led_colour(WARNING);
-
-   			}
-   			else if(get_timer() >= TRANSITION_TIME)
-   			{
-   			    reset_timer();
-   			    currentState=STOP;
-   				LOG("\nChanging from TRANSITION_TO_STOP to STOP state at %ld msec",current_time());
-   			}
-   		break;
-
-   		case TRANSITION_TO_CROSSWALK:		/*Crosswalk state is reached when button is pressed*/
-   			if((checkTimeoutFlag == SET) && get_timer() < TRANSITION_TIME)
-   			{
-   			    checkTimeoutFlag=RESET;
-   			    set_led_colour(TRANSITION_TO_CROSSWALK);
-
-   			}
-   			else if(get_timer() >= TRANSITION_TIME)
-   	    	{
-   	    		reset_timer();
-   	    		currentState=CROSSWALK;
-   	    		LOG("\nchanging from TRANSITION_TO_CROSSWALK to CROSSWALK state %ld msec",current_time());
-   	    	}
-   			break;
-
-   		case CROSSWALK:
-   			if(get_timer() < CROSSWALK_TIME)
-   			{
-
-   				if((get_timer() % TICKS_FOR_SECOND) <= TICKS_FOR_750MS)/*Turning on the led for 750ms*/
-   				{
-   					set_led_colour(CROSSWALK_LED_ON);
-   				}
-   				else if((get_timer() % TICKS_FOR_SECOND) > TICKS_FOR_750MS)/*Turning off the led for 750ms*/
-   				{
-   					set_led_colour(CROSSWALK_LED_OFF);
-   				}
-
-   			}
-   			if(get_timer()>= CROSSWALK_TIME)
-   			{
-   				reset_timer();
-   				percentageIncrement=0;
-   				currentState=TRANSITION_FROM_CROSSWALK;
-   				LOG("\nchanging from CROSSWALK to TRANSITION_FROM_CROSSWALK state %ld msec",current_time());
-   			}
-   		break;
-
-   		case TRANSITION_FROM_CROSSWALK:/*After crosswalk, the next state is GO*/
-   			{
-   				 if( (checkTimeoutFlag == SET) && get_timer() < TRANSITION_TIME)
-   				 {
-   				    checkTimeoutFlag =RESET;
-   				    set_led_colour(CROSSWALK);
-   				 }
-   				 else if(get_timer() >= TRANSITION_TIME)
-   				 {
-   				    reset_timer();
-   				    currentState=GO;
-   				    LOG("\nchanging from TRANSITION_FROM_CROSSWALK to GO state %ld msec",current_time());
-   				 }
-   			}
-   		break;
-   	}
-  }
+/*
+ * @brief One step of the fade of a transition every tick, then the next state
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 colour the fade starts from
+ * @param4 colour the fade ends at
+ * @param5 state after the transition
+ * @param6 outputs of the step
+ * @return void
+ */
+static void sm_transition(sm_ctx_t *ctx, ticktime now, const sm_colour_t *from, const sm_colour_t *to,
+						  uint8_t nextState, sm_outputs_t *outputs)
+{
+	if((ctx->fadeTick != now) && ((now - ctx->stateStart) < ctx->config->transitionTicks))
+	{
+		ctx->fadeTick=now;
+		sm_set_colour(ctx,from,to,&outputs->colour);
+		outputs->write=true;
+	}
+	else if((now - ctx->stateStart) >= ctx->config->transitionTicks)
+	{
+		sm_enter(ctx,nextState,now);
+		if(nextState == GO)
+		{
+			adaptive_timing_green_start(&ctx->timing,now);
+		}
+		else if(nextState == CROSSWALK)
+		{
+			crosswalk_policy_served(&ctx->policy,now);
+		}
+	}
+}
+
+/*
+ * @brief One pass of the traffic light sequence
+ *
+ * Reads and changes nothing but the instance: no hardware, timer or logging
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 inputs, only read when sm_inputs_due() is true
+ * @param4 colour to show and the state changes, colour is only written along with write
+ * @return void
+ */
+void sm_step(sm_ctx_t *ctx, ticktime now, const sm_inputs_t *inputs, sm_outputs_t *outputs)
+{
+	const sm_config_t *config=ctx->config;
+	ticktime elapsed;
+
+	outputs->write=false;
+	outputs->pressIgnored=false;
+	outputs->previousState=ctx->state;
+
+	if(sm_inputs_due(ctx,now))		/*Checking every 62.5 msec whether crosswalk is enabled */
+	{
+		ctx->inputTick=now;
+		adaptive_timing_detector(&ctx->timing,now,inputs->actuations);
+		if(inputs->pressed)
+		{
+			/*Presses batched into a pending or running pedestrian phase are counted as ignored*/
+			outputs->pressIgnored=!crosswalk_policy_press(&ctx->policy,now,ctx->state);
+		}
+		if(crosswalk_policy_should_start(&ctx->policy,now,ctx->state)) /*Conditions for crosswalk*/
+		{
+			ctx->fadeFrom=ctx->colour;
+			sm_enter(ctx,TRANSITION_TO_CROSSWALK,now);
+		}
+	}
+
+	elapsed=now-ctx->stateStart;
+	switch(ctx->state)
+	{
+		case STOP:
+			if((int32_t)elapsed < (int32_t)config->stopTicks+ctx->stopTrim)	/*To be in stop state till 5 seconds is reached*/
+			{
+				sm_set_colour(ctx,&stopColour,&stopColour,&outputs->colour);
+				outputs->write=true;
+			}
+			else
+			{
+				sm_enter(ctx,TRANSITION_TO_GO,now);
+			}
+		break;
+
+		case TRANSITION_TO_GO:
+			sm_transition(ctx,now,&stopColour,&goColour,GO,outputs);
+		break;
+
+		case GO:
+			if(adaptive_timing_green_done(&ctx->timing,now))	/*STOP_GO_TIME, or gap-out/max-out*/
+			{
+				sm_enter(ctx,TRANSITION_TO_WARNING,now);
+			}
+		break;
+
+		case TRANSITION_TO_WARNING:
+			sm_transition(ctx,now,&goColour,&warningColour,WARNING,outputs);
+		break;
+
+		case WARNING:
+			if(elapsed >= config->warningTicks)
+			{
+				sm_enter(ctx,TRANSITION_TO_STOP,now);
+			}
+		break;
+
+		case TRANSITION_TO_STOP:
+			sm_transition(ctx,now,&warningColour,&stopColour,STOP,outputs);
+		break;
+
+		case TRANSITION_TO_CROSSWALK:		/*Crosswalk state is reached when button is pressed*/
+			sm_transition(ctx,now,&ctx->fadeFrom,&crosswalkColour,CROSSWALK,outputs);
+		break;
+
+		case CROSSWALK:
+			if(elapsed < config->crosswalkTicks)
+			{
+				/*Turning on the led for 750ms, then off for the rest of the second*/
+				const sm_colour_t *colour=((elapsed % TICKS_FOR_SECOND) <= TICKS_FOR_750MS) ? &crosswalkColour : &offColour;
+
+				sm_set_colour(ctx,colour,colour,&outputs->colour);
+				outputs->write=true;
+			}
+			else
+			{
+				sm_enter(ctx,TRANSITION_FROM_CROSSWALK,now);
+			}
+		break;
+
+		case TRANSITION_FROM_CROSSWALK:		/*After crosswalk, the next state is GO*/
+			sm_transition(ctx,now,&crosswalkColour,&goColour,GO,outputs);
+		break;
+	}
+
+	outputs->state=ctx->state;
+}
+
+/*
+ * @brief Resets the traffic light sequence to the STOP state
+ *
+ * @return void
+ */
+void statemachine_init()
+{
+  sm_init(&smContext,&smDefaultConfig,now());
+  conflict_monitor_init(&smContext.state,colourRules,SM_STATE_COUNT);
+  metrics_state_enter(smContext.state);
+  LOG("\n Currently in %s STATE at %ld msec",state[smContext.state],(long)current_time());
+}
+
+/*
+ * @brief Restarts the STOP the sequence was held in from the current tick, with its colour
+ * 		  and its conflict monitor rules, after the night flash
+ *
+ * The crosswalk policy and the adaptive timing keep their requests and statistics
+ *
+ * @return void
+ */
+void statemachine_resume()
+{
+  smContext.stateStart=now();
+  smContext.stopTrim=0;
+  smContext.colour=stopColour;
+  conflict_monitor_init(&smContext.state,colourRules,SM_STATE_COUNT);
+  update_led_colour(stopColour.red,stopColour.green,stopColour.blue);
+}
+
+/*
+ * @brief Current state of the traffic light sequence
+ *
+ * @return one of the state IDs defined in statemachine.h
+ */
+uint8_t statemachine_state()
+{
+  return sm_state(&smContext);
+}
+
+/*
+ * @brief Instance of the traffic light sequence run by statemachine_poll()
+ *
+ * @return instance
+ */
+sm_ctx_t *statemachine_context()
+{
+  return &smContext;
+}
+
+/*
+ * @brief Crosswalk policy of the traffic light sequence, to read its statistics or change its limits
+ *
+ * @return policy instance used by statemachine_poll()
+ */
+crosswalk_policy_t *statemachine_crosswalk_policy()
+{
+  return &smContext.policy;
+}
+
+/*
+ * @brief Adaptive GO timing of the traffic light sequence, to read its statistics or change its limits
+ *
+ * @return adaptive timing instance used by statemachine_poll()
+ */
+adaptive_timing_t *statemachine_adaptive_timing()
+{
+  return &smContext.timing;
+}
+
+/*
+ * @brief One pass of the traffic light sequence of the firmware
+ *
+ * Samples the crosswalk inputs once every tick, runs sm_step() and shows, logs and counts
+ * its outputs
+ *
+ * @return void
+ */
+void statemachine_poll()
+{
+	sm_inputs_t inputs={ .pressed=false, .actuations=0 };
+	sm_outputs_t outputs;
+	ticktime tick=now();
+	bool sampled=sm_inputs_due(&smContext,tick);
+
+	metrics_loop_iteration();
+	console_poll();
+#if defined(TELEMETRY)
+	telemetry_poll(tick);		/*The debug UART keeps its baud rate in VLPR, see power_mode.c*/
+#endif
+#if defined(NIGHT_MODE)
+	if(night_mode_poll(tick))
+	{
+		return;		/*Flashing at night in VLPR*/
+	}
+#endif
+#if defined(GREEN_WAVE)
+	greenwave_poll();
+#endif
+
+	if(sampled)
+	{
+		watchdog_checkin(WATCHDOG_TASK_TICK);
+		inputs.actuations=detector_actuations();
+		inputs.pressed=check_button_pressed();
+		if(inputs.pressed)
+		{
+			LOG("\nButton press is detected at %ld msec",(long)current_time());
+		}
+	}
+
+	sm_step(&smContext,tick,&inputs,&outputs);
+
+	if(inputs.pressed)
+	{
+		metrics_crosswalk_request(outputs.pressIgnored);
+	}
+	if(inputs.actuations != 0)
+	{
+		metrics_actuations(inputs.actuations);
+	}
+	if(outputs.state != outputs.previousState)
+	{
+		metrics_state_enter(outputs.state);
+#if defined(TELEMETRY)
+		telemetry_state_event(outputs.state,tick);
+#endif
+		LOG("\nChanging from %s to %s state at %ld msec",state[outputs.previousState],state[outputs.state],(long)current_time());
+#if defined(MTB_TRACE_PREEMPTION)
+		if(outputs.state == TRANSITION_TO_CROSSWALK)
+		{
+			mtb_trace_start(true);		/*Keeps the first branches of the preemption, 't' exports them*/
+		}
+#endif
+#if defined(GREEN_WAVE)
+		if(outputs.state == STOP)		/*Moves the next GO start to its offset in the shared cycle*/
+		{
+			smContext.stopTrim=greenwave_trim(smContext.config->stopTicks+smContext.config->transitionTicks);
+		}
+#endif
+	}
+	if(outputs.write)
+	{
+		update_led_colour(outputs.colour.red,outputs.colour.green,outputs.colour.blue);
+	}
+#if defined(INPUT_RECORD)
+	if(sampled)
+	{
+		inputrec_snapshot(&smContext,tick);		/*A replay starts from the end of this iteration*/
+	}
+#endif
 }
 
 /*
  * @brief The red, green and blue values to be loaded with TPM modules is calculated
- * 		  depending on the states
+ * 		  depending on the states, for the instance of the firmware
  *
  * @param previous State to calculate the value of colours required to transition to the new state
  * @return void
@@ -278,89 +623,42 @@ void statemachine()
 
 void set_led_colour(uint8_t previousState)
 {
-	/*For Stop state the 24 bit hex triplet value - 0x611E3C */
-   	if(previousState==START)
-   	{
-   		redValue=STOP_RED_VALUE;
-   		greenValue=STOP_GREEN_VALUE;
-   		blueValue=STOP_BLUE_VALUE;
-   	}
-
-   	/*
-   	 * Eg: For a Red colour to tansition fro STOP to GO
-   	 * Assume Start Value : 0x61, End Value:0x22
-   	 * Formula = (0x22 - 0x61)*0.0625 + 0x61 = 0x59
-   	 */
-
-   	if(previousState==TRANSITION_TO_CROSSWALK)
-   	{
-   		redValue = (( CROSSWALK_RED_VALUE - redPreviousValue) *
-   					(SCALING_FACTOR*percentageIncrement)+ redPreviousValue);
-   		greenValue = ((CROSSWALK_GREEN_VALUE - greenPreviousValue) *
-   					(SCALING_FACTOR*percentageIncrement) + greenPreviousValue);
-   		blueValue = ((CROSSWALK_BLUE_VALUE - bluePreviousValue) *
-   					(SCALING_FACTOR*percentageIncrement) + bluePreviousValue);
-   		percentageIncrement++;
-   	}
-   	if(previousState==CROSSWALK)
-   	{
-   		redValue = (( GO_RED_VALUE - CROSSWALK_RED_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement)+ CROSSWALK_RED_VALUE) ;
-   		greenValue = ((GO_GREEN_VALUE - CROSSWALK_GREEN_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + CROSSWALK_GREEN_VALUE);
-   		blueValue = ((GO_BLUE_VALUE - CROSSWALK_BLUE_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + CROSSWALK_BLUE_VALUE);
-   		percentageIncrement++;
-   	}
-   	if(previousState == STOP)
-   	{
-   		redValue = ((GO_RED_VALUE - STOP_RED_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement)+STOP_RED_VALUE) ;
-   		greenValue = ((GO_GREEN_VALUE - STOP_GREEN_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + STOP_GREEN_VALUE);
-   		blueValue = ((GO_BLUE_VALUE - STOP_BLUE_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + STOP_BLUE_VALUE);
-   		percentageIncrement++;
-   	}
-   	if(previousState == GO)
-   	{
-   		redValue = ((WARNING_RED_VALUE - GO_RED_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement)+ GO_RED_VALUE) ;
-   		greenValue = ((WARNING_GREEN_VALUE - GO_GREEN_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + GO_GREEN_VALUE);
-   		blueValue = ((WARNING_BLUE_VALUE - GO_BLUE_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + GO_BLUE_VALUE);
-   		percentageIncrement++;
-   	}
-   	if(previousState == WARNING)
-   	{
-   		redValue = ((STOP_RED_VALUE - WARNING_RED_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement)+ WARNING_RED_VALUE) ;
-   		greenValue = ((STOP_GREEN_VALUE - WARNING_GREEN_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + WARNING_GREEN_VALUE);
-   		blueValue = ((STOP_BLUE_VALUE - WARNING_BLUE_VALUE) *
-   					(SCALING_FACTOR*percentageIncrement) + WARNING_BLUE_VALUE);
-   		percentageIncrement++;
-   	}
-
-   	/*For Crosswalk state the 24 bit hex triplet value - 0x001030*/
-   	if(previousState == CROSSWALK_LED_ON)
-   	{
-   		redValue=CROSSWALK_RED_VALUE;
-   		greenValue=CROSSWALK_GREEN_VALUE;
-   		blueValue=CROSSWALK_BLUE_VALUE;
-   	}
-
-   	/*Red, blue, green value to be 0 for duty cycle to be zero led off*/
-   	if(previousState == CROSSWALK_LED_OFF)
-   	{
-   		redValue=0;
-   		greenValue=0;
-   		blueValue=0;
-   	}
-   	update_led_colour(redValue,greenValue,blueValue);
-
- }
+	const sm_colour_t *from=&offColour;	/*Red, blue, green value to be 0 for duty cycle to be zero led off*/
+	const sm_colour_t *to=&offColour;
+	sm_colour_t colour;
+
+	switch(previousState)
+	{
+		case START:					/*For Stop state the 24 bit hex triplet value - 0x611E3C */
+			from=to=&stopColour;
+		break;
+		case STOP:
+			from=&stopColour;
+			to=&goColour;
+		break;
+		case GO:
+			from=&goColour;
+			to=&warningColour;
+		break;
+		case WARNING:
+			from=&warningColour;
+			to=&stopColour;
+		break;
+		case TRANSITION_TO_CROSSWALK:
+			from=&smContext.fadeFrom;
+			to=&crosswalkColour;
+		break;
+		case CROSSWALK:
+			from=&crosswalkColour;
+			to=&goColour;
+		break;
+		case CROSSWALK_LED_ON:		/*For Crosswalk state the 24 bit hex triplet value - 0x001030*/
+			from=to=&crosswalkColour;
+		break;
+	}
+	sm_set_colour(&smContext,from,to,&colour);
+	update_led_colour(colour.red,colour.green,colour.blue);
+}
 
 
 /*
@@ -372,7 +670,13 @@ void set_led_colour(uint8_t previousState)
 bool check_button_pressed()
 {
 	   bool button_state=check_switch_pressed();
+	   uint32_t scanStart=cycles_in_tick();
 	   int touchValue=Touch_Scan_LH();
+#if defined(INPUT_RECORD)
+	   inputrec_touch(touchValue);
+#endif
+	   metrics_tsi_scan(scanStart,cycles_in_tick());
+	   watchdog_checkin(WATCHDOG_TASK_TSI);		/*A stuck end of scan flag never gets here*/
 	   if ((touchValue > SLIDER_PRESSED_MINIMUM_VALUE) || (button_state == PRESSED))
 	   {
 		   return 1;
@@ -13,16 +13,148 @@
 #ifndef STATEMACHINE_H_
 #define STATEMACHINE_H_
 
+#include <stdbool.h>
+#include "MKL25Z4.h"
 
+#define START							(0)
+#define STOP							(1)
+#define TRANSITION_TO_GO				(2)
+#define GO				 				(3)
+#define TRANSITION_TO_WARNING			(4)
+#define WARNING							(5)
+#define TRANSITION_TO_STOP				(6)
+#define CROSSWALK 						(7)
+#define TRANSITION_TO_CROSSWALK			(8)
+#define TRANSITION_FROM_CROSSWALK		(9)
+#define CROSSWALK_LED_ON				(10)
+#define CROSSWALK_LED_OFF				(11)
 
-#endif /* STATEMACHINE_H_ */
+#define SM_STATE_COUNT					(12) /*Number of state IDs including the LED sub-states*/
+
+/*The walk light is on up to TICKS_FOR_750MS into every second of CROSSWALK, then off*/
+#define TICKS_FOR_SECOND				(16)
+#define TICKS_FOR_750MS					(12)
+
+#include "timer.h"
+#include "crosswalk_policy.h"
+#include "adaptive_timing.h"
+
+/*Colour of the led, the values loaded to the TPM modules*/
+typedef struct
+{
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+} sm_colour_t;
+
+/*Durations in ticks of 62.5 msec and the limits of the crosswalk and GO timing*/
+typedef struct
+{
+	uint32_t stopTicks;
+	uint32_t warningTicks;
+	uint32_t transitionTicks;		/*Fades take one step every tick*/
+	uint32_t crosswalkTicks;
+	crosswalk_policy_config_t policy;
+	adaptive_timing_config_t timing;
+} sm_config_t;
 
- #include "MKL25Z4.h"
+/*One instance of the traffic light sequence, all that sm_step() reads and changes. The
+  words come first and the bytes after them, so that the instance has no padding before the
+  8 byte aligned policy*/
+typedef struct
+{
+	const sm_config_t *config;
+	ticktime stateStart;			/*Tick at which the current state was entered*/
+	ticktime inputTick;				/*Tick at which the inputs were last taken*/
+	ticktime fadeTick;				/*Tick of the last fade step*/
+	int32_t stopTrim;				/*Ticks added to the current STOP, set by the green wave coordination*/
+	sm_colour_t colour;
+	sm_colour_t fadeFrom;			/*Colour at which TRANSITION_TO_CROSSWALK started*/
+	uint8_t state;
+	int8_t fadeStep;				/*Fade step of a transition, 0 to 16 sixteenths of the way*/
+	crosswalk_policy_t policy;		/*Latches crosswalk requests between the inputs and the transitions*/
+	adaptive_timing_t timing;		/*Ends GO from the vehicle detector actuations*/
+} sm_ctx_t;
+
+/*Inputs sampled once every tick, see sm_inputs_due()*/
+typedef struct
+{
+	bool pressed;					/*Touch slider or switch pressed*/
+	uint32_t actuations;			/*Vehicle detector actuations since the last sample*/
+} sm_inputs_t;
+
+/*What one step asks the caller to do*/
+typedef struct
+{
+	sm_colour_t colour;				/*Only written along with write*/
+	bool write;						/*colour was computed in this step and is to be shown*/
+	bool pressIgnored;				/*The press was batched into a pending or running walk*/
+	uint8_t previousState;			/*Differs from state when the step changed the state*/
+	uint8_t state;
+} sm_outputs_t;
+
+/*Timings of the firmware, STOP_GO_TIME and the others of statemachine.c*/
+extern const sm_config_t smDefaultConfig;
+
+/*
+ * @brief Starts an instance of the traffic light sequence in the STOP state
+ *
+ * @param1 instance
+ * @param2 timings, used by reference and to be kept alive as long as the instance
+ * @param3 current tick
+ * @return void
+ */
+void sm_init(sm_ctx_t *ctx, const sm_config_t *config, ticktime now);
+
+/*
+ * @brief Whether the next sm_step() takes the inputs, they are sampled once every tick
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @return true if the inputs are to be sampled for the next step
+ */
+bool sm_inputs_due(const sm_ctx_t *ctx, ticktime now);
+
+/*
+ * @brief One pass of the traffic light sequence
+ *
+ * Reads and changes nothing but the instance: no hardware, timer or logging. The firmware
+ * calls it every main loop iteration, a caller stepping once per tick repeats it while the
+ * state changes to do all that is due at the tick
+ *
+ * @param1 instance
+ * @param2 current tick
+ * @param3 inputs, only read when sm_inputs_due() is true
+ * @param4 colour to show and the state changes, colour is only written along with write
+ * @return void
+ */
+void sm_step(sm_ctx_t *ctx, ticktime now, const sm_inputs_t *inputs, sm_outputs_t *outputs);
+
+/*
+ * @brief Current state of an instance
+ *
+ * @param1 instance
+ * @return one of the state IDs defined above
+ */
+uint8_t sm_state(const sm_ctx_t *ctx);
+
+/*
+ * @brief Colours a state shows, for callers which compute them without sm_step()
+ *
+ * A transition fades between the two colours, STOP and CROSSWALK show one colour as both.
+ * TRANSITION_TO_CROSSWALK starts from the colour shown when it was entered, given as black
+ *
+ * @param1 state
+ * @param2 colour at the start of the state
+ * @param3 colour at its end
+ * @return true if the state shows a colour, false for black
+ */
+bool sm_state_colours(uint8_t stateId, sm_colour_t *from, sm_colour_t *to);
 
 
 /*
  * @brief The red, green and blue values to be loaded with TPM modules is calculated
- * 		  depending on the states
+ * 		  depending on the states, for the instance of the firmware
  *
  * @param previous State to calculate the value of colours required to transition to the new state
  * @return void
@@ -35,7 +167,9 @@ void set_led_colour(uint8_t previousState);
  * @brief Executes the traffic light sequence with cross-walk functionality
  *
  * The traffic light sequence consists of 9 states including STOP, GO, WARNING states
- * with cross-walk state triggered through touch slider or gpio push button
+ * with cross-walk state triggered through touch slider or gpio push button. Runs the
+ * sequence started by statemachine_init(), main() shows its first frame before the boot
+ * reports
  *
  * @return void
  */
@@ -48,3 +182,59 @@ void statemachine();
  * @return true if slider/switch is pressed else return false
  */
 bool check_button_pressed();
+
+/*
+ * @brief Resets the traffic light sequence to the STOP state
+ *
+ * @return void
+ */
+void statemachine_init();
+
+/*
+ * @brief Restarts the STOP the sequence was held in from the current tick, with its colour
+ * 		  and its conflict monitor rules, after the night flash
+ *
+ * @return void
+ */
+void statemachine_resume();
+
+/*
+ * @brief One pass of the traffic light sequence of the firmware
+ *
+ * Samples the crosswalk inputs once every tick, runs sm_step() on the instance of the
+ * firmware and shows, logs and counts its outputs. Called in a loop by statemachine() and
+ * once per simulated main loop iteration by the host simulator
+ *
+ * @return void
+ */
+void statemachine_poll();
+
+/*
+ * @brief Current state of the traffic light sequence
+ *
+ * @return one of the state IDs defined above
+ */
+uint8_t statemachine_state();
+
+/*
+ * @brief Instance of the traffic light sequence run by statemachine_poll()
+ *
+ * @return instance
+ */
+sm_ctx_t *statemachine_context();
+
+/*
+ * @brief Crosswalk policy of the traffic light sequence, to read its statistics or change its limits
+ *
+ * @return policy instance used by statemachine_poll()
+ */
+crosswalk_policy_t *statemachine_crosswalk_policy();
+
+/*
+ * @brief Adaptive GO timing of the traffic light sequence, to read its statistics or change its limits
+ *
+ * @return adaptive timing instance used by statemachine_poll()
+ */
+adaptive_timing_t *statemachine_adaptive_timing();
+
+#endif /* STATEMACHINE_H_ */
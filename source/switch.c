@@ -14,6 +14,7 @@
 #include <stdbool.h>
 #include "MKL25Z4.h"
 #include "switch.h"
+#include "inputrec.h"
 
 
 #define SWITCH_GPIO_PORT GPIOD
@@ -22,8 +23,12 @@
 #define SWITCH_SCGC5_MASK SIM_SCGC5_PORTD_MASK
 #define SWITCH_ISFR PORTD->ISFR
 #define INTERRUPT_WHEN_LOGIC_ZERO 8
+#define DETECTOR_PIN 2 /*Vehicle detector loop amplifier output, open collector pulled up on PTD2*/
+#define DETECTOR_PIN_CTRL_REG PORTD->PCR[DETECTOR_PIN]
+#define INTERRUPT_ON_FALLING_EDGE 10
 
 static int interrupt_triggered = 0; /*Flag set when switch interrupt is triggered*/
+static volatile uint32_t detector_count = 0; /*Vehicle actuations counted by the interrupt*/
 
 /*
  * @brief Initialize the on-board switch to trigger cross-walk state of KL25Z freedom development board
@@ -51,6 +56,39 @@ void init_switch()
   __enable_irq();/*If the PM bit in PRIMASK register is set,__enable_irq will enable the interrupt*/
 }
 
+/*
+ * @brief Initialize the vehicle detector input used by the adaptive GO timing
+ *
+ * The GPIO Port D 2nd pin is configured as input with pull-up functionality and counts
+ * every falling edge, it shares the PORTD interrupt with the switch
+ *
+ * @return void
+ */
+void init_detector()
+{
+  SIM->SCGC5 |= SWITCH_SCGC5_MASK;
+  DETECTOR_PIN_CTRL_REG &= ~PORT_PCR_MUX_MASK;
+  DETECTOR_PIN_CTRL_REG |= PORT_PCR_MUX(1) | PORT_PCR_PE(1) | PORT_PCR_PS(1);
+  SWITCH_GPIO_PORT->PDDR &= ~(1 << DETECTOR_PIN);
+  DETECTOR_PIN_CTRL_REG |= PORT_PCR_IRQC(INTERRUPT_ON_FALLING_EDGE);
+  NVIC_SetPriority (PORTD_IRQn, 4);
+  NVIC_EnableIRQ(PORTD_IRQn);
+}
+
+/*
+ * @brief Number of vehicle actuations since the previous call
+ *
+ * @return actuations counted by the PORTD interrupt, the count is cleared
+ */
+uint32_t detector_actuations(void){
+		uint32_t masking_state = __get_PRIMASK();
+		__disable_irq();
+		uint32_t actuations = detector_count;
+		detector_count = 0;
+		__set_PRIMASK(masking_state);
+		return actuations;
+}
+
 /*
  * @brief To check whether the button is pressed through interrupt
  *
@@ -70,17 +108,29 @@ int check_switch_pressed(void){
 
 /*
  * @brief Interrupt routine called when user presses the button connected to PORT D 3rd pin
+ * 		  or a vehicle is detected on PORT D 2nd pin
  *
- * When the interrupt is triggered, a flag is set and the IFSR register is written 1 to
- * clear the interrupt which was set
+ * When the interrupt is triggered, a flag is set or the actuation is counted and the IFSR
+ * register is written 1 to clear the interrupt which was set
  *
  * @return void
  */
 void PORTD_IRQHandler(void)
 {
+	if ( (SWITCH_ISFR) & (1 << DETECTOR_PIN) ) /*Check if a vehicle is detected*/
+	{
+		detector_count++;
+#if defined(INPUT_RECORD)
+		inputrec_record(INPUTREC_DETECTOR, (uint16_t)SWITCH_ISFR);
+#endif
+		SWITCH_ISFR = (1 << DETECTOR_PIN);
+	}
 	if ( ( (SWITCH_ISFR) & (1 << SWITCH_PIN) ) == 0) /*Check if switch is pressed*/
 	return;
 	interrupt_triggered = 1;
+#if defined(INPUT_RECORD)
+	inputrec_record(INPUTREC_SWITCH, (uint16_t)SWITCH_ISFR);
+#endif
 	SWITCH_ISFR &= (1 << SWITCH_PIN); /*Writing 1 will clear the bit 3 PORT D IFSR register*/
 }
 
@@ -13,6 +13,7 @@
 #ifndef SWITCH_H_
 #define SWITCH_H_
 
+#include <stdint.h>
 
 
 #endif /* SWITCH_H_ */
@@ -37,3 +38,20 @@ void init_switch();
  */
 int check_switch_pressed();
 
+/*
+ * @brief Initialize the vehicle detector input used by the adaptive GO timing
+ *
+ * The GPIO Port D 2nd pin is configured as input with pull-up functionality and counts
+ * every falling edge, it shares the PORTD interrupt with the switch
+ *
+ * @return void
+ */
+void init_detector();
+
+/*
+ * @brief Number of vehicle actuations since the previous call
+ *
+ * @return actuations counted by the PORTD interrupt, the count is cleared
+ */
+uint32_t detector_actuations();
+
@@ -0,0 +1,292 @@
+/**
+ * @file    telemetry.c
+ * @brief   This source file consists of function definitions of the binary telemetry uplink,
+ * 			the frame encoder and the ring buffer drained to the debug UART
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "MKL25Z4.h"
+#include "telemetry.h"
+#include "statemachine.h"
+#include "metrics.h"
+#include "conflict_monitor.h"
+#include "faultlog.h"
+#include "watchdog.h"
+
+#define CRC_INITIAL					(0xFFFF)
+#define COBS_BLOCK					(0xFF)	/*Code of a run of 254 bytes without a 0*/
+#define U8_MAX						(0xFF)
+#define U16_MAX						(0xFFFF)
+
+telemetry_t telemetry;
+
+/*CRC-16/CCITT-FALSE (polynomial 0x1021) a nibble at a time, 32 bytes of table instead of 512*/
+static const uint16_t crcNibbles[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/*
+ * @brief CRC-16/CCITT-FALSE of a buffer
+ *
+ * @param1 bytes
+ * @param2 number of bytes
+ * @return CRC
+ */
+static uint16_t crc16(const uint8_t *data, uint32_t length)
+{
+	uint16_t crc = CRC_INITIAL;
+	uint32_t index;
+
+	for (index = 0; index < length; index++)
+	{
+		crc = (uint16_t)((crc << 4) ^ crcNibbles[(crc >> 12) ^ (data[index] >> 4)]);
+		crc = (uint16_t)((crc << 4) ^ crcNibbles[(crc >> 12) ^ (data[index] & 0x0F)]);
+	}
+	return crc;
+}
+
+/*
+ * @brief Stores a 16 bit value little endian, saturated
+ *
+ * @param1 where
+ * @param2 value
+ * @return void
+ */
+static void put_u16(uint8_t *where, uint32_t value)
+{
+	if (value > U16_MAX)
+	{
+		value = U16_MAX;
+	}
+	where[0] = (uint8_t)value;
+	where[1] = (uint8_t)(value >> 8);
+}
+
+/*
+ * @brief Stores the low 16 bits of a counter little endian
+ *
+ * @param1 where
+ * @param2 counter
+ * @return void
+ */
+static void put_counter(uint8_t *where, uint32_t counter)
+{
+	where[0] = (uint8_t)counter;
+	where[1] = (uint8_t)(counter >> 8);
+}
+
+/*
+ * @brief Encodes a frame: payload, CRC, COBS and the 0 delimiter
+ *
+ * COBS replaces every 0 by the distance to the next one, so that 0 only ends frames and the
+ * collector finds the next frame after a lost byte
+ *
+ * @param1 sample
+ * @param2 sequence number
+ * @param3 state changes, tick (low 8 bits) and state each
+ * @param4 number of state changes
+ * @param5 TELEMETRY_FRAME_MAX bytes
+ * @return bytes in frame
+ */
+uint32_t telemetry_encode(const telemetry_sample_t *sample, uint8_t sequence, const uint8_t (*events)[2],
+						  uint8_t eventCount, uint8_t *frame)
+{
+	uint8_t payload[TELEMETRY_PAYLOAD_MAX + TELEMETRY_CRC_BYTES];
+	uint32_t length = TELEMETRY_HEADER_BYTES;
+	uint32_t code = 0;
+	uint32_t out = 1;
+	uint16_t crc;
+	uint32_t index;
+
+	payload[0] = TELEMETRY_VERSION;
+	payload[1] = sequence;
+	payload[2] = (uint8_t)sample->tick;
+	payload[3] = (uint8_t)(sample->tick >> 8);
+	payload[4] = (uint8_t)(sample->tick >> 16);
+	payload[5] = (uint8_t)(sample->tick >> 24);
+	payload[6] = sample->state;
+	put_u16(&payload[7], sample->timeInState);
+	payload[9] = sample->flags;
+	payload[10] = (uint8_t)((sample->faults > U8_MAX) ? U8_MAX : sample->faults);
+	put_counter(&payload[11], sample->presses);
+	put_counter(&payload[13], sample->ignored);
+	put_counter(&payload[15], sample->actuations);
+	put_counter(&payload[17], sample->tsiScans);
+	put_u16(&payload[19], sample->loopIterations);
+	put_u16(&payload[21], sample->tsiScanCycles);
+	payload[23] = eventCount;
+	for (index = 0; index < eventCount; index++)
+	{
+		uint8_t age = (uint8_t)((uint8_t)sample->tick - events[index][0]);
+
+		payload[length++] = age;
+		payload[length++] = events[index][1];
+	}
+	crc = crc16(payload, length);
+	payload[length++] = (uint8_t)crc;
+	payload[length++] = (uint8_t)(crc >> 8);
+
+	for (index = 0; index < length; index++)
+	{
+		if (payload[index] != 0)
+		{
+			frame[out++] = payload[index];
+		}
+		if ((payload[index] == 0) || (out - code == COBS_BLOCK))
+		{
+			frame[code] = (uint8_t)(out - code);
+			code = out++;
+		}
+	}
+	frame[code] = (uint8_t)(out - code);
+	frame[out++] = 0;
+	return out;
+}
+
+/*
+ * @brief Empties the ring and the events, the next frame is sent at the next poll
+ *
+ * @return void
+ */
+void telemetry_init(void)
+{
+	memset(&telemetry, 0, sizeof(telemetry));
+	telemetry.lastFrame = now() - TELEMETRY_PERIOD_TICKS;
+}
+
+/*
+ * @brief Notes a state change for the next frame
+ *
+ * @param1 state entered
+ * @param2 current tick
+ * @return void
+ */
+void telemetry_state_event(uint8_t state, ticktime now)
+{
+	if (telemetry.eventCount >= TELEMETRY_EVENTS_MAX)
+	{
+		telemetry.flags |= TELEMETRY_FLAG_EVENTS_LOST;
+		return;
+	}
+	telemetry.events[telemetry.eventCount][0] = (uint8_t)now;
+	telemetry.events[telemetry.eventCount][1] = state;
+	telemetry.eventCount++;
+}
+
+/*
+ * @brief Takes a sample of the metrics and queues its frame, or counts it lost when the
+ * 		  ring has no room for it
+ *
+ * @param current tick
+ * @return void
+ */
+static void queue_frame(ticktime now)
+{
+	telemetry_sample_t sample;
+	uint8_t frame[TELEMETRY_FRAME_MAX + 1];
+	uint32_t length = 0;
+	uint32_t used = (uint8_t)(telemetry.head - telemetry.tail);
+	uint32_t index;
+
+	sample.tick = now;
+	sample.state = smMetrics.state;
+	sample.timeInState = now - smMetrics.stateEntered;
+	sample.flags = telemetry.flags;
+	sample.flags |= conflictMonitor.tripped ? TELEMETRY_FLAG_TRIPPED : 0;
+	sample.flags |= (watchdog.stale != 0) ? TELEMETRY_FLAG_WATCHDOG : 0;
+	sample.flags |= statemachine_crosswalk_policy()->pending ? TELEMETRY_FLAG_PENDING : 0;
+	sample.faults = faultLog.count;
+	sample.presses = smMetrics.crosswalkRequests;
+	sample.ignored = smMetrics.crosswalkIgnored;
+	sample.actuations = smMetrics.actuations;
+	sample.tsiScans = smMetrics.tsiScans;
+	sample.loopIterations = smMetrics.loopIterations;
+	sample.tsiScanCycles = smMetrics.tsiScanCycles;
+
+	if (telemetry.resync)
+	{
+		frame[length++] = 0;		/*Ends what the console wrote*/
+	}
+	length += telemetry_encode(&sample, telemetry.sequence++, (const uint8_t (*)[2])telemetry.events,
+							   telemetry.eventCount, &frame[length]);
+	telemetry.lastFrame = now;
+	telemetry.eventCount = 0;
+
+	if (length > TELEMETRY_RING_BYTES - 1 - used)
+	{
+		telemetry.framesLost++;
+		telemetry.flags = TELEMETRY_FLAG_FRAMES_LOST;
+		return;
+	}
+	for (index = 0; index < length; index++)
+	{
+		telemetry.ring[telemetry.head++] = frame[index];
+	}
+	telemetry.frames++;
+	telemetry.bytes += length;
+	telemetry.flags = 0;
+	telemetry.resync = false;
+}
+
+/*
+ * @brief Queues a frame once every TELEMETRY_PERIOD_TICKS and sends a byte of the ring when
+ * 		  the debug UART can take one, called every main loop iteration
+ *
+ * A frame goes out over about 30 iterations of the main loop instead of blocking in a
+ * printf, the only cost per iteration is the read of the UART status
+ *
+ * @param current tick
+ * @return void
+ */
+void telemetry_poll(ticktime now)
+{
+	if ((now - telemetry.lastFrame) >= TELEMETRY_PERIOD_TICKS)
+	{
+		queue_frame(now);
+	}
+	if ((telemetry.head != telemetry.tail) && (UART0->S1 & UART0_S1_TDRE_MASK))
+	{
+		UART0->D = telemetry.ring[telemetry.tail++];
+	}
+}
+
+/*
+ * @brief Sends the whole ring, so that a console reply does not cut a frame
+ *
+ * @return void
+ */
+void telemetry_flush(void)
+{
+	while (telemetry.head != telemetry.tail)
+	{
+		while (!(UART0->S1 & UART0_S1_TDRE_MASK))
+		{
+		}
+		UART0->D = telemetry.ring[telemetry.tail++];
+	}
+	telemetry.resync = true;
+}
+
+/*
+ * @brief Takes bytes out of the ring, as the UART does, for a host capturing the uplink
+ *
+ * @param1 buffer
+ * @param2 size of the buffer
+ * @return bytes taken
+ */
+uint32_t telemetry_read(uint8_t *buffer, uint32_t size)
+{
+	uint32_t length = 0;
+
+	while ((length < size) && (telemetry.head != telemetry.tail))
+	{
+		buffer[length++] = telemetry.ring[telemetry.tail++];
+	}
+	return length;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file    telemetry.h
+ * @brief   This header file consists of the binary telemetry uplink: once a second a frame of
+ * 			the state, the counters, the fault flags and the input statistics is COBS framed with
+ * 			a CRC into a ring buffer, which the main loop drains to the debug UART a byte at a time
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+/*
+ * Frame payload, little endian, followed by the CRC-16/CCITT-FALSE of the payload (little
+ * endian), COBS encoded and ended by a 0 byte. Counters are the low 16 bits of the metrics,
+ * tools/telemetry_collect.py extends them
+ *
+ *  0  version			TELEMETRY_VERSION
+ *  1  sequence			+1 every frame, a gap is a frame lost in the ring or on the line
+ *  2  tick				u32, now() when the frame was taken
+ *  6  state			u8
+ *  7  timeInState		u16 ticks, saturated
+ *  9  flags			TELEMETRY_FLAG_
+ * 10  faults			u8 faults in the fault log, saturated
+ * 11  presses			u16 crosswalk presses
+ * 13  ignored			u16 presses batched into a pending or running walk
+ * 15  actuations		u16 vehicle detector actuations
+ * 17  tsiScans			u16 touch slider scans
+ * 19  loopIterations	u16 main loop iterations in the last tick, saturated
+ * 21  tsiScanCycles	u16 cycles of the last touch slider scan, saturated
+ * 23  events			u8 state changes since the last frame, then per change:
+ * 24  age, state		u8 ticks before tick (saturated) and the state entered
+ */
+#define TELEMETRY_VERSION				(1)
+#define TELEMETRY_PERIOD_TICKS			(16)	/*One frame a second*/
+#define TELEMETRY_EVENTS_MAX			(8)		/*State changes kept per frame, more set EVENTS_LOST*/
+#define TELEMETRY_HEADER_BYTES			(24)
+#define TELEMETRY_PAYLOAD_MAX			(TELEMETRY_HEADER_BYTES + 2 * TELEMETRY_EVENTS_MAX)
+#define TELEMETRY_CRC_BYTES				(2)
+/*COBS adds a byte per 254 and the code byte, then the 0 delimiter*/
+#define TELEMETRY_FRAME_MAX				(TELEMETRY_PAYLOAD_MAX + TELEMETRY_CRC_BYTES + 2)
+#define TELEMETRY_RING_BYTES			(256)	/*Power of 2, several frames*/
+
+#define TELEMETRY_FLAG_TRIPPED			(0x01)	/*Conflict monitor tripped, the LED flashes red*/
+#define TELEMETRY_FLAG_WATCHDOG			(0x02)	/*A supervised task is stale, the COP is no longer fed*/
+#define TELEMETRY_FLAG_PENDING			(0x04)	/*A crosswalk request waits*/
+#define TELEMETRY_FLAG_EVENTS_LOST		(0x08)	/*More state changes than TELEMETRY_EVENTS_MAX*/
+#define TELEMETRY_FLAG_FRAMES_LOST		(0x10)	/*A frame did not fit in the ring since the last one*/
+
+/*What goes into a frame, filled from the metrics by telemetry_poll()*/
+typedef struct
+{
+	ticktime tick;
+	uint8_t state;
+	uint32_t timeInState;
+	uint8_t flags;
+	uint32_t faults;
+	uint32_t presses;
+	uint32_t ignored;
+	uint32_t actuations;
+	uint32_t tsiScans;
+	uint32_t loopIterations;
+	uint32_t tsiScanCycles;
+} telemetry_sample_t;
+
+typedef struct
+{
+	ticktime lastFrame;				/*Tick of the last frame*/
+	uint8_t sequence;
+	uint8_t flags;					/*EVENTS_LOST and FRAMES_LOST for the next frame*/
+	bool resync;					/*The console wrote to the UART, the next frame starts with a 0 too*/
+	uint8_t eventCount;
+	uint8_t events[TELEMETRY_EVENTS_MAX][2];	/*Tick, low 8 bits, and state of every change*/
+	uint8_t ring[TELEMETRY_RING_BYTES];
+	uint8_t head;					/*Next byte written, TELEMETRY_RING_BYTES is 256*/
+	uint8_t tail;					/*Next byte sent*/
+	uint32_t frames;				/*Frames queued*/
+	uint32_t framesLost;			/*Frames which did not fit in the ring*/
+	uint32_t bytes;					/*Bytes queued*/
+} telemetry_t;
+
+extern telemetry_t telemetry;
+
+/*
+ * @brief Empties the ring and the events, the next frame is sent at the next poll
+ *
+ * @return void
+ */
+void telemetry_init(void);
+
+/*
+ * @brief Notes a state change for the next frame
+ *
+ * @param1 state entered
+ * @param2 current tick
+ * @return void
+ */
+void telemetry_state_event(uint8_t state, ticktime now);
+
+/*
+ * @brief Queues a frame once every TELEMETRY_PERIOD_TICKS and sends a byte of the ring when
+ * 		  the debug UART can take one, called every main loop iteration
+ *
+ * @param current tick
+ * @return void
+ */
+void telemetry_poll(ticktime now);
+
+/*
+ * @brief Sends the whole ring, so that a console reply does not cut a frame
+ *
+ * @return void
+ */
+void telemetry_flush(void);
+
+/*
+ * @brief Encodes a frame: payload, CRC, COBS and the 0 delimiter
+ *
+ * @param1 sample
+ * @param2 sequence number
+ * @param3 state changes, tick (low 8 bits) and state each
+ * @param4 number of state changes
+ * @param5 TELEMETRY_FRAME_MAX bytes
+ * @return bytes in frame
+ */
+uint32_t telemetry_encode(const telemetry_sample_t *sample, uint8_t sequence, const uint8_t (*events)[2],
+						  uint8_t eventCount, uint8_t *frame);
+
+/*
+ * @brief Takes bytes out of the ring, as the UART does, for a host capturing the uplink
+ *
+ * @param1 buffer
+ * @param2 size of the buffer
+ * @return bytes taken
+ */
+uint32_t telemetry_read(uint8_t *buffer, uint32_t size);
+
+#endif /* TELEMETRY_H_ */
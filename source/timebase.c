@@ -0,0 +1,120 @@
+/**
+ * @file    timebase.c
+ * @brief   This source file consists of function definitions of the timing layer which
+ * 			derives the SysTick reload, the TPM clock source, prescaler and MOD and the LED
+ * 			duty scale from the active clocks, and moves them on a clock switch
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 31 Timer/PWM Module
+ */
+
+#include "MKL25Z4.h"
+#include "timebase.h"
+#include "timer.h"
+#include "pwm.h"
+
+#define RUN_CORE_CLOCK				(48000000U)
+#define SYSTICK_LOAD_MAX			(SysTick_LOAD_RELOAD_Msk)
+#define TPM_COUNTS_MAX				(TIMEBASE_DUTY_PERIOD)	/*dutyScale stays at most 1.0, duty_counts() fits 32 bits*/
+#define TPM_COUNTS_MIN				(0x200U)	/*Over 2 counts a colour step, every colour value keeps its duty cycle*/
+#define TPM_PRESCALER_MAX			(7)			/*Divide by 128*/
+#define DUTY_SCALE_SHIFT			(16)		/*TIMEBASE_DUTY_SCALE_ONE*/
+
+/*The RUN profile of board/clock_config.c: 48 MHz core, TPM on MCGPLLCLK/2 divided by 2*/
+timebase_t timebase={
+	.coreClock=RUN_CORE_CLOCK,
+	.tpmClock=RUN_CORE_CLOCK,
+	.tpmSource=TIMEBASE_TPM_PLLFLL,
+	.tpmPrescaler=1,
+	.tpmMod=TIMEBASE_DUTY_PERIOD-1,
+	.systickLoad=RUN_CORE_CLOCK/TIMEBASE_SYSTICK_DIVIDER/TIMEBASE_TICKS_PER_SECOND-1,
+	.dutyScale=TIMEBASE_DUTY_SCALE_ONE
+};
+
+/*
+ * @brief Derives the timing of a set of clocks
+ *
+ * The smallest prescaler which fits a PWM period in TIMEBASE_DUTY_PERIOD counts keeps the
+ * most duty resolution. More counts would overflow the 32 bit product of duty_counts() in
+ * pwm.c, 25 MHz gives 25000 counts instead of 50000. The SysTick reload is exact for core
+ * clocks which are a multiple of 256 Hz
+ *
+ * @param1 core clock in Hz
+ * @param2 TIMEBASE_TPM_ source of the TPM clock
+ * @param3 TPM clock in Hz
+ * @param4 timing
+ * @return false if the SysTick cannot count a tick or the TPM cannot give TIMEBASE_PWM_HZ
+ * 		   with 8 bit duty cycles
+ */
+bool timebase_compute(uint32_t coreClock, uint8_t tpmSource, uint32_t tpmClock, timebase_t *out)
+{
+	uint32_t tickCounts=coreClock/TIMEBASE_SYSTICK_DIVIDER/TIMEBASE_TICKS_PER_SECOND;
+	uint32_t pwmCounts=tpmClock/TIMEBASE_PWM_HZ;
+	uint8_t prescaler=0;
+
+	if((tickCounts == 0) || (tickCounts-1 > SYSTICK_LOAD_MAX))
+	{
+		return false;
+	}
+	while((pwmCounts > TPM_COUNTS_MAX) && (prescaler < TPM_PRESCALER_MAX))
+	{
+		prescaler++;
+		pwmCounts=(tpmClock >> prescaler)/TIMEBASE_PWM_HZ;
+	}
+	if((pwmCounts > TPM_COUNTS_MAX) || (pwmCounts < TPM_COUNTS_MIN))
+	{
+		return false;
+	}
+
+	out->coreClock=coreClock;
+	out->tpmClock=tpmClock;
+	out->tpmSource=tpmSource;
+	out->tpmPrescaler=prescaler;
+	out->tpmMod=(uint16_t)(pwmCounts-1);
+	out->systickLoad=tickCounts-1;
+	out->dutyScale=(pwmCounts << DUTY_SCALE_SHIFT)/TIMEBASE_DUTY_PERIOD;
+	return true;
+}
+
+/*
+ * @brief Takes the timing of the clocks set at boot, before Init_SysTick() and the PWM
+ * 		  initialization read it
+ *
+ * @param1 core clock in Hz
+ * @param2 TIMEBASE_TPM_ source of the TPM clock
+ * @param3 TPM clock in Hz
+ * @return false if the clocks cannot be used, the timing is not changed
+ */
+bool timebase_configure(uint32_t coreClock, uint8_t tpmSource, uint32_t tpmClock)
+{
+	timebase_t next;
+
+	if(!timebase_compute(coreClock,tpmSource,tpmClock,&next))
+	{
+		return false;
+	}
+	timebase=next;
+	return true;
+}
+
+/*
+ * @brief Moves the SysTick and the TPM modules to new clocks, called right after the switch
+ *
+ * @param1 core clock in Hz
+ * @param2 TIMEBASE_TPM_ source of the TPM clock
+ * @param3 TPM clock in Hz
+ * @return false if the clocks cannot be used, the timing is not changed
+ */
+bool timebase_switch(uint32_t coreClock, uint8_t tpmSource, uint32_t tpmClock)
+{
+	if(!timebase_configure(coreClock,tpmSource,tpmClock))
+	{
+		return false;
+	}
+	retime_systick();
+	retime_pwm();
+	return true;
+}
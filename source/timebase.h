@@ -0,0 +1,84 @@
+/**
+ * @file    timebase.h
+ * @brief   This header file consists of the timing layer which derives the SysTick reload,
+ * 			the TPM clock source, prescaler and MOD and the LED duty scale from the active
+ * 			clocks, and moves them on a clock switch
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 31 Timer/PWM Module
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMEBASE_TICKS_PER_SECOND	(16)	/*A tick is 62.5 msec at every clock*/
+#define TIMEBASE_MS_PER_TICK_NUM	(125)	/*62.5 msec as a fraction, current_time() stays integer*/
+#define TIMEBASE_MS_PER_TICK_DEN	(2)
+#define TIMEBASE_SYSTICK_DIVIDER	(16)	/*SysTick runs from the external reference clock, core clock/16*/
+#define TIMEBASE_PWM_HZ				(500)
+/*The colour values are loaded as value << 8 out of this many counts, the PWM period at 48 MHz*/
+#define TIMEBASE_DUTY_PERIOD		(48000)
+#define TIMEBASE_DUTY_SCALE_ONE		(1u << 16)
+
+/*SIM_SOPT2 TPMSRC of the TPM clock*/
+#define TIMEBASE_TPM_PLLFLL			(1)		/*MCGPLLCLK/2 or MCGFLLCLK, by PLLFLLSEL*/
+#define TIMEBASE_TPM_OSCER			(2)
+#define TIMEBASE_TPM_MCGIRCLK		(3)
+
+typedef struct
+{
+	uint32_t coreClock;				/*Hz*/
+	uint32_t tpmClock;				/*Hz at the TPM clock input, before the prescaler*/
+	uint8_t tpmSource;				/*TIMEBASE_TPM_*/
+	uint8_t tpmPrescaler;			/*Divides by 1 << tpmPrescaler*/
+	uint16_t tpmMod;				/*TPM counts of a PWM period - 1*/
+	uint32_t systickLoad;			/*SysTick counts of a tick - 1*/
+	uint32_t dutyScale;				/*(tpmMod + 1) / TIMEBASE_DUTY_PERIOD in 1/65536, at most one*/
+} timebase_t;
+
+/*Timing of the active clocks, the 48 MHz RUN profile until timebase_configure()*/
+extern timebase_t timebase;
+
+/*
+ * @brief Derives the timing of a set of clocks
+ *
+ * @param1 core clock in Hz
+ * @param2 TIMEBASE_TPM_ source of the TPM clock
+ * @param3 TPM clock in Hz
+ * @param4 timing
+ * @return false if the SysTick cannot count a tick or the TPM cannot give TIMEBASE_PWM_HZ
+ * 		   with 8 bit duty cycles
+ */
+bool timebase_compute(uint32_t coreClock, uint8_t tpmSource, uint32_t tpmClock, timebase_t *out);
+
+/*
+ * @brief Takes the timing of the clocks set at boot, before Init_SysTick() and the PWM
+ * 		  initialization read it
+ *
+ * @param1 core clock in Hz
+ * @param2 TIMEBASE_TPM_ source of the TPM clock
+ * @param3 TPM clock in Hz
+ * @return false if the clocks cannot be used, the timing is not changed
+ */
+bool timebase_configure(uint32_t coreClock, uint8_t tpmSource, uint32_t tpmClock);
+
+/*
+ * @brief Moves the SysTick and the TPM modules to new clocks, called right after the switch
+ *
+ * The SysTick starts a new tick at once and the LED keeps its colour, so call it just after
+ * a tick
+ *
+ * @param1 core clock in Hz
+ * @param2 TIMEBASE_TPM_ source of the TPM clock
+ * @param3 TPM clock in Hz
+ * @return false if the clocks cannot be used, the timing is not changed
+ */
+bool timebase_switch(uint32_t coreClock, uint8_t tpmSource, uint32_t tpmClock);
+
+#endif /* TIMEBASE_H_ */
@@ -16,9 +16,10 @@
 #include <stdbool.h>
 #include "timer.h"
 #include "MKL25Z4.h"
+#include "timebase.h"
+#include "conflict_monitor.h"
+#include "watchdog.h"
 
-bool checkCrosswalkflag=0; /*if it is set, check whether the user has pressed has the button*/
-volatile uint16_t checkTimeoutFlag=0;/*To check if 1ms is passed*/
 
 ticktime ticksCount=0; /*Incremented every 62.5 ms in interrupt handler*/
 ticktime reset_time=0; /*Used the get the current time value from a previous Value by subtracting it */
@@ -34,13 +35,26 @@ ticktime reset_time=0; /*Used the get the current time value from a previous Val
  */
 void Init_SysTick(void)
 {
-  	SysTick->LOAD = ((48000000L/16)/16);
+  	SysTick->LOAD = timebase.systickLoad;	/*Counts of 62.5 ms at the boot clock - 1*/
   	NVIC_SetPriority(SysTick_IRQn,3);
   	SysTick->VAL=0;
   	SysTick->CTRL=SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk ;
 
 }
 
+/*
+ *@brief Reloads the systick from the timebase after a clock switch and starts a new tick at once
+ *
+ *Called right after a tick, so the tick in progress is only stretched by the time since
+ *
+ *@return void
+ */
+void retime_systick(void)
+{
+	SysTick->LOAD = timebase.systickLoad;
+	SysTick->VAL=0;		/*Any write clears the counter, it reloads on the next count*/
+}
+
 /*
  *@brief The interrupt handler when the interrupt is triggered for 62.5 ms
  *
@@ -51,8 +65,8 @@ void Init_SysTick(void)
 void SysTick_Handler()
 {
    ticksCount++;
-   checkTimeoutFlag=1;
-   checkCrosswalkflag=1;
+   conflict_monitor_tick();	/*Flashes red once the conflict monitor has tripped*/
+   watchdog_tick();			/*Feeds the COP while every supervised task is alive*/
 
 }
 
@@ -64,7 +78,11 @@ void SysTick_Handler()
  */
 ticktime current_time()
 {
-	return (ticksCount*62.5);
+	ticktime ticks=ticksCount;
+
+	/*62.5 ms in integers, the M0+ has no FPU and the float product lost msec past 2^24*/
+	return (ticks/TIMEBASE_MS_PER_TICK_DEN)*TIMEBASE_MS_PER_TICK_NUM +
+		   ((ticks%TIMEBASE_MS_PER_TICK_DEN)*TIMEBASE_MS_PER_TICK_NUM)/TIMEBASE_MS_PER_TICK_DEN;
 }
 
 
@@ -105,4 +123,24 @@ ticktime get_timer()
 
 }
 
+/*
+ *@brief Core clock cycles elapsed since the last tick, read from the SysTick down counter
+ *
+ *
+ *@return cycles since the last tick, wraps to 0 at every tick
+ */
+uint32_t cycles_in_tick()
+{
+	return (SysTick->LOAD - SysTick->VAL) * TIMEBASE_SYSTICK_DIVIDER;
+}
 
+/*
+ *@brief Core clock cycles in one tick
+ *
+ *
+ *@return cycles between two SysTick interrupts
+ */
+uint32_t cycles_per_tick()
+{
+	return (SysTick->LOAD + 1) * TIMEBASE_SYSTICK_DIVIDER;
+}
@@ -16,10 +16,6 @@
 #ifndef TIMER_H_
 #define TIMER_H_
 
-
-
-#endif /* TIMER_H_ */
-
 #include "MKL25Z4.h"
 
 typedef uint32_t ticktime;
@@ -34,6 +30,15 @@ typedef uint32_t ticktime;
  */
 void Init_SysTick(void);
 
+/*
+ *@brief Reloads the systick from the timebase after a clock switch and starts a new tick at once
+ *
+ *Called right after a tick, so the tick in progress is only stretched by the time since
+ *
+ *@return void
+ */
+void retime_systick(void);
+
 /*
  *@brief Time in msec since startup
  *
@@ -70,5 +75,20 @@ void reset_timer();
  */
 ticktime get_timer();
 
+/*
+ *@brief Core clock cycles elapsed since the last tick, read from the SysTick down counter
+ *
+ *Used to time short code paths, the resolution is 16 cycles as SysTick runs from core clock/16
+ *
+ *@return cycles since the last tick, wraps to 0 at every tick
+ */
+uint32_t cycles_in_tick();
 
+/*
+ *@brief Core clock cycles in one tick
+ *
+ *@return cycles between two SysTick interrupts
+ */
+uint32_t cycles_per_tick();
 
+#endif /* TIMER_H_ */
@@ -0,0 +1,512 @@
+/**
+ * @file    update.c
+ * @brief   This source file consists of the firmware update receiver: frame decoding, the
+ * 			delta ops which build a sector from the running image, the staging of the changed
+ * 			sectors and the verification of the new image. No hardware is used here, the
+ * 			flash is reached through update_flash.c
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#include <string.h>
+#include "update.h"
+
+#define CRC_POLYNOMIAL				(0xEDB88320u)
+#define COBS_BLOCK					(0xFF)	/*Code of a run of 254 bytes without a 0*/
+#define COPY_ADDRESS_BYTES			(3)
+#define NO_STAGING_SECTOR			(0xFF)
+
+/*CRC-32 (reflected polynomial 0xEDB88320) a nibble at a time, 64 bytes of table instead of 1 KB*/
+static const uint32_t crcNibbles[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/*
+ * @brief Reads a little endian 32 bit value
+ *
+ * @param where
+ * @return value
+ */
+static uint32_t get_u32(const uint8_t *where)
+{
+	return (uint32_t)where[0] | ((uint32_t)where[1] << 8) | ((uint32_t)where[2] << 16) | ((uint32_t)where[3] << 24);
+}
+
+/*
+ * @brief Stores a 32 bit value little endian
+ *
+ * @param1 where
+ * @param2 value
+ * @return void
+ */
+static void put_u32(uint8_t *where, uint32_t value)
+{
+	where[0] = (uint8_t)value;
+	where[1] = (uint8_t)(value >> 8);
+	where[2] = (uint8_t)(value >> 16);
+	where[3] = (uint8_t)(value >> 24);
+}
+
+/*
+ * @brief CRC-32 (IEEE 802.3, as zlib) of a buffer, continued from a previous value
+ *
+ * @param1 CRC of the bytes before, 0 for the first
+ * @param2 bytes
+ * @param3 number of bytes
+ * @return CRC
+ */
+uint32_t update_crc32(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+	uint32_t index;
+
+	crc = ~crc;
+	for (index = 0; index < length; index++)
+	{
+		crc ^= data[index];
+		crc = (crc >> 4) ^ crcNibbles[crc & 0x0F];
+		crc = (crc >> 4) ^ crcNibbles[crc & 0x0F];
+	}
+	return ~crc;
+}
+
+/*
+ * @brief Encodes a frame: payload, CRC, COBS and the 0 delimiter
+ *
+ * COBS replaces every 0 by the distance to the next one, so that 0 only ends frames
+ *
+ * @param1 payload
+ * @param2 bytes of payload
+ * @param3 frame, length + length / 254 + 7 bytes
+ * @return bytes in frame
+ */
+uint32_t update_frame_encode(const uint8_t *payload, uint32_t length, uint8_t *frame)
+{
+	uint8_t crc[UPDATE_CRC_BYTES];
+	uint32_t code = 0;
+	uint32_t out = 1;
+	uint32_t index;
+
+	put_u32(crc, update_crc32(0, payload, length));
+	for (index = 0; index < length + UPDATE_CRC_BYTES; index++)
+	{
+		uint8_t byte = (index < length) ? payload[index] : crc[index - length];
+
+		if (byte != 0)
+		{
+			frame[out++] = byte;
+		}
+		if ((byte == 0) || (out - code == COBS_BLOCK))
+		{
+			frame[code] = (uint8_t)(out - code);
+			code = out++;
+		}
+	}
+	frame[code] = (uint8_t)(out - code);
+	frame[out++] = 0;
+	return out;
+}
+
+/*
+ * @brief Decodes a COBS frame in place, the decoded bytes are never ahead of the encoded ones
+ *
+ * @param1 frame without its 0 delimiter
+ * @param2 bytes in frame
+ * @return bytes decoded, 0 if the codes do not match the length
+ */
+static uint32_t cobs_decode(uint8_t *frame, uint32_t length)
+{
+	uint32_t in = 0;
+	uint32_t out = 0;
+
+	while (in < length)
+	{
+		uint32_t code = frame[in++];
+		uint32_t index;
+
+		if (code - 1 > length - in)
+		{
+			return 0;
+		}
+		for (index = 1; index < code; index++)
+		{
+			frame[out++] = frame[in++];
+		}
+		if ((code != COBS_BLOCK) && (in < length))
+		{
+			frame[out++] = 0;
+		}
+	}
+	return out;
+}
+
+/*
+ * @brief Encodes a reply frame
+ *
+ * @param1 frame type answered
+ * @param2 UPDATE_ status
+ * @param3 argument, the sector of a sector frame
+ * @param4 value, the CRC found when it does not match
+ * @param5 UPDATE_REPLY_MAX bytes
+ * @return bytes in reply
+ */
+uint32_t update_reply(uint8_t type, uint8_t status, uint16_t argument, uint32_t value, uint8_t *reply)
+{
+	uint8_t payload[UPDATE_REPLY_BYTES];
+
+	payload[0] = UPDATE_FRAME_REPLY;
+	payload[1] = type;
+	payload[2] = status;
+	payload[3] = (uint8_t)argument;
+	payload[4] = (uint8_t)(argument >> 8);
+	put_u32(&payload[5], value);
+	return update_frame_encode(payload, sizeof(payload), reply);
+}
+
+/*
+ * @brief Starts a receiver with nothing staged
+ *
+ * @param1 receiver
+ * @param2 end of the running image, the staging area has to be above it
+ * @return void
+ */
+void update_init(update_t *update, uint32_t imageEnd)
+{
+	memset(update, 0, sizeof(*update));
+	update->imageEnd = imageEnd;
+}
+
+/*
+ * @brief Builds a sector from its delta ops, the copies read the running image
+ *
+ * @param1 receiver, the sector is built in update->sector
+ * @param2 ops
+ * @param3 bytes of ops
+ * @return UPDATE_OK, or UPDATE_BAD_DELTA if the ops do not give exactly one sector
+ */
+static uint8_t delta_apply(update_t *update, const uint8_t *ops, uint32_t length)
+{
+	const uint8_t *base = update_flash_base();
+	uint8_t *sector = (uint8_t *)update->sector;
+	uint32_t in = 0;
+	uint32_t out = 0;
+
+	while (in < length)
+	{
+		uint8_t header = ops[in++];
+		uint32_t count = (header & UPDATE_OP_LENGTH_MASK) + 1;
+
+		if (header & UPDATE_OP_LONG)
+		{
+			if (in >= length)
+			{
+				return UPDATE_BAD_DELTA;
+			}
+			count = ((((uint32_t)header & UPDATE_OP_LENGTH_MASK) << 8) | ops[in++]) + 1;
+		}
+		if (count > UPDATE_SECTOR_BYTES - out)
+		{
+			return UPDATE_BAD_DELTA;
+		}
+		switch (header >> UPDATE_OP_SHIFT)
+		{
+			case UPDATE_OP_LITERAL:
+				if (count > length - in)
+				{
+					return UPDATE_BAD_DELTA;
+				}
+				memcpy(&sector[out], &ops[in], count);
+				in += count;
+				break;
+			case UPDATE_OP_COPY:
+			{
+				uint32_t source;
+
+				if (length - in < COPY_ADDRESS_BYTES)
+				{
+					return UPDATE_BAD_DELTA;
+				}
+				source = (uint32_t)ops[in] | ((uint32_t)ops[in + 1] << 8) | ((uint32_t)ops[in + 2] << 16);
+				in += COPY_ADDRESS_BYTES;
+				if ((source > update->baseSize) || (count > update->baseSize - source))
+				{
+					return UPDATE_BAD_DELTA;
+				}
+				memcpy(&sector[out], &base[source], count);
+				break;
+			}
+			case UPDATE_OP_FILL:
+				if (in >= length)
+				{
+					return UPDATE_BAD_DELTA;
+				}
+				memset(&sector[out], ops[in++], count);
+				break;
+			default:
+				return UPDATE_BAD_DELTA;
+		}
+		out += count;
+	}
+	return (out == UPDATE_SECTOR_BYTES) ? UPDATE_OK : UPDATE_BAD_DELTA;
+}
+
+/*
+ * @brief Staging sector holding an image sector
+ *
+ * @param1 receiver
+ * @param2 image sector
+ * @return index in stagedSector, NO_STAGING_SECTOR if it is not staged
+ */
+static uint8_t staging_sector(const update_t *update, uint32_t sector)
+{
+	uint8_t index;
+
+	for (index = 0; index < update->staged; index++)
+	{
+		if (update->stagedSector[index] == sector)
+		{
+			return index;
+		}
+	}
+	return NO_STAGING_SECTOR;
+}
+
+/*
+ * @brief Checks the sizes and the CRC of the running image against the base of the delta
+ *
+ * @param1 receiver
+ * @param2 payload of the begin frame
+ * @param3 CRC of the running image, for the reply
+ * @return UPDATE_ status
+ */
+static uint8_t receive_begin(update_t *update, const uint8_t *payload, uint32_t *value)
+{
+	uint32_t newSize = get_u32(&payload[1]);
+	uint32_t baseSize = get_u32(&payload[9]);
+
+	update->begun = false;
+	if ((update->imageEnd > UPDATE_RECORDS_START) || (newSize == 0) || (newSize > UPDATE_RECORDS_START) ||
+		(baseSize > UPDATE_RECORDS_START))
+	{
+		return UPDATE_TOO_LARGE;
+	}
+	*value = update_crc32(0, update_flash_base(), baseSize);
+	if (*value != get_u32(&payload[13]))
+	{
+		return UPDATE_BAD_BASE;
+	}
+	update->newSize = newSize;
+	update->newCrc = get_u32(&payload[5]);
+	update->baseSize = baseSize;
+	update->staged = 0;
+	update->begun = true;
+	return UPDATE_OK;
+}
+
+/*
+ * @brief Checks that a built sector keeps the flash configuration field of the running image
+ * 		  and leaves the chip unsecured, a wrong FSEC or FPROT in flash cannot be undone over
+ * 		  the UART
+ *
+ * @param1 receiver, the sector is in update->sector
+ * @param2 address of the sector
+ * @return true if the sector does not hold the field, or holds it unchanged
+ */
+static bool config_kept(const update_t *update, uint32_t address)
+{
+	const uint8_t *sector = (const uint8_t *)update->sector;
+
+	if ((address > UPDATE_CONFIG_START) || ((address + UPDATE_SECTOR_BYTES) <= UPDATE_CONFIG_START))
+	{
+		return true;
+	}
+	return (sector[UPDATE_CONFIG_FSEC - address] == UPDATE_FSEC_UNSECURE) &&
+		   (memcmp(&sector[UPDATE_CONFIG_START - address], &update_flash_base()[UPDATE_CONFIG_START],
+				   UPDATE_CONFIG_BYTES) == 0);
+}
+
+/*
+ * @brief Builds a sector and stages it when it differs from the running image, a sector sent
+ * 		  again takes the staging sector it had
+ *
+ * @param1 receiver
+ * @param2 image sector
+ * @param3 ops
+ * @param4 bytes of ops
+ * @return UPDATE_ status
+ */
+static uint8_t receive_sector(update_t *update, uint32_t sector, const uint8_t *ops, uint32_t length)
+{
+	uint32_t address = sector << UPDATE_SECTOR_SHIFT;
+	uint8_t index;
+	uint8_t status;
+
+	if (!update->begun)
+	{
+		return UPDATE_SEQUENCE;
+	}
+	if (address >= update->newSize)
+	{
+		return UPDATE_BAD_DELTA;
+	}
+	status = delta_apply(update, ops, length);
+	if (status != UPDATE_OK)
+	{
+		return status;
+	}
+	if (!config_kept(update, address))
+	{
+		return UPDATE_PROTECTED;
+	}
+	update->stats.sectorsReceived++;
+	index = staging_sector(update, sector);
+	if ((index == NO_STAGING_SECTOR) &&
+		(memcmp(update->sector, &update_flash_base()[address], UPDATE_SECTOR_BYTES) == 0))
+	{
+		update->stats.sectorsUnchanged++;
+		return UPDATE_OK;
+	}
+	if (index == NO_STAGING_SECTOR)
+	{
+		if (update->staged >= UPDATE_STAGING_SECTORS)
+		{
+			return UPDATE_NO_STAGING;
+		}
+		index = update->staged;
+	}
+	if (!update_flash_write_sector(UPDATE_STAGING_START + ((uint32_t)index << UPDATE_SECTOR_SHIFT), update->sector))
+	{
+		return UPDATE_FLASH_ERROR;
+	}
+	update->stats.flashWrites++;
+	update->stagedSector[index] = (uint8_t)sector;
+	if (index == update->staged)
+	{
+		update->staged++;
+	}
+	return UPDATE_OK;
+}
+
+/*
+ * @brief CRC of the new image as it would be after the copy: the staged sectors read back
+ * 		  from the flash and the others from the running image
+ *
+ * @param1 receiver
+ * @param2 CRC found, for the reply
+ * @return UPDATE_ status
+ */
+static uint8_t receive_end(update_t *update, uint32_t *value)
+{
+	const uint8_t *flash = update_flash_base();
+	uint32_t crc = 0;
+	uint32_t address;
+
+	if (!update->begun)
+	{
+		return UPDATE_SEQUENCE;
+	}
+	for (address = 0; address < update->newSize; address += UPDATE_SECTOR_BYTES)
+	{
+		uint32_t sector = address >> UPDATE_SECTOR_SHIFT;
+		uint8_t index = staging_sector(update, sector);
+		uint32_t length = update->newSize - address;
+		const uint8_t *source = &flash[address];
+
+		if (index != NO_STAGING_SECTOR)
+		{
+			source = &flash[UPDATE_STAGING_START + ((uint32_t)index << UPDATE_SECTOR_SHIFT)];
+		}
+		crc = update_crc32(crc, source, (length > UPDATE_SECTOR_BYTES) ? UPDATE_SECTOR_BYTES : length);
+	}
+	*value = crc;
+	if (crc != update->newCrc)
+	{
+		return UPDATE_BAD_IMAGE;
+	}
+	update->commit = true;
+	update->finished = true;
+	return UPDATE_OK;
+}
+
+/*
+ * @brief Takes one byte of the link, a complete frame is carried out and answered
+ *
+ * A sector which differs from the running image is built in RAM and written to the next
+ * free staging sector, the running image is not written. The end frame checks the CRC of
+ * the image made of the staged and the unchanged sectors and sets commit
+ *
+ * @param1 receiver
+ * @param2 byte received
+ * @param3 UPDATE_REPLY_MAX bytes
+ * @return bytes of the reply to be sent, 0 while a frame is not complete
+ */
+uint32_t update_receive(update_t *update, uint8_t byte, uint8_t *reply)
+{
+	uint8_t *payload = update->rxFrame;
+	uint32_t length;
+	uint32_t value = 0;
+	uint16_t argument = 0;
+	uint8_t status;
+
+	update->stats.bytesReceived++;
+	if (byte != 0)
+	{
+		if (update->rxLength < UPDATE_FRAME_MAX)
+		{
+			payload[update->rxLength++] = byte;
+		}
+		else
+		{
+			update->rxOverrun = true;
+		}
+		return 0;
+	}
+	length = update->rxLength;
+	update->rxLength = 0;
+	if (length == 0)
+	{
+		return 0;
+	}
+	length = update->rxOverrun ? 0 : cobs_decode(payload, length);
+	update->rxOverrun = false;
+	if ((length <= UPDATE_CRC_BYTES) ||
+		(update_crc32(0, payload, length - UPDATE_CRC_BYTES) != get_u32(&payload[length - UPDATE_CRC_BYTES])))
+	{
+		update->stats.badFrames++;
+		return update_reply(0, UPDATE_BAD_FRAME, 0, 0, reply);
+	}
+	length -= UPDATE_CRC_BYTES;
+	update->stats.framesReceived++;
+
+	switch (payload[0])
+	{
+		case UPDATE_FRAME_BEGIN:
+			status = (length == UPDATE_BEGIN_BYTES) ? receive_begin(update, payload, &value) : UPDATE_BAD_DELTA;
+			break;
+		case UPDATE_FRAME_SECTOR:
+			if (length < UPDATE_SECTOR_HEADER_BYTES)
+			{
+				status = UPDATE_BAD_DELTA;
+				break;
+			}
+			argument = (uint16_t)(payload[1] | (payload[2] << 8));
+			status = receive_sector(update, argument, &payload[UPDATE_SECTOR_HEADER_BYTES],
+									length - UPDATE_SECTOR_HEADER_BYTES);
+			break;
+		case UPDATE_FRAME_END:
+			status = receive_end(update, &value);
+			break;
+		case UPDATE_FRAME_ABORT:
+			update->begun = false;
+			update->finished = true;
+			status = UPDATE_OK;
+			break;
+		default:
+			status = UPDATE_SEQUENCE;
+			break;
+	}
+	return update_reply(payload[0], status, argument, value, reply);
+}
@@ -0,0 +1,189 @@
+/**
+ * @file    update.h
+ * @brief   This header file consists of the firmware update receiver: a binary delta of the
+ * 			image sent over the debug UART sector by sector, staged in the upper half of the
+ * 			flash and verified before it is copied over the running image
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ */
+
+#ifndef UPDATE_H_
+#define UPDATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UPDATE_COMMAND				('u') /*Character received on the debug UART which starts an update*/
+
+#define UPDATE_SECTOR_BYTES			(1024)		/*Erase unit of the KL25Z flash*/
+#define UPDATE_SECTOR_SHIFT			(10)
+#define UPDATE_FLASH_BYTES			(0x20000u)
+/*The new image is staged in the upper 64 KB. Below it are the flash records of crashdump.c and
+  inputrec.c (the FLASH_RECORDS memory region of the MCU settings, PROGRAM_FLASH ends there),
+  which no update reads or writes, so images are limited to UPDATE_RECORDS_START*/
+#define UPDATE_STAGING_START		(0x10000u)
+#define UPDATE_RECORDS_START		(0xF400u)
+#define UPDATE_STAGING_SECTORS		((UPDATE_FLASH_BYTES - UPDATE_STAGING_START) / UPDATE_SECTOR_BYTES)
+/*The flash configuration field (backdoor key, FPROT, FSEC, FOPT) is loaded from 0x400 at reset, a
+  secured or protected chip can only be mass erased. No update may change it, and the vector
+  table in sector 0 is copied after every other sector*/
+#define UPDATE_CONFIG_START			(0x400u)
+#define UPDATE_CONFIG_BYTES			(16)
+#define UPDATE_CONFIG_FSEC			(0x40Cu)
+#define UPDATE_FSEC_UNSECURE		(0xFE)		/*SEC = 10, KEYEN, MEEN and FSLACC enabled*/
+#define UPDATE_VECTOR_SECTOR		(0)
+#define UPDATE_TIMEOUT_TICKS		(16*10)		/*The update is abandoned after 10 s without a byte*/
+#define UPDATE_RED					(0xFF)		/*Colour of the flash while the update runs*/
+
+/*Frames: payload, CRC-32 little endian, COBS encoded and ended by a 0 byte, as the telemetry
+  frames. The sender waits for the reply to every frame before it sends the next one, the
+  debug UART has no FIFO and nothing is received while the flash is being written*/
+#define UPDATE_FRAME_MAX			(1088)		/*Encoded bytes, a sector of literals and the overhead*/
+#define UPDATE_CRC_BYTES			(4)
+#define UPDATE_FRAME_BEGIN			('B')		/*New size and CRC, base size and CRC, 4 bytes each*/
+#define UPDATE_FRAME_SECTOR			('S')		/*Sector number, 2 bytes, and the delta ops of the sector*/
+#define UPDATE_FRAME_END			('E')		/*Verifies the staged image and copies it*/
+#define UPDATE_FRAME_ABORT			('X')
+#define UPDATE_FRAME_REPLY			('A')		/*Frame type answered, status, 2 byte argument, 4 byte value*/
+#define UPDATE_BEGIN_BYTES			(17)
+#define UPDATE_SECTOR_HEADER_BYTES	(3)
+#define UPDATE_REPLY_BYTES			(9)
+#define UPDATE_REPLY_MAX			(16)		/*Encoded reply*/
+
+/*Delta ops, each builds the next bytes of the sector: a header with the op in the top 2 bits and
+  the length - 1 in the low 5, or in 13 bits with the next byte when UPDATE_OP_LONG is set*/
+#define UPDATE_OP_LITERAL			(0)			/*The bytes follow*/
+#define UPDATE_OP_COPY				(1)			/*From the running image, 3 byte address follows*/
+#define UPDATE_OP_FILL				(2)			/*One byte repeated, the byte follows*/
+#define UPDATE_OP_SHIFT				(6)
+#define UPDATE_OP_LONG				(0x20)
+#define UPDATE_OP_LENGTH_MASK		(0x1F)
+#define UPDATE_OP_SHORT_MAX			(32)
+#define UPDATE_OP_LONG_MAX			(8192)
+
+/*Status of a reply*/
+#define UPDATE_OK					(0)
+#define UPDATE_BAD_FRAME			(1)			/*COBS or CRC error, the frame is sent again*/
+#define UPDATE_BAD_BASE				(2)			/*The running image is not the base of the delta*/
+#define UPDATE_TOO_LARGE			(3)			/*An image reaches into the flash records*/
+#define UPDATE_BAD_DELTA			(4)
+#define UPDATE_FLASH_ERROR			(5)
+#define UPDATE_NO_STAGING			(6)			/*More changed sectors than staging sectors*/
+#define UPDATE_BAD_IMAGE			(7)			/*The staged image does not have the new CRC*/
+#define UPDATE_SEQUENCE				(8)			/*A sector or the end before the begin*/
+#define UPDATE_PROTECTED			(9)			/*A sector changes the flash configuration field*/
+
+typedef struct
+{
+	uint32_t framesReceived;
+	uint32_t badFrames;
+	uint32_t bytesReceived;
+	uint32_t sectorsReceived;
+	uint32_t sectorsUnchanged;		/*Received but the same as the running image*/
+	uint32_t flashWrites;			/*Staging sectors erased and programmed*/
+} update_stats_t;
+
+typedef struct
+{
+	update_stats_t stats;
+	uint32_t imageEnd;				/*End of the running image, nothing may be staged below it*/
+	uint32_t baseSize;				/*Bytes of the running image the copy ops read*/
+	uint32_t newSize;
+	uint32_t newCrc;
+	bool begun;
+	bool finished;					/*Verified and ready to be copied, or abandoned*/
+	bool commit;					/*The staged sectors are to be copied over the image*/
+	uint8_t staged;					/*Staging sectors used*/
+	uint8_t stagedSector[UPDATE_STAGING_SECTORS];	/*Image sector of every staging sector*/
+	uint16_t rxLength;
+	bool rxOverrun;
+	uint8_t rxFrame[UPDATE_FRAME_MAX];
+	uint32_t sector[UPDATE_SECTOR_BYTES / sizeof(uint32_t)];	/*Built by the ops, words for FLASH_Program*/
+} update_t;
+
+/*
+ * @brief Start of the flash, the running image read by the copy ops and the verification.
+ * 		  Given by update_flash.c, or by the host simulator
+ *
+ * @return address 0 of the flash
+ */
+const uint8_t *update_flash_base(void);
+
+/*
+ * @brief Erases and programs one staging sector, given by update_flash.c or the host simulator
+ *
+ * @param1 flash address of the sector
+ * @param2 UPDATE_SECTOR_BYTES of data
+ * @return true if the sector was written
+ */
+bool update_flash_write_sector(uint32_t address, const uint32_t *data);
+
+/*
+ * @brief Starts a receiver with nothing staged
+ *
+ * @param1 receiver
+ * @param2 end of the running image, the staging area has to be above it
+ * @return void
+ */
+void update_init(update_t *update, uint32_t imageEnd);
+
+/*
+ * @brief CRC-32 (IEEE 802.3, as zlib) of a buffer, continued from a previous value
+ *
+ * @param1 CRC of the bytes before, 0 for the first
+ * @param2 bytes
+ * @param3 number of bytes
+ * @return CRC
+ */
+uint32_t update_crc32(uint32_t crc, const uint8_t *data, uint32_t length);
+
+/*
+ * @brief Encodes a frame: payload, CRC, COBS and the 0 delimiter
+ *
+ * @param1 payload
+ * @param2 bytes of payload
+ * @param3 frame, length + length / 254 + 7 bytes
+ * @return bytes in frame
+ */
+uint32_t update_frame_encode(const uint8_t *payload, uint32_t length, uint8_t *frame);
+
+/*
+ * @brief Encodes a reply frame
+ *
+ * @param1 frame type answered
+ * @param2 UPDATE_ status
+ * @param3 argument, the sector of a sector frame
+ * @param4 value, the CRC found when it does not match
+ * @param5 UPDATE_REPLY_MAX bytes
+ * @return bytes in reply
+ */
+uint32_t update_reply(uint8_t type, uint8_t status, uint16_t argument, uint32_t value, uint8_t *reply);
+
+/*
+ * @brief Takes one byte of the link, a complete frame is carried out and answered
+ *
+ * A sector which differs from the running image is built in RAM and written to the next
+ * free staging sector, the running image is not written. The end frame checks the CRC of
+ * the image made of the staged and the unchanged sectors and sets commit
+ *
+ * @param1 receiver
+ * @param2 byte received
+ * @param3 UPDATE_REPLY_MAX bytes
+ * @return bytes of the reply to be sent, 0 while a frame is not complete
+ */
+uint32_t update_receive(update_t *update, uint8_t byte, uint8_t *reply);
+
+/*
+ * @brief Receives an update with the light flashing red and nothing else running. Called
+ * 		  by the console on UPDATE_COMMAND, returns to the STOP of the sequence if the update
+ * 		  is abandoned. A verified update is copied by a loop in RAM, which keeps the red
+ * 		  flashing, and the board is reset
+ *
+ * @return void
+ */
+void update_run(void);
+
+#endif /* UPDATE_H_ */
@@ -0,0 +1,294 @@
+/**
+ * @file    update_flash.c
+ * @brief   This source file consists of the flash side of the firmware update: the staging
+ * 			sectors written with the flash driver, the receive loop on the debug UART and the
+ * 			copy of the staged sectors over the running image by a loop in RAM
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, 27.4.10 Flash command descriptions
+ */
+
+/*Allow the firmware update to be built by setting a define (via command line)*/
+#if defined(FIRMWARE_UPDATE)
+
+#include <string.h>
+#include "MKL25Z4.h"
+#include "fsl_flash.h"
+#include "update.h"
+#include "conflict_monitor.h"
+#include "statemachine.h"
+#include "night_mode.h"
+#include "watchdog.h"
+#include "timer.h"
+#include "pwm.h"
+#include "logfmt.h"
+
+#define UPDATE_FLASH_TICKS			(8)			/*Half period of the red flash, 0.5 s*/
+#define FTFA_ERASE_SECTOR			(0x09)
+#define FTFA_PROGRAM_LONGWORD		(0x06)
+#define FTFA_COMMAND_SHIFT			(24)		/*FCCOB0, above the address in FCCOB1-3*/
+#define FTFA_ERRORS					(FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK)
+#define COP_SERVICE_FIRST			(0x55)
+#define COP_SERVICE_SECOND			(0xAA)
+#define AIRCR_VECTKEY				(0x5FAu)
+
+#define RAMFUNC						__attribute__((section(".ramfunc.update"), noinline, long_call))
+
+extern const uint8_t __vectors_start__[];	/*Address 0, the start of the flash*/
+extern const uint8_t _image_end[];			/*End of the .data load image, the end of the running image*/
+
+static update_t update;
+static flash_config_t flash;
+static volatile uint8_t monitorState;		/*Single rule, always 0*/
+
+/*The red flash is the only colour while the update runs*/
+static const conflict_monitor_rule_t updateRule=
+	MONITOR_RULE_EXACT(UPDATE_RED,0,0,0,0,0);
+
+/*
+ * @brief Start of the flash for the copy ops and the verification
+ *
+ * @return address 0 of the flash
+ */
+const uint8_t *update_flash_base(void)
+{
+	return __vectors_start__;
+}
+
+/*
+ * @brief Erases and programs one staging sector with the flash driver
+ *
+ * @param1 flash address of the sector
+ * @param2 UPDATE_SECTOR_BYTES of data
+ * @return true if the sector was written
+ */
+bool update_flash_write_sector(uint32_t address, const uint32_t *data)
+{
+	uint32_t masking_state = __get_PRIMASK();
+	status_t status;
+
+	__disable_irq();		/*Nothing may run from flash while it is being erased*/
+	status = FLASH_Erase(&flash, address, UPDATE_SECTOR_BYTES, kFLASH_ApiEraseKey);
+	if (status == kStatus_FLASH_Success)
+	{
+		status = FLASH_Program(&flash, address, (uint32_t *)data, UPDATE_SECTOR_BYTES);
+	}
+	__set_PRIMASK(masking_state);
+	return (status == kStatus_FLASH_Success);
+}
+
+/*
+ * @brief Runs one flash command and keeps the red flashing and the COP fed while it runs.
+ * 		  In RAM, the flash cannot be read until the command completes
+ *
+ * @param1 command and address, FCCOB0-3
+ * @param2 longword to program, FCCOB4-7
+ * @param3 TPM2 channel 0 value of the red on and off
+ * @param4 ticks since the last change of the red, carried between commands
+ * @return true if the command completed without error
+ */
+static RAMFUNC bool ram_flash_command(uint32_t command, uint32_t data, const uint16_t *red, uint8_t *ticks)
+{
+	FTFA->FSTAT = FTFA_ERRORS;			/*Write 1 to clear the errors of the last command*/
+	*(volatile uint32_t *)&FTFA->FCCOB3 = command;
+	*(volatile uint32_t *)&FTFA->FCCOB7 = data;
+	FTFA->FSTAT = FTFA_FSTAT_CCIF_MASK;	/*Launch*/
+	while (!(FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK))
+	{
+		if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk)	/*A tick, the flag clears on the read*/
+		{
+			if (++*ticks >= UPDATE_FLASH_TICKS)
+			{
+				*ticks = 0;
+				TPM2->CONTROLS[0].CnV = (TPM2->CONTROLS[0].CnV == red[0]) ? red[1] : red[0];
+			}
+#if defined(WATCHDOG)
+			SIM->SRVCOP = COP_SERVICE_FIRST;
+			SIM->SRVCOP = COP_SERVICE_SECOND;
+#endif
+		}
+	}
+	return !(FTFA->FSTAT & (FTFA_ERRORS | FTFA_FSTAT_MGSTAT0_MASK));
+}
+
+/*
+ * @brief Copies one staged sector over its image sector, retried until it is written
+ *
+ * @param1 receiver with the staged sectors
+ * @param2 staging sector
+ * @param3 TPM2 channel 0 value of the red on and off
+ * @param4 ticks since the last change of the red, carried between commands
+ * @return void
+ */
+static RAMFUNC void ram_copy_sector(update_t *staged, uint8_t index, const uint16_t *red, uint8_t *ticks)
+{
+	const volatile uint32_t *source = (const volatile uint32_t *)(UPDATE_STAGING_START +
+									  ((uint32_t)index << UPDATE_SECTOR_SHIFT));
+	uint32_t target = (uint32_t)staged->stagedSector[index] << UPDATE_SECTOR_SHIFT;
+	uint32_t word;
+	bool written;
+
+	for (word = 0; word < UPDATE_SECTOR_BYTES / sizeof(uint32_t); word++)
+	{
+		staged->sector[word] = source[word];	/*Volatile, not turned into a memcpy() call*/
+	}
+	do
+	{
+		written = ram_flash_command((FTFA_ERASE_SECTOR << FTFA_COMMAND_SHIFT) | target, 0, red, ticks);
+		for (word = 0; written && (word < UPDATE_SECTOR_BYTES / sizeof(uint32_t)); word++)
+		{
+			written = ram_flash_command((FTFA_PROGRAM_LONGWORD << FTFA_COMMAND_SHIFT) |
+										(target + word * sizeof(uint32_t)), staged->sector[word], red, ticks);
+		}
+	} while (!written);
+}
+
+/*
+ * @brief Copies the staged sectors over the running image and resets the board
+ *
+ * Runs from RAM with the interrupts disabled and calls nothing in flash, the flash driver
+ * and the vector table are overwritten. A staging sector is read into the sector buffer
+ * before its target is erased, the flash cannot be read during a command. The red keeps
+ * flashing from the SysTick count flag. A sector which fails is retried. The vector table
+ * is copied last, so a power loss before it leaves the reset vector of the old image; the
+ * flash configuration field was checked by update.c when the sector was received. A board
+ * which loses power here still has to be programmed over SWD, there is no resident loader
+ *
+ * @param1 receiver with the staged sectors
+ * @param2 TPM2 channel 0 value of the red on and off
+ * @return does not return
+ */
+static RAMFUNC void ram_commit(update_t *staged, const uint16_t *red)
+{
+	uint8_t ticks = 0;
+	uint8_t vectors = UPDATE_STAGING_SECTORS;
+	uint8_t index;
+
+	for (index = 0; index < staged->staged; index++)
+	{
+		if (staged->stagedSector[index] == UPDATE_VECTOR_SECTOR)
+		{
+			vectors = index;
+		}
+		else
+		{
+			ram_copy_sector(staged, index, red, &ticks);
+		}
+	}
+	if (vectors != UPDATE_STAGING_SECTORS)
+	{
+		ram_copy_sector(staged, vectors, red, &ticks);
+	}
+	SCB->AIRCR = (AIRCR_VECTKEY << SCB_AIRCR_VECTKEY_Pos) | SCB_AIRCR_SYSRESETREQ_Msk;
+	__DSB();
+	for (;;)
+	{
+	}
+}
+
+/*
+ * @brief Sends a reply, waiting for the transmitter
+ *
+ * @param1 reply
+ * @param2 bytes
+ * @return void
+ */
+static void send_reply(const uint8_t *reply, uint32_t length)
+{
+	uint32_t index;
+
+	for (index = 0; index < length; index++)
+	{
+		while (!(UART0->S1 & UART0_S1_TDRE_MASK))
+		{
+		}
+		UART0->D = reply[index];
+	}
+}
+
+/*
+ * @brief Receives an update with the light flashing red and nothing else running. Called
+ * 		  by the console on UPDATE_COMMAND, returns to the STOP of the sequence if the update
+ * 		  is abandoned. A verified update is copied by a loop in RAM, which keeps the red
+ * 		  flashing, and the board is reset
+ *
+ * The sender is told the end of the running image by a reply to UPDATE_COMMAND, then the
+ * frames are answered one by one. The SysTick keeps running, so the tasks are checked in
+ * here and the COP is fed by the SysTick handler as in the main loop
+ *
+ * @return void
+ */
+void update_run(void)
+{
+	uint8_t reply[UPDATE_REPLY_MAX];
+	uint16_t red[2];
+	ticktime lastByte;
+	ticktime flashTick;
+	bool lit = true;
+
+#if defined(NIGHT_MODE)
+	if (nightMode.active)
+	{
+		logfmt_printf("\r\nno update during the night flash\r\n");
+		return;
+	}
+#endif
+	memset(&flash, 0, sizeof(flash));
+	if (FLASH_Init(&flash) != kStatus_FLASH_Success)
+	{
+		logfmt_printf("\r\nflash driver not ready, no update\r\n");
+		return;
+	}
+	update_init(&update, (uint32_t)_image_end);
+	conflict_monitor_init(&monitorState, &updateRule, 1);
+	update_led_colour(UPDATE_RED, 0, 0);
+	send_reply(reply, update_reply(UPDATE_COMMAND, UPDATE_OK, 0, update.imageEnd, reply));
+	lastByte = now();
+	flashTick = lastByte;
+
+	while (!update.finished && ((now() - lastByte) < UPDATE_TIMEOUT_TICKS))
+	{
+		ticktime tick = now();
+
+		watchdog_checkin(WATCHDOG_TASK_TICK);
+		watchdog_checkin(WATCHDOG_TASK_TSI);
+		watchdog_checkin(WATCHDOG_TASK_CONSOLE);
+		if ((tick - flashTick) >= UPDATE_FLASH_TICKS)
+		{
+			flashTick = tick;
+			lit = !lit;
+			update_led_colour(lit ? UPDATE_RED : 0, 0, 0);
+		}
+		if (UART0->S1 & UART0_S1_OR_MASK)
+		{
+			UART0->S1 = UART0_S1_OR_MASK;	/*The lost byte fails the CRC of its frame, which is sent again*/
+		}
+		if (UART0->S1 & UART0_S1_RDRF_MASK)
+		{
+			uint32_t length = update_receive(&update, UART0->D, reply);
+
+			lastByte = tick;
+			send_reply(reply, length);
+		}
+	}
+
+	if (update.commit)
+	{
+		show_led_colour(UPDATE_RED, 0, 0);
+		red[0] = (uint16_t)TPM2->CONTROLS[0].CnV;
+		show_led_colour(0, 0, 0);
+		red[1] = (uint16_t)TPM2->CONTROLS[0].CnV;
+		show_led_colour(UPDATE_RED, 0, 0);
+		__disable_irq();
+		ram_commit(&update, red);
+	}
+	logfmt_printf("\r\nupdate abandoned: %lu frames, %lu bad, %lu sectors staged\r\n",
+				  (unsigned long)update.stats.framesReceived, (unsigned long)update.stats.badFrames,
+				  (unsigned long)update.staged);
+	statemachine_resume();
+}
+
+#endif
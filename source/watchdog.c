@@ -0,0 +1,108 @@
+/**
+ * @file    watchdog.c
+ * @brief   This source file consists of function definitions of the COP watchdog and the
+ * 			software supervisor which feeds it only while every periodic activity is alive
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 12 System Integration Module (COP) and
+ * 	  chapter 16 Reset Control Module
+ */
+
+#include "MKL25Z4.h"
+#include "system_MKL25Z4.h"
+#include "watchdog.h"
+#include "faultlog.h"
+#include "statemachine.h"
+
+#if defined(WATCHDOG) && DISABLE_WDOG
+#error "WATCHDOG needs DISABLE_WDOG=0, SystemInit() would otherwise disable the write once COP"
+#endif
+
+#define COP_SERVICE_FIRST			(0x55)
+#define COP_SERVICE_SECOND			(0xAA)
+#define RESET_REASON_SHIFT			(8)
+
+/*Resets which are logged, power on and the reset pin are normal starts*/
+#define ABNORMAL_SRS0				(RCM_SRS0_WDOG_MASK | RCM_SRS0_LOC_MASK | RCM_SRS0_LOL_MASK | RCM_SRS0_LVD_MASK)
+#define ABNORMAL_SRS1				(RCM_SRS1_LOCKUP_MASK | RCM_SRS1_SW_MASK | RCM_SRS1_MDM_AP_MASK | RCM_SRS1_SACKERR_MASK)
+
+watchdog_t watchdog;
+
+/*
+ * @brief Records the reason of the last reset in the fault log and starts the supervisor
+ *
+ * @return void
+ */
+void watchdog_init(void)
+{
+	uint8_t task;
+
+	watchdog.resetSRS0 = RCM->SRS0;
+	watchdog.resetSRS1 = RCM->SRS1;
+	faultLog.resetReason = ((uint32_t)watchdog.resetSRS1 << RESET_REASON_SHIFT) | watchdog.resetSRS0;
+	if ((watchdog.resetSRS0 & ABNORMAL_SRS0) || (watchdog.resetSRS1 & ABNORMAL_SRS1))
+	{
+		faultlog_record(FAULT_RESET, START, START, faultLog.resetReason);
+	}
+
+	for (task = 0; task < WATCHDOG_TASKS; task++)
+	{
+		watchdog.lastCheckin[task] = now();
+	}
+	watchdog.stale = 0;
+	watchdog.feeds = 0;
+
+#if defined(WATCHDOG)
+	SIM->COPC = SIM_COPC_COPT(WATCHDOG_COPT);	/*LPO clock, normal mode, written once after reset*/
+#endif
+}
+
+/*
+ * @brief Called by a supervised task every time it runs
+ *
+ * @param task WATCHDOG_TASK_ ID
+ * @return void
+ */
+void watchdog_checkin(uint8_t task)
+{
+	watchdog.lastCheckin[task] = now();
+}
+
+/*
+ * @brief Feeds the COP when every task is alive, called from the SysTick handler
+ *
+ * @return void
+ */
+void watchdog_tick(void)
+{
+	ticktime tick = now();
+	uint8_t stale = 0;
+	uint8_t task;
+
+	if (watchdog.stale != 0)
+	{
+		return;		/*Latched until the COP resets the board*/
+	}
+	for (task = 0; task < WATCHDOG_TASKS; task++)
+	{
+		if ((tick - watchdog.lastCheckin[task]) > WATCHDOG_DEADLINE)
+		{
+			stale |= (1u << task);
+		}
+	}
+	if (stale != 0)
+	{
+		watchdog.stale = stale;
+		faultlog_record(FAULT_WATCHDOG, statemachine_state(), statemachine_state(), stale);
+		return;
+	}
+
+	watchdog.feeds++;
+#if defined(WATCHDOG)
+	SIM->SRVCOP = COP_SERVICE_FIRST;
+	SIM->SRVCOP = COP_SERVICE_SECOND;
+#endif
+}
@@ -0,0 +1,71 @@
+/**
+ * @file    watchdog.h
+ * @brief   This header file consists of the COP watchdog and the software supervisor which
+ * 			feeds it only while every periodic activity checks in within its deadline
+ * @date 	18th October, 2026
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) Embedded Systems fundamentals with ARM Cortex-M based microcontroller by Alexander Dean
+ * 2) KL25 Sub-Family Reference Manual, chapter 12 System Integration Module (COP) and
+ * 	  chapter 16 Reset Control Module
+ */
+
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+/*Periodic activities supervised, each one calls watchdog_checkin() every time it runs*/
+#define WATCHDOG_TASK_TICK			(0) /*Tick processing of the main loop*/
+#define WATCHDOG_TASK_TSI			(1) /*Touch slider sampling*/
+#define WATCHDOG_TASK_CONSOLE		(2) /*Debug UART service, metrics and fault log commands*/
+#define WATCHDOG_TASKS				(3)
+
+#define WATCHDOG_DEADLINE			(8) /*Ticks of 62.5 msec a task may miss before it is stale*/
+
+/*COP timeout of 2^10 cycles of the 1 kHz LPO, COPT = 3*/
+#define WATCHDOG_COP_TIMEOUT_MS		(1024)
+#define WATCHDOG_COPT				(3)
+
+typedef struct
+{
+	ticktime lastCheckin[WATCHDOG_TASKS];
+	uint32_t feeds;				/*COP services*/
+	uint8_t stale;				/*Tasks found stale, the COP is no longer fed*/
+	uint8_t resetSRS0;			/*Reset reason of the last reset, RCM status registers*/
+	uint8_t resetSRS1;
+} watchdog_t;
+
+extern watchdog_t watchdog;
+
+/*
+ * @brief Records the reason of the last reset in the fault log and starts the supervisor
+ *
+ * With WATCHDOG defined the COP is enabled here, which needs DISABLE_WDOG=0 so that
+ * SystemInit() leaves the write once COPC register to this function
+ *
+ * @return void
+ */
+void watchdog_init(void);
+
+/*
+ * @brief Called by a supervised task every time it runs
+ *
+ * @param task WATCHDOG_TASK_ ID
+ * @return void
+ */
+void watchdog_checkin(uint8_t task);
+
+/*
+ * @brief Feeds the COP when every task is alive, called from the SysTick handler
+ *
+ * Once a task is stale the stall is logged and the COP is left to reset the board
+ *
+ * @return void
+ */
+void watchdog_tick(void);
+
+#endif /* WATCHDOG_H_ */
@@ -83,6 +83,12 @@ __attribute__ ((used,section(".FlashConfig"))) const struct {
 extern void SystemInit(void);
 #endif // (__USE_CMSIS)
 
+//*****************************************************************************
+// Declaration of the boot timer, see source/boot.h
+//*****************************************************************************
+extern void boot_timer_start(void);
+extern void boot_clock_start(void);
+
 //*****************************************************************************
 // Forward declaration of the core exception handlers.
 // When the application defines a handler (with the same name), this will
@@ -260,21 +266,48 @@ void (* const g_pfnVectors[])(void) = {
 // are written as separate functions rather than being inlined within the
 // ResetISR() function in order to cope with MCUs with multiple banks of
 // memory.
+//
+// Four words are moved per LDM/STM pair, 13 cycles for the copy and 8 for the
+// zero fill against about 32 and 24 for four single word iterations. The
+// sections are word aligned and sized by the linker script, the words left
+// over are done one at a time. tools/init_report.py prints the sizes
 //*****************************************************************************
+#define INIT_BLOCK_BYTES 16
+#define INIT_BLOCK_MASK (INIT_BLOCK_BYTES - 1)
+
 __attribute__ ((section(".after_vectors.init_data")))
 void data_init(unsigned int romstart, unsigned int start, unsigned int len) {
 	unsigned int *pulDest = (unsigned int*) start;
 	unsigned int *pulSrc = (unsigned int*) romstart;
+	unsigned int blocks = len / INIT_BLOCK_BYTES;
 	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
+	while (blocks--) {
+		__asm volatile ("ldmia %0!, {r3-r6}\n\t"
+						"stmia %1!, {r3-r6}"
+						: "+l" (pulSrc), "+l" (pulDest)
+						:
+						: "r3", "r4", "r5", "r6", "memory");
+	}
+	for (loop = 0; loop < (len & INIT_BLOCK_MASK); loop = loop + 4)
 		*pulDest++ = *pulSrc++;
 }
 
 __attribute__ ((section(".after_vectors.init_bss")))
 void bss_init(unsigned int start, unsigned int len) {
 	unsigned int *pulDest = (unsigned int*) start;
+	unsigned int blocks = len / INIT_BLOCK_BYTES;
 	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
+	register unsigned int zero0 __asm("r3") = 0;
+	register unsigned int zero1 __asm("r4") = 0;
+	register unsigned int zero2 __asm("r5") = 0;
+	register unsigned int zero3 __asm("r6") = 0;
+	while (blocks--) {
+		__asm volatile ("stmia %0!, {r3-r6}"
+						: "+l" (pulDest)
+						: "r" (zero0), "r" (zero1), "r" (zero2), "r" (zero3)
+						: "memory");
+	}
+	for (loop = 0; loop < (len & INIT_BLOCK_MASK); loop = loop + 4)
 		*pulDest++ = 0;
 }
 
@@ -290,6 +323,20 @@ extern unsigned int __data_section_table_end;
 extern unsigned int __bss_section_table;
 extern unsigned int __bss_section_table_end;
 
+//*****************************************************************************
+// Bounds of the default .noinit section, given by the managed linker script
+//*****************************************************************************
+extern unsigned int _noinit;
+extern unsigned int _end_noinit;
+
+//*****************************************************************************
+// Reset Control Module SRS0: a power-on or low-voltage reset leaves random
+// contents in the .noinit sections, every other reset (COP, pin, lockup,
+// software) keeps them for the fault log, the crash dump and the recordings
+//*****************************************************************************
+#define RCM_SRS0 (*((volatile unsigned char *)0x4007F000))
+#define RCM_SRS0_COLD_MASK (0x80u | 0x02u) // POR, LVD
+
 //*****************************************************************************
 // Reset entry point for your code.
 // Sets up a simple runtime environment and initializes the C/C++
@@ -301,6 +348,10 @@ void ResetISR(void) {
     // Disable interrupts
     __asm volatile ("cpsid i");
 
+    // Start the SysTick as the boot timer, the time to first light is
+    // measured from here
+    boot_timer_start();
+
 #if defined (__USE_CMSIS)
 // If __USE_CMSIS defined, then call CMSIS SystemInit code
     SystemInit();
@@ -310,6 +361,12 @@ void ResetISR(void) {
     *((volatile unsigned int *)0x40048100) = 0x00u;
 #endif // (__USE_CMSIS)
 
+#if !defined(BOOT_SEQUENTIAL)
+    // Start the crystal and the PLL, they lock while the RAM is
+    // initialized and the board is set up
+    boot_clock_start();
+#endif
+
     //
     // Copy the data sections from flash to SRAM.
     //
@@ -335,6 +392,12 @@ void ResetISR(void) {
 		bss_init(ExeAddr, SectionLen);
 	}
 
+	// Zero fill the noinit section after a cold reset only
+	if (RCM_SRS0 & RCM_SRS0_COLD_MASK) {
+		bss_init((unsigned int)&_noinit,
+				 (unsigned int)&_end_noinit - (unsigned int)&_noinit);
+	}
+
 #if !defined (__USE_CMSIS)
 // Assume that if __USE_CMSIS defined, then CMSIS SystemInit code
 // will setup the VTOR register
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Compares a host benchmark run against a stored baseline.
+
+Both files are the JSON written by host/build/bench_control. A benchmark whose
+time grew by more than the threshold is a regression, one missing from either
+file is reported. Times are compared relative to the reference benchmark of the
+same run, so a host which is slower or faster as a whole is not a regression;
+--absolute compares ns/op instead. With several current runs the fastest run of
+every benchmark counts, a busy host only ever makes a benchmark slower.
+
+The baseline only holds for the machine and compiler it was recorded on,
+refresh it with "make -C host bench_baseline".
+
+Usage: bench_compare.py baseline.json current.json [current.json ...] [--threshold PERCENT]
+Exits 1 on a regression.
+"""
+
+import argparse
+import json
+import sys
+
+DEFAULT_THRESHOLD = 5.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current", nargs="+")
+    parser.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD, help="percent, default 5")
+    parser.add_argument("--absolute", action="store_true", help="compare ns/op, not relative to the reference")
+    options = parser.parse_args()
+
+    with open(options.baseline) as baseline_file:
+        baseline = json.load(baseline_file)["benchmarks"]
+    key = "ns_per_op" if options.absolute else "relative"
+    current = {}
+    for path in options.current:
+        with open(path) as current_file:
+            for name, result in json.load(current_file)["benchmarks"].items():
+                if name not in current or result[key] < current[name][key]:
+                    current[name] = result
+
+    regressions = 0
+    print(f"{'benchmark':32} {'baseline':>10} {'current':>10} {'change':>8}  ({key})")
+    for name in sorted(set(baseline) | set(current)):
+        if name not in baseline or name not in current:
+            print(f"{name:32} {'only in ' + ('baseline' if name in baseline else 'current'):>30}")
+            continue
+        before = baseline[name][key]
+        after = current[name][key]
+        change = 100.0 * (after - before) / before
+        flag = ""
+        if change > options.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print(f"{name:32} {before:10.2f} {after:10.2f} {change:+7.1f}%{flag}")
+    if regressions:
+        print(f"{regressions} benchmarks slower by more than {options.threshold:g} %", file=sys.stderr)
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
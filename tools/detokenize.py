@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""Turns a tokenized log stream captured from the UART back into text.
+
+The firmware built with LOG_TOKENIZED sends every LOG() call as a record
+(see source/logtok.h):
+
+    0xA5, token (16 bit little endian), one LEB128 varint per argument
+
+The token is the offset of the format string in the log_tokens section of
+the .axf, which is never loaded on the board. %s arguments are tokens too.
+
+Usage: detokenize.py firmware.axf [capture.bin | /dev/ttyACM0]
+Reads stdin when no capture is given. The input is decoded as it arrives,
+so a tty (set to raw at the baud rate, e.g. "stty -F /dev/ttyACM0 raw
+115200") or a pipe prints every record as soon as its last byte is read.
+"""
+
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+SECTION = "log_tokens"
+CONVERSION = re.compile(r"%(-?[0-9]*)l?([diuxXcs%])")
+CHUNK = 4096  # most bytes taken per read, a tty returns what it has
+
+
+def read_section(path, name):
+    """Returns the contents of an ELF section, 32 or 64 bit, little endian."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+    if data[:4] != b"\x7fELF":
+        raise SystemExit(f"{path}: not an ELF file")
+    is64 = data[4] == 2
+    if is64:
+        shoff, = struct.unpack_from("<Q", data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        header = "<IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        header = "<IIIIIIIIII"
+    sections = [struct.unpack_from(header, data, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for section in sections:
+        start = names[4] + section[0]
+        if data[start:data.index(b"\0", start)].decode() == name:
+            return data[section[4]:section[4] + section[5]]
+    raise SystemExit(f"{path}: no {name} section, was the firmware built with LOG_TOKENIZED?")
+
+
+class Detokenizer:
+    def __init__(self, strings):
+        self.strings = strings
+        self.pending = b""  # bytes of a record not complete yet
+
+    def string(self, token):
+        if token >= len(self.strings):
+            return None
+        end = self.strings.find(b"\0", token)
+        return self.strings[token:end].decode("ascii", "replace")
+
+    def feed(self, data):
+        """Yields the text of every record completed by the bytes, keeping the rest for the next call."""
+        stream = self.pending + data
+        index = 0
+        while index + 3 <= len(stream):
+            if stream[index] != SYNC:
+                index += 1
+                continue
+            token = stream[index + 1] | (stream[index + 2] << 8)
+            fmt = self.string(token)
+            if fmt is None:
+                index += 1
+                continue
+            position = index + 3
+            args = []
+            complete = True
+            for match in CONVERSION.finditer(fmt):
+                if match.group(2) == "%":
+                    continue
+                value, shift = 0, 0
+                while True:
+                    if position >= len(stream):
+                        complete = False
+                        break
+                    byte = stream[position]
+                    position += 1
+                    value |= (byte & 0x7F) << shift
+                    shift += 7
+                    if not byte & 0x80:
+                        break
+                if not complete:
+                    break
+                args.append(value)
+            if not complete:
+                break
+            yield self.format(fmt, args)
+            index = position
+        self.pending = stream[index:]
+
+    def format(self, fmt, args):
+        values = iter(args)
+
+        def convert(match):
+            width, kind = match.groups()
+            if kind == "%":
+                return "%"
+            value = next(values)
+            if kind == "s":
+                text = self.string(value)
+                text = text if text is not None else f"<token {value}>"
+                return text.ljust(-int(width)) if width.startswith("-") else text.rjust(int(width or 0))
+            if kind in "di" and value & 0x80000000:
+                value -= 1 << 32
+            if kind == "c":
+                return chr(value)
+            return ("%" + width + {"i": "d", "u": "d"}.get(kind, kind)) % value
+
+        return CONVERSION.sub(convert, fmt)
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        raise SystemExit(__doc__)
+    detokenizer = Detokenizer(read_section(sys.argv[1], SECTION))
+    source = os.open(sys.argv[2], os.O_RDONLY) if len(sys.argv) == 3 else sys.stdin.fileno()
+    try:
+        while True:
+            data = os.read(source, CHUNK)
+            if not data:
+                break
+            for line in detokenizer.feed(data):
+                sys.stdout.write(line)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if source != sys.stdin.fileno():
+            os.close(source)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""RAM initialisation work done by ResetISR before main, from the .axf.
+
+.data is copied from flash and .bss zeroed on every reset, .noinit is zeroed
+after a power-on or low-voltage reset only and kept over the others (COP, pin,
+lockup, software). The largest objects of every section are listed, with the
+cycles of the single word loops the startup code had and of the LDM/STM block
+loops it has now, at the 20.97 MHz FLL clock the core runs from at reset.
+
+Usage: init_report.py firmware.axf [--top N] [--budget BYTES]
+Exits 1 when the bytes initialised on a cold reset exceed the budget.
+"""
+
+import argparse
+import struct
+import sys
+
+from stack_report import Elf, SHT_SYMTAB
+
+STT_OBJECT = 1
+RESET_CLOCK_HZ = 20971520
+BLOCK_BYTES = 16
+WORD_COPY_CYCLES = 8    # LDR, STR, ADDS, CMP, BCC per word
+WORD_ZERO_CYCLES = 6    # STR, ADDS, CMP, BCC per word
+BLOCK_COPY_CYCLES = 13  # LDMIA and STMIA of 4 registers, SUBS, BCS
+BLOCK_ZERO_CYCLES = 8   # STMIA of 4 registers, SUBS, BCS
+# section, what ResetISR does with it, word and block cycles
+SECTIONS = [
+    (".data", "copied", WORD_COPY_CYCLES, BLOCK_COPY_CYCLES),
+    (".bss", "zeroed", WORD_ZERO_CYCLES, BLOCK_ZERO_CYCLES),
+    (".noinit", "zeroed cold", WORD_ZERO_CYCLES, BLOCK_ZERO_CYCLES),
+]
+
+
+def objects(elf):
+    """(size, name) of the data objects of every section index."""
+    found = {}
+    for symtab in elf.sections:
+        if symtab[1] != SHT_SYMTAB:
+            continue
+        strings = elf.sections[symtab[6]]
+        for offset in range(symtab[4], symtab[4] + symtab[5], 16):
+            name, _, size, info, _, shndx = struct.unpack_from("<IIIBBH", elf.data, offset)
+            if info & 0xF == STT_OBJECT and size:
+                found.setdefault(shndx, []).append((size, elf.string(strings, name)))
+    return found
+
+
+def cycles(size, word, block):
+    """Old single word loop and new block loop with its word tail."""
+    return size // 4 * word, size // BLOCK_BYTES * block + size % BLOCK_BYTES // 4 * word
+
+
+def usec(count):
+    return count * 1e6 / RESET_CLOCK_HZ
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("axf")
+    parser.add_argument("--top", type=int, default=3, help="largest objects listed per section")
+    parser.add_argument("--budget", type=int, help="bytes copied and zeroed on a cold reset")
+    options = parser.parse_args()
+
+    elf = Elf(options.axf)
+    by_section = objects(elf)
+    print(f"{'section':10} {'action':12} {'bytes':>6} {'word loop':>16} {'LDM/STM':>16}")
+    total = [0, 0, 0]
+    warm = [0, 0, 0]
+    for name, action, word, block in SECTIONS:
+        if name not in elf.names:
+            print(f"{name:10} {'absent':12}")
+            continue
+        index = elf.names.index(name)
+        size = elf.sections[index][5]
+        old, new = cycles(size, word, block)
+        print(f"{name:10} {action:12} {size:6} {old:7} {usec(old):5.1f} us {new:7} {usec(new):5.1f} us")
+        for row in (total, warm) if name != ".noinit" else (total,):
+            row[0] += size
+            row[1] += old
+            row[2] += new
+        for object_size, object_name in sorted(by_section.get(index, []), reverse=True)[:options.top]:
+            print(f"    {object_name:32} {object_size:6}")
+    for label, (size, old, new) in (("cold reset", total), ("warm reset", warm)):
+        print(f"{label:23} {size:6} {old:7} {usec(old):5.1f} us {new:7} {usec(new):5.1f} us")
+
+    if options.budget is not None and total[0] > options.budget:
+        print(f"over budget: RAM init {total[0]} > {options.budget} bytes", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
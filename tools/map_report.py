@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""RAM and flash of every module and symbol from the linker map, with budgets.
+
+Reads the GNU ld map written next to the .axf (-Map). Every input section of
+the memory map is charged to its object file, archive members to their
+archive, and named after its symbol: .bss.foo is foo, which -fdata-sections
+and -ffunction-sections give to every object of this tree. .data counts in
+both RAM and flash, its load image. The heap and the stack are reserved by the
+linker script and reported apart, what is left of the SRAM after them and the
+static data is the headroom for more log rings and trace buffers.
+
+Usage: map_report.py firmware.map [--top N] [--ram-budget BYTES]
+                     [--flash-budget BYTES] [--module-budget MODULE:BYTES ...]
+Budgets are on static RAM (.data, .bss, .noinit, the MTB buffer) and flash, a
+module budget on the static RAM of one module. Exits 1 when one is exceeded.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+FLASH_BASE = 0x00000000
+FLASH_SIZE = 128 * 1024
+SRAM_BASE = 0x1FFFF000
+SRAM_SIZE = 16 * 1024
+RESERVED = {".heap": "heap", ".heap2stackfill": "stack"}  # .stack is empty, _StackSize is filled before it
+NOT_LOADED = (".debug", ".comment", ".ARM.attributes", ".stab", "/DISCARD/")
+INPUT_PREFIXES = (".text_FLASH_RECORDS.", ".text.", ".rodata.", ".data.", ".bss.", ".noinit.",
+                  ".after_vectors.", ".ramfunc.")
+
+OUTPUT = re.compile(r"^(\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)(?:\s+load address 0x([0-9a-f]+))?)?\s*$")
+INPUT = re.compile(r"^ (\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+))?\s*$")
+CONTINUED = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+?)\s*$")
+SYMBOL = re.compile(r"^\s+0x([0-9a-f]+)\s+([A-Za-z_]\w*)\s*$")
+
+
+def in_sram(address):
+    return SRAM_BASE <= address < SRAM_BASE + SRAM_SIZE
+
+
+def in_flash(address):
+    return FLASH_BASE <= address < FLASH_BASE + FLASH_SIZE
+
+
+def module_of(path):
+    """Object name without directory and .o, or the archive of a member."""
+    path = path.replace("\\", "/")
+    archive = re.match(r"(.*\.a)\((.*)\)$", path)
+    if archive:
+        return os.path.basename(archive.group(1))
+    name = os.path.basename(path)
+    return name[:-2] if name.endswith(".o") else name
+
+
+def symbol_of(section):
+    for prefix in INPUT_PREFIXES:
+        if section.startswith(prefix):
+            return section[len(prefix):]
+    return section
+
+
+class Entry:
+    def __init__(self, output, section, address, size, path, load):
+        self.output = output
+        self.name = symbol_of(section)
+        self.address = address
+        self.size = size
+        self.module = module_of(path)
+        self.load = load  # .data image in flash
+
+
+def parse(path):
+    """Input sections of the memory map and the sizes of the reserved sections."""
+    with open(path, errors="replace") as mapfile:
+        lines = mapfile.read().splitlines()
+    try:
+        start = lines.index("Linker script and memory map")
+    except ValueError:
+        raise SystemExit(f"{path}: no memory map, not a GNU ld map file")
+
+    entries = []
+    reserved = {}
+    output = None
+    loads = False
+    pending = None  # input section name whose address and size are on the next line
+    for line in lines[start + 1:]:
+        if not line.strip():
+            continue
+        if not line.startswith(" "):
+            match = OUTPUT.match(line)
+            pending = None
+            output = None
+            if not match or match.group(1).startswith(NOT_LOADED):
+                continue
+            output = match.group(1)
+            loads = match.group(4) is not None
+            if match.group(2) is None:
+                pending = ("output", output)
+            elif output in RESERVED:
+                reserved[RESERVED[output]] = int(match.group(3), 16)
+            continue
+        if output is None:
+            continue
+        if pending and pending[0] == "output":
+            found = CONTINUED.match(line) or re.match(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)", line)
+            if found and output in RESERVED:
+                reserved[RESERVED[output]] = int(found.group(2), 16)
+            pending = None
+            if found:
+                continue
+        if pending:
+            found = CONTINUED.match(line)
+            if found:
+                entries.append(Entry(output, pending[1], int(found.group(1), 16), int(found.group(2), 16),
+                                     found.group(3), loads))
+            pending = None
+            continue
+        if line.startswith(" *fill*"):
+            found = re.match(r"^ \*fill\*\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)", line)
+            if found:
+                entries.append(Entry(output, "*fill*", int(found.group(1), 16), int(found.group(2), 16),
+                                     "(fill)", loads))
+            continue
+        if line.startswith(" *") or line.startswith(" FILL") or SYMBOL.match(line):
+            continue
+        linker = re.match(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(LONG|SHORT|BYTE|QUAD)\b", line)
+        if linker:
+            entries.append(Entry(output, "section table", int(linker.group(1), 16), int(linker.group(2), 16),
+                                 "(linker script)", loads))
+            continue
+        match = INPUT.match(line)
+        if not match:
+            continue
+        if match.group(2) is None:
+            pending = ("input", match.group(1))
+        else:
+            entries.append(Entry(output, match.group(1), int(match.group(2), 16), int(match.group(3), 16),
+                                 match.group(4), loads))
+    return [entry for entry in entries if entry.size and entry.output not in RESERVED], reserved
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("map")
+    parser.add_argument("--top", type=int, default=12, help="largest RAM symbols listed")
+    parser.add_argument("--ram-budget", type=int, help="bytes of static RAM")
+    parser.add_argument("--flash-budget", type=int, help="bytes of flash")
+    parser.add_argument("--module-budget", action="append", default=[], help="MODULE:BYTES of static RAM")
+    options = parser.parse_args()
+
+    entries, reserved = parse(options.map)
+    modules = {}
+    for entry in entries:
+        ram = entry.size if in_sram(entry.address) else 0
+        flash = entry.size if in_flash(entry.address) or entry.load else 0
+        totals = modules.setdefault(entry.module, [0, 0])
+        totals[0] += flash
+        totals[1] += ram
+
+    print(f"{'module':28} {'flash':>7} {'RAM':>6}")
+    for module, (flash, ram) in sorted(modules.items(), key=lambda item: (-item[1][1], -item[1][0], item[0])):
+        print(f"{module:28} {flash:7} {ram:6}")
+
+    ram_entries = sorted((entry for entry in entries if in_sram(entry.address)),
+                         key=lambda entry: (-entry.size, entry.name))
+    print(f"\n{'RAM symbol':28} {'section':20} {'bytes':>6}  module")
+    for entry in ram_entries[:options.top]:
+        print(f"{entry.name:28} {entry.output:20} {entry.size:6}  {entry.module}")
+
+    static = sum(ram for _, ram in modules.values())
+    flash = sum(flash for flash, _ in modules.values())
+    heap = reserved.get("heap", 0)
+    stack = reserved.get("stack", 0)
+    headroom = SRAM_SIZE - static - heap - stack
+    print(f"\nRAM: static {static} + heap {heap} + stack {stack} of {SRAM_SIZE} bytes, headroom {headroom}")
+    print(f"flash: {flash} of {FLASH_SIZE} bytes")
+
+    failed = []
+    if options.ram_budget is not None and static > options.ram_budget:
+        failed.append(f"static RAM {static} > {options.ram_budget} bytes")
+    if options.flash_budget is not None and flash > options.flash_budget:
+        failed.append(f"flash {flash} > {options.flash_budget} bytes")
+    for limit in options.module_budget:
+        name, value = limit.rsplit(":", 1)
+        ram = modules.get(name, [0, 0])[1]
+        if ram > int(value):
+            failed.append(f"{name} RAM {ram} > {value} bytes")
+    for failure in failed:
+        print(f"over budget: {failure}", file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Maps a Micro Trace Buffer export captured from the UART back to source lines.
+
+The firmware sends the trace on 't' from the debug UART, and at boot after a
+fault froze it (see source/mtb.h), as one line per branch, oldest first:
+
+    mtb <source> <destination> [exception] [start]
+
+Every branch is printed as function and file:line of both addresses using
+arm-none-eabi-addr2line on the .axf. Without addr2line the symbol table of the
+.axf gives function+offset instead.
+
+Usage: mtb_decode.py firmware.axf [capture.txt | /dev/ttyACM0] [--addr2line PATH]
+Reads stdin when no capture is given.
+"""
+
+import re
+import shutil
+import struct
+import subprocess
+import sys
+
+ADDR2LINE = "arm-none-eabi-addr2line"
+PACKET = re.compile(r"mtb ([0-9a-fA-F]{8}) ([0-9a-fA-F]{8})((?: exception| start)*)")
+STT_FUNC = 2
+
+
+def read_symbols(path):
+    """Returns the sorted (address, size, name) of the functions of a 32 bit ELF."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1:
+        raise SystemExit(f"{path}: not a 32 bit ELF file")
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+    sections = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+    functions = []
+    for section in sections:
+        if section[1] != 2:  # SHT_SYMTAB
+            continue
+        strings = sections[section[6]]
+        for offset in range(section[4], section[4] + section[5], 16):
+            name, value, size, info = struct.unpack_from("<IIIB", data, offset)
+            if info & 0xF != STT_FUNC:
+                continue
+            start = strings[4] + name
+            text = data[start:data.index(b"\0", start)].decode()
+            functions.append((value & ~1, size, text))
+    return sorted(functions)
+
+
+class Resolver:
+    def __init__(self, axf, addr2line):
+        self.axf = axf
+        self.addr2line = shutil.which(addr2line)
+        self.functions = None if self.addr2line else read_symbols(axf)
+
+    def resolve(self, addresses):
+        """Returns a description of every address, in order."""
+        if not addresses:
+            return []
+        if self.addr2line:
+            output = subprocess.run([self.addr2line, "-f", "-e", self.axf] + [f"{a:#x}" for a in addresses],
+                                    check=True, capture_output=True, text=True).stdout.splitlines()
+            return [f"{output[2 * i]} {output[2 * i + 1].rsplit('/', 1)[-1]}" for i in range(len(addresses))]
+        return [self.symbol(address) for address in addresses]
+
+    def symbol(self, address):
+        for start, size, name in reversed(self.functions):
+            if start <= address < start + max(size, 1):
+                return f"{name}+{address - start:#x}"
+        return "?"
+
+
+def main():
+    args = sys.argv[1:]
+    addr2line = ADDR2LINE
+    if "--addr2line" in args:
+        index = args.index("--addr2line")
+        addr2line = args[index + 1]
+        del args[index:index + 2]
+    if len(args) not in (1, 2):
+        raise SystemExit(__doc__)
+    if len(args) == 2:
+        with open(args[1], "r", errors="replace") as capture:
+            text = capture.read()
+    else:
+        text = sys.stdin.read()
+
+    packets = [(int(m.group(1), 16), int(m.group(2), 16), m.group(3).split()) for m in PACKET.finditer(text)]
+    resolver = Resolver(args[0], addr2line)
+    places = resolver.resolve([address for packet in packets for address in packet[:2]])
+    for index, (source, destination, flags) in enumerate(packets):
+        if "start" in flags:
+            print("-- trace started")
+        arrow = "=>" if "exception" in flags else "->"
+        print(f"{source:08x} {places[2 * index]:40} {arrow} {destination:08x} {places[2 * index + 1]}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,297 @@
+#!/usr/bin/env python3
+"""Worst case stack depth and ISR cycle estimate of the firmware, with budgets.
+
+The frame of every function comes from the -fstack-usage .su files of the
+build, or from its PUSH and SUB SP prologue for functions without one (library
+and assembly). The call graph and the cycle counts come from disassembling the
+Thumb code of the .axf, so no target toolchain is needed.
+
+Stack: the depth of an entry point is its frame plus the deepest chain of
+callees. Interrupts nest by priority, so the worst case adds the deepest
+handler of every priority level above the thread, each with its 32 byte
+exception frame (+4 for alignment). Calls through a pointer and recursion
+cannot be followed and are reported.
+
+Cycles: Cortex-M0+ timings with a zero wait state flash, every instruction of a
+function counted once with branches taken, plus its callees at every call.
+Loops are counted once and flagged, so their bounds must be checked by hand.
+
+Usage: stack_report.py firmware.axf build_dir [--isr NAME:PRIORITY ...]
+                       [--stack-budget BYTES] [--cycle-budget NAME:CYCLES ...]
+Exits 1 when a budget is exceeded.
+"""
+
+import argparse
+import bisect
+import os
+import struct
+import sys
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHF_ALLOC = 0x2
+STT_FUNC = 2
+SRAM_BASE = 0x1FFFF000
+SRAM_SIZE = 16 * 1024
+EXCEPTION_FRAME = 32 + 4
+THREAD_ENTRY = "main"
+DEFAULT_ISRS = ["SysTick_Handler:3", "PORTD_IRQHandler:0"]  # NVIC_SetPriority(PORTD_IRQn, 4) keeps 2 bits
+
+
+class Elf:
+    def __init__(self, path):
+        with open(path, "rb") as elf:
+            self.data = elf.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise SystemExit(f"{path}: not a 32 bit ELF file")
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+        self.sections = [struct.unpack_from("<IIIIIIIIII", self.data, shoff + i * shentsize) for i in range(shnum)]
+        names = self.sections[shstrndx]
+        self.names = [self.string(names, section[0]) for section in self.sections]
+        self.functions = {}
+        self.mapping = []
+        self.absolute = {}
+        for section in self.sections:
+            if section[1] == SHT_SYMTAB:
+                self.read_symbols(section)
+        self.mapping.sort()
+        self.mapping_starts = [start for start, _ in self.mapping]
+
+    def string(self, table, offset):
+        start = table[4] + offset
+        return self.data[start:self.data.index(b"\0", start)].decode()
+
+    def read_symbols(self, symtab):
+        strings = self.sections[symtab[6]]
+        for offset in range(symtab[4], symtab[4] + symtab[5], 16):
+            name, value, size, info, _, shndx = struct.unpack_from("<IIIBBH", self.data, offset)
+            text = self.string(strings, name)
+            if text in ("$t", "$d") or text.startswith(("$t.", "$d.")):
+                self.mapping.append((value, text[1]))
+            elif info & 0xF == STT_FUNC and size:
+                self.functions[text] = (value & ~1, size)
+            elif shndx == 0xFFF1:  # SHN_ABS, linker script constants
+                self.absolute[text] = value
+
+    def read(self, address, size):
+        for section in self.sections:
+            if section[1] == SHT_PROGBITS and section[3] <= address and address + size <= section[3] + section[5]:
+                start = section[4] + address - section[3]
+                return self.data[start:start + size]
+        return None
+
+    def is_data(self, address):
+        index = bisect.bisect_right(self.mapping_starts, address)
+        return index > 0 and self.mapping[index - 1][1] == "d"
+
+    def ram_used(self):
+        """Bytes of SRAM below the stack: data, bss, noinit, MTB buffer and heap."""
+        end = SRAM_BASE
+        for name, section in zip(self.names, self.sections):
+            if section[2] & SHF_ALLOC and SRAM_BASE <= section[3] < SRAM_BASE + SRAM_SIZE and \
+                    name not in (".heap2stackfill", ".stack"):
+                end = max(end, section[3] + section[5])
+        return end - SRAM_BASE
+
+
+def bl_target(address, first, second):
+    sign = (first >> 10) & 1
+    i1 = 1 - (((second >> 13) & 1) ^ sign)
+    i2 = 1 - (((second >> 11) & 1) ^ sign)
+    offset = (sign << 24) | (i1 << 23) | (i2 << 22) | ((first & 0x3FF) << 12) | ((second & 0x7FF) << 1)
+    if sign:
+        offset -= 1 << 25
+    return address + 4 + offset
+
+
+class Function:
+    def __init__(self, name, start, size):
+        self.name = name
+        self.start = start
+        self.size = size
+        self.cycles = 0
+        self.prologue = 0
+        self.calls = []          # target addresses of BL and tail calls
+        self.indirect = False
+        self.loop = False
+
+
+def decode(elf, name, start, size):
+    """Walks the Thumb instructions of a function, Cortex-M0+ cycles with branches taken."""
+    function = Function(name, start, size)
+    code = elf.read(start, size) or b""
+    address = start
+    in_prologue = True
+    while address < start + len(code):
+        if elf.is_data(address):
+            address += 2
+            continue
+        half, = struct.unpack_from("<H", code, address - start)
+        cycles = 1
+        length = 2
+        if half >> 11 in (0x1D, 0x1E, 0x1F) and address + 4 <= start + len(code):
+            second, = struct.unpack_from("<H", code, address - start + 2)
+            length = 4
+            if half >> 11 == 0x1E and (second >> 14) == 0x3 and (second >> 12) & 1:
+                cycles = 3
+                function.calls.append(bl_target(address, half, second))
+            else:
+                cycles = 3  # MSR, MRS, DSB, DMB, ISB
+        elif half >> 8 == 0x47:  # BX, BLX
+            rm = (half >> 3) & 0xF
+            cycles = 3 if half & 0x80 else 2
+            if half & 0x80 or rm != 14:
+                function.indirect = True
+        elif half >> 10 == 0x11 and (half >> 8) & 0x3 in (0, 2) and (half & 0x87) == 0x87:
+            cycles = 2  # ADD or MOV to pc
+            function.indirect = True
+        elif half >> 11 == 0x09 or half >> 12 in (0x5, 0x6, 0x7, 0x8, 0x9):
+            cycles = 2  # loads and stores
+        elif half >> 9 == 0x5A:  # PUSH
+            registers = bin(half & 0x1FF).count("1")
+            cycles = 1 + registers
+            if in_prologue:
+                function.prologue += 4 * registers
+        elif half >> 9 == 0x5E:  # POP
+            cycles = 1 + bin(half & 0x1FF).count("1") + (2 if half & 0x100 else 0)
+        elif half >> 7 == 0x161 and in_prologue:  # SUB SP, #imm
+            function.prologue += 4 * (half & 0x7F)
+        elif half >> 12 == 0xC:  # LDM, STM
+            cycles = 1 + bin(half & 0xFF).count("1")
+        elif half >> 12 == 0xD and (half >> 8) & 0xF < 0xE:  # conditional branch
+            cycles = 2
+            offset = (half & 0xFF) << 1
+            if offset & 0x100:
+                offset -= 0x200
+            function.loop |= offset < 0
+        elif half >> 11 == 0x1C:  # B
+            cycles = 2
+            offset = (half & 0x7FF) << 1
+            if offset & 0x800:
+                offset -= 0x1000
+            target = address + 4 + offset
+            if not start <= target < start + size:
+                function.calls.append(target)  # tail call
+            function.loop |= offset < 0
+        if half >> 9 not in (0x5A,) and half >> 7 != 0x161 and not (half >> 11 == 0x09):
+            in_prologue = False
+        function.cycles += cycles
+        address += length
+    return function
+
+
+class Analysis:
+    def __init__(self, elf, frames):
+        self.elf = elf
+        self.frames = frames
+        self.by_address = {}
+        self.functions = {}
+        for name, (start, size) in elf.functions.items():
+            self.functions[name] = decode(elf, name, start, size)
+            self.by_address[start] = name
+        self.notes = set()
+
+    def frame(self, name):
+        if name in self.frames:
+            return self.frames[name]
+        return self.functions[name].prologue
+
+    def callees(self, name):
+        for target in self.functions[name].calls:
+            callee = self.by_address.get(target)
+            if callee is None:
+                self.notes.add(f"{name}: call to {target:#x} outside any function")
+                continue
+            yield callee
+
+    def walk(self, name, path):
+        """Worst (stack, cycles) of a call tree, depth first."""
+        function = self.functions[name]
+        if function.indirect:
+            self.notes.add(f"{name}: call through a pointer not followed")
+        if function.loop:
+            self.notes.add(f"{name}: loop counted once")
+        stack, cycles = 0, 0
+        for callee in self.callees(name):
+            if callee in path:
+                self.notes.add(f"{name}: recursion through {callee} not bounded")
+                continue
+            callee_stack, callee_cycles = self.walk(callee, path + [callee])
+            stack = max(stack, callee_stack)
+            cycles += callee_cycles
+        return self.frame(name) + stack, function.cycles + cycles
+
+    def entry(self, name):
+        if name not in self.functions:
+            raise SystemExit(f"{name}: no such function in the .axf")
+        return self.walk(name, [name])
+
+
+def read_frames(build_dir):
+    """Frame size of every function from the .su files, largest when a name is in several."""
+    frames = {}
+    for root, _, files in os.walk(build_dir):
+        for file in files:
+            if not file.endswith(".su"):
+                continue
+            with open(os.path.join(root, file)) as su:
+                for line in su:
+                    fields = line.rstrip("\n").split("\t")
+                    if len(fields) < 2:
+                        continue
+                    name = fields[0].rsplit(":", 1)[-1]
+                    frames[name] = max(frames.get(name, 0), int(fields[1]))
+    return frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("axf")
+    parser.add_argument("build_dir")
+    parser.add_argument("--isr", action="append", help="handler and NVIC priority, NAME:PRIORITY")
+    parser.add_argument("--stack-budget", type=int, help="bytes, the _StackSize of the linker script by default")
+    parser.add_argument("--cycle-budget", action="append", default=[], help="NAME:CYCLES")
+    options = parser.parse_args()
+
+    elf = Elf(options.axf)
+    analysis = Analysis(elf, read_frames(options.build_dir))
+    isrs = [(name, int(priority)) for name, priority in
+            (isr.rsplit(":", 1) for isr in (options.isr or DEFAULT_ISRS))]
+
+    thread_stack, _ = analysis.entry(THREAD_ENTRY)
+    print(f"{'entry':24} {'priority':>8} {'stack':>6} {'cycles':>8}")
+    print(f"{THREAD_ENTRY:24} {'thread':>8} {thread_stack:6} {'-':>8}")
+    levels = {}
+    cycles = {}
+    for name, priority in isrs:
+        stack, isr_cycles = analysis.entry(name)
+        cycles[name] = isr_cycles
+        levels[priority] = max(levels.get(priority, 0), stack + EXCEPTION_FRAME)
+        print(f"{name:24} {priority:8} {stack:6} {isr_cycles:8}")
+    worst = thread_stack + sum(levels.values())
+    ram = elf.ram_used()
+    budget = options.stack_budget or elf.absolute.get("_StackSize", SRAM_SIZE - ram)
+    print(f"\nworst stack with nesting {worst} bytes, budget {budget}, "
+          f"static RAM {ram} + stack {worst} of {SRAM_SIZE} bytes")
+    for note in sorted(analysis.notes):
+        print(f"note: {note}")
+
+    failed = []
+    if worst > budget:
+        failed.append(f"stack {worst} > {budget} bytes")
+    if ram + worst > SRAM_SIZE:
+        failed.append(f"RAM {ram + worst} > {SRAM_SIZE} bytes")
+    for limit in options.cycle_budget:
+        name, value = limit.rsplit(":", 1)
+        if name not in cycles:
+            raise SystemExit(f"--cycle-budget {name}: not one of the --isr handlers")
+        if cycles[name] > int(value):
+            failed.append(f"{name} {cycles[name]} > {value} cycles")
+    for failure in failed:
+        print(f"over budget: {failure}", file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
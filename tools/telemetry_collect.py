@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""Collects the binary telemetry uplink of the firmware into a columnar log.
+
+Built with -DTELEMETRY the firmware sends one frame a second on the debug UART
+(see source/telemetry.h): a 24 byte header and the state changes of the second,
+a CRC-16/CCITT-FALSE, COBS encoded and ended by a 0 byte. The capture is split
+on 0, every frame decoded and checked, and the 16 bit counters extended to 32
+bits across wraps and board resets.
+
+With --out the frames are written as one little endian array per column, and
+the state changes as a second table, with schema.json giving the file, type and
+length of every column, e.g. numpy.fromfile(dir/"tick.u4", "<u4"). Console
+replies sent between frames are skipped, not counted as errors.
+
+Usage: telemetry_collect.py [capture.bin | /dev/ttyACM0 | -] [--out DIR] [--baud N]
+Reads stdin when no capture is given. Exits 1 on a CRC error or a lost frame.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+VERSION = 1
+HEADER = struct.Struct("<BBIBHBBHHHHHHB")
+CRC_BYTES = 2
+TICKS_PER_SECOND = 16
+CHUNK = 1 << 16
+BAUD = 115200  # BOARD_DEBUG_UART_BAUDRATE
+
+# Frame columns in header order: name, array type, extended from 16 bits
+FRAME_COLUMNS = [
+    ("sequence", "u1", False),
+    ("tick", "u4", False),
+    ("state", "u1", False),
+    ("time_in_state", "u2", False),
+    ("flags", "u1", False),
+    ("faults", "u1", False),
+    ("presses", "u4", True),
+    ("ignored", "u4", True),
+    ("actuations", "u4", True),
+    ("tsi_scans", "u4", True),
+    ("loop_iterations", "u2", False),
+    ("tsi_scan_cycles", "u2", False),
+    ("events", "u1", False),
+]
+EVENT_COLUMNS = [("event_tick", "u4"), ("event_state", "u1")]
+TYPECODES = {"u1": "B", "u2": "H", "u4": "I"}
+FLAGS = {0x01: "tripped", 0x02: "watchdog", 0x04: "pending", 0x08: "events_lost", 0x10: "frames_lost"}
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE a byte at a time, the firmware uses a nibble table for the same."""
+    crc = 0xFFFF
+    for byte in data:
+        crc = ((crc << 8) & 0xFFFF) ^ BYTE_TABLE[(crc >> 8) ^ byte]
+    return crc
+
+
+def byte_table():
+    """CRC of every byte value from a zero register."""
+    table = []
+    for value in range(256):
+        crc = value << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        table.append(crc & 0xFFFF)
+    return table
+
+
+BYTE_TABLE = byte_table()
+
+
+def cobs_decode(segment):
+    """Returns the decoded bytes, or None when a code points past the end."""
+    out = bytearray()
+    index = 0
+    length = len(segment)
+    while index < length:
+        code = segment[index]
+        end = index + code
+        if code == 0 or end > length:
+            return None
+        out += segment[index + 1:end]
+        index = end
+        if code != 0xFF and index < length:
+            out.append(0)
+    return bytes(out)
+
+
+def is_text(segment):
+    """Console replies are printable lines."""
+    return (b"\n" in segment or b"\r" in segment) and all(byte >= 0x20 or byte in b"\r\n\t" for byte in segment)
+
+
+def open_capture(path, baud):
+    """Returns a binary stream of the capture, a tty is put in raw mode at baud."""
+    if path in (None, "-"):
+        return sys.stdin.buffer
+    stream = open(path, "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+
+        tty.setraw(stream.fileno())
+        attributes = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, f"B{baud}")
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attributes)
+    return stream
+
+
+class Collector:
+    """Decodes frames and keeps the columns."""
+
+    def __init__(self):
+        self.columns = {name: [] for name, _, _ in FRAME_COLUMNS}
+        self.columns.update({name: [] for name, _ in EVENT_COLUMNS})
+        self.frames = 0
+        self.crc_errors = 0
+        self.text_segments = 0
+        self.lost = 0
+        self.resets = 0
+        self.bytes = 0
+        self.flags = 0
+        self.previous = None  # raw header of the last frame
+        self.totals = {}
+
+    def segment(self, segment):
+        """Handles the bytes between two 0 delimiters."""
+        if not segment:
+            return
+        payload = cobs_decode(segment)
+        if (payload is None or len(payload) < HEADER.size + CRC_BYTES or
+                crc16(payload[:-CRC_BYTES]) != int.from_bytes(payload[-CRC_BYTES:], "little")):
+            if is_text(segment):
+                self.text_segments += 1
+            else:
+                self.crc_errors += 1
+            return
+        fields = HEADER.unpack_from(payload)
+        if fields[0] != VERSION or len(payload) != HEADER.size + 2 * fields[-1] + CRC_BYTES:
+            self.crc_errors += 1
+            return
+        self.frame(fields[1:], payload[HEADER.size:-CRC_BYTES])
+
+    def frame(self, fields, events):
+        """Appends a decoded frame, counters are extended from the last one."""
+        sequence, tick = fields[0], fields[1]
+        previous = self.previous
+        if previous is not None and tick < previous[1]:
+            self.resets += 1  # the board restarted, its counters and sequence with it
+            previous = None  # counters go on from their totals
+        elif previous is not None:
+            self.lost += (sequence - previous[0] - 1) & 0xFF
+        for column, ((name, _, extended), value) in enumerate(zip(FRAME_COLUMNS, fields)):
+            if extended:
+                step = value if previous is None else (value - previous[column]) & 0xFFFF
+                self.totals[name] = (self.totals.get(name, 0) + step) & 0xFFFFFFFF
+                value = self.totals[name]
+            self.columns[name].append(value)
+        for index in range(0, len(events), 2):
+            self.columns["event_tick"].append((tick - events[index]) & 0xFFFFFFFF)
+            self.columns["event_state"].append(events[index + 1])
+        self.flags |= fields[4]
+        self.frames += 1
+        self.previous = fields
+
+    def write(self, directory):
+        """Writes one array per column and schema.json."""
+        os.makedirs(directory, exist_ok=True)
+        schema = {"version": VERSION, "ticks_per_second": TICKS_PER_SECOND, "tables": {}}
+        tables = {"frames": [(name, kind) for name, kind, _ in FRAME_COLUMNS], "events": EVENT_COLUMNS}
+        for table, columns in tables.items():
+            schema["tables"][table] = []
+            for name, kind in columns:
+                path = f"{name}.{kind}"
+                values = self.columns[name]
+                with open(os.path.join(directory, path), "wb") as column_file:
+                    column_file.write(struct.pack(f"<{len(values)}{TYPECODES[kind]}", *values))
+                schema["tables"][table].append({"column": name, "file": path, "type": "<" + kind,
+                                                "length": len(values)})
+        with open(os.path.join(directory, "schema.json"), "w") as schema_file:
+            json.dump(schema, schema_file, indent=1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("capture", nargs="?")
+    parser.add_argument("--out", help="directory of the columnar log")
+    parser.add_argument("--baud", type=int, default=BAUD, help=f"of a tty, default {BAUD}")
+    options = parser.parse_args()
+
+    stream = open_capture(options.capture, options.baud)
+    collector = Collector()
+    pending = b""
+    start = time.perf_counter()
+    try:
+        while True:
+            chunk = stream.read(CHUNK)
+            if not chunk:
+                break
+            collector.bytes += len(chunk)
+            segments = (pending + chunk).split(b"\x00")
+            pending = segments.pop()
+            for segment in segments:
+                collector.segment(segment)
+    except KeyboardInterrupt:
+        pass
+    seconds = time.perf_counter() - start
+    if pending:
+        collector.crc_errors += 0 if is_text(pending) else 1  # a frame cut by the end of the capture
+
+    if options.out:
+        collector.write(options.out)
+    ticks = collector.columns["tick"]
+    span = (ticks[-1] - ticks[0] + TICKS_PER_SECOND) / TICKS_PER_SECOND if ticks else 0
+    print(f"{collector.frames} frames, {len(collector.columns['event_state'])} state changes, "
+          f"{collector.crc_errors} CRC errors, {collector.lost} frames lost, {collector.resets} resets, "
+          f"{collector.text_segments} console replies")
+    if span > 0 and collector.resets == 0:
+        print(f"{collector.bytes} bytes over {span:.0f} s of uplink, {collector.bytes / span:.1f} bytes/s "
+              f"({100.0 * collector.bytes * 10 / span / options.baud:.2f} % of {options.baud} baud)")
+    if seconds > 0:
+        print(f"parsed {collector.frames / seconds:.0f} frames/s, {collector.bytes / seconds / 1e6:.2f} MB/s")
+    if collector.flags:
+        print("flags seen: " + " ".join(name for bit, name in FLAGS.items() if collector.flags & bit))
+    return 1 if collector.crc_errors or collector.lost else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -216,8 +216,10 @@ static debug_console_state_t s_debugConsole = {.type = DEBUG_CONSOLE_DEVICE_TYPE
 /*******************************************************************************
  * Prototypes
  ******************************************************************************/
-#if SDK_DEBUGCONSOLE
+#if SDK_DEBUGCONSOLE || defined(LOGFMT_BENCHMARK)
 static int DbgConsole_PrintfFormattedData(PUTCHAR_FUNC func_ptr, const char *fmt, va_list ap);
+#endif /* SDK_DEBUGCONSOLE || LOGFMT_BENCHMARK */
+#if SDK_DEBUGCONSOLE
 static int DbgConsole_ScanfFormattedData(const char *line_ptr, char *format, va_list args_ptr);
 double modf(double input_dbl, double *intpart_ptr);
 #endif /* SDK_DEBUGCONSOLE */
@@ -508,7 +510,9 @@ static uint32_t DbgConsole_ScanIgnoreWhiteSpace(const char **s)
     }
     return count;
 }
+#endif /* SDK_DEBUGCONSOLE */
 
+#if SDK_DEBUGCONSOLE || defined(LOGFMT_BENCHMARK)
 /*!
  * @brief This function puts padding character.
  *
@@ -1302,6 +1306,40 @@ static int DbgConsole_PrintfFormattedData(PUTCHAR_FUNC func_ptr, const char *fmt
     return count;
 }
 
+#if defined(LOGFMT_BENCHMARK)
+/* Next character of DbgConsole_BenchmarkSprintf(). */
+static char *s_benchmarkBuffer;
+
+/*!
+ * @brief Stores a character of DbgConsole_BenchmarkSprintf().
+ *
+ * @param[in] ch Character.
+ * @return 1
+ */
+static int DbgConsole_BenchmarkPutchar(int ch)
+{
+    *s_benchmarkBuffer++ = (char)ch;
+    return 1;
+}
+
+/* See fsl_debug_console.h for documentation of this function. */
+int DbgConsole_BenchmarkSprintf(char *buffer, const char *fmt_s, ...)
+{
+    va_list ap;
+    int result;
+
+    s_benchmarkBuffer = buffer;
+    va_start(ap, fmt_s);
+    result = DbgConsole_PrintfFormattedData(DbgConsole_BenchmarkPutchar, fmt_s, ap);
+    va_end(ap);
+    *s_benchmarkBuffer = '\0';
+
+    return result;
+}
+#endif /* LOGFMT_BENCHMARK */
+#endif /* SDK_DEBUGCONSOLE || LOGFMT_BENCHMARK */
+
+#if SDK_DEBUGCONSOLE
 /*!
  * @brief Converts an input line of ASCII characters based upon a provided
  * string format.
@@ -182,6 +182,18 @@ int DbgConsole_Getchar(void);
 
 #endif /* SDK_DEBUGCONSOLE */
 
+#if defined(LOGFMT_BENCHMARK)
+/*!
+ * @brief Formats into a buffer with the formatter of DbgConsole_Printf, for the cycle benchmark of
+ * the LOG formatter. Built with LOGFMT_BENCHMARK, whichever printf SDK_DEBUGCONSOLE selects.
+ *
+ * @param   buffer  Buffer large enough for the formatted string and its null character.
+ * @param   fmt_s   Format control string.
+ * @return  Number of characters stored, without the null character.
+ */
+int DbgConsole_BenchmarkSprintf(char *buffer, const char *fmt_s, ...);
+#endif /* LOGFMT_BENCHMARK */
+
 /*! @} */
 
 #if defined(__cplusplus)